@@ -0,0 +1,30 @@
+// Benchmarks for AxisAlignerEigen.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <memory>
+
+#include "benchmarks.hpp"
+#include "mesaac_shape/axis_aligner_eigen.hpp"
+
+using namespace std;
+
+namespace mesaac::benchmarks {
+
+void add_axis_aligner_eigen_benchmarks(BenchmarkRunner &runner,
+                                       const BenchmarkData &data) {
+  const float atom_scale = 1.0;
+  const auto aligner =
+      make_shared<shape::AxisAlignerEigen>(data.sphere, atom_scale, true);
+  // As for AxisAligner, this includes the cost of copying atoms.
+  runner.add("AxisAlignerEigen::align_to_axes",
+             [&data, aligner, i = size_t(0),
+              atoms = mol::AtomVector()]() mutable {
+               atoms = data.mols[i].atoms();
+               i = (i + 1) % data.mols.size();
+               aligner->align_to_axes(atoms);
+               keep(atoms);
+             });
+}
+
+} // namespace mesaac::benchmarks
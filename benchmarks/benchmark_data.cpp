@@ -0,0 +1,63 @@
+// Reads the inputs shared by the benchmark suites.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "benchmarks.hpp"
+#include "mesaac_mol/io/sdreader.hpp"
+#include "mesaac_shape/point_set.hpp"
+
+using namespace std;
+
+namespace mesaac::benchmarks {
+
+namespace {
+string read_text(const filesystem::path &path) {
+  ifstream inf(path);
+  if (!inf) {
+    throw runtime_error(
+        format("Cannot open {} for reading.", path.string()));
+  }
+  ostringstream result;
+  result << inf.rdbuf();
+  return result.str();
+}
+
+vector<mol::Mol> read_mols(const string &sd_text, const string &pathname) {
+  vector<mol::Mol> result;
+  istringstream ins(sd_text);
+  mol::SDReader reader(ins, pathname);
+  for (;;) {
+    auto read_result = reader.read();
+    if (!read_result.is_ok()) {
+      if (!reader.eof()) {
+        throw runtime_error(read_result.error());
+      }
+      break;
+    }
+    result.push_back(std::move(read_result).value());
+  }
+  if (result.empty()) {
+    throw runtime_error(format("{} has no structures.", pathname));
+  }
+  return result;
+}
+} // namespace
+
+BenchmarkData load_benchmark_data(const filesystem::path &data_dir) {
+  const auto sd_path = data_dir / "sd_files" / "cox2_3d.sd";
+  BenchmarkData result;
+  result.sd_text = read_text(sd_path);
+  result.mols = read_mols(result.sd_text, sd_path.string());
+  result.sphere = shape::read_point_set(data_dir / "hammersley" /
+                                        "hamm_spheroid_20k_11rad.txt");
+  result.ellipsoid = shape::read_point_set(data_dir / "hammersley" /
+                                           "hamm_ellipsoid_20k_11rad.txt");
+  return result;
+}
+
+} // namespace mesaac::benchmarks
@@ -0,0 +1,166 @@
+// Times small units of work, and reports the timings as JSON.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "benchmark_runner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <numeric>
+
+using namespace std;
+
+namespace mesaac::benchmarks {
+
+namespace {
+using Clock = chrono::steady_clock;
+
+// Time iterations calls of body, in nanoseconds.
+double time_iterations(const BenchmarkRunner::Body &body, size_t iterations) {
+  const auto start = Clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    body();
+  }
+  const auto elapsed = Clock::now() - start;
+  return chrono::duration<double, nano>(elapsed).count();
+}
+
+string json_string(const string &value) {
+  string result("\"");
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    }
+    result += c;
+  }
+  return result + "\"";
+}
+
+string utc_timestamp() {
+  const time_t now = time(nullptr);
+  tm utc;
+  gmtime_r(&now, &utc);
+  char buffer[32];
+  strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+  return buffer;
+}
+
+const char *build_type() {
+#if defined(MESAAC_BUILD_TYPE)
+  return MESAAC_BUILD_TYPE;
+#else
+  return "";
+#endif
+}
+
+bool have_openmp() {
+#if HAVE_OPENMP
+  return true;
+#else
+  return false;
+#endif
+}
+} // namespace
+
+double BenchmarkResult::min_ns() const {
+  return *min_element(sample_ns.begin(), sample_ns.end());
+}
+
+double BenchmarkResult::max_ns() const {
+  return *max_element(sample_ns.begin(), sample_ns.end());
+}
+
+double BenchmarkResult::mean_ns() const {
+  return accumulate(sample_ns.begin(), sample_ns.end(), 0.0) /
+         sample_ns.size();
+}
+
+double BenchmarkResult::median_ns() const {
+  vector<double> sorted(sample_ns);
+  sort(sorted.begin(), sorted.end());
+  const size_t mid = sorted.size() / 2;
+  return (sorted.size() % 2) ? sorted[mid]
+                             : (sorted[mid - 1] + sorted[mid]) / 2.0;
+}
+
+double BenchmarkResult::stddev_ns() const {
+  const double mean = mean_ns();
+  double sum_sqr = 0.0;
+  for (const double value : sample_ns) {
+    sum_sqr += (value - mean) * (value - mean);
+  }
+  return sqrt(sum_sqr / sample_ns.size());
+}
+
+BenchmarkRunner::BenchmarkRunner(chrono::nanoseconds min_sample_time,
+                                 unsigned int num_samples,
+                                 const string &filter)
+    : m_min_sample_time(min_sample_time),
+      m_num_samples(max(num_samples, 1U)), m_filter(filter) {}
+
+bool BenchmarkRunner::is_selected(const string &name) const {
+  return name.find(m_filter) != string::npos;
+}
+
+void BenchmarkRunner::add(const string &name, Body body) {
+  if (is_selected(name)) {
+    m_benchmarks.push_back({.name = name, .body = body});
+  }
+}
+
+vector<BenchmarkResult> BenchmarkRunner::run(ostream &progress) const {
+  vector<BenchmarkResult> result;
+  for (const auto &benchmark : m_benchmarks) {
+    progress << benchmark.name << "..." << flush;
+    result.push_back(run_one(benchmark));
+    progress << " " << result.back().median_ns() << " ns" << endl;
+  }
+  return result;
+}
+
+BenchmarkResult BenchmarkRunner::run_one(const Benchmark &benchmark) const {
+  // Calibrate.  The first call also warms caches.
+  const double min_ns = m_min_sample_time.count();
+  size_t iterations = 1;
+  while (time_iterations(benchmark.body, iterations) < min_ns) {
+    iterations *= 2;
+  }
+
+  BenchmarkResult result{.name = benchmark.name,
+                         .iterations = iterations,
+                         .sample_ns = {}};
+  for (unsigned int i = 0; i < m_num_samples; ++i) {
+    result.sample_ns.push_back(time_iterations(benchmark.body, iterations) /
+                               iterations);
+  }
+  return result;
+}
+
+void write_json(ostream &outs, const vector<BenchmarkResult> &results) {
+  outs << "{\n"
+       << "  \"context\": {\n"
+       << "    \"date\": " << json_string(utc_timestamp()) << ",\n"
+       << "    \"compiler\": " << json_string(__VERSION__) << ",\n"
+       << "    \"build_type\": " << json_string(build_type()) << ",\n"
+       << "    \"openmp\": " << (have_openmp() ? "true" : "false") << "\n"
+       << "  },\n"
+       << "  \"benchmarks\": [";
+  const char *sep = "\n";
+  for (const auto &result : results) {
+    outs << sep << "    {\n"
+         << "      \"name\": " << json_string(result.name) << ",\n"
+         << "      \"iterations\": " << result.iterations << ",\n"
+         << "      \"samples\": " << result.sample_ns.size() << ",\n"
+         << "      \"min_ns\": " << result.min_ns() << ",\n"
+         << "      \"median_ns\": " << result.median_ns() << ",\n"
+         << "      \"mean_ns\": " << result.mean_ns() << ",\n"
+         << "      \"max_ns\": " << result.max_ns() << ",\n"
+         << "      \"stddev_ns\": " << result.stddev_ns() << "\n"
+         << "    }";
+    sep = ",\n";
+  }
+  outs << "\n  ]\n}" << endl;
+}
+
+} // namespace mesaac::benchmarks
@@ -0,0 +1,123 @@
+// Times small units of work, and reports the timings as JSON.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mesaac::benchmarks {
+
+/**
+ * @brief Keep the compiler from optimizing away the computation of a value.
+ * @param value a benchmark result which is otherwise unused
+ */
+template <typename T> inline void keep(const T &value) {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+/**
+ * @brief The timings of a single benchmark.
+ */
+struct BenchmarkResult {
+  /**
+   * @brief the name of the benchmark
+   */
+  std::string name;
+
+  /**
+   * @brief the number of times the benchmark body ran for each sample
+   */
+  std::size_t iterations;
+
+  /**
+   * @brief per-iteration times of each sample, in nanoseconds
+   */
+  std::vector<double> sample_ns;
+
+  double min_ns() const;
+  double max_ns() const;
+  double mean_ns() const;
+  double median_ns() const;
+  double stddev_ns() const;
+};
+
+/**
+ * @brief Runs named benchmarks, each of which performs one unit of work per
+ * call.
+ *
+ * Each benchmark is first calibrated: its iteration count is doubled until
+ * a batch of iterations takes at least the minimum sample time.  Then
+ * several batches of that many iterations are timed.
+ */
+class BenchmarkRunner {
+public:
+  /**
+   * @brief a callable which performs one unit of work
+   */
+  using Body = std::function<void()>;
+
+  /**
+   * @brief Create a new instance.
+   * @param min_sample_time the minimum duration of each timed sample
+   * @param num_samples the number of samples to time
+   * @param filter run only benchmarks whose names contain this text
+   */
+  BenchmarkRunner(std::chrono::nanoseconds min_sample_time,
+                  unsigned int num_samples, const std::string &filter);
+
+  /**
+   * @brief Find out whether a benchmark would be run.  Callers can use this
+   * to skip setup for benchmarks which are filtered out.
+   * @param name the name of a benchmark
+   * @return whether the name matches the filter
+   */
+  bool is_selected(const std::string &name) const;
+
+  /**
+   * @brief Add a benchmark, if its name matches the filter.
+   * @param name the name of the benchmark
+   * @param body performs one unit of work
+   */
+  void add(const std::string &name, Body body);
+
+  /**
+   * @brief Run all of the added benchmarks, in the order added.
+   * @param progress stream to which to report progress
+   * @return the timings of each benchmark
+   */
+  std::vector<BenchmarkResult> run(std::ostream &progress) const;
+
+private:
+  struct Benchmark {
+    std::string name;
+    Body body;
+  };
+
+  const std::chrono::nanoseconds m_min_sample_time;
+  const unsigned int m_num_samples;
+  const std::string m_filter;
+  std::vector<Benchmark> m_benchmarks;
+
+  BenchmarkResult run_one(const Benchmark &benchmark) const;
+};
+
+/**
+ * @brief Write benchmark timings as a JSON document.
+ *
+ * The document holds a "context" object, describing the build, and a
+ * "benchmarks" array with one object per benchmark.  Times are per
+ * iteration, in nanoseconds.
+ *
+ * @param outs the stream to which to write
+ * @param results the timings to write
+ */
+void write_json(std::ostream &outs,
+                const std::vector<BenchmarkResult> &results);
+
+} // namespace mesaac::benchmarks
@@ -0,0 +1,73 @@
+// Declares the benchmark suites of mesaac_benchmarks.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "benchmark_runner.hpp"
+#include "mesaac_mol/mol.hpp"
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::benchmarks {
+
+/**
+ * @brief Inputs shared by the benchmark suites, read from the test data
+ * directory.
+ */
+struct BenchmarkData {
+  /**
+   * @brief the text of an SD file of 3D conformers
+   */
+  std::string sd_text;
+
+  /**
+   * @brief the conformers read from sd_text
+   */
+  std::vector<mol::Mol> mols;
+
+  /**
+   * @brief Hammersley sphere points, for axis alignment
+   */
+  shape::PointList sphere;
+
+  /**
+   * @brief Hammersley ellipsoid points, for fingerprinting
+   */
+  shape::PointList ellipsoid;
+};
+
+/**
+ * @brief Read the benchmark inputs.
+ * @param data_dir the test data directory, e.g., tests/data
+ * @return the benchmark inputs
+ * @throw std::runtime_error if an input cannot be read
+ */
+BenchmarkData load_benchmark_data(const std::filesystem::path &data_dir);
+
+/**
+ * @brief Add benchmarks for VolBox, Fingerprinter and AxisAligner.
+ */
+void add_shape_benchmarks(BenchmarkRunner &runner, const BenchmarkData &data);
+
+/**
+ * @brief Add benchmarks for AxisAlignerEigen.  This is available only when
+ * building with PROVIDE_EIGEN.
+ */
+void add_axis_aligner_eigen_benchmarks(BenchmarkRunner &runner,
+                                       const BenchmarkData &data);
+
+/**
+ * @brief Add benchmarks for each MeasuresBase subclass.
+ */
+void add_measures_benchmarks(BenchmarkRunner &runner);
+
+/**
+ * @brief Add benchmarks for SDReader and SDWriter.
+ */
+void add_mol_io_benchmarks(BenchmarkRunner &runner, const BenchmarkData &data);
+
+} // namespace mesaac::benchmarks
@@ -0,0 +1,137 @@
+// Benchmarks for the MeasuresBase subclasses.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <format>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "benchmarks.hpp"
+#include "mesaac_measures/bub.hpp"
+#include "mesaac_measures/compressed_fp.hpp"
+#include "mesaac_measures/contingency_counts.hpp"
+#include "mesaac_measures/cosine.hpp"
+#include "mesaac_measures/euclidean.hpp"
+#include "mesaac_measures/hamann.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+#include "mesaac_measures/tanimoto.hpp"
+#include "mesaac_measures/tversky.hpp"
+
+using namespace std;
+
+namespace mesaac::benchmarks {
+
+namespace {
+// Fingerprint lengths, similar to those of 10k and 20k point clouds.
+const unsigned int NumBitsList[] = {10240, 20480};
+const unsigned int NumFingerprints = 64;
+// Roughly the fraction of bits set in a typical shape fingerprint.
+const double BitDensity = 0.3;
+// The fraction of bits set in a low-density fingerprint, e.g. a small
+// ligand in a large point cloud.
+const double SparseBitDensity = 0.02;
+
+shared_ptr<const shape_defs::ArrayBitVectors>
+get_fingerprints(unsigned int num_bits, double density = BitDensity) {
+  mt19937 gen(20101120);
+  bernoulli_distribution is_set(density);
+  auto result = make_shared<shape_defs::ArrayBitVectors>();
+  for (unsigned int i = 0; i < NumFingerprints; ++i) {
+    shape_defs::BitVector fp(num_bits);
+    for (unsigned int b = 0; b < num_bits; ++b) {
+      fp[b] = is_set(gen);
+    }
+    result->push_back(fp);
+  }
+  return result;
+}
+} // namespace
+
+void add_measures_benchmarks(BenchmarkRunner &runner) {
+  const vector<measures::MeasuresBase::Ptr> all_measures{
+      make_shared<measures::Tanimoto>(), make_shared<measures::BUB>(),
+      make_shared<measures::Cosine>(),   make_shared<measures::Euclidean>(),
+      make_shared<measures::Hamann>(),   make_shared<measures::Tversky>(0.5)};
+
+  for (const unsigned int num_bits : NumBitsList) {
+    const auto fps = get_fingerprints(num_bits);
+    for (const auto &measure : all_measures) {
+      // Each iteration measures one pair of fingerprints.
+      runner.add(format("{}::similarity/{}", measure->name(), num_bits),
+                 [measure, fps, i = 0U]() mutable {
+                   const unsigned int j = (i + 1) % NumFingerprints;
+                   keep(measure->similarity((*fps)[i], (*fps)[j]));
+                   i = j;
+                 });
+    }
+
+    // Each iteration computes every measure of one pair, first one
+    // measure at a time, then from one set of contingency counts.
+    runner.add(format("all_measures::similarity/{}", num_bits),
+               [all_measures, fps, i = 0U]() mutable {
+                 const unsigned int j = (i + 1) % NumFingerprints;
+                 for (const auto &measure : all_measures) {
+                   keep(measure->similarity((*fps)[i], (*fps)[j]));
+                 }
+                 i = j;
+               });
+    runner.add(format("all_measures::contingency_counts/{}", num_bits),
+               [all_measures, fps, i = 0U]() mutable {
+                 const unsigned int j = (i + 1) % NumFingerprints;
+                 const auto counts =
+                     measures::get_contingency_counts((*fps)[i], (*fps)[j]);
+                 for (const auto &measure : all_measures) {
+                   keep(measure->similarity(counts));
+                 }
+                 i = j;
+               });
+
+    // Each iteration measures one fingerprint against all of them, first
+    // one pair at a time, then in one batch.
+    for (const auto &measure : all_measures) {
+      // The measurer refers to *fps, which the lambdas keep alive.
+      const auto measurer =
+          measures::shape::get_fp_measurer(measure, true, *fps);
+      runner.add(format("{}::measurer_value/{}", measure->name(), num_bits),
+                 [measurer, fps, i = 0U]() mutable {
+                   for (unsigned int j = 0; j < NumFingerprints; ++j) {
+                     keep(measurer->value(i, j));
+                   }
+                   i = (i + 1) % NumFingerprints;
+                 });
+      runner.add(format("{}::measurer_value_row/{}", measure->name(), num_bits),
+                 [measurer, fps, i = 0U,
+                  row = vector<float>(NumFingerprints)]() mutable {
+                   measurer->value_row(i, 0, NumFingerprints, row.data());
+                   keep(row[0]);
+                   i = (i + 1) % NumFingerprints;
+                 });
+    }
+
+    // Each iteration counts one pair of low-density fingerprints, first as
+    // bit vectors, then compressed.
+    const auto sparse_fps = get_fingerprints(num_bits, SparseBitDensity);
+    const auto compressed_fps =
+        make_shared<const vector<measures::CompressedFP>>(sparse_fps->begin(),
+                                                          sparse_fps->end());
+    runner.add(format("sparse::contingency_counts/{}", num_bits),
+               [sparse_fps, i = 0U]() mutable {
+                 const unsigned int j = (i + 1) % NumFingerprints;
+                 keep(measures::get_contingency_counts((*sparse_fps)[i],
+                                                       (*sparse_fps)[j])
+                          .a);
+                 i = j;
+               });
+    runner.add(format("compressed::contingency_counts/{}", num_bits),
+               [compressed_fps, i = 0U]() mutable {
+                 const unsigned int j = (i + 1) % NumFingerprints;
+                 keep(measures::get_contingency_counts((*compressed_fps)[i],
+                                                       (*compressed_fps)[j])
+                          .a);
+                 i = j;
+               });
+  }
+}
+
+} // namespace mesaac::benchmarks
@@ -0,0 +1,93 @@
+// Micro-benchmarks for shape fingerprinting and measures hot paths.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "benchmarks.hpp"
+#include "mesaac_arg_parser/arg_parser.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+
+struct CmdLine {
+  Option<filesystem::path>::Ptr output_opt = Option<filesystem::path>::create(
+      "-o", "--output",
+      "write JSON results to the named file - default is standard output");
+
+  Option<string>::Ptr filter_opt = Option<string>::create(
+      "-f", "--filter",
+      "run only the benchmarks whose names contain FILTER, e.g. VolBox");
+
+  Option<unsigned int>::Ptr min_time_opt = Option<unsigned int>::create(
+      "-t", "--min-time",
+      "minimum duration of each timed sample, in milliseconds - default is "
+      "100");
+
+  Option<unsigned int>::Ptr samples_opt = Option<unsigned int>::create(
+      "-n", "--samples",
+      "number of timed samples per benchmark - default is 10");
+
+  Option<filesystem::path>::Ptr data_dir_opt =
+      Option<filesystem::path>::create(
+          "-d", "--data-dir",
+          std::format("directory of benchmark inputs - default is {}",
+                      BENCHMARK_DATA_DIR));
+
+  ArgParser parser = ArgParser(
+      {output_opt, filter_opt, min_time_opt, samples_opt, data_dir_opt}, {},
+      "Time shape fingerprinting, alignment, measures and SD file I/O, and "
+      "report the timings as JSON.  Progress is reported on standard error.");
+};
+} // namespace
+
+int main(int argc, const char **const argv) {
+  using namespace mesaac::benchmarks;
+
+  CmdLine opts;
+  const int status = opts.parser.parse_args(argc, argv);
+  if (status != 0 || opts.parser.usage_requested()) {
+    return status;
+  }
+
+  try {
+    const auto data = load_benchmark_data(
+        opts.data_dir_opt->value_or(filesystem::path(BENCHMARK_DATA_DIR)));
+
+    const chrono::milliseconds min_time(opts.min_time_opt->value_or(100));
+    BenchmarkRunner runner(min_time, opts.samples_opt->value_or(10),
+                           opts.filter_opt->value_or(""));
+    add_shape_benchmarks(runner, data);
+#if PROVIDE_EIGEN
+    add_axis_aligner_eigen_benchmarks(runner, data);
+#endif
+    add_measures_benchmarks(runner);
+    add_mol_io_benchmarks(runner, data);
+
+    const auto results = runner.run(cerr);
+    if (opts.output_opt->has_value()) {
+      const auto path = opts.output_opt->value();
+      ofstream outf(path);
+      if (!outf) {
+        throw runtime_error(
+            std::format("Cannot open {} for writing.", path.string()));
+      }
+      write_json(outf, results);
+    } else {
+      write_json(cout, results);
+    }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
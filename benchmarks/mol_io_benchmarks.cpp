@@ -0,0 +1,81 @@
+// Benchmarks for SDReader and SDWriter.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <memory>
+#include <sstream>
+
+#include "benchmarks.hpp"
+#include "mesaac_mol/io/sdreader.hpp"
+#include "mesaac_mol/io/sdwriter.hpp"
+
+using namespace std;
+
+namespace mesaac::benchmarks {
+
+namespace {
+// Reads the same SD text over and over, one structure at a time.
+class RepeatingReader {
+public:
+  RepeatingReader(const string &sd_text) : m_sd_text(sd_text) { rewind(); }
+
+  mol::Mol read() {
+    auto result = m_reader->read();
+    if (result.is_ok()) {
+      return std::move(result).value();
+    }
+    rewind();
+    return m_reader->read().value();
+  }
+
+  // Read into mol, reusing its storage.
+  void read(mol::Mol &mol) {
+    if (!m_reader->read(mol).is_ok()) {
+      rewind();
+      keep(m_reader->read(mol).is_ok());
+    }
+  }
+
+private:
+  const string &m_sd_text;
+  unique_ptr<istringstream> m_ins;
+  unique_ptr<mol::SDReader> m_reader;
+
+  void rewind() {
+    m_reader.reset();
+    m_ins = make_unique<istringstream>(m_sd_text);
+    m_reader = make_unique<mol::SDReader>(*m_ins, "(benchmark)");
+  }
+};
+
+// Writes structures to an in-memory stream, which is emptied each time
+// all of the structures have been written.
+struct MemoryWriter {
+  ostringstream outs;
+  mol::SDWriter writer{outs};
+};
+} // namespace
+
+void add_mol_io_benchmarks(BenchmarkRunner &runner,
+                           const BenchmarkData &data) {
+  // Each iteration reads or writes one structure.
+  const auto reader = make_shared<RepeatingReader>(data.sd_text);
+  runner.add("SDReader::read", [reader]() { keep(reader->read()); });
+  const auto refill_reader = make_shared<RepeatingReader>(data.sd_text);
+  const auto refill_mol = make_shared<mol::Mol>();
+  runner.add("SDReader::read_refill", [refill_reader, refill_mol]() {
+    refill_reader->read(*refill_mol);
+    keep(refill_mol->num_atoms());
+  });
+
+  const auto writer = make_shared<MemoryWriter>();
+  runner.add("SDWriter::write", [&data, writer, i = size_t(0)]() mutable {
+    if (i == 0) {
+      writer->outs.str("");
+    }
+    keep(writer->writer.write(data.mols[i]));
+    i = (i + 1) % data.mols.size();
+  });
+}
+
+} // namespace mesaac::benchmarks
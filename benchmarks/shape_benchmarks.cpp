@@ -0,0 +1,114 @@
+// Benchmarks for VolBox, Fingerprinter and AxisAligner.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <memory>
+
+#include "benchmarks.hpp"
+#include "mesaac_shape/axis_aligner.hpp"
+#include "mesaac_shape/fingerprinter.hpp"
+#include "mesaac_shape/vol_box.hpp"
+
+using namespace std;
+
+namespace mesaac::benchmarks {
+
+namespace {
+// The atom radius scale factor, as for shape_fingerprinter.
+const float AtomScale = 1.0;
+const unsigned int NumFolds = 2;
+
+// Conformers aligned to their principal axes, as they are before
+// fingerprinting.
+struct AlignedMols {
+  vector<mol::Mol> mols;
+  // Heavy atom x, y, z, radius, for each conformer.
+  vector<shape::PointList> spheres;
+  shape::VolBox volbox;
+
+  AlignedMols(const BenchmarkData &data)
+      : mols(data.mols), volbox(data.ellipsoid, AtomScale) {
+    shape::AxisAligner aligner(data.sphere, AtomScale, true);
+    for (auto &mol : mols) {
+      aligner.align_to_axes(mol);
+      shape::PointList heavies;
+      aligner.get_atom_points(mol.atoms(), heavies, false);
+      spheres.push_back(heavies);
+    }
+  }
+};
+
+// Each benchmark iteration handles one conformer, cycling through the set.
+struct Cycle {
+  size_t size;
+  size_t index = 0;
+
+  size_t next() {
+    const size_t result = index;
+    index = (index + 1) % size;
+    return result;
+  }
+};
+
+void add_volbox_benchmarks(BenchmarkRunner &runner,
+                           const shared_ptr<AlignedMols> &aligned) {
+  runner.add("VolBox::set_bits_for_spheres",
+             [aligned, cycle = Cycle{aligned->mols.size()},
+              bits = shape_defs::BitVector()]() mutable {
+               aligned->volbox.set_bits_for_spheres(
+                   aligned->spheres[cycle.next()], bits, true, 0);
+               keep(bits);
+             });
+
+  const size_t folded_size = aligned->volbox.size() >> NumFolds;
+  runner.add("VolBox::set_folded_bits_for_spheres",
+             [aligned, cycle = Cycle{aligned->mols.size()},
+              bits = shape_defs::BitVector(folded_size)]() mutable {
+               bits.reset();
+               aligned->volbox.set_folded_bits_for_spheres(
+                   aligned->spheres[cycle.next()], bits, NumFolds, 0);
+               keep(bits);
+             });
+}
+
+void add_fingerprinter_benchmarks(BenchmarkRunner &runner,
+                                  const shared_ptr<AlignedMols> &aligned) {
+  const auto fingerprinter = make_shared<shape::Fingerprinter>(aligned->volbox);
+  runner.add("Fingerprinter::compute",
+             [aligned, fingerprinter, cycle = Cycle{aligned->mols.size()},
+              sfp = shape::ShapeFingerprint()]() mutable {
+               fingerprinter->compute(aligned->mols[cycle.next()].atoms(),
+                                      sfp);
+               keep(sfp);
+             });
+}
+
+void add_axis_aligner_benchmarks(BenchmarkRunner &runner,
+                                 const BenchmarkData &data) {
+  const auto aligner =
+      make_shared<shape::AxisAligner>(data.sphere, AtomScale, true);
+  // The benchmark includes the cost of copying each conformer's atoms,
+  // since alignment modifies them.
+  runner.add("AxisAligner::align_to_axes",
+             [&data, aligner, cycle = Cycle{data.mols.size()},
+              atoms = mol::AtomVector()]() mutable {
+               atoms = data.mols[cycle.next()].atoms();
+               aligner->align_to_axes(atoms);
+               keep(atoms);
+             });
+}
+} // namespace
+
+void add_shape_benchmarks(BenchmarkRunner &runner, const BenchmarkData &data) {
+  // Skip the alignment setup if none of its benchmarks will run.
+  if (runner.is_selected("VolBox::set_bits_for_spheres") ||
+      runner.is_selected("VolBox::set_folded_bits_for_spheres") ||
+      runner.is_selected("Fingerprinter::compute")) {
+    const auto aligned = make_shared<AlignedMols>(data);
+    add_volbox_benchmarks(runner, aligned);
+    add_fingerprinter_benchmarks(runner, aligned);
+  }
+  add_axis_aligner_benchmarks(runner, data);
+}
+
+} // namespace mesaac::benchmarks
@@ -0,0 +1,262 @@
+#!/usr/bin/env python
+"""Report the recall and speed of MinHash shape fingerprint indexes against
+brute-force search, to help choose LSH parameters.
+
+A synthetic target library and a separate set of synthetic queries are
+generated (see synthetic_library.py) and cached in a work directory.  The
+queries are searched by brute force with measures_shape_fp --search, by an
+exact popcount index, and by a MinHash index for each requested
+BANDSxROWS setting.  For each method, index build time, query time, speedup
+over brute force, recall of the brute-force hits and mean candidates
+rescored per query are written to a CSV file.
+
+Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import argparse
+import csv
+import json
+import logging
+import subprocess
+import sys
+import time
+import typing as tp
+from dataclasses import asdict, dataclass, fields
+from pathlib import Path
+
+import synthetic_library
+
+_REPO_DIR = Path(__file__).resolve().parents[2]
+DEFAULT_BIN_DIR = _REPO_DIR / "build" / "release"
+
+# Each query's hits, as a map from target index to measure.
+Hits = tp.List[tp.Dict[int, str]]
+
+
+@dataclass(frozen=True)
+class MethodResult:
+    method: str
+    bands: int
+    rows: int
+    build_s: float
+    query_s: float
+    speedup: float
+    recall: float
+    candidates_per_query: float
+    hits: int
+
+
+def _exe_path(bin_dir: Path, tool: str) -> Path:
+    return bin_dir / "src" / "cli" / "measures" / tool
+
+
+def _run(args: tp.List[tp.Any], stdout_path: tp.Optional[Path] = None) -> float:
+    """Run a command, failing if it fails.  Get its wall time in seconds."""
+    start = time.perf_counter()
+    with open(stdout_path or "/dev/null", "w") as outf:
+        subprocess.run(
+            [str(arg) for arg in args],
+            stdout=outf,
+            stderr=subprocess.DEVNULL,
+            check=True,
+        )
+    return time.perf_counter() - start
+
+
+def _read_hits(path: Path) -> Hits:
+    """Read PVM-format rows of hits."""
+    result = []
+    with open(path) as inf:
+        for line in inf:
+            fields = line.split()
+            indices = [int(index) for index in fields[:-1:2]]
+            result.append(dict(zip(indices, fields[1:-1:2])))
+    return result
+
+
+def _stage_items(stats_path: Path, name: str) -> int:
+    with open(stats_path) as inf:
+        for stage in json.load(inf)["stages"]:
+            if stage["name"] == name:
+                return stage["items"]
+    return 0
+
+
+def _recall(expected: Hits, actual: Hits) -> float:
+    num_expected = sum(len(row) for row in expected)
+    num_found = sum(
+        len(expected_row.keys() & actual_row.keys())
+        for expected_row, actual_row in zip(expected, actual)
+    )
+    return num_found / num_expected if num_expected else 1.0
+
+
+def _params_list(value: str) -> tp.List[tp.Tuple[int, int]]:
+    result = []
+    for spec in value.split(","):
+        bands, rows = spec.lower().split("x")
+        result.append((int(bands), int(rows)))
+    return result
+
+
+def main() -> int:
+    logging.basicConfig(level=logging.INFO, format="%(message)s")
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument(
+        "--bin-dir",
+        type=Path,
+        default=DEFAULT_BIN_DIR,
+        help="CMake build directory holding the executables",
+    )
+    parser.add_argument(
+        "--work-dir",
+        type=Path,
+        default=Path("lsh_recall_work"),
+        help="directory in which to cache generated inputs",
+    )
+    parser.add_argument(
+        "--size", type=int, default=100000, help="number of target shapes"
+    )
+    parser.add_argument(
+        "--queries", type=int, default=100, help="number of query shapes"
+    )
+    parser.add_argument(
+        "--params",
+        type=_params_list,
+        default=[(8, 4), (16, 4), (32, 4), (16, 2), (32, 2), (64, 2)],
+        help="comma-separated BANDSxROWS MinHash settings, e.g. 16x4,32x2",
+    )
+    parser.add_argument("--measure", default="T", help="measure code, e.g. T")
+    parser.add_argument(
+        "--threshold", type=float, default=0.6, help="least similarity to report"
+    )
+    parser.add_argument(
+        "--flip",
+        type=float,
+        default=0.02,
+        help="fraction of each synthetic fingerprint's bits to invert",
+    )
+    parser.add_argument("--seed", type=int, default=20101118)
+    parser.add_argument("--output", type=Path, default=Path("lsh_recall.csv"))
+    args = parser.parse_args()
+
+    tools = ["measures_shape_fp", "shape_fp_pack", "shape_fp_index"]
+    for tool in tools:
+        if not _exe_path(args.bin_dir, tool).exists():
+            parser.error(f"{_exe_path(args.bin_dir, tool)} does not exist")
+    measures_exe, pack_exe, index_exe = [
+        _exe_path(args.bin_dir, tool) for tool in tools
+    ]
+
+    work_dir = args.work_dir
+    work_dir.mkdir(parents=True, exist_ok=True)
+    stem = f"{args.size}_{args.queries}_{args.flip}_{args.seed}"
+    targets_path = work_dir / f"targets_{stem}.txt"
+    queries_path = work_dir / f"queries_{stem}.txt"
+    combined_path = work_dir / f"combined_{stem}.txt"
+    db_path = work_dir / f"targets_{stem}.db"
+    if not combined_path.exists():
+        logging.info("Generating %s", combined_path)
+        with open(targets_path, "w") as outf:
+            synthetic_library.write_fingerprints(
+                outf, args.size, args.seed, args.flip
+            )
+        # Different perturbations of the same source shapes, so that each
+        # query has near neighbors among the targets.
+        with open(queries_path, "w") as outf:
+            synthetic_library.write_fingerprints(
+                outf, args.queries, args.seed + 1, args.flip
+            )
+        with open(combined_path, "w") as outf:
+            for path in [queries_path, targets_path]:
+                outf.write(path.read_text())
+        _run([pack_exe, targets_path, db_path])
+
+    search_args = ["-m", args.measure, "-f", "P", "-t", args.threshold]
+    hits_path = work_dir / "hits.txt"
+    stats_path = work_dir / "stats.json"
+
+    logging.info("Brute force")
+    brute_s = _run(
+        [measures_exe, "-s", args.queries, *search_args, combined_path], hits_path
+    )
+    expected = _read_hits(hits_path)
+
+    settings = [("popcount", 0, 0)] + [
+        ("minhash", bands, rows) for bands, rows in args.params
+    ]
+    results = [
+        MethodResult(
+            method="brute_force",
+            bands=0,
+            rows=0,
+            build_s=0.0,
+            query_s=round(brute_s, 4),
+            speedup=1.0,
+            recall=1.0,
+            candidates_per_query=float(args.size),
+            hits=sum(len(row) for row in expected),
+        )
+    ]
+    for method, bands, rows in settings:
+        logging.info("%s %dx%d", method, bands, rows)
+        index_path = work_dir / "index.idx"
+        index_args = ["-b", bands, "-r", rows] if method == "minhash" else []
+        build_s = _run([index_exe, *index_args, db_path, index_path])
+        query_s = _run(
+            [
+                measures_exe,
+                "-x",
+                index_path,
+                "-S",
+                stats_path,
+                *search_args,
+                queries_path,
+            ],
+            hits_path,
+        )
+        actual = _read_hits(hits_path)
+        if method == "minhash":
+            candidates = _stage_items(stats_path, "MinHashIndex::search")
+        else:
+            # A popcount index examines each shape once per orientation.
+            candidates = (
+                _stage_items(stats_path, "PopcountIndex::search")
+                / synthetic_library.FPS_PER_SHAPE
+            )
+        candidates /= args.queries
+        results.append(
+            MethodResult(
+                method=method,
+                bands=bands,
+                rows=rows,
+                build_s=round(build_s, 4),
+                query_s=round(query_s, 4),
+                speedup=round(brute_s / query_s, 2),
+                recall=round(_recall(expected, actual), 4),
+                candidates_per_query=round(candidates, 1),
+                hits=sum(len(row) for row in actual),
+            )
+        )
+
+    with open(args.output, "w", newline="") as outf:
+        writer = csv.DictWriter(
+            outf, fieldnames=[f.name for f in fields(MethodResult)]
+        )
+        writer.writeheader()
+        for result in results:
+            writer.writerow(asdict(result))
+            logging.info(
+                "%-12s %3dx%-2d recall %.4f speedup %8.2f candidates %10.1f",
+                result.method,
+                result.bands,
+                result.rows,
+                result.recall,
+                result.speedup,
+                result.candidates_per_query,
+            )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,205 @@
+#!/usr/bin/env python
+"""Generate reproducible synthetic conformer libraries and shape fingerprint
+files, of any size, from small test inputs.
+
+SD libraries are made by cycling through the structures of a V2000 SD file,
+rotating each copy by a random rotation about its centroid and jittering
+its atom coordinates.  Fingerprint files are made by cycling through the
+blocks of an ASCII shape fingerprint file, flipping a fraction of the bits
+of each copy.  The same seed always yields the same output.
+
+Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import argparse
+import gzip
+import logging
+import math
+import random
+import sys
+import typing as tp
+from pathlib import Path
+
+_DATA_DIR = Path(__file__).resolve().parents[2] / "tests" / "data"
+DEFAULT_SD_SOURCE = _DATA_DIR / "sd_files" / "cox2_3d.sd"
+DEFAULT_FP_SOURCE = (
+    _DATA_DIR / "shape_fingerprinter" / "ref_cox2_3d_first_few.fp.txt.gz"
+)
+FPS_PER_SHAPE = 4
+
+
+def _open_text(path: Path, mode: str = "rt") -> tp.TextIO:
+    if path.suffix == ".gz":
+        return gzip.open(path, mode)  # type: ignore
+    return open(path, mode)
+
+
+def read_sd_records(path: Path) -> tp.List[tp.List[str]]:
+    """Read the records of an SD file, as lists of lines."""
+    records = []
+    record: tp.List[str] = []
+    with _open_text(path) as inf:
+        for line in inf:
+            record.append(line.rstrip("\n"))
+            if line.startswith("$$$$"):
+                records.append(record)
+                record = []
+    if not records:
+        raise ValueError(f"{path} has no SD records.")
+    return records
+
+
+def _random_rotation(rng: random.Random) -> tp.List[tp.List[float]]:
+    """Get a uniformly distributed random rotation matrix."""
+    # Shoemake's method: a uniform random unit quaternion.
+    u1, u2, u3 = rng.random(), rng.random(), rng.random()
+    a = math.sqrt(1.0 - u1)
+    b = math.sqrt(u1)
+    w, x = a * math.sin(2 * math.pi * u2), a * math.cos(2 * math.pi * u2)
+    y, z = b * math.sin(2 * math.pi * u3), b * math.cos(2 * math.pi * u3)
+    return [
+        [1 - 2 * (y * y + z * z), 2 * (x * y - z * w), 2 * (x * z + y * w)],
+        [2 * (x * y + z * w), 1 - 2 * (x * x + z * z), 2 * (y * z - x * w)],
+        [2 * (x * z - y * w), 2 * (y * z + x * w), 1 - 2 * (x * x + y * y)],
+    ]
+
+
+def perturb_sd_record(
+    record: tp.List[str], name: str, jitter: float, rng: random.Random
+) -> tp.List[str]:
+    """Get a renamed copy of a V2000 SD record, with its atoms rotated about
+    their centroid and jittered by a Gaussian of standard deviation jitter.
+    """
+    counts = record[3]
+    if "V3000" in counts:
+        raise ValueError("Only V2000 SD records are supported.")
+    num_atoms = int(counts[0:3])
+    atom_lines = record[4 : 4 + num_atoms]
+    coords = [
+        [float(line[0:10]), float(line[10:20]), float(line[20:30])]
+        for line in atom_lines
+    ]
+    center = [sum(c[k] for c in coords) / num_atoms for k in range(3)]
+    rotation = _random_rotation(rng)
+
+    result = [name] + record[1:4]
+    for line, coord in zip(atom_lines, coords):
+        offset = [coord[k] - center[k] for k in range(3)]
+        new_coord = [
+            center[j]
+            + sum(rotation[j][k] * offset[k] for k in range(3))
+            + rng.gauss(0.0, jitter)
+            for j in range(3)
+        ]
+        result.append("{:10.4f}{:10.4f}{:10.4f}".format(*new_coord) + line[30:])
+    result += record[4 + num_atoms :]
+    return result
+
+
+def write_sd_library(
+    outf: tp.TextIO,
+    count: int,
+    seed: int,
+    jitter: float = 0.25,
+    source: Path = DEFAULT_SD_SOURCE,
+) -> None:
+    """Write count perturbed copies of the records of source."""
+    records = read_sd_records(source)
+    rng = random.Random(seed)
+    for i in range(count):
+        record = records[i % len(records)]
+        name = f"{record[0].strip()}_{i}"
+        for line in perturb_sd_record(record, name, jitter, rng):
+            outf.write(line)
+            outf.write("\n")
+
+
+def read_fingerprint_blocks(path: Path) -> tp.List[tp.List[str]]:
+    """Read the blocks of an ASCII shape fingerprint file."""
+    with _open_text(path) as inf:
+        fps = inf.read().split()
+    if not fps or len(fps) % FPS_PER_SHAPE:
+        raise ValueError(
+            f"{path} does not hold blocks of {FPS_PER_SHAPE} fingerprints."
+        )
+    return [fps[i : i + FPS_PER_SHAPE] for i in range(0, len(fps), FPS_PER_SHAPE)]
+
+
+def perturb_fingerprint(fp: str, flip: float, rng: random.Random) -> str:
+    """Get a copy of an ASCII fingerprint with a fraction flip of its bits
+    inverted."""
+    bits = bytearray(fp, "ascii")
+    for i in rng.sample(range(len(bits)), round(flip * len(bits))):
+        bits[i] ^= 1  # Toggles between "0" and "1"
+    return bits.decode("ascii")
+
+
+def write_fingerprints(
+    outf: tp.TextIO,
+    count: int,
+    seed: int,
+    flip: float = 0.02,
+    single: bool = False,
+    source: Path = DEFAULT_FP_SOURCE,
+) -> None:
+    """Write count perturbed copies of the shape fingerprints of source.
+    If single is true, write only the first fingerprint of each shape, as
+    for measures_nxn.
+    """
+    blocks = read_fingerprint_blocks(source)
+    rng = random.Random(seed)
+    for i in range(count):
+        block = blocks[i % len(blocks)]
+        for fp in block[:1] if single else block:
+            outf.write(perturb_fingerprint(fp, flip, rng))
+            outf.write("\n")
+
+
+def main() -> int:
+    logging.basicConfig(level=logging.INFO)
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--seed", type=int, default=20101118)
+    subparsers = parser.add_subparsers(dest="kind", required=True)
+
+    sd_parser = subparsers.add_parser("sd", help="write an SD library")
+    sd_parser.add_argument("count", type=int, help="number of conformers")
+    sd_parser.add_argument("output", type=Path)
+    sd_parser.add_argument("--source", type=Path, default=DEFAULT_SD_SOURCE)
+    sd_parser.add_argument(
+        "--jitter",
+        type=float,
+        default=0.25,
+        help="standard deviation of coordinate jitter, in Angstroms",
+    )
+
+    fp_parser = subparsers.add_parser(
+        "fingerprints", help="write a shape fingerprint file"
+    )
+    fp_parser.add_argument("count", type=int, help="number of shapes")
+    fp_parser.add_argument("output", type=Path)
+    fp_parser.add_argument("--source", type=Path, default=DEFAULT_FP_SOURCE)
+    fp_parser.add_argument(
+        "--flip",
+        type=float,
+        default=0.02,
+        help="fraction of each fingerprint's bits to invert",
+    )
+    fp_parser.add_argument(
+        "--single",
+        action="store_true",
+        help="write one fingerprint per shape, for measures_nxn",
+    )
+
+    args = parser.parse_args()
+    with _open_text(args.output, "wt") as outf:
+        if args.kind == "sd":
+            write_sd_library(outf, args.count, args.seed, args.jitter, args.source)
+        else:
+            write_fingerprints(
+                outf, args.count, args.seed, args.flip, args.single, args.source
+            )
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,244 @@
+#!/usr/bin/env python
+"""Measure end-to-end throughput of the shape fingerprinting and measures
+executables across library sizes and thread counts.
+
+For each library size, a synthetic SD library and fingerprint files are
+generated (see synthetic_library.py) and cached in a work directory.  Each
+selected tool is then run once per thread count, with OMP_NUM_THREADS set
+accordingly, and its wall time, throughput and peak resident set size are
+appended to a CSV file.
+
+Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import argparse
+import csv
+import logging
+import os
+import subprocess
+import sys
+import time
+import typing as tp
+from dataclasses import asdict, dataclass, fields
+from pathlib import Path
+
+import synthetic_library
+
+_REPO_DIR = Path(__file__).resolve().parents[2]
+DEFAULT_BIN_DIR = _REPO_DIR / "build" / "release"
+DEFAULT_SPHERE = (
+    _REPO_DIR / "tests" / "data" / "hammersley" / "hamm_spheroid_20k_11rad.txt"
+)
+ATOM_SCALE = "1.0"
+
+# Tools which process each conformer of an SD library.
+RECORD_TOOLS = ["shape_fingerprinter", "align_monte"]
+# Tools which measure all pairs of a fingerprint file.
+PAIR_TOOLS = ["measures_nxn", "measures_shape_fp"]
+
+
+@dataclass(frozen=True)
+class RunResult:
+    tool: str
+    records: int
+    threads: int
+    wall_s: float
+    records_per_s: float
+    pairs: int
+    pairs_per_s: float
+    peak_rss_kb: int
+    returncode: int
+
+
+@dataclass(frozen=True)
+class Inputs:
+    sd_path: Path
+    shape_fp_path: Path
+    single_fp_path: Path
+
+
+def _exe_path(bin_dir: Path, tool: str) -> Path:
+    subdir = "measures" if tool.startswith("measures_") else tool
+    return bin_dir / "src" / "cli" / subdir / tool
+
+
+def get_inputs(work_dir: Path, size: int, seed: int) -> Inputs:
+    """Generate, or reuse, the synthetic inputs for a library size."""
+    result = Inputs(
+        sd_path=work_dir / f"library_{size}_{seed}.sd",
+        shape_fp_path=work_dir / f"shape_fps_{size}_{seed}.txt",
+        single_fp_path=work_dir / f"single_fps_{size}_{seed}.txt",
+    )
+    if not result.sd_path.exists():
+        logging.info("Generating %s", result.sd_path)
+        with open(result.sd_path, "w") as outf:
+            synthetic_library.write_sd_library(outf, size, seed)
+    for path, single in [
+        (result.shape_fp_path, False),
+        (result.single_fp_path, True),
+    ]:
+        if not path.exists():
+            logging.info("Generating %s", path)
+            with open(path, "w") as outf:
+                synthetic_library.write_fingerprints(outf, size, seed, single=single)
+    return result
+
+
+def _read_peak_rss_kb(pid: int) -> int:
+    """Get the peak RSS of a running process, in KiB, or 0 if it has exited.
+    """
+    try:
+        with open(f"/proc/{pid}/status") as inf:
+            for line in inf:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1])
+    except OSError:
+        pass
+    return 0
+
+
+def run_timed(args: tp.List[str], threads: int) -> tp.Tuple[float, int, int]:
+    """Run a command, discarding its output.  Get its wall time in seconds,
+    its peak RSS in KiB, and its return code."""
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+    start = time.perf_counter()
+    proc = subprocess.Popen(
+        args, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, env=env
+    )
+    # On Linux the child's ru_maxrss includes the RSS of this Python process,
+    # inherited across fork and exec.  So sample the child's own high-water
+    # mark while it runs, and fall back to ru_maxrss where /proc is missing.
+    peak_rss_kb = 0
+    while True:
+        peak_rss_kb = max(peak_rss_kb, _read_peak_rss_kb(proc.pid))
+        pid, status, rusage = os.wait4(proc.pid, os.WNOHANG)
+        if pid == proc.pid:
+            break
+        time.sleep(0.01)
+    wall_s = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    return wall_s, (peak_rss_kb or rusage.ru_maxrss), proc.returncode
+
+
+def run_tool(
+    bin_dir: Path, tool: str, inputs: Inputs, size: int, threads: int
+) -> RunResult:
+    exe = str(_exe_path(bin_dir, tool))
+    sphere = str(DEFAULT_SPHERE)
+    pairs = 0
+    if tool in RECORD_TOOLS:
+        args = [exe, str(inputs.sd_path), sphere, ATOM_SCALE]
+    elif tool == "measures_nxn":
+        args = [exe, str(inputs.single_fp_path)]
+        # Each row includes the diagonal.
+        pairs = size * size
+    elif tool == "measures_shape_fp":
+        args = [exe, str(inputs.shape_fp_path)]
+        pairs = size * (size - 1)
+    else:
+        raise ValueError(f"Unknown tool {tool}")
+
+    wall_s, peak_rss_kb, returncode = run_timed(args, threads)
+    if returncode != 0:
+        logging.warning("%s exited with status %d", " ".join(args), returncode)
+    return RunResult(
+        tool=tool,
+        records=size,
+        threads=threads,
+        wall_s=round(wall_s, 4),
+        records_per_s=round(size / wall_s, 2),
+        pairs=pairs,
+        pairs_per_s=round(pairs / wall_s, 2),
+        peak_rss_kb=peak_rss_kb,
+        returncode=returncode,
+    )
+
+
+def _int_list(value: str) -> tp.List[int]:
+    return [int(v) for v in value.split(",")]
+
+
+def main() -> int:
+    logging.basicConfig(level=logging.INFO, format="%(message)s")
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument(
+        "--bin-dir",
+        type=Path,
+        default=DEFAULT_BIN_DIR,
+        help="CMake build directory holding the executables",
+    )
+    parser.add_argument(
+        "--work-dir",
+        type=Path,
+        default=Path("throughput_work"),
+        help="directory in which to cache generated inputs",
+    )
+    parser.add_argument(
+        "--sizes",
+        type=_int_list,
+        default=[1000, 10000, 100000],
+        help="comma-separated conformer counts for " + ", ".join(RECORD_TOOLS),
+    )
+    parser.add_argument(
+        "--pair-sizes",
+        type=_int_list,
+        default=[500, 1000, 2000],
+        help="comma-separated fingerprint counts for "
+        + ", ".join(PAIR_TOOLS)
+        + ", whose run times grow quadratically",
+    )
+    parser.add_argument(
+        "--threads",
+        type=_int_list,
+        default=sorted({1, 2, 4, os.cpu_count() or 1}),
+        help="comma-separated OMP_NUM_THREADS values",
+    )
+    parser.add_argument(
+        "--tools",
+        type=lambda v: v.split(","),
+        default=RECORD_TOOLS + PAIR_TOOLS,
+        help="comma-separated tools to run",
+    )
+    parser.add_argument("--seed", type=int, default=20101118)
+    parser.add_argument(
+        "--output",
+        type=Path,
+        default=Path("throughput.csv"),
+        help="CSV file to which results are appended",
+    )
+    args = parser.parse_args()
+
+    unknown = set(args.tools) - set(RECORD_TOOLS + PAIR_TOOLS)
+    if unknown:
+        parser.error(f"unknown tools: {', '.join(sorted(unknown))}")
+    for tool in args.tools:
+        if not _exe_path(args.bin_dir, tool).exists():
+            parser.error(f"{_exe_path(args.bin_dir, tool)} does not exist")
+
+    args.work_dir.mkdir(parents=True, exist_ok=True)
+    # Append, so that successive sweeps accumulate in one file.
+    is_new = not args.output.exists() or args.output.stat().st_size == 0
+    with open(args.output, "a", newline="") as outf:
+        writer = csv.DictWriter(outf, fieldnames=[f.name for f in fields(RunResult)])
+        if is_new:
+            writer.writeheader()
+        for tool in args.tools:
+            sizes = args.sizes if tool in RECORD_TOOLS else args.pair_sizes
+            for size in sizes:
+                inputs = get_inputs(args.work_dir, size, args.seed)
+                for threads in args.threads:
+                    result = run_tool(args.bin_dir, tool, inputs, size, threads)
+                    logging.info(
+                        "%s: %d records, %d threads: %.3f s",
+                        tool,
+                        size,
+                        threads,
+                        result.wall_s,
+                    )
+                    writer.writerow(asdict(result))
+                    outf.flush()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -58,6 +58,7 @@
 
 #include <unistd.h>
 
+#include "mesaac_common/stats.hpp"
 #include "mesaac_shape/shared_types.hpp" // For bitvector types
 #include "sdf_mol_aligner.hpp"
 #include "shared_types.hpp"
@@ -167,7 +168,8 @@ public:
 
   void get_args(string &sd_pathname, string &hs_pathname, float &atom_scale,
                 bool &atom_centers_only, MeasureIDList &measure_ids,
-                float &tversky_alpha, string &sorted_pathname) {
+                float &tversky_alpha, string &sorted_pathname,
+                string &stats_pathname) {
     atom_centers_only = false;
     string measure_name("");
     MeasureIDEnum measures_applied = MIE_Invalid;
@@ -175,6 +177,7 @@ public:
     measure_ids.clear();
     tversky_alpha = 0.0;
     sorted_pathname = "";
+    stats_pathname = "";
 
     int i = 1;
     while (i < m_argc) {
@@ -186,6 +189,8 @@ public:
         atom_centers_only = true;
       } else if ((curr_arg == "-s") || (curr_arg == "--sort")) {
         get_value_for("SORT_FILE", i, sorted_pathname);
+      } else if ((curr_arg == "-S") || (curr_arg == "--stats")) {
+        get_value_for("STATS_FILE", i, stats_pathname);
       } else if ((curr_arg == "-m") || (curr_arg == "--measure")) {
         get_value_for("MEASURE", i, measure_name);
         // Add this measure type, if it has not already been added.
@@ -285,7 +290,10 @@ public:
          << "                    per line with space-separated coordinates, "
             "for principal"
          << endl
-         << "                    axes generation via SVD" << endl
+         << "                    axes generation via SVD; or "
+            "cloud:N,SCALE,A,B,C to"
+         << endl
+         << "                    generate N sphere points in memory" << endl
          << "atom_scale        = the amount, in the range [1.0..2.0], by which "
             "to "
          << endl
@@ -332,6 +340,11 @@ public:
             "used as the sort"
          << endl
          << "                    value." << endl
+         << "-S|--stats STATS_FILE" << endl
+         << "                  = Write a JSON summary of per-stage times and "
+            "item counts"
+         << endl
+         << "                    to the named STATS_FILE." << endl
          << "-h | --help       = print this help message and exit" << endl;
 
     if (err_msg.size()) {
@@ -370,11 +383,15 @@ int main(int argc, char **argv) {
   MeasureIDList measure_ids;
   float tversky_alpha = 0.0;
   string sorted_pathname("");
+  string stats_pathname("");
 
   ArgParser options(argc, argv);
   options.get_args(sd_pathname, hamms_sphere_pathname, atom_scale,
                    atom_centers_only, measure_ids, tversky_alpha,
-                   sorted_pathname);
+                   sorted_pathname, stats_pathname);
+  if (!stats_pathname.empty()) {
+    mesaac::common::stats::enable();
+  }
 
   MeasuresList measures;
   get_measures(measure_ids, tversky_alpha, measures);
@@ -384,5 +401,14 @@ int main(int argc, char **argv) {
   SDFMolAligner aligner(sd_pathname, hamms_sphere_pathname, atom_scale,
                         atom_centers_only, measures, sorted_pathname);
   aligner.run();
+
+  if (!stats_pathname.empty()) {
+    try {
+      mesaac::common::stats::write_report(stats_pathname);
+    } catch (const exception &e) {
+      cerr << "Error: " << e.what() << endl;
+      return 1;
+    }
+  }
   return 0;
 }
@@ -10,6 +10,7 @@
 #include <cmath>
 #include <cstdlib>
 
+#include "mesaac_common/stats.hpp"
 #include "mesaac_mol/element_info.hpp"
 
 using namespace std;
@@ -23,17 +24,13 @@ static constexpr float c_flip_matrix[4][3] = {{1.0, 1.0, 1.0}, // Unflipped
                                               {-1.0, -1.0, 1.0}};
 static constexpr unsigned int c_flip_matrix_size =
     sizeof(c_flip_matrix) / sizeof(c_flip_matrix[0]);
+static_assert(c_flip_matrix_size == MolAligner::NumFlips);
 
-void add_tag(mol::Mol &mol, string tag, string value) {
+template <typename T>
+void add_tag(mol::Mol &mol, const string &tag, const T &value) {
   mol.mutable_tags().add(tag, value);
 }
 
-template <typename T> void add_tag(mol::Mol &mol, string tag, T value) {
-  ostringstream outs;
-  outs << value;
-  mol.mutable_tags().add(tag, outs.str());
-}
-
 void add_best_measure_tag(mol::Mol &mol, string measure_name, float value) {
   add_tag(mol, "MaxAlign" + measure_name, value);
 }
@@ -70,6 +67,14 @@ void MolAligner::process_one_molecule(mol::Mol &mol) {
   PointList heavies;
   m_axisAligner.get_atom_points(mol.atoms(), heavies, false);
 
+  // Rasterizing is the costly part, so fingerprint each flip once and
+  // measure all of the fingerprints with every measure.  Every measure is
+  // a function of the same contingency counts, so count them once too.
+  FlipFingerprints fingerprints;
+  compute_flip_fingerprints(heavies, fingerprints);
+  FlipCounts counts;
+  get_flip_counts(fingerprints, counts);
+
   // The last measure wins, flip-wise?
   unsigned int best_flip = 0;
   for (const auto &measure : m_measures) {
@@ -77,8 +82,7 @@ void MolAligner::process_one_molecule(mol::Mol &mol) {
       string name = measure->name();
       float best_measure = 0.0;
 
-      compute_best_sphere_fingerprint(heavies, measure, best_flip,
-                                      best_measure);
+      get_best_flip(counts, measure, best_flip, best_measure);
       add_best_measure_tag(mol, name, best_measure);
       add_best_flip_tag(mol, name, best_flip);
     }
@@ -86,21 +90,6 @@ void MolAligner::process_one_molecule(mol::Mol &mol) {
   flip_mol(mol, c_flip_matrix[best_flip]);
 }
 
-void MolAligner::compute_best_sphere_fingerprint(
-    const PointList &points, measures::MeasuresBase::Ptr measure,
-    unsigned int &i_best, float &best_measure) {
-  i_best = 0;
-  best_measure = 0;
-  for (unsigned int iFlip = 0; iFlip != c_flip_matrix_size; iFlip++) {
-    const float *flip = c_flip_matrix[iFlip];
-    float currMeasure = compute_measure_for_flip(points, flip, measure);
-    if (currMeasure > best_measure) {
-      i_best = iFlip;
-      best_measure = currMeasure;
-    }
-  }
-}
-
 static inline void get_flipped_points(const PointList &points,
                                       const float *flip,
                                       PointList &flipped_points) {
@@ -117,15 +106,41 @@ static inline void get_flipped_points(const PointList &points,
   }
 }
 
-float MolAligner::compute_measure_for_flip(
-    const PointList &points, const float *flip,
-    measures::MeasuresBase::Ptr measure) {
+void MolAligner::compute_flip_fingerprints(const PointList &points,
+                                           FlipFingerprints &fingerprints) {
   PointList flipped_points;
-  get_flipped_points(points, flip, flipped_points);
+  for (unsigned int iFlip = 0; iFlip != c_flip_matrix_size; iFlip++) {
+    get_flipped_points(points, c_flip_matrix[iFlip], flipped_points);
+    m_volBox.set_bits_for_spheres(flipped_points, fingerprints[iFlip], true,
+                                  0);
+  }
+}
+
+void MolAligner::get_flip_counts(const FlipFingerprints &fingerprints,
+                                 FlipCounts &counts) const {
+  static common::stats::Stage &counts_stage(
+      common::stats::stage("get_contingency_counts"));
+  const common::stats::ScopedTimer timer(counts_stage, c_flip_matrix_size);
 
-  shape_defs::BitVector curr_fingerprint;
-  m_volBox.set_bits_for_spheres(flipped_points, curr_fingerprint, true, 0);
-  return measure->similarity(curr_fingerprint, m_ref_fingerprint);
+  for (unsigned int iFlip = 0; iFlip != c_flip_matrix_size; iFlip++) {
+    counts[iFlip] = measures::get_contingency_counts(fingerprints[iFlip],
+                                                     m_ref_fingerprint);
+  }
+}
+
+void MolAligner::get_best_flip(const FlipCounts &counts,
+                               measures::MeasuresBase::Ptr measure,
+                               unsigned int &i_best,
+                               float &best_measure) const {
+  i_best = 0;
+  best_measure = 0;
+  for (unsigned int iFlip = 0; iFlip != c_flip_matrix_size; iFlip++) {
+    float currMeasure = measure->similarity(counts[iFlip]);
+    if (currMeasure > best_measure) {
+      i_best = iFlip;
+      best_measure = currMeasure;
+    }
+  }
 }
 
 void MolAligner::flip_mol(mol::Mol &mol, const float *flip) {
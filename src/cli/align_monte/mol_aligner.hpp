@@ -7,6 +7,8 @@
 // Singular value decomposition, for PCA -- this defines ap::real_2d_array
 #include "svd.h"
 
+#include <array>
+
 #include "mesaac_measures/measures_base.hpp"
 #include "mesaac_mol/mol.hpp"
 #include "mesaac_shape/axis_aligner.hpp"
@@ -16,6 +18,9 @@
 namespace mesaac::align_monte {
 class MolAligner {
 public:
+  // The number of orientations in which a molecule is fingerprinted.
+  static constexpr unsigned int NumFlips = 4;
+
   MolAligner(PointList &hamms_sphere_coords, float epsilon_sqr,
              shape_defs::BitVector &ref_fp, bool atom_centers_only,
              MeasuresList &measures)
@@ -27,17 +32,21 @@ public:
   void process_one_molecule(mol::Mol &mol);
 
 protected:
+  using FlipFingerprints = std::array<shape_defs::BitVector, NumFlips>;
+  using FlipCounts = std::array<measures::ContingencyCounts, NumFlips>;
+
   const shape_defs::BitVector &m_ref_fingerprint;
   shape::AxisAligner m_axisAligner;
   shape::VolBox m_volBox;
   MeasuresList &m_measures;
 
-  void compute_best_sphere_fingerprint(const PointList &points,
-                                       measures::MeasuresBase::Ptr measure,
-                                       unsigned int &i_best,
-                                       float &best_measure);
-  float compute_measure_for_flip(const PointList &points, const float *flip,
-                                 measures::MeasuresBase::Ptr measure);
+  void compute_flip_fingerprints(const PointList &points,
+                                 FlipFingerprints &fingerprints);
+  void get_flip_counts(const FlipFingerprints &fingerprints,
+                       FlipCounts &counts) const;
+  void get_best_flip(const FlipCounts &counts,
+                     measures::MeasuresBase::Ptr measure,
+                     unsigned int &i_best, float &best_measure) const;
   void flip_mol(mol::Mol &mol, const float *flip);
 
 private:
@@ -8,6 +8,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 
 #if HAVE_OPENMP
 #include <omp.h>
@@ -16,6 +17,7 @@
 #include "mesaac_mol/io/sdreader.hpp"
 #include "mesaac_mol/io/sdwriter.hpp"
 #include "mesaac_mol/mol.hpp"
+#include "mesaac_shape/point_set.hpp"
 
 #include "mol_aligner.hpp"
 
@@ -51,17 +53,8 @@ struct SortRecord {
 
 using SortRecordList = vector<SortRecord>;
 
-float get_tag_value(const mol::Mol &mol, string tag_name) {
-  const mol::SDTagMap &tags(mol.tags());
-  mol::SDTagMap::const_iterator i = tags.find(tag_name);
-  float result = nan("");
-  if (i != tags.end()) {
-    istringstream ins(i->second);
-    if (!(ins >> result)) {
-      result = nan("");
-    }
-  }
-  return result;
+float get_tag_value(const mol::Mol &mol, const string &tag_name) {
+  return mol.tags().get<float>(tag_name).value_or(nan(""));
 }
 
 } // namespace
@@ -72,17 +65,20 @@ void SDFMolAligner::run() {
 }
 
 void SDFMolAligner::read_sphere_points() {
-  ifstream inf;
-  open_input(inf, m_hamms_sphere_pathname, "Hamms Sphere Points file");
-
-  float coord;
-  while (inf >> coord) {
-    FloatVector point(3, 0.0);
-    point[0] = coord;
-    inf >> point[1] >> point[2];
-    m_hamms_sphere_coords.push_back(point);
+  if (!shape::is_point_cloud_spec(m_hamms_sphere_pathname)) {
+    // open_input reports unreadable files in the same way as for other
+    // inputs.
+    ifstream inf;
+    open_input(inf, m_hamms_sphere_pathname, "Hamms Sphere Points file");
+    inf.close();
+  }
+
+  try {
+    m_hamms_sphere_coords = shape::get_point_cloud(m_hamms_sphere_pathname);
+  } catch (const invalid_argument &e) {
+    cerr << e.what() << endl;
+    exit(1);
   }
-  inf.close();
 }
 
 void SDFMolAligner::process_molecules() {
@@ -98,13 +94,12 @@ void SDFMolAligner::process_molecules() {
   bool write_sorted = (!m_sorted_pathname.empty());
   SortRecordList sort_records;
   string last_measure = (m_measures.at(m_measures.size() - 1)->name());
-  string measure_tag = ">  <MaxAlign" + last_measure + ">";
+  const string measure_tag = "MaxAlign" + last_measure;
 
   mol::Mol refmol;
   int i = 0;
-  const auto read_result = reader.read();
+  const auto read_result = reader.read(refmol);
   if (read_result.is_ok()) {
-    refmol = read_result.value();
     ma.process_ref_molecule(refmol, m_ref_fingerprint);
     writer.write(refmol);
     if (write_sorted) {
@@ -131,17 +126,17 @@ void SDFMolAligner::process_molecules() {
         buff_writer[j] = make_shared<mol::SDWriter>(*outstr[j]);
       }
     }
+#else
+    mol::Mol mol;
 #endif
 
     while (true) {
 #if HAVE_OPENMP
       int j;
       for (j = 0; j < queue_size; j++) {
-        const auto read_result = reader.read();
-        if (!read_result.is_ok()) {
+        if (!reader.read(mol_batch[j]).is_ok()) {
           break;
         }
-        mol_batch[j] = read_result.value();
       }
       int num_mols = j;
 #pragma omp parallel for
@@ -170,12 +165,11 @@ void SDFMolAligner::process_molecules() {
         break;
       }
 #else
-      const auto read_result = reader.read();
+      const auto read_result = reader.read(mol);
       if (!read_result.is_ok()) {
         std::cerr << read_result.error() << std::endl;
         break;
       }
-      auto mol = read_result.value();
       ma.process_one_molecule(mol);
       writer.write(mol);
       if (write_sorted) {
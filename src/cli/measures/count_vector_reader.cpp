@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "count_vector_reader.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace mesaac::cli::measures {
+namespace {
+template <typename CountVectorsType>
+CountVectorsType to_count_vectors(const vector<unsigned int> &counts,
+                                  unsigned int num_features) {
+  CountVectorsType result(num_features);
+  const span<const unsigned int> all_counts(counts);
+  for (size_t offset = 0; offset < counts.size(); offset += num_features) {
+    result.push_back(all_counts.subspan(offset, num_features));
+  }
+  return result;
+}
+
+AnyCountVectors read_from_stream(const string &pathname, istream &ins) {
+  vector<unsigned int> counts;
+  unsigned int num_features = 0;
+  unsigned int max_count = 0;
+  unsigned int line_num = 0;
+  string line;
+  while (getline(ins, line)) {
+    line_num++;
+    if (line.find_first_not_of(" \t\r") == string::npos) {
+      continue;
+    }
+    const size_t line_start = counts.size();
+    istringstream line_ins(line);
+    long count = 0;
+    while (line_ins >> count) {
+      if (count < 0) {
+        break;
+      }
+      if (count > numeric_limits<uint16_t>::max()) {
+        throw runtime_error(format("Line {} of {}: count {} exceeds {}",
+                                   line_num, pathname, count,
+                                   numeric_limits<uint16_t>::max()));
+      }
+      counts.push_back(count);
+      max_count = max<unsigned int>(max_count, count);
+    }
+    if (!line_ins.eof() || (count < 0)) {
+      throw runtime_error(format(
+          "Line {} of {}: counts must be non-negative integers", line_num,
+          pathname));
+    }
+    const size_t line_features = counts.size() - line_start;
+    if (num_features == 0) {
+      num_features = line_features;
+    } else if (line_features != num_features) {
+      throw runtime_error(format("Line {} of {} has {} counts; expected {}",
+                                 line_num, pathname, line_features,
+                                 num_features));
+    }
+  }
+
+  if (max_count <= numeric_limits<uint8_t>::max()) {
+    return to_count_vectors<mesaac::measures::CountVectors8>(counts,
+                                                             num_features);
+  }
+  return to_count_vectors<mesaac::measures::CountVectors16>(counts,
+                                                            num_features);
+}
+} // namespace
+
+AnyCountVectors read_count_vectors(const string &pathname) {
+  ifstream inf(pathname);
+  if (!inf) {
+    throw runtime_error(format("Cannot open count vector file {}", pathname));
+  }
+  return read_from_stream(pathname, inf);
+}
+} // namespace mesaac::cli::measures
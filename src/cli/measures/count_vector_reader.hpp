@@ -0,0 +1,22 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <string>
+#include <variant>
+
+#include "mesaac_measures/count_vectors.hpp"
+
+namespace mesaac::cli::measures {
+using AnyCountVectors = std::variant<mesaac::measures::CountVectors8,
+                                     mesaac::measures::CountVectors16>;
+
+// Read count vectors from the named file, one per line, with counts
+// separated by whitespace.  Every line must have the same number of counts.
+// The counts are stored in 8 bits apiece if they all fit, else in 16 bits.
+// Throws std::runtime_error if the file cannot be read or parsed, or if a
+// count exceeds 65535.
+AnyCountVectors read_count_vectors(const std::string &pathname);
+} // namespace mesaac::cli::measures
@@ -1,7 +1,8 @@
 #!/usr/bin/env python
 # encoding: utf-8
 """Demos generation of a sparse shape distance matrix using multiple cores,
-   via measures_sfp_band and Python's multiprocessing module.
+   via measures_shape_fp --shard, measures_merge and Python's
+   multiprocessing module.
    
    Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
 """
@@ -11,7 +12,6 @@ if sys.version_info[:3] < (2, 7, 0):
     raise SystemExit("Sorry, this example requires Python 2.7 or later")
 
 import os
-import math
 import subprocess
 import multiprocessing
 import argparse
@@ -46,13 +46,10 @@ def parse_cmd_line():
         
     return result
     
-def get_num_shape_fingerprints(pathname):
-    with open(pathname) as inf:
-        return sum(1 for line in inf) // 4  # shape fps span 4 lines each
-
 def process_band(args):
-    band_id, sfp_path, measure, tv_alpha, start, end, thresh = args
-    cmd_args = ['measures_sfp_band', '-r', str(start), str(end), '-d',
+    band_id, num_bands, sfp_path, measure, tv_alpha, thresh = args
+    cmd_args = ['measures_shape_fp', '--shard',
+                "{}/{}".format(band_id, num_bands), '-d',
                 '-m', measure, '-t', str(thresh)]
     if measure == "V":
         cmd_args += ['-a', str(tv_alpha)]
@@ -72,20 +69,18 @@ def reduce_results(results):
     failures = [i for (i, (status, path)) in enumerate(results) if 0 != status]
     if failures:
         raise SystemExit("Could not compute bands {}".format(failures))
-    
-    for status, band_path in results:
-        with open(band_path) as inf:
-            for line in inf:
-                sys.stdout.write(line)
+
+    band_paths = [band_path for (status, band_path) in results]
+    status = subprocess.call(['measures_merge'] + band_paths)
+    for band_path in band_paths:
         os.remove(band_path)
+    if status:
+        raise SystemExit("Could not merge bands")
 
 def run(num_jobs, sfp_path, measure, tv_alpha, thresh):
-    num_fps = get_num_shape_fingerprints(sfp_path)
-    fps_per_job = int(math.ceil(num_fps / float(num_jobs)))
     jobs = []
-    for i, start in enumerate(range(0, num_fps, fps_per_job)):
-        end = min(start + fps_per_job, num_fps)
-        jobs.append([i, sfp_path, measure, tv_alpha, start, end, thresh])
+    for i in range(1, num_jobs + 1):
+        jobs.append([i, num_jobs, sfp_path, measure, tv_alpha, thresh])
         
     p = multiprocessing.Pool()
     reduce_results(p.map(process_band, jobs))
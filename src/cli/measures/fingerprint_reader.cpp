@@ -3,14 +3,21 @@
 //
 
 #include "fingerprint_reader.hpp"
+#include "fp_decoder.hpp"
 
 #include <fstream>
 #include <iostream>
 
+#include "mesaac_common/stats.hpp"
+#include "mesaac_measures/compressed_shape_fps.hpp"
+#include "mesaac_measures/segmented_shape_fps.hpp"
+
 using namespace std;
 
 namespace mesaac::cli::measures {
 namespace {
+const unsigned int FPsPerBlock = 4;
+
 void read_fingerprints_from_stream(const string &pathname, istream &ins,
                                    shape_defs::ArrayBitVectors &fingerprints) {
   fingerprints.clear();
@@ -38,13 +45,106 @@ void read_fingerprints_from_stream(const string &pathname, istream &ins,
   }
 }
 
+void for_each_fpblock_in_stream(const string &pathname, istream &ins,
+                                const FPBlockHandler &on_block) {
+  shape_defs::ArrayBitVectors block;
+  bool first = true;
+  unsigned int vector_size = 0;
+  string fpstr;
+  unsigned int line_num = 0;
+
+  while (ins >> fpstr) {
+    line_num++;
+    shape_defs::BitVector fp;
+    if (!decode_fp(fpstr, fp)) {
+      cerr << "Error at line " << line_num << " of " << pathname << ":" << endl
+           << "  Invalid fingerprint string '" << fpstr << "'." << endl;
+      exit(1);
+    } else {
+      if (first) {
+        vector_size = fp.size();
+        first = false;
+      } else if (fp.size() != vector_size) {
+        // TODO:  Use exceptions, or an error return
+        cerr << "Error at line " << line_num << " of " << pathname << ":"
+             << endl
+             << "  Expected fingerprint of size " << vector_size
+             << ", got fingerprint of size " << fp.size() << endl;
+        exit(1);
+      }
+      block.push_back(shape_defs::BitVector(fp));
+      if (block.size() == FPsPerBlock) {
+        on_block(block);
+        block.clear();
+      }
+    }
+  }
+
+  if (block.size() != 0) {
+    cerr << "A Shape Fingerprint file must contain blocks of " << FPsPerBlock
+         << " fingerprints.  " << endl
+         << pathname << " has only " << block.size()
+         << ((block.size() == 1) ? "fingerprint " : "fingerprints ")
+         << "in its last block." << endl
+         << "This may not be a shape fingerprint file." << endl;
+    exit(1);
+  }
+}
+
+void for_each_fpblock_in_compressed(const string &pathname,
+                                    const FPBlockHandler &on_block) {
+  try {
+    const mesaac::measures::shape::CompressedShapeFPs fps(pathname);
+    shape_defs::ArrayBitVectors block;
+    for (unsigned int i = 0; i < fps.size(); i++) {
+      fps.get(i, block);
+      on_block(block);
+    }
+  } catch (const exception &e) {
+    // TODO:  Use exceptions, or an error return
+    cerr << "Error: " << e.what() << endl;
+    exit(1);
+  }
+}
+
+void for_each_fpblock_in_segmented(const string &pathname,
+                                   const FPBlockHandler &on_block) {
+  try {
+    const mesaac::measures::shape::SegmentedShapeFPs fps(pathname);
+    shape_defs::ArrayBitVectors block;
+    for (unsigned int i = 0; i < fps.size(); i++) {
+      fps.get(i, block);
+      on_block(block);
+    }
+  } catch (const exception &e) {
+    // TODO:  Use exceptions, or an error return
+    cerr << "Error: " << e.what() << endl;
+    exit(1);
+  }
+}
+
+bool is_shape_fp_database(const string &pathname) {
+  return (pathname != "-") &&
+         (mesaac::measures::shape::CompressedShapeFPs::is_compressed(
+              pathname) ||
+          mesaac::measures::shape::SegmentedShapeFPs::is_database(pathname));
+}
+
 } // namespace
 
 void read_fingerprints(const string &pathname,
                        shape_defs::ArrayBitVectors &fingerprints) {
-  // Input from either stdin or file
+  common::stats::ScopedTimer timer(common::stats::stage("read_fingerprints"));
+  // Input from either stdin, a database or a plaintext file
   if (pathname == "-") {
     read_fingerprints_from_stream("standard input", cin, fingerprints);
+  } else if (is_shape_fp_database(pathname)) {
+    // A database's fingerprints, in the order of a plaintext file.
+    fingerprints.clear();
+    for_each_fingerprint_block(
+        pathname, [&fingerprints](const shape_defs::ArrayBitVectors &block) {
+          fingerprints.insert(fingerprints.end(), block.begin(), block.end());
+        });
   } else {
     ifstream inf(pathname);
     if (!inf) {
@@ -55,5 +155,47 @@ void read_fingerprints(const string &pathname,
     read_fingerprints_from_stream(pathname, inf, fingerprints);
     inf.close();
   }
+  timer.set_items(fingerprints.size());
+}
+
+void for_each_fingerprint_block(const string &pathname,
+                                const FPBlockHandler &on_block) {
+  // Input from either stdin, a database or a plaintext file
+  if (pathname == "-") {
+    for_each_fpblock_in_stream("standard input", cin, on_block);
+  } else if (mesaac::measures::shape::CompressedShapeFPs::is_compressed(
+                 pathname)) {
+    for_each_fpblock_in_compressed(pathname, on_block);
+  } else if (mesaac::measures::shape::SegmentedShapeFPs::is_database(
+                 pathname)) {
+    for_each_fpblock_in_segmented(pathname, on_block);
+  } else {
+    ifstream inf(pathname);
+    if (!inf) {
+      // TODO:  Use exceptions, or an error return
+      cerr << "Cannot open fingerprint file " << pathname << "." << endl;
+      exit(1);
+    }
+    for_each_fpblock_in_stream(pathname, inf, on_block);
+    inf.close();
+  }
+}
+
+void read_fingerprint_blocks(const string &pathname,
+                             shape_defs::ShapeFPBlocks &fingerprints) {
+  common::stats::ScopedTimer timer(
+      common::stats::stage("read_fingerprint_blocks"));
+  fingerprints.clear();
+  unsigned int vector_size = 0;
+  const auto on_block = [&fingerprints, &vector_size](
+                            const shape_defs::ArrayBitVectors &block) {
+    fingerprints.push_back(block);
+    vector_size = block[0].size();
+  };
+  for_each_fingerprint_block(pathname, on_block);
+  timer.set_items(fingerprints.size());
+  cerr << "Number of fingerprints is " << fingerprints.size() << endl
+       << fingerprints.size() << " " << FPsPerBlock << " " << vector_size
+       << endl;
 }
 } // namespace mesaac::cli::measures
\ No newline at end of file
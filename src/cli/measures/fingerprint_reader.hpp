@@ -4,12 +4,37 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 
 #include "mesaac_common/shape_defs.hpp"
 namespace mesaac::cli::measures {
 // Read fingerprints from the named file, returning them in fingerprints.
+// The file may also be a shape fingerprint database, as for
+// read_fingerprint_blocks; its fingerprints are returned in the order of a
+// plaintext file.
 // If pathname is '-', read from stdin.
 void read_fingerprints(const std::string &pathname,
                        shape_defs::ArrayBitVectors &fingerprints);
+
+using FPBlockHandler =
+    std::function<void(const shape_defs::ArrayBitVectors &block)>;
+
+// Read shape fingerprints -- blocks of 4 fingerprints, one per canonical
+// orientation -- from the named file one at a time, passing each to
+// on_block.  This avoids holding the whole file in memory.
+// The file may also be a compressed or packed database from shape_fp_pack,
+// or a segmented database directory from shape_fp_append, whose live
+// segments are read as one database.
+// If pathname is '-', read from stdin.
+void for_each_fingerprint_block(const std::string &pathname,
+                                const FPBlockHandler &on_block);
+
+// Read shape fingerprints -- blocks of 4 fingerprints, one per canonical
+// orientation -- from the named file, returning them in fingerprints.
+// Fingerprints may be in any format accepted by decode_fp, or the file may
+// be any database accepted by for_each_fingerprint_block.
+// If pathname is '-', read from stdin.
+void read_fingerprint_blocks(const std::string &pathname,
+                             shape_defs::ShapeFPBlocks &fingerprints);
 } // namespace mesaac::cli::measures
@@ -0,0 +1,149 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "matrix_writer.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "mesaac_common/stats.hpp"
+
+using namespace std;
+
+namespace mesaac::cli::measures {
+namespace {
+// Rows per block are limited so that a block's values need no more than
+// about 16MB.
+const unsigned int MaxBlockRows = 256;
+const size_t MaxBlockValues = 1 << 22;
+// Rows are measured a few at a time, so that a measurer can reuse each
+// tile of columns across rows while it is in cache.
+const unsigned int RowsPerBatch = 8;
+
+using Entry = pair<unsigned int, float>;
+
+void format_sparse_row(const MatrixFormat &format, unsigned int i,
+                       span<const float> values, vector<Entry> &entries,
+                       ostream &outs) {
+  entries.clear();
+  for (unsigned int j = 0; j < values.size(); j++) {
+    if (format.skip_diagonal && (i == j)) {
+      continue;
+    }
+    const float value = values[j];
+    if (format.sparse_threshold) {
+      const float threshold = format.sparse_threshold.value();
+      if (format.is_similarity ? (value < threshold) : (value > threshold)) {
+        continue;
+      }
+    }
+    entries.emplace_back(j, value);
+  }
+  if (format.top_k > 0) {
+    const auto nearer = [&format](const Entry &a, const Entry &b) {
+      if (a.second != b.second) {
+        return format.is_similarity ? (a.second > b.second)
+                                    : (a.second < b.second);
+      }
+      return a.first < b.first;
+    };
+    const size_t num_kept = min<size_t>(format.top_k, entries.size());
+    partial_sort(entries.begin(), entries.begin() + num_kept, entries.end(),
+                 nearer);
+    entries.resize(num_kept);
+  }
+  for (const auto &[j, value] : entries) {
+    outs << j << " " << value << " ";
+  }
+  outs << -1 << "\n";
+}
+
+void format_row(const MatrixFormat &format, unsigned int i,
+                span<const float> values, vector<Entry> &entries,
+                ostream &outs) {
+  switch (format.format) {
+  case OutputFormat::ordered_pair:
+    for (unsigned int j = 0; j < values.size(); j++) {
+      outs << i << " " << j << " " << values[j] << "\n";
+    }
+    break;
+
+  case OutputFormat::matrix:
+    for (unsigned int j = 0; j < values.size(); j++) {
+      outs << ((j == 0) ? "" : " ") << values[j];
+    }
+    outs << "\n";
+    break;
+
+  case OutputFormat::sparse_matrix:
+    format_sparse_row(format, i, values, entries, outs);
+    break;
+  }
+}
+} // namespace
+
+void write_matrix_rows(ostream &outs, const MatrixFormat &format,
+                       const RowRange &rows, unsigned int num_cols,
+                       const RowBlockFn &compute_rows) {
+  const unsigned int block_rows = max<size_t>(
+      1, min<size_t>(MaxBlockRows, MaxBlockValues / max(1u, num_cols)));
+  vector<float> values(size_t(block_rows) * num_cols);
+  vector<ostringstream> formatted(block_rows);
+  common::stats::Stage &compute_stage(common::stats::stage("compute_rows"));
+  common::stats::Stage &write_stage(common::stats::stage("write_matrix_rows"));
+  for (unsigned int begin = rows.begin; begin < rows.end;
+       begin += block_rows) {
+    const unsigned int end = min(rows.end, begin + block_rows);
+    {
+      const common::stats::ScopedTimer timer(compute_stage,
+                                             size_t(end - begin) * num_cols);
+      compute_rows(begin, end, values);
+    }
+
+    const common::stats::ScopedTimer timer(write_stage, end - begin);
+#if HAVE_OPENMP
+#pragma omp parallel
+#endif
+    {
+      vector<Entry> entries;
+#if HAVE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (int r = 0; r < int(end - begin); r++) {
+        const span<const float> row_values(
+            values.data() + size_t(r) * num_cols, num_cols);
+        formatted[r].str("");
+        format_row(format, begin + r, row_values, entries, formatted[r]);
+      }
+    }
+    for (unsigned int r = 0; r < end - begin; r++) {
+      outs << formatted[r].view();
+    }
+  }
+  outs.flush();
+}
+
+void write_matrix_rows(
+    ostream &outs, const MatrixFormat &format, const RowRange &rows,
+    unsigned int num_cols,
+    const mesaac::measures::shape::IIndexedShapeFPMeasure &measurer) {
+  const auto compute_rows = [&measurer, num_cols](unsigned int begin,
+                                                  unsigned int end,
+                                                  span<float> values) {
+    const int num_batches = (end - begin + RowsPerBatch - 1) / RowsPerBatch;
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int b = 0; b < num_batches; b++) {
+      const unsigned int r = b * RowsPerBatch;
+      const unsigned int r_end = min(end - begin, r + RowsPerBatch);
+      measurer.value_block(begin + r, begin + r_end, 0, num_cols,
+                           values.data() + size_t(r) * num_cols);
+    }
+  };
+  write_matrix_rows(outs, format, rows, num_cols, compute_rows);
+}
+} // namespace mesaac::cli::measures
@@ -0,0 +1,55 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <span>
+
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+#include "shard.hpp"
+
+namespace mesaac::cli::measures {
+
+enum class OutputFormat {
+  ordered_pair,
+  matrix,
+  sparse_matrix,
+};
+
+struct MatrixFormat {
+  OutputFormat format;
+  // Whether values are similarities (larger is nearer) or distances.
+  bool is_similarity;
+  // For sparse_matrix: if set, list only values >= threshold for
+  // similarities, or <= threshold for distances.
+  std::optional<float> sparse_threshold;
+  // For sparse_matrix: if nonzero, list only the top_k nearest values of
+  // each row, nearest first, rather than all values in column order.
+  unsigned int top_k;
+  // For sparse_matrix: whether to omit column i from row i.
+  bool skip_diagonal;
+};
+
+// Computes the values of rows begin..(end - 1), for all columns, in row
+// major order.
+using RowBlockFn = std::function<void(unsigned int begin, unsigned int end,
+                                      std::span<float> values)>;
+
+// Write rows of a measures matrix.  Rows are computed a block at a time,
+// and formatted in parallel when OpenMP is available, but are always
+// written in row order.
+void write_matrix_rows(std::ostream &outs, const MatrixFormat &format,
+                       const RowRange &rows, unsigned int num_cols,
+                       const RowBlockFn &compute_rows);
+
+// Write rows of a measures matrix, computing each value with measurer.
+void write_matrix_rows(std::ostream &outs, const MatrixFormat &format,
+                       const RowRange &rows, unsigned int num_cols,
+                       const mesaac::measures::shape::IIndexedShapeFPMeasure
+                           &measurer);
+} // namespace mesaac::cli::measures
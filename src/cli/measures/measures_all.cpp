@@ -1,22 +1,25 @@
-#include <cstdlib>
-#include <fstream>
+#include <filesystem>
 #include <iostream>
-#include <libgen.h>
-#include <sstream>
-#include <stdexcept>
+#include <optional>
 #include <string>
 #include <vector>
 
-#include "Globals.h"
-#include "fingerprint_reader.h"
-#include "mesaac_measures/measurer_factory.h"
+#include "fingerprint_reader.hpp"
+#include "measure_type_converter.hpp"
 
-#include "mesaac_common/mesaac_common.h"
+#include "mesaac_measures/contingency_counts.hpp"
+#include "mesaac_measures/measures_factory.hpp"
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
 
 using namespace std;
 
-string Version = "1.2";
-string CreationDate = "October 17, 2005";
+namespace {
+using namespace mesaac::measures;
+
+const string Version = "1.3";
+const string CreationDate = "October 17, 2005";
 
 void show_blurb() {
   cerr << "Running MeasuresAll " << endl
@@ -25,203 +28,216 @@ void show_blurb() {
        << "Version number " << Version << " Creation Date: " << CreationDate
        << endl;
 }
-
-void show_usage(int /* argc */, char **argv, string msg = "") {
-  cerr << "Usage: " << basename(argv[0])
-       << " fingerprintfile.txt measure similarity format searching" << endl
-       << "       searchnumber | alpha | sparsethreshold" << endl
-       << "measure      = '-T' for Tanimoto, '-V' for Tversky, '-E' for "
-          "Euclidean,"
-       << endl
-       << "               '-H' for Hamann, '-C' for Cosine, '-B' for BUB"
-       << endl
-       << "similarity   = '-S' for similarity, '-D' for dissimilarity" << endl
-       << "format       = '-M' for Matrix, '-O' for Ordered Pairs, " << endl
-       << "               '-S' for Sparse Matrix, '-P' for PVM" << endl
-       << "searching    = '-T' for similarity searching, '-F' if not" << endl
-       << "searchnumber = a positive integer M < N to be searched" << endl
-       << endl
-       << "Note: fingerprint file will have M + N fingerprints for searching = "
-          "'-T'"
-       << endl
-       << "alpha is in the range 0-1, and measure must = '-V'" << endl
-       << "sparsethreshold is in the range of (0,1), and format must be = '-S' "
-          "or '-P'"
-       << endl;
-  if (msg.size() > 0) {
-    cerr << endl << msg << endl;
+} // namespace
+
+namespace {
+using namespace mesaac::arg_parser;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  std::vector<MeasureType> measure_types;
+  float tversky_alpha;
+  bool compute_similarity;
+  unsigned int search_number;
+  std::optional<float> threshold;
+  std::filesystem::path fingerprint_file;
+  std::optional<std::filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Option<std::string>::Ptr measures_opt = Option<std::string>::create(
+      "-m", "--measures",
+      ("the measures to report for each pair, in order, as a string of "
+       "codes -\n"
+       "        B (BUB), C (Cosine), E (Euclidean), H (Hamann), T "
+       "(Tanimoto),\n"
+       "        V (Tversky) - default is all, BCEHTV"));
+
+  Option<float>::Ptr alpha_opt = Option<float>::create(
+      "-a", "--alpha",
+      "alpha value to use for measure V (Tversky) - default is 0.0");
+
+  Flag::Ptr dissim = Flag::create(
+      "-d", "--dissimilarity",
+      "compute dissimilarity values - default is to compute similarity");
+
+  Option<unsigned int>::Ptr search_opt = Option<unsigned int>::create(
+      "-s", "--search",
+      ("measure only the first SEARCH fingerprints against the rest, "
+       "numbering\n"
+       "        the rest from 0 - default is to measure all pairs"));
+
+  Option<float>::Ptr threshold_opt = Option<float>::create(
+      "-t", "--threshold",
+      ("report only pairs whose first measure is at least (or, for "
+       "dissimilarity,\n"
+       "        at most) this value"));
+
+  Option<std::filesystem::path>::Ptr stats_opt =
+      Option<std::filesystem::path>::create(
+          "-S", "--stats",
+          "write a JSON summary of per-stage times and item counts to the "
+          "named file");
+
+  Argument<std::filesystem::path>::Ptr fp_path_arg =
+      Argument<std::filesystem::path>::create(
+          "fingerprint_file",
+          "plaintext file of binary fingerprints, one per line");
+
+  ArgParser parser = ArgParser(
+      {measures_opt, alpha_opt, dissim, search_opt, threshold_opt, stats_opt},
+      {fp_path_arg},
+      "Print several measures for each pair of a set of fingerprints, as "
+      "ordered pairs\n"
+      "followed by one value per measure.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{
+        .parse_status = 0,
+        .usage_requested = false,
+        .measure_types = {},
+        .tversky_alpha = 0.0,
+        .compute_similarity = true,
+        .search_number = 0,
+        .threshold = std::nullopt,
+        .fingerprint_file = std::filesystem::path(""),
+        .stats_file = std::nullopt,
+    };
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+    const auto codes = measures_opt->value_or("BCEHTV");
+    if (codes.empty()) {
+      parser.show_usage("Specify at least one measure");
+      result.parse_status = 1;
+      return result;
+    }
+    for (const char code : codes) {
+      try {
+        result.measure_types.push_back(
+            mesaac::cli::measures::get_measure_type(code));
+      } catch (std::invalid_argument &e) {
+        parser.show_usage(e);
+        result.parse_status = 1;
+        return result;
+      }
+    }
+    result.tversky_alpha = alpha_opt->value_or(0.0);
+    result.compute_similarity = !dissim->value();
+    result.search_number = search_opt->value_or(0);
+    if (threshold_opt->has_value()) {
+      result.threshold = threshold_opt->value();
+    }
+    result.fingerprint_file = fp_path_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
   }
-  exit(1);
-}
-
-int main(int argc, char **argv) {
-  unsigned int i, j;
-  float tversky_alpha = 0;
-  float sparse_threshold = 0;
-  unsigned int search_number = 0;
 
-  mesaac::MesaacFeatures f;
-  f.set(mesaac::MFE_GroupingModule);
-  mesaac::initCommon(f);
+  void show_usage(const std::string &err_msg) { parser.show_usage(err_msg); }
+};
 
-  show_blurb();
-
-  if ((argc < 7) || (argc > 9)) {
-    show_usage(argc, argv, "Wrong number of arguments");
+// Writes every requested measure of a pair, from one set of contingency
+// counts.
+class PairWriter {
+public:
+  PairWriter(const CmdParams &params) : m_params(params) {
+    for (const auto measure_type : params.measure_types) {
+      m_measures.push_back(get_measures(measure_type, params.tversky_alpha));
+    }
+    m_values.resize(m_measures.size());
   }
 
-  string distance_measure = argv[2];
-  if (distance_measure.size() != 2) {
-    ostringstream outs;
-    outs << "Unknown measure '" << distance_measure << "'";
-    show_usage(argc, argv, outs.str());
+  void write(ostream &outs, unsigned int i, unsigned int j,
+             const mesaac::shape_defs::BitVector &fp1,
+             const mesaac::shape_defs::BitVector &fp2) {
+    const auto counts = get_contingency_counts(fp1, fp2);
+    for (size_t k = 0; k < m_measures.size(); k++) {
+      const auto &measure = *m_measures[k];
+      m_values[k] = m_params.compute_similarity ? measure.similarity(counts)
+                                                : measure.distance(counts);
+    }
+    if (m_params.threshold) {
+      const float v = m_values[0];
+      const float threshold = m_params.threshold.value();
+      if (m_params.compute_similarity ? (v < threshold) : (v > threshold)) {
+        return;
+      }
+    }
+    outs << i << " " << j;
+    for (const float v : m_values) {
+      outs << " " << v;
+    }
+    outs << endl;
   }
 
-  string similarity = argv[3];
-  string format = argv[4];
-  string searching = argv[5];
-
-  if (similarity[1] != 'S' && similarity[1] != 'D') {
-    cerr << "similarity option is not either S or D. Default to Dissimilarity"
-         << endl;
+private:
+  const CmdParams &m_params;
+  std::vector<MeasuresBase::Ptr> m_measures;
+  std::vector<float> m_values;
+};
+
+void write_pairs(const CmdParams &params,
+                 const mesaac::shape_defs::ArrayBitVectors &fingerprints) {
+  static mesaac::common::stats::Stage &write_stage(
+      mesaac::common::stats::stage("measures_all"));
+
+  const unsigned int num_fingerprints = fingerprints.size();
+  const unsigned int num_rows =
+      params.search_number ? params.search_number : num_fingerprints;
+  const unsigned int col_start = params.search_number;
+  mesaac::common::stats::ScopedTimer timer(
+      write_stage, num_rows * (num_fingerprints - col_start));
+
+  PairWriter writer(params);
+  for (unsigned int i = 0; i < num_rows; i++) {
+    for (unsigned int j = col_start; j < num_fingerprints; j++) {
+      writer.write(cout, i, j - col_start, fingerprints[i], fingerprints[j]);
+    }
   }
+}
+} // namespace
 
-  if (distance_measure[1] == 'V' && (argc != 8 && argc != 9)) {
-    show_usage(argc, argv, "No alpha value supplied for Tversky measure.");
-  } else if (distance_measure[1] != 'V' && format[1] != 'S' &&
-             format[1] != 'P' && (argc == 8 || argc == 9)) {
-    show_usage(argc, argv, "Too many arguments");
-  }
+int main(int argc, const char **argv) {
+  using namespace mesaac;
 
-  // Format "-P" implies searching:
-  if ((searching[1] == 'T') || (format[1] == 'P')) {
-    search_number = atoi(argv[6]);
+  show_blurb();
+
+  CmdLineParser parser;
+  const auto params = parser.parse_args(argc, argv);
+  if (params.parse_status != 0) {
+    return params.parse_status;
   }
-  if (distance_measure[1] == 'V' && format[1] != 'S' && format[1] != 'P' &&
-      argc == 8) {
-    tversky_alpha = atof(argv[7]);
-  } else if (distance_measure[1] == 'V' &&
-             (format[1] == 'S' || format[1] == 'P') && argc == 9) {
-    tversky_alpha = atof(argv[7]);
-    sparse_threshold = atof(argv[8]);
-  } else if (distance_measure[1] != 'V' &&
-             (format[1] == 'S' || format[1] == 'P') && argc == 8) {
-    sparse_threshold = atof(argv[7]);
-  } else if (argc != 7) {
-    show_usage(argc, argv, "Wrong number of arguments");
+  if (params.usage_requested) {
+    return 0;
   }
-
-  bool compute_sim = ('S' == similarity[1]);
-  const char dist_type(distance_measure[1]);
-
-  // cerr << "Settings:" << endl
-  //      << "    Measure: " << dist_type << endl
-  //      << "    Similarity? " << compute_sim << endl
-  //      << "    Format: " << format << endl
-  //      << "    Searching: " << searching << " search number, if applicable: "
-  //      << search_number << endl
-  //      << "    Tversky alpha, if applicable: " << tversky_alpha << endl
-  //      << "    Sparse threshold, if app.:    " << sparse_threshold << endl
-  //      ;
-
-  // Create a list of fingerprints to store each bitstring in
-  ArrayBitVectors fingerprints;
-  read_fingerprints(argv[1], fingerprints);
-
-  IMeasurer *measurer =
-      get_measurer(compute_sim, dist_type, fingerprints, tversky_alpha);
-  if (0 == measurer) {
-    ostringstream msg;
-    msg << "Unknown measure -" << dist_type
-        << ".  Please specify one of  -T, -V, -E, -H or -C";
-    show_usage(argc, argv, msg.str());
+  if (params.stats_file) {
+    common::stats::enable();
   }
 
-  const unsigned int number_fingerprints = fingerprints.size();
-
-  if ((searching == "-T") &&
-      ((search_number <= 0) || (search_number >= number_fingerprints))) {
-    ostringstream msg;
-    msg << "Search number (" << search_number << ") must be in the range 1.."
-        << number_fingerprints << " (number of fingerprints), inclusive.";
-    show_usage(argc, argv, msg.str());
-  }
-  if (format[1] == 'O') { // ordered pair format
-    for (i = 0; i < number_fingerprints; i++) {
-      for (j = 0; j < number_fingerprints; j++) {
-        cout << i << " " << j << " " << measurer->value(i, j) << endl;
-      }
-    }
-  } else if (format[1] == 'M') { // Matrix format
-    for (i = 0; i < number_fingerprints; i++) {
-      string sep("");
-      for (j = 0; j < number_fingerprints; j++) {
-        cout << sep << measurer->value(i, j);
-        sep = " ";
-      }
-      cout << endl;
+  try {
+    shape_defs::ArrayBitVectors fingerprints;
+    cli::measures::read_fingerprints(params.fingerprint_file, fingerprints);
+    if (params.search_number &&
+        params.search_number >= fingerprints.size()) {
+      parser.show_usage(
+          "Search number (" + to_string(params.search_number) +
+          ") must be less than the number of fingerprints (" +
+          to_string(fingerprints.size()) + ").");
+      return 1;
     }
-  } else if (format[1] == 'S') { // Sparse Matrix
-    unsigned int i_end = number_fingerprints;
-    unsigned int j_start = 0;
-    bool is_searching = (searching == "-T");
-    if (is_searching) {
-      i_end = search_number;
-      j_start = search_number;
-    }
-    if (compute_sim) {
-      for (i = 0; i < i_end; i++) {
-        if (is_searching) {
-          cout << i << " ";
-        }
-        for (j = j_start; j < number_fingerprints; j++) {
-          if (i != j) {
-            float v = measurer->value(i, j);
-            if (sparse_threshold <= v) {
-              cout << j << " " << v << " ";
-            }
-          }
-        }
-        cout << -1 << endl;
-      }
-    } else {
-      for (i = 0; i < i_end; i++) {
-        if (is_searching) {
-          cout << i << " ";
-        }
-        for (j = j_start; j < number_fingerprints; j++) {
-          if (i != j) {
-            float v = measurer->value(i, j);
-            if (sparse_threshold >= v) {
-              cout << j << " " << v << " ";
-            }
-          }
-        }
-        cout << -1 << endl;
-      }
-    }
-  } else if (format[1] == 'P') { // PVM
-    if (compute_sim) {
-      for (i = 0; i < search_number; i++) {
-        for (j = search_number; j < number_fingerprints; j++) {
-          float v = measurer->value(i, j);
-          if (sparse_threshold <= v) {
-            cout << (j - search_number) << " " << v << " ";
-          }
-        }
-        cout << -1 << endl;
-      }
-    } else {
-      for (i = 0; i < search_number; i++) {
-        for (j = search_number; j < number_fingerprints; j++) {
-          float v = measurer->value(i, j);
-          if (sparse_threshold >= v) {
-            cout << (j - search_number) << " " << v << " ";
-          }
-        }
-        cout << -1 << endl;
-      }
+    write_pairs(params, fingerprints);
+    if (params.stats_file) {
+      common::stats::write_report(params.stats_file.value());
     }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
   }
   return 0;
 }
@@ -1,581 +1,214 @@
-#include <fstream>
-#include <string>
-#include <vector>
-#include <iostream>
-#include <cmath>
-#include <cstdlib>
-
-#include "Globals.h"
-#include "EuclideanCounts.h"
-#include "TanimotoCounts.h"
-#include "TverskyCounts.h"
-#include "CosineCounts.h"
-
-#include "mesaac_common/mesaac_common.h"
-
-using namespace std;
-
-string Version = "1.0";
-string CreationDate = "May, 2007";
-
-
-int main(int argc, char **argv){
-  
-  unsigned int i,j, number_countVectors = 0;
-  float SparseThreshold;
-  float tmpmeasure;
-  float TverskyAlpha;
-  unsigned int count;
-  char charcount;
-  vector<char> countsVector;
+// Print pairwise measures for a set of feature count vectors.
+// Copyright (c) 2007-2010 Mesa Analytics & Computing, Inc.  All rights
+// reserved
 
-  
-  mesaac::MesaacFeatures f;
-  f.set(mesaac::MFE_GroupingModule);
-  mesaac::initCommon(f);
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <variant>
 
-  cerr << "Running Measures.  Source code Copyright (c) 2007 Mesa Analytics & Computing, LLC" << endl
-       << "Version number " << Version << " Creation Date: " << CreationDate << endl
-       << "Expiration Date: " << mesaac::expirationDateStr() << endl;
+#include "mesaac_measures/count_measures.hpp"
 
-  if (argc != 7){
-      cerr << "Usage: " << argv[0]
-         << "countsfile.txt measure similarity format sparsethreshold alpha" << endl
-         << "measure = '-T' for Tanimoto,'-V' for Tversky, '-E' for Euclidean, '-C' for Cosine" << endl
-         << "similarity = '-S' for similarity, '-D' for dissimilarity" << endl
-         << "format = '-M' for Matrix, '-O' for Ordered Pairs, '-S' for Sparse Matrix" << endl
-         << "sparsethreshold is in the range of (0,1), and format must be = '-S'" << endl;
-    exit(1);
-  }
-  
-  // Input from either stdin or file
-  string inputstring = argv[1];
-  ifstream ifs1;
-  if(inputstring != "-"){
-    ifs1.open(argv[1]);
-    if(!ifs1){
-      cerr << "Cannot open counts file. Abort." << endl;
-      exit(1);
-    }
-  }                       
-  
-  string distanceMeasure = argv[2];
-  string similarity = argv[3];
-  string format = argv[4];
-  
-  if(similarity[1] != 'S' && similarity[1] != 'D'){
-    cerr << "similarity option is not either S or D. Default to Dissimilarity" << endl;
-  }    
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
 
-  //Read in fingerprints from fingerprint file. 
-  SparseThreshold = atof(argv[5]);
-  TverskyAlpha = atof(argv[6]);
-  
-  //Create a list of fingerprints to store each bitstring in
-  ArrayCountVectors CountVectors;
-  //Length of count vector
-  unsigned int vector_size = FPLEN;
-
-
-  if(inputstring == "-"){
-      //Read in single counts from count fingerprints from standard input
-      i = 0;
-      while(cin >> count){
-          if(i < vector_size){
-              charcount = count;
-              countsVector.push_back(charcount);
-              i++;
-          }
-          else{
-              CountVectors.push_back(countsVector);
-              countsVector.erase(countsVector.begin(),countsVector.end());
-              charcount = count;
-              countsVector.push_back(charcount);
-              i = 1;
-              number_countVectors++;
-          }
-      }
-      //Insert the last remaining countsVector and erase the countsVector.
-      CountVectors.push_back(countsVector);
-      countsVector.erase(countsVector.begin(),countsVector.end());
-      number_countVectors++;
-  }
-  else{// Same as above, only read in from a file.
-     //Read in single counts from count fingerprints from standard input
-      i = 0;
-      while(ifs1 >> count){
-          if(i < vector_size){
-              charcount = count;
-              countsVector.push_back(charcount);
-              i++;
-          }
-          else{
-              CountVectors.push_back(countsVector);
-              countsVector.erase(countsVector.begin(),countsVector.end());
-              charcount = count;
-              countsVector.push_back(charcount);
-              i = 1;
-              number_countVectors++;
-          }
-      }
-      //Insert the last remaining countsVector and erase the countsVector.
-      CountVectors.push_back(countsVector);
-      countsVector.erase(countsVector.begin(),countsVector.end());
-      number_countVectors++;
-  }
+#include "count_vector_reader.hpp"
+#include "matrix_writer.hpp"
+#include "measure_type_converter.hpp"
+#include "shard.hpp"
 
+using namespace std;
 
-  //Measures
-  if(distanceMeasure[1] == 'T'){
-    tanimotocounts tanicountmeasure;
-    tanicountmeasure.init(vector_size);
-    float max = 0.0;
-    float tmpmax = 0.0;
-    for(i=0; i < number_countVectors; i++){
-        tanicountmeasure.init(vector_size);
-        tmpmax = tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[i]);
-        if(tmpmax > max){
-            max = tmpmax;
-        }
+namespace {
+using namespace mesaac::arg_parser;
+using mesaac::cli::measures::MatrixFormat;
+using mesaac::cli::measures::OutputFormat;
+using mesaac::cli::measures::RowRange;
+using mesaac::cli::measures::Shard;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  mesaac::measures::MeasureType measure_type;
+  float tversky_alpha;
+  bool compute_similarity;
+  OutputFormat out_format;
+  float sparse_threshold;
+  optional<Shard> shard;
+  filesystem::path counts_file;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Choice::Ptr measure_choice = Choice::create(
+      "-m", "--measure", "the measure to use",
+      {
+          {"C", "Cosine measure"},
+          {"E", "Euclidean measure"},
+          {"T", "Tanimoto measure - default"},
+          {"V",
+           "Tversky measure - can be used in conjunction with -a | --alpha"},
+      });
+
+  Option<float>::Ptr alpha_opt = Option<float>::create(
+      "-a", "--alpha",
+      "alpha value to use for measure V (Tversky), greater than 0 and less "
+      "than 2 - default is 1.0");
+
+  Flag::Ptr dissim = Flag::create(
+      "-d", "--dissimilarity",
+      "compute dissimilarity values - default is to compute similarity");
+
+  Choice::Ptr format_choice = Choice::create(
+      "-f", "--format", "how to format the output - default is 'S'",
+      {
+          {"M", "full matrix"},
+          {"S", "sparse matrix"},
+          {"O", "ordered pairs"},
+      });
+
+  Option<float>::Ptr sparse_opt =
+      Option<float>::create("-t", "--threshold",
+                            "(dis)similarity sparse threshold to use for "
+                            "output format S - default is 1.0");
+
+  Option<string>::Ptr shard_opt = Option<string>::create(
+      "-p", "--shard",
+      ("compute only part I of N of the output rows, for combining with "
+       "measures_merge -\n"
+       "        given as I/N, e.g. 2/4"));
+
+  Argument<filesystem::path>::Ptr counts_path_arg =
+      Argument<filesystem::path>::create(
+          "counts_file",
+          "plaintext file of count vectors, one per line, with counts "
+          "separated by whitespace");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  ArgParser parser = ArgParser(
+      {measure_choice, alpha_opt, dissim, format_choice, sparse_opt,
+       shard_opt, stats_opt},
+      {counts_path_arg},
+      "Print pairwise measures for a set of feature count vectors.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{
+        .parse_status = 0,
+        .usage_requested = false,
+        .measure_type = mesaac::measures::MeasureType::tanimoto,
+        .tversky_alpha = 1.0,
+        .compute_similarity = true,
+        .out_format = OutputFormat::sparse_matrix,
+        .sparse_threshold = 1.0,
+        .shard = nullopt,
+        .counts_file = filesystem::path(""),
+        .stats_file = nullopt,
+    };
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
     }
-    if(max <= 0){
-      cerr << "Cannot normalize Tanimoto:  Max self Tanimoto <= 0" << endl;
-      exit(1);
+    const auto measure_str = measure_choice->value_or("T");
+    result.measure_type =
+        mesaac::cli::measures::get_measure_type(measure_str.at(0));
+    result.tversky_alpha = alpha_opt->value_or(1.0);
+    result.compute_similarity = !dissim->value();
+
+    const auto format_str = format_choice->value_or("S");
+    if (format_str == "M") {
+      result.out_format = OutputFormat::matrix;
+    } else if (format_str == "O") {
+      result.out_format = OutputFormat::ordered_pair;
+    } else if (format_str == "S") {
+      result.out_format = OutputFormat::sparse_matrix;
+    } else {
+      // Should not get here.
+      parser.show_usage("Unknown format value '" + format_str + "'");
+      result.parse_status = 1;
+      return result;
     }
-
-    if(similarity[1] == 'S'){//similarity
-      if(format[1] == 'O'){//ordered pair format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            tanicountmeasure.init(vector_size);
-            cout << i << " " << j << " " << 
-                tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max << endl;
-          }
-        }
-      }
-      else if(format[1] == 'M'){//Matrix format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            tanicountmeasure.init(vector_size);
-            
-            if(j != number_countVectors - 1)
-              cout << 
-                 tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max << " ";
-            else
-              cout << tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max;
-          }
-          cout << endl;
-        }
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            if(i!=j){
-              tanicountmeasure.init(vector_size);             
-              tmpmeasure = 
-                  tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max;      
-              if(SparseThreshold < tmpmeasure)
-                cout << j << " " << tmpmeasure << " ";
-              }
-          }
-          cout << -1 << endl;
-        }
+    result.sparse_threshold = sparse_opt->value_or(1.0);
+    if (shard_opt->has_value()) {
+      try {
+        result.shard = mesaac::cli::measures::parse_shard(shard_opt->value());
+      } catch (invalid_argument &e) {
+        parser.show_usage(e);
+        result.parse_status = 1;
+        return result;
       }
     }
-    else{// dissimilarity
-      if(format[1] == 'O'){//ordered pair format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            tanicountmeasure.init(vector_size);
-            cout << i << " " << j << " " << 
-                1.0 - tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max << endl;
-          }
-        }
-      }
-      else if(format[1] == 'M'){//Matrix format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            tanicountmeasure.init(vector_size);
-            
-            if(j != number_countVectors - 1)
-              cout << 
-                  (max - tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[j]))/max << " ";
-                  //1.0 - tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max << " ";
-
-            else
-                cout << (max - tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[j]))/max;
-          }
-          cout << endl;
-        }
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            if(i!=j){
-              tanicountmeasure.init(vector_size);             
-              tmpmeasure = 
-                  1.0 - tanicountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max;        
-              if(SparseThreshold >= tmpmeasure)
-                cout << j << " " << tmpmeasure << " ";
-              }
-          }
-          cout << -1 << endl;
-        }
-      }
+    result.counts_file = counts_path_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
     }
+    return result;
   }
-  else if(distanceMeasure[1] == 'V'){
-
+};
+
+template <typename CountVectorsType>
+void compute_and_output(const CmdParams &params,
+                        const CountVectorsType &counts) {
+  const auto measurer = mesaac::measures::get_count_measurer(
+      params.measure_type, params.tversky_alpha, params.compute_similarity,
+      counts);
+
+  const unsigned int num_vectors = counts.size();
+  RowRange rows{.begin = 0, .end = num_vectors};
+  if (params.shard) {
+    rows = mesaac::cli::measures::get_shard_rows(params.shard.value(),
+                                                 num_vectors);
+    mesaac::cli::measures::write_shard_header(cout, params.shard.value(),
+                                              rows, num_vectors);
+  }
+  const MatrixFormat format{
+      .format = params.out_format,
+      .is_similarity = params.compute_similarity,
+      .sparse_threshold = params.sparse_threshold,
+      .top_k = 0,
+      .skip_diagonal = true,
+  };
+  mesaac::cli::measures::write_matrix_rows(cout, format, rows, num_vectors,
+                                           *measurer);
+  if (params.shard) {
+    mesaac::cli::measures::write_shard_trailer(cout);
+  }
+}
+} // namespace
 
-    if(TverskyAlpha > 2.0 || TverskyAlpha < 0.0)
-      cout << "Alpha is not in the range 0 to 2 -- hope that is ok. Normalization is based on this range." << endl;
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
 
-    tverskycounts tvercountmeasure;
-    float max = 0.0;
-    float tmpmax = 0.0;
-    for(i=0; i < number_countVectors; i++){
-        tvercountmeasure.init(vector_size,TverskyAlpha);        
-        tmpmax = tvercountmeasure.computeMeasure(CountVectors[i],CountVectors[i]);
-        if(tmpmax > max){
-            max = tmpmax;
-        }
-        tvercountmeasure.init(vector_size,2.0 - TverskyAlpha);  
-        tmpmax = tvercountmeasure.computeMeasure(CountVectors[i],CountVectors[i]);
-        if(tmpmax > max){
-            max = tmpmax;
-        }
-    }
-    if(max <= 0){
-      cerr << "Cannot normalize Tversky:  Max self Tversky (calculated with both alpha and beta) <= 0" << endl;
-      exit(1);
-    }
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
 
-    if(similarity[1] == 'S'){//similarity
-      if(format[1] == 'O'){//ordered pair format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            //asymmetry is stored in the triangular portions of the matrices.
-            //upper
-            
-            if(i<j){
-              tvercountmeasure.init(vector_size,TverskyAlpha);  
-              cout << i << " " << j << " " << 
-                  tvercountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max << endl;
-            }
-            else if(j<i){
-              tvercountmeasure.init(vector_size,2.0 - TverskyAlpha);    
-              cout << i << " " << j << " " << 
-                  tvercountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max << endl;
-            }
-            else{
-              cout << i << " " << j << " " << 1.0 << endl;
-            }
-          }
-        }
-      }
-      else if(format[1] == 'M'){//Matrix format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            //asymmetry is stored in the triangular portions of the matrices.
-            //upper
-            
-            if(i<j){
-              tvercountmeasure.init(vector_size,TverskyAlpha);  
-              if(j != number_countVectors - 1){
-                cout << tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max << " ";
-              }
-              else{
-                cout << tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max;
-              }
-            }
-            else if(j<i){
-              tvercountmeasure.init(vector_size,2.0 - TverskyAlpha);    
-              if(j != number_countVectors - 1){
-                cout << tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max << " ";
-              }
-              else{
-                cout << tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max;
-              }
-            }
-            else{
-              if(j != number_countVectors - 1){
-                cout << 1.0 << " ";
-              }
-              else{
-                cout << 1.0;
-              }
-            }
-          }
-          cout << endl;
-        }
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            if(i!=j){
-              tvercountmeasure.init(vector_size,TverskyAlpha);  
-              tmpmeasure = tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max;
-              if(SparseThreshold < tmpmeasure)
-                cout << j << " " << tmpmeasure << " ";
-            }
-          }
-          cout << -1 << endl;
-        }
-      }
-    }
-    else{//dissimilarity
-      if(format[1] == 'O'){//ordered pair format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            //asymmetry is stored in the triangular portions of the matrices.
-            //upper
-            
-            if(i<j){
-              tvercountmeasure.init(vector_size,TverskyAlpha);  
-              cout << i << " " << j << " " << 
-                  1.0 - tvercountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max << endl;
-            }
-            else if(j<i){
-              tvercountmeasure.init(vector_size,2.0 - TverskyAlpha);    
-              cout << i << " " << j << " " << 
-                  1.0 - tvercountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/max << endl;
-            }
-            else{
-              cout << i << " " << j << " " << 0.0 << endl;
-            }
-          }
-        }
-      }
-      else if(format[1] == 'M'){//Matrix format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            //asymmetry is stored in the triangular portions of the matrices.
-            //upper
-            
-            if(i<j){
-              tvercountmeasure.init(vector_size,TverskyAlpha);  
-              if(j != number_countVectors - 1){
-                cout << 1.0 - tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max << " ";
-              }
-              else{
-                cout << 1.0 - tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max;
-              }
-            }
-            else if(j<i){
-              tvercountmeasure.init(vector_size,2.0 - TverskyAlpha);    
-              if(j != number_countVectors - 1){
-                cout << 1.0 - tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max << " ";
-              }
-              else{
-                cout << 1.0 - tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max;
-              }
-            }
-            else{
-              if(j != number_countVectors - 1){
-                cout << 0.0 << " ";
-              }
-              else{
-                cout << 0.0;
-              }
-            }
-          }
-          cout << endl;
-        }
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            if(i!=j){
-              tvercountmeasure.init(vector_size,TverskyAlpha);  
-              tmpmeasure = 1.0 - tvercountmeasure.computeMeasure(CountVectors[j],CountVectors[i])/max;
-              if(SparseThreshold >= tmpmeasure)
-                cout << j << " " << tmpmeasure << " ";
-            }
-          }
-          cout << -1 << endl;
-        }
-      }
-    }
-  }//End else if
-  else if(distanceMeasure[1] == 'E'){
-    euclideancounts euclidcountmeasure;
-    int max = 0;
-    int tmpmax = 0;
-    for(i=0; i < number_countVectors; i++){
-        for(j=0; j < vector_size; j++){
-            tmpmax += CountVectors[i][j];
-        }
-        if(max <= tmpmax){
-            max = tmpmax;
-        }
-    }
-    double doublemax = sqrt((double)max);
-    if(max <= 0){
-      cerr << "Cannot normalize Euclidean:  Max counts for any vector is 0" << endl;
-      exit(1);
-    }
-    if(similarity[1] == 'S'){
-      if(format[1] == 'O'){//ordered pair format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            euclidcountmeasure.init(vector_size);
-            cout << i << " " << j << " " << 
-                1.0 - euclidcountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/doublemax << endl;
-          }
-        }
-      }
-      else if(format[1] == 'M'){//Matrix format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            euclidcountmeasure.init(vector_size);
-            if(j != number_countVectors - 1)
-              cout << 1.0 - euclidcountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/doublemax << " ";
-            else
-              cout << 1.0 - euclidcountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/doublemax;
-          }
-          cout << endl;
-        }
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            if(i!=j){
-              euclidcountmeasure.init(vector_size);
-              tmpmeasure = 1.0 - euclidcountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/doublemax;
-                if(SparseThreshold < tmpmeasure)
-                  cout << j << " " << tmpmeasure << " ";
-            }
-          }
-          cout << -1 << endl;
-        }
-      } 
-    }
-    else{// dissimilarity
-      if(format[1] == 'O'){//ordered pair format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            euclidcountmeasure.init(vector_size);
-            cout << i << " " << j << " " << 
-                euclidcountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/doublemax << endl;
-          }
-        }
-      }
-      else if(format[1] == 'M'){//Matrix format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            euclidcountmeasure.init(vector_size);
-            if(j != number_countVectors - 1)
-              cout << euclidcountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/doublemax << " ";
-            else
-              cout << euclidcountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/doublemax;
-          }
-          cout << endl;
-        }
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            if(i!=j){
-              euclidcountmeasure.init(vector_size);
-              tmpmeasure = euclidcountmeasure.computeMeasure(CountVectors[i],CountVectors[j])/doublemax;
-                if(SparseThreshold >= tmpmeasure)
-                  cout << j << " " << tmpmeasure << " ";
-            }
-          }
-          cout << -1 << endl;
-        }
-      }
-    }
-  }//End else if
-  else if(distanceMeasure[1] == 'C'){
-    cosinecounts cosinecountmeasure;
-    if(similarity[1] == 'S'){
-      if(format[1] == 'O'){//ordered pair format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            cosinecountmeasure.init(vector_size);
-            cout << i << " " << j << " " << 
-                cosinecountmeasure.computeMeasure(CountVectors[i],CountVectors[j]) << endl;
-          }
-        }
-      }
-      else if(format[1] == 'M'){//Matrix format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            cosinecountmeasure.init(vector_size);
-            if(j != number_countVectors - 1)
-              cout << cosinecountmeasure.computeMeasure(CountVectors[i],CountVectors[j]) << " ";
-            else
-              cout << cosinecountmeasure.computeMeasure(CountVectors[i],CountVectors[j]);
-          }
-          cout << endl;
-        }
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            if(i!=j){
-              cosinecountmeasure.init(vector_size);
-              tmpmeasure = cosinecountmeasure.computeMeasure(CountVectors[i],CountVectors[j]);
-              if(SparseThreshold < tmpmeasure)
-                cout << j << " " << tmpmeasure << " ";
-            }
-          }
-          cout << -1 << endl;
-        }
-      }
+  try {
+    const auto counts =
+        mesaac::cli::measures::read_count_vectors(params.counts_file);
+    visit([&params](const auto &cvs) { compute_and_output(params, cvs); },
+          counts);
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
     }
-    else{// dissimilarity
-      if(format[1] == 'O'){//ordered pair format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            cosinecountmeasure.init(vector_size);
-            cout << i << " " << j << " " << 
-                1.0 - cosinecountmeasure.computeMeasure(CountVectors[i],CountVectors[j]) << endl;
-          }
-        }
-      }
-      else if(format[1] == 'M'){//Matrix format
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            cosinecountmeasure.init(vector_size);
-            if(j != number_countVectors - 1)
-              cout << 1.0 - cosinecountmeasure.computeMeasure(CountVectors[i],CountVectors[j]) << " ";
-            else
-              cout << 1.0 - cosinecountmeasure.computeMeasure(CountVectors[i],CountVectors[j]);
-          }
-          cout << endl;
-        }
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-        for(i=0; i < number_countVectors; i++){
-          for(j=0; j < number_countVectors; j++){
-            if(i!=j){
-              cosinecountmeasure.init(vector_size);
-              tmpmeasure = 1.0 - cosinecountmeasure.computeMeasure(CountVectors[i],CountVectors[j]);
-              if(SparseThreshold >= tmpmeasure)
-                cout << j << " " << tmpmeasure << " ";
-              }
-          }
-          cout << -1 << endl;
-        }
-      }
-    }
-  }//End else if
-  else {
-    cerr << "No measure chosen, check that - option set to either T, V, E, or C\n";
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
     return 1;
   }
   return 0;
 }
-
-
-
-
-
-
-
-
-
-
-
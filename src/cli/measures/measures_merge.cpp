@@ -0,0 +1,92 @@
+// Combine the outputs of a sharded measures job.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+
+#include "shard.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  vector<filesystem::path> shard_paths;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  MultiValuedArgument<filesystem::path>::Ptr shards_arg =
+      MultiValuedArgument<filesystem::path>::create(
+          "shard_file",
+          "output of one shard of the job - give one file for each shard, "
+          "in any order");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  ArgParser parser = ArgParser(
+      {stats_opt}, {shards_arg},
+      "Combine the outputs of measures_nxn, measures_sim or "
+      "measures_shape_fp\n"
+      "jobs run with --shard I/N, printing the output of the equivalent "
+      "unsharded job.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .shard_paths = {},
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+    result.shard_paths = shards_arg->values();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
+  }
+};
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  try {
+    mesaac::cli::measures::merge_shards(params.shard_paths, cout);
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
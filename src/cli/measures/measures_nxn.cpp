@@ -4,12 +4,14 @@
 #include <iostream>
 #include <libgen.h>
 #include <map>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "fingerprint_reader.hpp"
 #include "measure_type_converter.hpp"
+#include "shard.hpp"
 
 #include "mesaac_measures/measures_factory.hpp"
 #include "mesaac_measures/shape_measures_factory.hpp"
@@ -18,6 +20,7 @@
 
 #include "mesaac_arg_parser/arg_parser.hpp"
 #include "mesaac_arg_parser/value_converter.hpp"
+#include "mesaac_common/stats.hpp"
 
 using namespace std;
 
@@ -38,6 +41,8 @@ void show_blurb() {
 
 namespace {
 using namespace mesaac::arg_parser;
+using mesaac::cli::measures::RowRange;
+using mesaac::cli::measures::Shard;
 
 enum class OutputFormat {
   ordered_pair,
@@ -54,7 +59,9 @@ struct CmdParams {
   bool compute_similarity;
   OutputFormat out_format;
   float sparse_threshold;
+  std::optional<Shard> shard;
   std::filesystem::path fingerprint_file;
+  std::optional<std::filesystem::path> stats_file;
 };
 
 struct CmdLineParser {
@@ -91,13 +98,26 @@ struct CmdLineParser {
                             "(dis)similarity sparse threshold to use for "
                             "output format S - default is 1.0");
 
+  Option<std::string>::Ptr shard_opt = Option<std::string>::create(
+      "-p", "--shard",
+      ("compute only part I of N of the output rows, for combining with "
+       "measures_merge -\n"
+       "        given as I/N, e.g. 2/4"));
+
   Argument<std::filesystem::path>::Ptr fp_path_arg =
       Argument<std::filesystem::path>::create(
           "fingerprint_file",
           "plaintext file of binary fingerprints, one per line");
 
+  Option<std::filesystem::path>::Ptr stats_opt =
+      Option<std::filesystem::path>::create(
+          "-S", "--stats",
+          "write a JSON summary of per-stage times and item counts to the "
+          "named file");
+
   ArgParser parser = ArgParser(
-      {measure_choice, alpha_opt, dissim, format_choice, sparse_opt},
+      {measure_choice, alpha_opt, dissim, format_choice, sparse_opt,
+       shard_opt, stats_opt},
       {fp_path_arg}, "Print pairwise measures for a set of fingerprints.");
 
   CmdParams parse_args(int argc, const char *argv[]) {
@@ -109,7 +129,9 @@ struct CmdLineParser {
         .compute_similarity = true,
         .out_format = OutputFormat::sparse_matrix,
         .sparse_threshold = 1.0,
+        .shard = std::nullopt,
         .fingerprint_file = std::filesystem::path(""),
+        .stats_file = std::nullopt,
     };
     result.parse_status = parser.parse_args(argc, argv);
     result.usage_requested = parser.usage_requested();
@@ -138,41 +160,60 @@ struct CmdLineParser {
       return result;
     }
     result.sparse_threshold = sparse_opt->value_or(1.0);
+    if (shard_opt->has_value()) {
+      try {
+        result.shard =
+            mesaac::cli::measures::parse_shard(shard_opt->value());
+      } catch (std::invalid_argument &e) {
+        parser.show_usage(e);
+        result.parse_status = 1;
+        return result;
+      }
+    }
     result.fingerprint_file = fp_path_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
     return result;
   }
 
   void show_usage(const std::string &err_msg) { parser.show_usage(err_msg); }
 };
 
-void output_ordered_pairs(size_t num_fingerprints,
+void output_ordered_pairs(size_t num_fingerprints, const RowRange &rows,
                           shape::IIndexedShapeFPMeasure::Ptr measurer) {
-  for (size_t i = 0; i < num_fingerprints; i++) {
+  vector<float> row(num_fingerprints);
+  for (size_t i = rows.begin; i < rows.end; i++) {
+    measurer->value_row(i, 0, num_fingerprints, row.data());
     for (size_t j = 0; j < num_fingerprints; j++) {
-      cout << i << " " << j << " " << measurer->value(i, j) << endl;
+      cout << i << " " << j << " " << row[j] << endl;
     }
   }
 }
 
-void output_full_matrix(size_t num_fingerprints,
+void output_full_matrix(size_t num_fingerprints, const RowRange &rows,
                         shape::IIndexedShapeFPMeasure::Ptr measurer) {
-  for (size_t i = 0; i < num_fingerprints; i++) {
+  vector<float> row(num_fingerprints);
+  for (size_t i = rows.begin; i < rows.end; i++) {
+    measurer->value_row(i, 0, num_fingerprints, row.data());
     string sep("");
     for (size_t j = 0; j < num_fingerprints; j++) {
-      cout << sep << measurer->value(i, j);
+      cout << sep << row[j];
       sep = " ";
     }
     cout << endl;
   }
 }
 
-void output_sparse_sim_matrix(size_t num_fingerprints,
+void output_sparse_sim_matrix(size_t num_fingerprints, const RowRange &rows,
                               shape::IIndexedShapeFPMeasure::Ptr measurer,
                               const float sparse_threshold) {
-  for (size_t i = 0; i < num_fingerprints; i++) {
+  vector<float> row(num_fingerprints);
+  for (size_t i = rows.begin; i < rows.end; i++) {
+    measurer->value_row(i, 0, num_fingerprints, row.data());
     for (size_t j = 0; j < num_fingerprints; j++) {
       if (i != j) {
-        float v = measurer->value(i, j);
+        float v = row[j];
         if (sparse_threshold <= v) {
           cout << j << " " << v << " ";
         }
@@ -182,13 +223,15 @@ void output_sparse_sim_matrix(size_t num_fingerprints,
   }
 }
 
-void output_sparse_dist_matrix(size_t num_fingerprints,
+void output_sparse_dist_matrix(size_t num_fingerprints, const RowRange &rows,
                                shape::IIndexedShapeFPMeasure::Ptr measurer,
                                const float sparse_threshold) {
-  for (size_t i = 0; i < num_fingerprints; i++) {
+  vector<float> row(num_fingerprints);
+  for (size_t i = rows.begin; i < rows.end; i++) {
+    measurer->value_row(i, 0, num_fingerprints, row.data());
     for (size_t j = 0; j < num_fingerprints; j++) {
       if (i != j) {
-        float v = measurer->value(i, j);
+        float v = row[j];
         if (sparse_threshold >= v) {
           cout << j << " " << v << " ";
         }
@@ -198,7 +241,7 @@ void output_sparse_dist_matrix(size_t num_fingerprints,
   }
 }
 
-void output_results(const size_t num_fingerprints,
+void output_results(const size_t num_fingerprints, const RowRange &rows,
                     const OutputFormat &out_format,
                     shape::IIndexedShapeFPMeasure::Ptr measurer,
                     const bool compute_similarity,
@@ -206,18 +249,20 @@ void output_results(const size_t num_fingerprints,
 
   switch (out_format) {
   case OutputFormat::matrix:
-    output_full_matrix(num_fingerprints, measurer);
+    output_full_matrix(num_fingerprints, rows, measurer);
     break;
 
   case OutputFormat::ordered_pair:
-    output_ordered_pairs(num_fingerprints, measurer);
+    output_ordered_pairs(num_fingerprints, rows, measurer);
     break;
 
   case OutputFormat::sparse_matrix:
     if (compute_similarity) {
-      output_sparse_sim_matrix(num_fingerprints, measurer, sparse_threshold);
+      output_sparse_sim_matrix(num_fingerprints, rows, measurer,
+                               sparse_threshold);
     } else {
-      output_sparse_dist_matrix(num_fingerprints, measurer, sparse_threshold);
+      output_sparse_dist_matrix(num_fingerprints, rows, measurer,
+                                sparse_threshold);
     }
     break;
   }
@@ -241,6 +286,9 @@ int main(int argc, const char **argv) {
   if (params.usage_requested) {
     return 0;
   }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
 
   shape_defs::ArrayBitVectors fingerprints;
   cli::measures::read_fingerprints(params.fingerprint_file, fingerprints);
@@ -257,7 +305,23 @@ int main(int argc, const char **argv) {
   }
 
   const unsigned int num_fingerprints = fingerprints.size();
-  output_results(num_fingerprints, params.out_format, measurer,
+  RowRange rows{.begin = 0, .end = num_fingerprints};
+  if (params.shard) {
+    rows = get_shard_rows(params.shard.value(), num_fingerprints);
+    write_shard_header(cout, params.shard.value(), rows, num_fingerprints);
+  }
+  output_results(num_fingerprints, rows, params.out_format, measurer,
                  params.compute_similarity, params.sparse_threshold);
+  if (params.shard) {
+    write_shard_trailer(cout);
+  }
+  if (params.stats_file) {
+    try {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    } catch (const exception &e) {
+      cerr << "Error: " << e.what() << endl;
+      return 1;
+    }
+  }
   return 0;
 }
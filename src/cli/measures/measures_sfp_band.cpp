@@ -1,459 +1,454 @@
-// Generate sparse (dis)similarity matrix bands from a set of shape
-// fingerprints.
+// Generate sparse (dis)similarity matrix bands from a packed database of
+// shape fingerprints, without loading the whole database into memory.
 // Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
 
+#include <algorithm>
 #include <cstdlib>
+#include <filesystem>
+#include <format>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <libgen.h>
+#include <optional>
+#include <set>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include "Globals.h"
-#include "build_info.h"
-#include "mesaac_measures/measurer_factory.h"
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/segmented_shape_fps.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
 
-#include "mesaac_common/b64.h"
-#include "mesaac_common/gzip.h"
-#include "mesaac_common/mesaac_common.h"
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/file_sync.hpp"
+#include "mesaac_common/stats.hpp"
 
-#include "fp_decoder.h"
+#include "measure_type_converter.hpp"
 
 using namespace std;
 
-string Version = "1.0";
-string CreationDate = "November, 2010";
+namespace {
+using namespace mesaac::arg_parser;
+using mesaac::measures::shape::SegmentedShapeFPs;
 
-static void show_blurb(char *exename) {
-  cerr << "Running " << basename(exename) << endl
-       << "Source code Copyright (c) 2009" << endl
-       << "Mesa Analytics & Computing, Inc." << endl
-       << "Revision: " << BUILD_REVISION << " Built: " << BUILD_DATE << endl
-       << "Expiration Date: " << mesaac::expirationDateStr();
-}
-
-void read_fpblocks_from_stream(const string &pathname, istream &ins,
-                               ShapeFPBlocks &fingerprints) {
-  ArrayBitVectors block;
-  const unsigned int FPsPerBlock = 4;
-  bool first = true;
-  unsigned int vector_size = 0;
-  string fpstr;
-  unsigned int line_num = 0;
-
-  fingerprints.clear();
-  while (ins >> fpstr) {
-    line_num++;
-    BitVector fp;
-    if (!decode_fp(fpstr, fp)) {
-      cerr << "Error at line " << line_num << " of " << pathname << ":" << endl
-           << "  Invalid fingerprint string '" << fpstr << "'." << endl;
-      exit(1);
-    } else {
-      if (first) {
-        vector_size = fp.size();
-        first = false;
-      } else if (fp.size() != vector_size) {
-        // TODO:  Use exceptions, or an error return
-        cerr << "Error at line " << line_num << " of " << pathname << ":"
-             << endl
-             << "  Expected fingerprint of size " << vector_size
-             << ", got fingerprint of size " << fp.size() << endl;
-        exit(1);
-      }
-      block.push_back(BitVector(fp));
-      if (block.size() == FPsPerBlock) {
-        fingerprints.push_back(block);
-        block.clear();
-      }
-    }
-  }
-  // Discard any leftover sub-block.
-  // cerr << "Number of fingerprints is " << fingerprints.size() << endl
-  //      << fingerprints.size() << " " << FPsPerBlock << " " << vector_size
-  //      << endl;
-
-  if (block.size() != 0) {
-    cerr << "A Shape Fingerprint file must contain blocks of " << FPsPerBlock
-         << " fingerprints.  " << endl
-         << pathname << " has only " << block.size()
-         << ((block.size() == 1) ? "fingerprint " : "fingerprints ")
-         << "in its last block." << endl
-         << "This may not be a shape fingerprint file." << endl;
-    exit(1);
-  }
-}
-
-void read_fingerprint_blocks(const string pathname,
-                             ShapeFPBlocks &fingerprints) {
-  // Input from either stdin or file
-  if (pathname == "-") {
-    read_fpblocks_from_stream("standard input", cin, fingerprints);
-  } else {
-    ifstream inf(pathname);
-    if (!inf) {
-      // TODO:  Use exceptions, or an error return
-      cerr << "Cannot open fingerprint file " << pathname << "." << endl;
-      exit(1);
-    }
-    read_fpblocks_from_stream(pathname, inf, fingerprints);
-    inf.close();
-  }
-}
-
-class ArgParser {
-public:
-  ArgParser(int argc, char **argv) : m_argc(argc), m_argv(argv) {}
-
-  virtual ~ArgParser() {}
-
-  void parse_args(string &sfp_pathname, string &measure_name, bool &compute_sim,
-                  float &tversky_alpha, float &sparse_threshold,
-                  unsigned int &start_row, unsigned int &end_row,
-                  string &format) {
-    measure_name = "T";
-    compute_sim = false;
-    tversky_alpha = 0.0;
-    sparse_threshold = 1.0;
-    start_row = 0;
-    end_row = 0;
-    format = "S";
-
-    bool alpha_specified = false;
-    bool thresh_specified = false;
-
-    int i = 1;
-    while (i < m_argc) {
-      const string opt(m_argv[i]);
-      if (opt == "-m" || opt == "--measure") {
-        i += 1;
-        parse_val("MEASURE", i, measure_name);
-        // Let get_shape_measurer validate the measure type.
-      } else if (opt == "-a" || opt == "--alpha") {
-        i += 1;
-        parse_val("ALPHA", i, tversky_alpha, 0.0, 2.0);
-        alpha_specified = true;
-      } else if (opt == "-d" || opt == "--dist") {
-        i += 1;
-        compute_sim = false;
-      } else if (opt == "-s" || opt == "--sim") {
-        i += 1;
-        compute_sim = true;
-      } else if (opt == "-r" || opt == "--records") {
-        i += 1;
-        parse_val("START", i, start_row, 0);
-        parse_val("END", i, end_row, start_row + 1);
-      } else if (opt == "-f" || opt == "--format") {
-        i += 1;
-        parse_val("FORMAT", i, format);
-        if (format != "S" && format != "M") {
-          m_msg << "Invalid FORMAT " << format;
-          show_usage_and_exit();
-        }
-      } else if (opt == "-t" || opt == "--threshold") {
-        i += 1;
-        parse_val("THRESHOLD", i, sparse_threshold, 0.0, 1.0);
-        thresh_specified = true;
-      } else if (opt == "-h" || opt == "--help") {
-        show_help_msg();
-      } else if (opt != "-" && opt.substr(1, 1) == "-") {
-        // '-' is a positional argument denoting standard input.
-        // '-' followed by any other character is an option.
-        m_msg << "Unsupported option " << opt;
-        show_usage_and_exit();
-      } else {
-        break;
-      }
-    }
+enum class OutputFormat {
+  matrix,
+  sparse_matrix,
+};
 
-    // Only required arguments remain.
-    parse_val("FILENAME", i, sfp_pathname);
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  string measure_code;
+  mesaac::measures::MeasureType measure_type;
+  float tversky_alpha;
+  bool compute_similarity;
+  OutputFormat out_format;
+  float sparse_threshold;
+  bool has_records;
+  unsigned int start_row;
+  unsigned int end_row;
+  unsigned int band_rows;
+  size_t memory_cap;
+  filesystem::path database_path;
+  filesystem::path output_dir;
+  optional<filesystem::path> stats_file;
+};
 
-    if (i < m_argc) {
-      m_msg << "Too many arguments";
-      show_usage_and_exit();
+struct CmdLineParser {
+  Choice::Ptr measure_choice = Choice::create(
+      "-m", "--measure", "the measure to use",
+      {
+          {"B", "BUB measure"},
+          {"C", "Cosine measure"},
+          {"E", "Euclidean measure"},
+          {"H", "Hamann measure"},
+          {"T", "Tanimoto measure - default"},
+          {"V",
+           "Tversky measure - can be used in conjunction with -a | --alpha"},
+      });
+
+  Option<float>::Ptr alpha_opt = Option<float>::create(
+      "-a", "--alpha",
+      "alpha value to use for measure V (Tversky) - default is 0.0");
+
+  Flag::Ptr dissim = Flag::create(
+      "-d", "--dissimilarity",
+      "compute dissimilarity values - default is to compute similarity");
+
+  Choice::Ptr format_choice =
+      Choice::create("-f", "--format", "how to format the output",
+                     {
+                         {"M", "full matrix"},
+                         {"S", "sparse matrix - default"},
+                     });
+
+  Option<float>::Ptr sparse_opt = Option<float>::create(
+      "-t", "--threshold",
+      ("(dis)similarity sparse threshold to use for output format S - "
+       "default is 0.0 for similarity, 1.0 for dissimilarity"));
+
+  MultiValuedOption<unsigned int, 2>::Ptr records_opt =
+      MultiValuedOption<unsigned int, 2>::create(
+          "-r", "--records",
+          "compute only rows START..(END - 1) - default is all rows");
+
+  Option<unsigned int>::Ptr band_rows_opt = Option<unsigned int>::create(
+      "-b", "--band-rows",
+      "number of matrix rows to write to each band file - default is 1000");
+
+  Option<unsigned int>::Ptr memory_cap_opt = Option<unsigned int>::create(
+      "-c", "--memory-cap",
+      ("megabytes of decoded fingerprints and formatted rows to hold in "
+       "memory at once - default is 1024"));
+
+  Argument<filesystem::path>::Ptr database_arg =
+      Argument<filesystem::path>::create(
+          "database",
+          "packed shape fingerprint database from shape_fp_pack, or "
+          "segmented\n"
+          "        database directory from shape_fp_append");
+
+  Argument<filesystem::path>::Ptr output_dir_arg =
+      Argument<filesystem::path>::create(
+          "output_dir",
+          "directory to which to write band files and the checkpoint file");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  ArgParser parser = ArgParser(
+      {measure_choice, alpha_opt, dissim, format_choice, sparse_opt,
+       records_opt, band_rows_opt, memory_cap_opt, stats_opt},
+      {database_arg, output_dir_arg},
+      "Write pairwise measures of a packed shape fingerprint database as a\n"
+      "series of row band files.  Each band is written atomically and "
+      "recorded\n"
+      "in a checkpoint file, so an interrupted job can be resumed by "
+      "re-running\n"
+      "it with the same arguments.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .measure_code = "T",
+                     .measure_type = mesaac::measures::MeasureType::tanimoto,
+                     .tversky_alpha = 0.0,
+                     .compute_similarity = true,
+                     .out_format = OutputFormat::sparse_matrix,
+                     .sparse_threshold = 0.0,
+                     .has_records = false,
+                     .start_row = 0,
+                     .end_row = 0,
+                     .band_rows = 1000,
+                     .memory_cap = 1024,
+                     .database_path = filesystem::path(""),
+                     .output_dir = filesystem::path(""),
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
     }
 
-    // Warnings...
-    m_msg.str("");
-    if (alpha_specified && (measure_name != "V")) {
-      m_msg << "A measure other than Tversky was used.  Ignoring ALPHA."
-            << endl;
+    result.measure_code = measure_choice->value_or("T");
+    result.measure_type =
+        mesaac::cli::measures::get_measure_type(result.measure_code.at(0));
+    result.tversky_alpha = alpha_opt->value_or(0.0);
+    result.compute_similarity = !dissim->value();
+    result.out_format = (format_choice->value_or("S") == "M")
+                            ? OutputFormat::matrix
+                            : OutputFormat::sparse_matrix;
+    result.sparse_threshold =
+        sparse_opt->value_or(result.compute_similarity ? 0.0 : 1.0);
+
+    result.has_records = records_opt->has_values();
+    if (result.has_records) {
+      const auto records = records_opt->values();
+      result.start_row = records[0];
+      result.end_row = records[1];
     }
 
-    // Set default threshold.
-    if (format == "S" && !thresh_specified) {
-      // Equivalent to full matrix.
-      string similarity("similarity");
-      if (compute_sim) {
-        sparse_threshold = 0.0;
-      } else {
-        similarity = "distance";
-        sparse_threshold = 1.0;
-      }
-
-      m_msg << "No sparse THRESHOLD was given.  The default " << similarity
-            << " threshold, " << sparse_threshold << ", will be used." << endl;
-    } else if (format == "M" && thresh_specified) {
-      m_msg << "Full matrix FORMAT ('-f M') was specified.  "
-            << "Sparse threshold will be ignored." << endl;
+    result.band_rows = band_rows_opt->value_or(1000);
+    if (result.band_rows == 0) {
+      parser.show_usage("BAND-ROWS must be greater than 0");
+      result.parse_status = 1;
+      return result;
     }
-    if (m_msg.str().size()) {
-      show_usage();
+    result.memory_cap = size_t(memory_cap_opt->value_or(1024)) * 1024 * 1024;
+    result.database_path = database_arg->value();
+    result.output_dir = output_dir_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
     }
+    return result;
   }
 
-  void warn(const string msg) {
-    m_msg.str(msg);
-    show_usage();
-  }
-
-  void error(const string msg) {
-    m_msg.str(msg);
-    show_usage_and_exit();
-  }
-
-protected:
-  int m_argc;
-  char **m_argv;
-  ostringstream m_msg; // Error message stream.
-
-  void show_usage() {
-    const string msg(m_msg.str());
-    if (msg.size()) {
-      cerr << msg << endl;
-    }
-    m_msg.str(""); // In case there are more warnings.
+  void show_usage(const string &err_msg) { parser.show_usage(err_msg); }
+};
 
-    string exename = basename(m_argv[0]);
-    cerr << "use \"" << exename << " --help\" for more information." << endl
-         << endl;
-  }
+// Describes a job, so that a resumed job can be checked against the job
+// that wrote the checkpoint.
+string get_job_signature(const CmdParams &params, const SegmentedShapeFPs &db) {
+  // A segmented database changes only by rewriting its manifest.
+  const filesystem::path content_path(
+      filesystem::is_directory(params.database_path)
+          ? mesaac::measures::shape::segment_manifest_path(params.database_path)
+          : params.database_path);
+  const auto mtime =
+      filesystem::last_write_time(content_path).time_since_epoch();
+  return format("database={} bytes={} mtime={} shapes={} bits={} measure={} "
+                "alpha={} similarity={} format={} threshold={} rows={}..{} "
+                "band_rows={}",
+                filesystem::absolute(params.database_path).string(),
+                filesystem::file_size(content_path), mtime.count(),
+                db.size(), db.num_bits(), params.measure_code,
+                params.tversky_alpha, params.compute_similarity,
+                (params.out_format == OutputFormat::matrix) ? "M" : "S",
+                params.sparse_threshold, params.start_row, params.end_row,
+                params.band_rows);
+}
 
-  void show_usage_and_exit() {
-    show_usage();
-    exit(1);
-  }
+using Band = pair<unsigned int, unsigned int>;
 
-  void show_help_msg() {
-    string exename = basename(m_argv[0]);
-    cerr
-        << "Usage: " << exename
-        << " [-m | --measure MEASURE] [-a | --alpha ALPHA]\n\
-    [-d | --dist | -s | --sim] [-r | --records START END] [-f | --format FORMAT]\n\
-    [-t | --threshold THRESHOLD] FILENAME\n\
-Print pairwise similarities or distances between shape fingerprints.\n\
-\n\
--m | --measure MEASURE\n\
-    The MEASURE with which to compute the matrix.  Valid values are 'T'\n\
-    (Tanimoto, the default), 'V' (Tversky), 'E' (Euclidean), 'H' (Hamann),\n\
-    'C' (Cosine) and 'B' (BUB).\n\
--a | --alpha ALPHA\n\
-    When the Tversky measure ('-m V') is used, a Tversky ALPHA value in the\n\
-    range 0..2, inclusive, may be specified.  If ALPHA is not specified, a\n\
-    default value of 0 is used.\n\
-    NOTES:  The Tversky beta value is automatically set to 2 - ALPHA.\n\
-            Setting ALPHA = beta = 1 is equivalent to using the Tanimoto\n\
-            measure ('-m T').\n\
--d | --dist | -s | --sim\n\
-    Specify whether to compute distances (the default) or similarities.\n\
--r | --records START END\n\
-    Output rows START..(END - 1), inclusive, of the matrix.  By default all\n\
-    rows, 0..(# fingerprints - 1), are output.\n\
--f | --format FORMAT\n\
-    Write results in sparse matrix format ('S', the default) or full matrix\n\
-    format ('M')\n\
--t | --threshold THRESHOLD\n\
-    When writing results in sparse matrix format ('-f S') a sparse threshold\n\
-    may be specified.  Valid values are in the range 0..1, inclusive.\n\
-    For similarity matrices only values greater than or equal to THRESHOLD\n\
-    are output.  For distance matrices only values less than or equal to\n\
-    THRESHOLD are output.\n\
-    If no THRESHOLD is specified for sparse matrix output, a default value\n\
-    of 0 (for similarity matrices) or 1 (for distance matrices) will be used.\n\
--h | --help\n\
-    Show this help message and exit.\n\
-\n\
-FILENAME\n\
-    Path to the shape fingerprint file.  To read from stdin use '-'.\n\
-\n\
-Examples:"
-        << endl
-        << "    $ " << exename << " -t 0.4 shape_fingerprints.txt" << endl
-        << "Write out a complete Tanimoto sparse distance matrix.  Use shape fingerprints\n\
-from shape_fingerprints.txt.  The matrix will include all pairwise distances\n\
-less than or equal to 0.4."
-        << endl
-        << endl;
-
-    const string msg(m_msg.str());
-    if (msg.size()) {
-      cerr << endl << msg << endl;
+class Checkpoint {
+public:
+  Checkpoint(const filesystem::path &output_dir, const string &signature)
+      : m_output_dir(output_dir), m_path(output_dir / "checkpoint.txt") {
+    ifstream inf(m_path);
+    if (inf) {
+      string recorded_signature;
+      getline(inf, recorded_signature);
+      if (recorded_signature != signature) {
+        throw runtime_error(
+            format("{} records a different job.  Use a new output directory, "
+                   "or remove the checkpoint to start over.",
+                   m_path.string()));
+      }
+      unsigned int start, end;
+      while (inf >> start >> end) {
+        m_completed.insert({start, end});
+      }
+      inf.close();
     }
-    exit(0);
-  }
 
-  void parse_val(string option_name, int &i, string &sval) {
-    if (i >= m_argc) {
-      m_msg << "No value specified for " << option_name;
-      show_usage_and_exit();
-    } else {
-      sval = m_argv[i];
+    m_outf.open(m_path, ios::app);
+    if (!m_outf) {
+      throw runtime_error(
+          format("Cannot open {} for writing.", m_path.string()));
     }
-    i++;
-  }
-
-  void parse_val(string option_name, int &i, unsigned int &ival) {
-    string sval;
-    parse_val(option_name, i, sval);
-    istringstream ins(sval);
-    if (!(ins >> ival)) {
-      m_msg << "Value provided for " << option_name << " ('" << sval
-            << "') is not a valid integer.";
-      show_usage_and_exit();
+    if (filesystem::file_size(m_path) == 0) {
+      m_outf << signature << endl;
     }
   }
 
-  void parse_val(string option_name, int &i, float &fval) {
-    string sval;
-    parse_val(option_name, i, sval);
-    istringstream ins(sval);
-    if (!(ins >> fval)) {
-      m_msg << "Value provided for " << option_name << " ('" << sval
-            << "') is not a valid number.";
-      show_usage_and_exit();
-    }
+  filesystem::path band_path(const Band &band) const {
+    return m_output_dir /
+           format("band_{:010}_{:010}.txt", band.first, band.second);
   }
 
-  void parse_val(string option_name, int &i, unsigned int &ival,
-                 unsigned int min_val) {
-    parse_val(option_name, i, ival);
-    if (ival < min_val) {
-      m_msg << option_name << " (" << ival << ") must be >= " << min_val;
-      show_usage_and_exit();
-    }
+  bool is_complete(const Band &band) const {
+    return m_completed.contains(band) && filesystem::exists(band_path(band));
   }
 
-  void parse_val(string option_name, int &i, unsigned int &ival,
-                 unsigned int min_val, unsigned int max_val) {
-    parse_val(option_name, i, ival, min_val);
-    if (ival > max_val) {
-      m_msg << option_name << " (" << ival << ") must be <= " << max_val;
-      show_usage_and_exit();
+  void record(const Band &band) {
+    m_outf << band.first << " " << band.second << endl;
+    if (!m_outf) {
+      throw runtime_error(format("Cannot update {}", m_path.string()));
     }
+    m_completed.insert(band);
   }
 
-  void parse_val(string option_name, int &i, float &fval, float min_val,
-                 float max_val) {
-    parse_val(option_name, i, fval);
-    if (min_val > fval || fval > max_val) {
-      m_msg << option_name << " (" << fval << ") must be in the range "
-            << min_val << ".." << max_val << ", inclusive.";
-      show_usage_and_exit();
-    }
-  }
+private:
+  const filesystem::path m_output_dir;
+  const filesystem::path m_path;
+  set<Band> m_completed;
+  ofstream m_outf;
 };
 
-static void write_sparse_matrix(IMeasurer *measurer,
-                                unsigned int number_shapefingerprints,
-                                unsigned int start_row, unsigned int end_row,
-                                bool compute_sim, float sparse_threshold) {
-  if (compute_sim) {
-    for (unsigned int i = start_row; i < end_row; ++i) {
-      for (unsigned int j = 0; j < number_shapefingerprints; ++j) {
-        if (i != j) {
-          float v = measurer->value(i, j);
-          if (sparse_threshold <= v) {
-            cout << j << " " << v << " ";
-          }
+function<bool(float)> get_thresh_filter(bool compute_similarity,
+                                        const float threshold) {
+  const function<bool(float)> above_thresh = [threshold](const float value) {
+    return value >= threshold;
+  };
+  const function<bool(float)> below_thresh = [threshold](const float value) {
+    return value <= threshold;
+  };
+  return compute_similarity ? above_thresh : below_thresh;
+}
+
+// Formatted output takes at most this many bytes per value, e.g.
+// "4294967295 -1.23457e-05 " in sparse matrix format.
+constexpr size_t MaxValueBytes = 24;
+
+// Compute some of a band's rows, streaming the database through memory in
+// column tiles.
+void compute_rows(const CmdParams &params, const SegmentedShapeFPs &db,
+                  mesaac::measures::MeasuresBase::Ptr measure,
+                  const Band &row_range, size_t row_bytes,
+                  vector<ostringstream> &rows) {
+  const unsigned int num_rows = row_range.second - row_range.first;
+  const unsigned int num_shapes = db.size();
+  const size_t rows_bytes = size_t(num_rows) * row_bytes;
+  const size_t tile_cols = max<size_t>(
+      1, (params.memory_cap > rows_bytes)
+             ? (params.memory_cap - rows_bytes) / db.shape_bytes()
+             : 1);
+
+  const auto should_output =
+      get_thresh_filter(params.compute_similarity, params.sparse_threshold);
+  const float self_value = params.compute_similarity ? 1.0 : 0.0;
+  const bool is_matrix = params.out_format == OutputFormat::matrix;
+
+  // The tile holds the rows' fingerprints, decoded once, followed by the
+  // current column tile.
+  mesaac::shape::ShapeFingerprintVector tile;
+  db.append_range(row_range.first, row_range.second, tile);
+  for (unsigned int col_start = 0; col_start < num_shapes;
+       col_start += tile_cols) {
+    const unsigned int col_end =
+        min<size_t>(num_shapes, size_t(col_start) + tile_cols);
+    tile.resize(num_rows);
+    db.append_range(col_start, col_end, tile);
+    const auto measurer = mesaac::measures::shape::get_shape_measurer(
+        measure, params.compute_similarity, tile);
+
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int r = 0; r < int(num_rows); r++) {
+      const unsigned int i = row_range.first + r;
+      ostringstream &outs(rows[r]);
+      thread_local vector<float> values;
+      values.resize(col_end - col_start);
+      measurer->value_row(r, num_rows, num_rows + (col_end - col_start),
+                          values.data());
+      for (unsigned int j = col_start; j < col_end; ++j) {
+        const float value = (i == j) ? self_value : values[j - col_start];
+        if (is_matrix) {
+          outs << ((j == 0) ? "" : " ") << value;
+        } else if ((i != j) && should_output(value)) {
+          outs << j << " " << value << " ";
         }
       }
-      cout << -1 << endl;
     }
-  } else {
-    for (unsigned int i = start_row; i < end_row; ++i) {
-      for (unsigned int j = 0; j < number_shapefingerprints; ++j) {
-        if (i != j) {
-          float v = measurer->value(i, j);
-          if (sparse_threshold >= v) {
-            cout << j << " " << v << " ";
-          }
-        }
+  }
+}
+
+// Compute the rows of one band, writing them to outf.  Rows are computed
+// in passes, so that the memory cap covers both the decoded fingerprints
+// and the formatted rows waiting to be written.
+void compute_band(const CmdParams &params, const SegmentedShapeFPs &db,
+                  mesaac::measures::MeasuresBase::Ptr measure,
+                  const Band &band, ostream &outf) {
+  // Each row of a pass needs its fingerprint and its formatted output.  Up
+  // to half the cap goes to rows; the rest is for column tiles.
+  const size_t row_bytes = db.shape_bytes() + size_t(db.size()) * MaxValueBytes;
+  const unsigned int pass_rows = clamp<size_t>(
+      params.memory_cap / 2 / row_bytes, 1, band.second - band.first);
+  for (unsigned int start = band.first; start < band.second;
+       start += pass_rows) {
+    const Band row_range{start, min(band.second, start + pass_rows)};
+    vector<ostringstream> rows(row_range.second - row_range.first);
+    compute_rows(params, db, measure, row_range, row_bytes, rows);
+    for (auto &row : rows) {
+      outf << row.str();
+      if (params.out_format == OutputFormat::sparse_matrix) {
+        outf << -1;
       }
-      cout << -1 << endl;
+      outf << "\n";
     }
   }
 }
 
-static void write_full_matrix(IMeasurer *measurer,
-                              unsigned int number_shapefingerprints,
-                              unsigned int start_row, unsigned int end_row) {
-  for (unsigned int i = start_row; i < end_row; ++i) {
-    string sep("");
-    for (unsigned int j = 0; j < number_shapefingerprints; ++j) {
-      cout << sep << measurer->value(i, j);
-      sep = " ";
+// Write a band to a temporary file, then rename it into place so that a
+// band file is either complete or absent, even after a crash.
+void write_band(const CmdParams &params, const SegmentedShapeFPs &db,
+                mesaac::measures::MeasuresBase::Ptr measure, const Band &band,
+                const filesystem::path &path) {
+  filesystem::path tmp_path(path);
+  tmp_path += ".tmp";
+  {
+    ofstream outf(tmp_path);
+    compute_band(params, db, measure, band, outf);
+    outf.close();
+    if (!outf) {
+      throw runtime_error(format("Cannot write {}", tmp_path.string()));
     }
-    cout << endl;
   }
+  mesaac::common::rename_durably(tmp_path, path);
 }
 
-int main(int argc, char **argv) {
-  mesaac::MesaacFeatures f;
-  f.set(mesaac::MFE_GroupingModule);
-  mesaac::initCommon(f); // Validate license.
-
-  string fp_pathname = "-";
-  string dist_type = "T";
-  bool compute_sim = false;
-  float tversky_alpha = 0.0;
-  float sparse_threshold = 1.0;
-  unsigned int start_row, end_row;
-  string format = "S";
-
-  ArgParser arg_parser(argc, argv);
-  arg_parser.parse_args(fp_pathname, dist_type, compute_sim, tversky_alpha,
-                        sparse_threshold, start_row, end_row, format);
-  show_blurb(argv[0]);
-
-  // start_row and end_row should both be zero now; or they should
-  // be values explicitly specified by the user.
-
-  ShapeFPBlocks fingerprints;
-  read_fingerprint_blocks(fp_pathname, fingerprints);
-
-  IMeasurer *measurer =
-      get_shape_measurer(compute_sim, dist_type, fingerprints, tversky_alpha);
-  if (0 == measurer) {
-    ostringstream msg;
-    msg << "Could not create measurer " << dist_type;
-    arg_parser.error(msg.str());
+int compute_bands(const CmdParams &params) {
+  const SegmentedShapeFPs db(params.database_path);
+
+  const unsigned int num_shapes = db.size();
+  const unsigned int start_row = params.has_records ? params.start_row : 0;
+  const unsigned int end_row = params.has_records ? params.end_row : num_shapes;
+  if (start_row > end_row || end_row > num_shapes) {
+    cerr << "Cannot generate rows " << start_row << ".." << end_row
+         << " - 1.  " << params.database_path << " contains only "
+         << num_shapes << " shape fingerprints." << endl;
+    return 1;
   }
 
-  // No end row specified?  Output everything.
-  unsigned int number_shapefingerprints = fingerprints.size();
-  if (end_row == 0) {
-    end_row = number_shapefingerprints;
-  }
-  if (start_row > end_row || end_row > number_shapefingerprints) {
-    ostringstream msg;
-    msg << "Cannot generate sparse rows " << start_row << ".." << end_row
-        << " - 1.  Fingerprint file contains only " << number_shapefingerprints
-        << " shape fingerprints.";
-    arg_parser.error(msg.str());
+  filesystem::create_directories(params.output_dir);
+  CmdParams job(params);
+  job.start_row = start_row;
+  job.end_row = end_row;
+  Checkpoint checkpoint(params.output_dir, get_job_signature(job, db));
+
+  auto measure =
+      mesaac::measures::get_measures(params.measure_type, params.tversky_alpha);
+
+  unsigned int num_skipped = 0;
+  unsigned int num_written = 0;
+  for (unsigned int b = start_row; b < end_row; b += params.band_rows) {
+    const Band band{b, min(end_row, b + params.band_rows)};
+    if (checkpoint.is_complete(band)) {
+      num_skipped++;
+      continue;
+    }
+    // Record a band only once its file is safely on disk, so that a resumed
+    // job never skips a band lost in a crash.
+    write_band(params, db, measure, band, checkpoint.band_path(band));
+    checkpoint.record(band);
+    num_written++;
   }
+  cerr << "Wrote " << num_written << " bands; " << num_skipped
+       << " bands were already complete." << endl;
+  return 0;
+}
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
 
-  if ("S" == format) {
-    write_sparse_matrix(measurer, number_shapefingerprints, start_row, end_row,
-                        compute_sim, sparse_threshold);
-  } else if ("M" == format) {
-    write_full_matrix(measurer, number_shapefingerprints, start_row, end_row);
-  } else {
-    ostringstream msg;
-    msg << "Invalid FORMAT " << format << ".  Please specify 'M' or 'S'.";
-    arg_parser.error(msg.str());
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
   }
 
-  return 0;
+  try {
+    const int status = compute_bands(params);
+    if ((status == 0) && params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    }
+    return status;
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
 }
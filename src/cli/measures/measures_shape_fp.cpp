@@ -1,28 +1,38 @@
+#include <algorithm>
 #include <cstdlib>
+#include <format>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <libgen.h>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "mesaac_measures/compressed_shape_fps.hpp"
 #include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/prefix_screen.hpp"
+#include "mesaac_measures/shape_fp_index.hpp"
 #include "mesaac_measures/shape_measures_factory.hpp"
 
 #include "mesaac_common/b64.hpp"
 #include "mesaac_common/gzip.hpp"
 
 #include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
 
-#include "fp_decoder.hpp"
+#include "fingerprint_reader.hpp"
 #include "measure_type_converter.hpp"
+#include "shard.hpp"
 
 using namespace std;
 
 namespace {
 using namespace mesaac::arg_parser;
+using mesaac::cli::measures::RowRange;
+using mesaac::cli::measures::Shard;
 
 enum class OutputFormat {
   matrix,
@@ -40,7 +50,12 @@ struct CmdParams {
   unsigned int search_index;
   OutputFormat out_format;
   float sparse_threshold;
+  optional<Shard> shard;
+  optional<unsigned int> screen_bits;
+  float screen_margin;
+  optional<filesystem::path> index_path;
   filesystem::path fingerprints_path;
+  optional<filesystem::path> stats_file;
 };
 
 struct CmdLineParser {
@@ -84,13 +99,58 @@ struct CmdLineParser {
                             "(dis)similarity sparse threshold to use for "
                             "output formats S and P - default is 1.0");
 
+  Option<string>::Ptr shard_opt = Option<string>::create(
+      "-p", "--shard",
+      ("compute only part I of N of the output rows, for combining with "
+       "measures_merge -\n"
+       "        given as I/N, e.g. 2/4"));
+
+  Option<unsigned int>::Ptr screen_bits_opt = Option<unsigned int>::create(
+      "-b", "--screen-bits",
+      ("for output formats S and P, measure only the first SCREEN_BITS bits "
+       "of each fingerprint\n"
+       "        first, and skip the rest for pairs well outside the "
+       "threshold - intended for\n"
+       "        fingerprints built from halton: point clouds, whose prefixes "
+       "are lower-resolution\n"
+       "        fingerprints - default is to measure every bit"));
+
+  Option<float>::Ptr screen_margin_opt = Option<float>::create(
+      "-e", "--screen-margin",
+      ("how far beyond the threshold a prefix measure must lie for a pair to "
+       "be skipped when\n"
+       "        using --screen-bits - larger values skip fewer pairs which "
+       "would pass the threshold\n"
+       "        - default is 0.1"));
+
+  Option<filesystem::path>::Ptr index_opt = Option<filesystem::path>::create(
+      "-x", "--index",
+      ("compare each fingerprint in shape_fingerprints with each shape in "
+       "INDEX, an index\n"
+       "        from shape_fp_index, examining only the shapes which can or "
+       "likely will pass\n"
+       "        the threshold - for output formats S and P; INDEX shapes are "
+       "numbered by\n"
+       "        their database index"));
+
   Argument<filesystem::path>::Ptr fingerprints_arg =
       Argument<filesystem::path>::create(
-          "shape_fingerprints", "plaintext file of shape fingerprints");
+          "shape_fingerprints",
+          "plaintext file of shape fingerprints, a packed or segmented "
+          "database, or\n"
+          "        a compressed database from shape_fp_pack --compressed, "
+          "which is\n"
+          "        measured without decoding it");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
 
   ArgParser parser = ArgParser(
       {measure_choice, alpha_opt, dissim, search_opt, format_choice,
-       sparse_opt},
+       sparse_opt, shard_opt, screen_bits_opt, screen_margin_opt, index_opt,
+       stats_opt},
       {fingerprints_arg}, "Print pairwise measures of a set of fingerprints.");
 
   CmdParams parse_args(int argc, const char *argv[]) {
@@ -102,7 +162,12 @@ struct CmdLineParser {
                      .search_index = 0, // In effect, no search
                      .out_format = OutputFormat::sparse_matrix,
                      .sparse_threshold = 1.0,
-                     .fingerprints_path = filesystem::path("")};
+                     .shard = nullopt,
+                     .screen_bits = nullopt,
+                     .screen_margin = 0.1,
+                     .index_path = nullopt,
+                     .fingerprints_path = filesystem::path(""),
+                     .stats_file = nullopt};
 
     result.parse_status = parser.parse_args(argc, argv);
     result.usage_requested = parser.usage_requested();
@@ -132,7 +197,46 @@ struct CmdLineParser {
     }
 
     result.sparse_threshold = sparse_opt->value_or(1.0);
+    if (shard_opt->has_value()) {
+      try {
+        result.shard = mesaac::cli::measures::parse_shard(shard_opt->value());
+      } catch (invalid_argument &e) {
+        parser.show_usage(e);
+        result.parse_status = 1;
+        return result;
+      }
+    }
+    if (screen_bits_opt->has_value()) {
+      result.screen_bits = screen_bits_opt->value();
+      if (result.screen_bits.value() == 0) {
+        parser.show_usage("--screen-bits must be greater than 0");
+        result.parse_status = 1;
+        return result;
+      }
+    }
+    result.screen_margin = screen_margin_opt->value_or(0.1);
+    if (result.screen_margin < 0.0) {
+      parser.show_usage("--screen-margin must not be negative");
+      result.parse_status = 1;
+      return result;
+    }
+    if (index_opt->has_value()) {
+      if (result.out_format == OutputFormat::matrix) {
+        parser.show_usage("--index requires output format S or P");
+        result.parse_status = 1;
+        return result;
+      }
+      if (result.search_index > 0) {
+        parser.show_usage("--index cannot be combined with --search");
+        result.parse_status = 1;
+        return result;
+      }
+      result.index_path = index_opt->value();
+    }
     result.fingerprints_path = fingerprints_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
     return result;
   }
 
@@ -141,73 +245,22 @@ struct CmdLineParser {
 } // namespace
 
 namespace {
-void read_fpblocks_from_stream(
-    const string &pathname, istream &ins,
-    mesaac::shape_defs::ShapeFPBlocks &fingerprints) {
-  mesaac::shape_defs::ArrayBitVectors block;
-  const unsigned int FPsPerBlock = 4;
-  bool first = true;
-  unsigned int vector_size = 0;
-  string fpstr;
-  unsigned int line_num = 0;
-
-  fingerprints.clear();
-  while (ins >> fpstr) {
-    line_num++;
-    mesaac::shape_defs::BitVector fp;
-    if (!decode_fp(fpstr, fp)) {
-      cerr << "Error at line " << line_num << " of " << pathname << ":" << endl
-           << "  Invalid fingerprint string '" << fpstr << "'." << endl;
-      exit(1);
-    } else {
-      if (first) {
-        vector_size = fp.size();
-        first = false;
-      } else if (fp.size() != vector_size) {
-        // TODO:  Use exceptions, or an error return
-        cerr << "Error at line " << line_num << " of " << pathname << ":"
-             << endl
-             << "  Expected fingerprint of size " << vector_size
-             << ", got fingerprint of size " << fp.size() << endl;
-        exit(1);
-      }
-      block.push_back(mesaac::shape_defs::BitVector(fp));
-      if (block.size() == FPsPerBlock) {
-        fingerprints.push_back(block);
-        block.clear();
-      }
-    }
-  }
-  // Discard any leftover sub-block.
-  cerr << "Number of fingerprints is " << fingerprints.size() << endl
-       << fingerprints.size() << " " << FPsPerBlock << " " << vector_size
-       << endl;
-
-  if (block.size() != 0) {
-    cerr << "A Shape Fingerprint file must contain blocks of " << FPsPerBlock
-         << " fingerprints.  " << endl
-         << pathname << " has only " << block.size()
-         << ((block.size() == 1) ? "fingerprint " : "fingerprints ")
-         << "in its last block." << endl
-         << "This may not be a shape fingerprint file." << endl;
-    exit(1);
+// Get the rows, out of num_rows, to compute and output.  When sharding,
+// also write the shard output header.
+RowRange begin_rows(const CmdParams &params, unsigned int num_rows) {
+  if (!params.shard) {
+    return RowRange{.begin = 0, .end = num_rows};
   }
+  const RowRange result(
+      mesaac::cli::measures::get_shard_rows(params.shard.value(), num_rows));
+  mesaac::cli::measures::write_shard_header(cout, params.shard.value(),
+                                            result, num_rows);
+  return result;
 }
 
-void read_fingerprint_blocks(const string pathname,
-                             mesaac::shape_defs::ShapeFPBlocks &fingerprints) {
-  // Input from either stdin or file
-  if (pathname == "-") {
-    read_fpblocks_from_stream("standard input", cin, fingerprints);
-  } else {
-    ifstream inf(pathname);
-    if (!inf) {
-      // TODO:  Use exceptions, or an error return
-      cerr << "Cannot open fingerprint file " << pathname << "." << endl;
-      exit(1);
-    }
-    read_fpblocks_from_stream(pathname, inf, fingerprints);
-    inf.close();
+void end_rows(const CmdParams &params) {
+  if (params.shard) {
+    mesaac::cli::measures::write_shard_trailer(cout);
   }
 }
 
@@ -215,19 +268,26 @@ void read_fingerprint_blocks(const string pathname,
 void compute_and_output_matrix(
     const CmdParams &params,
     mesaac::measures::shape::IIndexedShapeFPMeasure::Ptr const measurer,
-    const mesaac::shape_defs::ShapeFPBlocks &fps) {
+    unsigned int num_fps) {
 
   if (params.search_index > 0) {
     cerr << "Warning: --search is ignored for --format M." << endl;
   }
-  for (unsigned int i = 0; i < fps.size(); ++i) {
+  if (params.screen_bits) {
+    cerr << "Warning: --screen-bits is ignored for --format M." << endl;
+  }
+  const RowRange rows(begin_rows(params, num_fps));
+  vector<float> row(num_fps);
+  for (unsigned int i = rows.begin; i < rows.end; ++i) {
+    measurer->value_row(i, 0, num_fps, row.data());
     string sep("");
-    for (unsigned int j = 0; j < fps.size(); ++j) {
-      cout << sep << measurer->value(i, j);
+    for (unsigned int j = 0; j < num_fps; ++j) {
+      cout << sep << row[j];
       sep = " ";
     }
     cout << endl;
   }
+  end_rows(params);
 }
 
 function<bool(float)> get_thresh_filter(bool compute_similarity,
@@ -252,13 +312,12 @@ void fail_bad_search_index(unsigned int search_index, unsigned int num_fps) {
 void compute_and_output_sparse_matrix(
     const CmdParams &params,
     mesaac::measures::shape::IIndexedShapeFPMeasure::Ptr const measurer,
-    const mesaac::shape_defs::ShapeFPBlocks &fps) {
+    size_t num_fps) {
 
   const auto should_output =
       get_thresh_filter(params.compute_similarity, params.sparse_threshold);
 
   const bool is_searching = params.search_index > 0;
-  const size_t num_fps = fps.size();
   if (is_searching && params.search_index >= (num_fps - 1)) {
     fail_bad_search_index(params.search_index, num_fps);
   }
@@ -266,13 +325,16 @@ void compute_and_output_sparse_matrix(
   const size_t i_end = is_searching ? params.search_index : num_fps;
   const size_t j_start = is_searching ? params.search_index : 0;
 
-  for (size_t i = 0; i < i_end; ++i) {
+  const RowRange rows(begin_rows(params, i_end));
+  vector<float> row(num_fps - j_start);
+  for (size_t i = rows.begin; i < rows.end; ++i) {
     if (is_searching) {
       cout << i << " ";
     }
+    measurer->value_row(i, j_start, num_fps, row.data());
     for (size_t j = j_start; j < num_fps; ++j) {
       if (i != j) {
-        const float value = measurer->value(i, j);
+        const float value = row[j - j_start];
         if (should_output(value)) {
           cout << j << " " << value << " ";
         }
@@ -280,47 +342,105 @@ void compute_and_output_sparse_matrix(
     }
     cout << -1 << endl;
   }
+  end_rows(params);
 }
 
 void compute_and_output_pvm(
     const CmdParams &params,
     mesaac::measures::shape::IIndexedShapeFPMeasure::Ptr const measurer,
-    const mesaac::shape_defs::ShapeFPBlocks &fps) {
+    size_t num_fps) {
 
   const auto should_output =
       get_thresh_filter(params.compute_similarity, params.sparse_threshold);
-  const size_t num_fps = fps.size();
   const size_t search_index = params.search_index;
   if (search_index >= (num_fps - 1)) {
     fail_bad_search_index(search_index, num_fps);
   }
 
-  for (size_t i = 0; i < search_index; ++i) {
+  const RowRange rows(begin_rows(params, search_index));
+  vector<float> row(num_fps - search_index);
+  for (size_t i = rows.begin; i < rows.end; ++i) {
+    measurer->value_row(i, search_index, num_fps, row.data());
     for (size_t j = search_index; j < num_fps; ++j) {
-      const float value = measurer->value(i, j);
+      const float value = row[j - search_index];
       if (should_output(value)) {
         cout << (j - search_index) << " " << value << " ";
       }
     }
     cout << -1 << endl;
   }
+  end_rows(params);
+}
+
+// Search a shape fingerprint index with each fingerprint.  Blocks of
+// queries are searched in parallel, and their hits are printed in order.
+int search_index(const CmdParams &params,
+                 const mesaac::shape_defs::ShapeFPBlocks &fps) {
+  if (params.screen_bits) {
+    cerr << "Warning: --screen-bits is ignored with --index." << endl;
+  }
+  try {
+    const auto index =
+        mesaac::measures::shape::open_shape_fp_index(params.index_path.value());
+    // Searches throw for mismatched queries; check them all up front, so
+    // that nothing is thrown from a parallel region.
+    for (const auto &fp : fps) {
+      if (fp.empty() || (fp[0].size() != index->num_bits())) {
+        throw invalid_argument(
+            format("Fingerprints have {} bits, but the index has {}.",
+                   fp.empty() ? 0 : fp[0].size(), index->num_bits()));
+      }
+    }
+
+    const bool is_sparse = params.out_format == OutputFormat::sparse_matrix;
+    const unsigned int block_size = 256;
+    vector<vector<mesaac::measures::shape::IndexHit>> block_hits;
+    const RowRange rows(begin_rows(params, fps.size()));
+    for (unsigned int block = rows.begin; block < rows.end;
+         block += block_size) {
+      const unsigned int block_end = min(rows.end, block + block_size);
+      block_hits.assign(block_end - block, {});
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (int r = 0; r < int(block_hits.size()); r++) {
+        block_hits[r] = index->search(
+            fps[block + r], params.measure_type, params.tversky_alpha,
+            params.compute_similarity, params.sparse_threshold);
+      }
+      for (unsigned int i = block; i < block_end; ++i) {
+        if (is_sparse) {
+          cout << i << " ";
+        }
+        for (const auto &hit : block_hits[i - block]) {
+          cout << hit.index << " " << hit.value << " ";
+        }
+        cout << -1 << endl;
+      }
+    }
+    end_rows(params);
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
 }
 
 int compute_and_output_results(
     const CmdLineParser &parser, const CmdParams &params,
     mesaac::measures::shape::IIndexedShapeFPMeasure::Ptr const measurer,
-    const mesaac::shape_defs::ShapeFPBlocks &fps) {
+    unsigned int num_fps) {
   switch (params.out_format) {
   case OutputFormat::matrix:
-    compute_and_output_matrix(params, measurer, fps);
+    compute_and_output_matrix(params, measurer, num_fps);
     return 0;
 
   case OutputFormat::sparse_matrix:
-    compute_and_output_sparse_matrix(params, measurer, fps);
+    compute_and_output_sparse_matrix(params, measurer, num_fps);
     return 0;
 
   case OutputFormat::pvm:
-    compute_and_output_pvm(params, measurer, fps);
+    compute_and_output_pvm(params, measurer, num_fps);
     return 0;
   }
 
@@ -328,6 +448,58 @@ int compute_and_output_results(
        << "'" << endl;
   return 2;
 }
+
+// Measure pairs of fingerprints, in the output format.
+int measure_pairs(const CmdLineParser &parser, const CmdParams &params,
+                  const mesaac::shape_defs::ShapeFPBlocks &fingerprints) {
+  auto measure =
+      mesaac::measures::get_measures(params.measure_type, params.tversky_alpha);
+  mesaac::measures::shape::IIndexedShapeFPMeasure::Ptr measurer;
+  if (params.screen_bits && (params.out_format != OutputFormat::matrix)) {
+    measurer = mesaac::measures::shape::get_prefix_screened_measurer(
+        measure, params.compute_similarity, fingerprints,
+        {.num_bits = params.screen_bits.value(),
+         .threshold = params.sparse_threshold,
+         .margin = params.screen_margin});
+  } else {
+    measurer = mesaac::measures::shape::get_shape_measurer(
+        measure, params.compute_similarity, fingerprints);
+  }
+  if (0 == measurer) {
+    cerr << "Internal error - could not create shape measurer." << endl;
+    return 2;
+  }
+  return compute_and_output_results(parser, params, measurer,
+                                    fingerprints.size());
+}
+
+// Measure pairs of compressed fingerprints, in the output format.
+int measure_compressed_pairs(const CmdLineParser &parser,
+                             const CmdParams &params) {
+  optional<mesaac::measures::shape::CompressedShapeFPs> fingerprints;
+  try {
+    fingerprints.emplace(params.fingerprints_path);
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  cerr << "Number of fingerprints is " << fingerprints->size() << " ("
+       << fingerprints->memory_bytes() << " bytes compressed)" << endl;
+  if (params.screen_bits) {
+    cerr << "Warning: --screen-bits is ignored for compressed databases."
+         << endl;
+  }
+  auto measure =
+      mesaac::measures::get_measures(params.measure_type, params.tversky_alpha);
+  const auto measurer = mesaac::measures::shape::get_shape_measurer(
+      measure, params.compute_similarity, fingerprints.value());
+  if (0 == measurer) {
+    cerr << "Internal error - could not create shape measurer." << endl;
+    return 2;
+  }
+  return compute_and_output_results(parser, params, measurer,
+                                    fingerprints->size());
+}
 } // namespace
 
 int main(int argc, const char **argv) {
@@ -340,18 +512,32 @@ int main(int argc, const char **argv) {
   if (params.parse_status != 0) {
     return params.parse_status;
   }
-
-  mesaac::shape_defs::ShapeFPBlocks fingerprints;
-  read_fingerprint_blocks(params.fingerprints_path, fingerprints);
-
-  auto measure =
-      mesaac::measures::get_measures(params.measure_type, params.tversky_alpha);
-  auto measurer = mesaac::measures::shape::get_shape_measurer(
-      measure, params.compute_similarity, fingerprints);
-  if (0 == measurer) {
-    cerr << "Internal error - could not create shape measurer." << endl;
-    return 2;
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
   }
 
-  return compute_and_output_results(parser, params, measurer, fingerprints);
+  int status = 0;
+  if (!params.index_path &&
+      mesaac::measures::shape::CompressedShapeFPs::is_compressed(
+          params.fingerprints_path)) {
+    status = measure_compressed_pairs(parser, params);
+  } else {
+    mesaac::shape_defs::ShapeFPBlocks fingerprints;
+    mesaac::cli::measures::read_fingerprint_blocks(params.fingerprints_path,
+                                                   fingerprints);
+    status = params.index_path ? search_index(params, fingerprints)
+                               : measure_pairs(parser, params, fingerprints);
+  }
+  if (status != 0) {
+    return status;
+  }
+  if (params.stats_file) {
+    try {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    } catch (const exception &e) {
+      cerr << "Error: " << e.what() << endl;
+      return 1;
+    }
+  }
+  return 0;
 }
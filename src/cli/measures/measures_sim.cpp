@@ -1,16 +1,22 @@
 #include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <libgen.h>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "fingerprint_reader.hpp"
 #include "measure_type_converter.hpp"
+#include "shard.hpp"
+#include "mesaac_common/stats.hpp"
 #include "mesaac_measures/shape_measures_factory.hpp"
 
 using namespace std;
+using mesaac::cli::measures::RowRange;
+using mesaac::cli::measures::Shard;
 
 string Version = "1.2";
 string CreationDate = "May, 2004";
@@ -26,7 +32,7 @@ void show_blurb() {
 void show_usage(int /* argc */, char **argv, const string msg = "") {
   cerr << "Usage: " << basename(argv[0])
        << " fingerprintfile.txt measure similarity format searchnumber | alpha "
-          "| sparsethreshold"
+          "| sparsethreshold [--shard I/N] [--stats FILE]"
        << endl
        << "measure = '-T' for Tanimoto, '-V' for Tversky," << endl
        << "'-E' for Euclidean, '-H' for Hamann, '-C' for Cosine, '-B' for BUB"
@@ -41,6 +47,12 @@ void show_usage(int /* argc */, char **argv, const string msg = "") {
        << endl
        << "alpha is in the range 0-1, and measure must = '-V'" << endl
        << "sparsethreshold is in the range of (0,1), and format must be = '-S'"
+       << endl
+       << "--shard I/N computes only part I of N of the searchnumber rows, for "
+          "combining with measures_merge"
+       << endl
+       << "--stats FILE writes a JSON summary of per-stage times and item "
+          "counts to FILE"
        << endl;
   if (msg.size() > 0) {
     cerr << endl << msg << endl;
@@ -48,6 +60,40 @@ void show_usage(int /* argc */, char **argv, const string msg = "") {
   exit(1);
 }
 
+struct ExtraOptions {
+  optional<Shard> shard;
+  optional<filesystem::path> stats_file;
+};
+
+// Remove "--shard I/N" and "--stats FILE", which may appear anywhere on the
+// command line, leaving the positional arguments in args.
+ExtraOptions extract_options(int argc, char **argv, vector<char *> &args) {
+  ExtraOptions result;
+  for (int k = 0; k < argc; ++k) {
+    const string arg(argv[k]);
+    if (arg != "--shard" && arg != "--stats") {
+      args.push_back(argv[k]);
+    } else if (k + 1 >= argc) {
+      show_usage(argc, argv, arg + " requires 1 value");
+    } else if (arg == "--stats") {
+      result.stats_file = argv[++k];
+    } else {
+      try {
+        result.shard = mesaac::cli::measures::parse_shard(argv[++k]);
+      } catch (invalid_argument &e) {
+        show_usage(argc, argv, e.what());
+      }
+    }
+  }
+  return result;
+}
+
+void write_section_break(const optional<Shard> &shard) {
+  if (shard) {
+    mesaac::cli::measures::write_shard_section_break(cout);
+  }
+}
+
 int main(int argc, char **argv) {
   using namespace mesaac::measures;
   using namespace mesaac::cli::measures;
@@ -59,6 +105,15 @@ int main(int argc, char **argv) {
 
   show_blurb();
 
+  vector<char *> args;
+  const ExtraOptions extra = extract_options(argc, argv, args);
+  const optional<Shard> &shard = extra.shard;
+  argc = args.size();
+  argv = args.data();
+  if (extra.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
   if (argc != 6 && argc != 7 && argc != 8) {
     show_usage(argc, argv, "Wrong number of arguments");
   }
@@ -130,10 +185,16 @@ int main(int argc, char **argv) {
   const unsigned int number_fingerprints = fingerprints.size();
   unsigned int i, j;
 
+  RowRange rows{.begin = 0, .end = search_number};
+  if (shard) {
+    rows = get_shard_rows(shard.value(), search_number);
+    write_shard_header(cout, shard.value(), rows, search_number);
+  }
+
   // TODO:  Abstract out the Tversky special-case output.
   if (format[1] == 'S') { // Sparse Matrix
     if (compute_sim) {
-      for (i = 0; i < search_number; i++) {
+      for (i = rows.begin; i < rows.end; i++) {
         cout << i << "  ";
         for (j = search_number; j < number_fingerprints; j++) {
           float tmpmeasure = measurer->value(i, j);
@@ -144,8 +205,9 @@ int main(int argc, char **argv) {
         cout << -1 << endl;
       }
       if (using_tversky) {
+        write_section_break(shard);
         // For Tversky, also output the complementary distances.
-        for (i = 0; i < search_number; i++) {
+        for (i = rows.begin; i < rows.end; i++) {
           cout << i << "  ";
           for (j = search_number; j < number_fingerprints; j++) {
             float tmpmeasure = measurer->value(j, i);
@@ -157,7 +219,7 @@ int main(int argc, char **argv) {
         }
       }
     } else {
-      for (i = 0; i < search_number; i++) {
+      for (i = rows.begin; i < rows.end; i++) {
         cout << i << "  ";
         for (j = search_number; j < number_fingerprints; j++) {
           float tmpmeasure = measurer->value(i, j);
@@ -168,7 +230,8 @@ int main(int argc, char **argv) {
         cout << -1 << endl;
       }
       if (using_tversky) {
-        for (i = 0; i < search_number; i++) {
+        write_section_break(shard);
+        for (i = rows.begin; i < rows.end; i++) {
           cout << i << "  ";
           for (j = search_number; j < number_fingerprints; j++) {
             float tmpmeasure = measurer->value(j, i);
@@ -181,14 +244,15 @@ int main(int argc, char **argv) {
       }
     }
   } else if (format[1] == 'M') { // Matrix
-    for (i = 0; i < search_number; i++) {
+    for (i = rows.begin; i < rows.end; i++) {
       for (j = search_number; j < number_fingerprints - 1; j++) {
         cout << measurer->value(i, j) << " ";
       }
       cout << measurer->value(i, j) << endl;
     }
     if (using_tversky) {
-      for (i = 0; i < search_number; i++) {
+      write_section_break(shard);
+      for (i = rows.begin; i < rows.end; i++) {
         for (j = search_number; j < number_fingerprints - 1; j++) {
           cout << measurer->value(j, i) << " ";
         }
@@ -197,7 +261,7 @@ int main(int argc, char **argv) {
     }
   } else if (format[1] == 'O') { // Ordered Pair
     if (using_tversky) {
-      for (i = 0; i < search_number; i++) {
+      for (i = rows.begin; i < rows.end; i++) {
         for (j = search_number; j < number_fingerprints; j++) {
           cout << i << " " << j << " " << measurer->value(i, j) << " "
                << measurer->value(j, i) << endl;
@@ -205,12 +269,23 @@ int main(int argc, char **argv) {
       }
 
     } else {
-      for (i = 0; i < search_number; i++) {
+      for (i = rows.begin; i < rows.end; i++) {
         for (j = search_number; j < number_fingerprints; j++) {
           cout << i << " " << j << " " << measurer->value(i, j) << endl;
         }
       }
     }
   }
+  if (shard) {
+    mesaac::cli::measures::write_shard_trailer(cout);
+  }
+  if (extra.stats_file) {
+    try {
+      mesaac::common::stats::write_report(extra.stats_file.value());
+    } catch (const exception &e) {
+      cerr << "Error: " << e.what() << endl;
+      return 1;
+    }
+  }
   return 0;
 }
@@ -0,0 +1,201 @@
+// Cluster a set of shape fingerprints using the Taylor-Butina algorithm.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "mesaac_measures/butina_clusterer.hpp"
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/neighbor_lists.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+
+#include "fingerprint_reader.hpp"
+#include "measure_type_converter.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+using mesaac::measures::shape::NeighborLists;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  mesaac::measures::MeasureType measure_type;
+  float tversky_alpha;
+  NeighborLists::Params neighbor_params;
+  filesystem::path centroids_path;
+  filesystem::path fingerprints_path;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Choice::Ptr measure_choice = Choice::create(
+      "-m", "--measure", "the measure to use",
+      {
+          {"B", "BUB measure"},
+          {"C", "Cosine measure"},
+          {"E", "Euclidean measure"},
+          {"H", "Hamann measure"},
+          {"T", "Tanimoto measure - default"},
+          {"V",
+           "Tversky measure - can be used in conjunction with -a | --alpha"},
+      });
+
+  Option<float>::Ptr alpha_opt = Option<float>::create(
+      "-a", "--alpha",
+      "alpha value to use for measure V (Tversky) - default is 0.0");
+
+  Flag::Ptr dissim = Flag::create(
+      "-d", "--dissimilarity",
+      "compare dissimilarity values - default is to compare similarity");
+
+  Option<float>::Ptr threshold_opt = Option<float>::create(
+      "-t", "--threshold",
+      ("neighbor threshold - shapes are neighbors if their similarity is >= "
+       "THRESHOLD,\n"
+       "        or their dissimilarity is <= THRESHOLD - default is 0.8 for "
+       "similarity, 0.2 for dissimilarity"));
+
+  Option<unsigned int>::Ptr memory_opt = Option<unsigned int>::create(
+      "-b", "--memory-budget",
+      ("megabytes of neighbor lists to hold in memory before spilling to "
+       "disk - default is 1024"));
+
+  Option<filesystem::path>::Ptr spill_dir_opt =
+      Option<filesystem::path>::create(
+          "-s", "--spill-dir",
+          "directory for spilled neighbor lists - default is the system "
+          "temporary directory");
+
+  Option<filesystem::path>::Ptr centroids_opt =
+      Option<filesystem::path>::create(
+          "-c", "--centroids",
+          ("file to which to write one line per cluster: cluster index, "
+           "centroid index, cluster size"));
+
+  Argument<filesystem::path>::Ptr fingerprints_arg =
+      Argument<filesystem::path>::create(
+          "shape_fingerprints",
+          "plaintext file of shape fingerprints, or a packed, compressed or\n"
+          "        segmented database");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  ArgParser parser = ArgParser(
+      {measure_choice, alpha_opt, dissim, threshold_opt, memory_opt,
+       spill_dir_opt, centroids_opt, stats_opt},
+      {fingerprints_arg},
+      "Cluster a set of shape fingerprints using the Taylor-Butina "
+      "algorithm.\n"
+      "For each fingerprint, print its 0-based index and its cluster index.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .measure_type = mesaac::measures::MeasureType::tanimoto,
+                     .tversky_alpha = 0.0,
+                     .neighbor_params = NeighborLists::Params(),
+                     .centroids_path = filesystem::path(""),
+                     .fingerprints_path = filesystem::path(""),
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+
+    const auto measure_str = measure_choice->value_or("T");
+    result.measure_type =
+        mesaac::cli::measures::get_measure_type(measure_str.at(0));
+    result.tversky_alpha = alpha_opt->value_or(0.0);
+
+    auto &neighbor_params(result.neighbor_params);
+    neighbor_params.is_similarity = !dissim->value();
+    neighbor_params.threshold =
+        threshold_opt->value_or(neighbor_params.is_similarity ? 0.8 : 0.2);
+    neighbor_params.memory_budget =
+        size_t(memory_opt->value_or(1024)) * 1024 * 1024;
+    neighbor_params.spill_dir = spill_dir_opt->value_or("");
+
+    result.centroids_path = centroids_opt->value_or("");
+    result.fingerprints_path = fingerprints_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
+  }
+};
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  mesaac::shape_defs::ShapeFPBlocks fingerprints;
+  mesaac::cli::measures::read_fingerprint_blocks(params.fingerprints_path,
+                                                 fingerprints);
+
+  auto measure =
+      mesaac::measures::get_measures(params.measure_type, params.tversky_alpha);
+  auto measurer = mesaac::measures::shape::get_shape_measurer(
+      measure, params.neighbor_params.is_similarity, fingerprints);
+  if (0 == measurer) {
+    cerr << "Internal error - could not create shape measurer." << endl;
+    return 2;
+  }
+
+  try {
+    const NeighborLists neighbors(*measurer, fingerprints.size(),
+                                  params.neighbor_params);
+    const auto clusters =
+        mesaac::measures::shape::cluster_taylor_butina(neighbors);
+
+    for (unsigned int i = 0; i != clusters.assignments.size(); ++i) {
+      cout << i << " " << clusters.assignments[i] << endl;
+    }
+
+    if (!params.centroids_path.empty()) {
+      ofstream outf(params.centroids_path);
+      if (!outf) {
+        cerr << "Cannot open centroids file " << params.centroids_path
+             << " for writing." << endl;
+        return 1;
+      }
+      for (unsigned int c = 0; c != clusters.centroids.size(); ++c) {
+        outf << c << " " << clusters.centroids[c] << " " << clusters.sizes[c]
+             << endl;
+      }
+    }
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    }
+  } catch (const runtime_error &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
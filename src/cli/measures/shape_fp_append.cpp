@@ -0,0 +1,145 @@
+// Append plaintext shape fingerprints to a segmented database as a new
+// segment.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+#include "mesaac_measures/segmented_shape_fps.hpp"
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+
+#include "fingerprint_reader.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+using mesaac::measures::shape::SegmentedShapeFPs;
+using mesaac::measures::shape::SegmentedShapeFPWriter;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  unsigned int compact_over;
+  filesystem::path fingerprints_path;
+  filesystem::path database_dir;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Option<unsigned int>::Ptr compact_opt = Option<unsigned int>::create(
+      "-c", "--compact-over",
+      ("after appending, merge all segments if there are more than SEGMENTS "
+       "-\n"
+       "        default is never to merge"));
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  Argument<filesystem::path>::Ptr fingerprints_arg =
+      Argument<filesystem::path>::create(
+          "shape_fingerprints",
+          "plaintext file of shape fingerprints - '-' for standard input");
+
+  Argument<filesystem::path>::Ptr database_arg =
+      Argument<filesystem::path>::create(
+          "database_dir",
+          "segmented shape fingerprint database directory - created if it "
+          "does not\n"
+          "        exist");
+
+  ArgParser parser = ArgParser(
+      {compact_opt, stats_opt}, {fingerprints_arg, database_arg},
+      "Append plaintext shape fingerprints to a segmented database as a new,\n"
+      "immutable segment.  Existing shapes keep their global indices.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .compact_over = 0,
+                     .fingerprints_path = filesystem::path(""),
+                     .database_dir = filesystem::path(""),
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+    result.compact_over = compact_opt->value_or(0);
+    result.fingerprints_path = fingerprints_arg->value();
+    result.database_dir = database_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
+  }
+};
+
+void append(const CmdParams &params) {
+  // The fingerprint size is not known until the first block is read.
+  unique_ptr<SegmentedShapeFPWriter> writer;
+  const auto on_block =
+      [&writer, &params](const mesaac::shape_defs::ArrayBitVectors &block) {
+        if (!writer) {
+          writer = make_unique<SegmentedShapeFPWriter>(params.database_dir,
+                                                       block[0].size());
+        }
+        writer->write(block);
+      };
+  mesaac::cli::measures::for_each_fingerprint_block(params.fingerprints_path,
+                                                    on_block);
+  if (!writer) {
+    cerr << "Appended no shape fingerprints." << endl;
+    return;
+  }
+  writer->close();
+  cerr << "Appended " << writer->size()
+       << " shape fingerprints with global indices " << writer->first_index()
+       << ".." << writer->first_index() + writer->size() - 1 << "." << endl;
+
+  if (params.compact_over > 0) {
+    const SegmentedShapeFPs db(params.database_dir);
+    if (db.num_segments() > params.compact_over) {
+      const unsigned int num_merged =
+          mesaac::measures::shape::compact_segments(params.database_dir);
+      cerr << "Merged " << num_merged << " segments." << endl;
+    }
+  }
+}
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  try {
+    append(params);
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Merge the segments of a segmented shape fingerprint database.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+
+#include "mesaac_measures/segmented_shape_fps.hpp"
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  filesystem::path database_dir;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  Argument<filesystem::path>::Ptr database_arg =
+      Argument<filesystem::path>::create(
+          "database_dir",
+          "segmented shape fingerprint database directory, from "
+          "shape_fp_append");
+
+  ArgParser parser = ArgParser(
+      {stats_opt}, {database_arg},
+      "Merge all live segments of a segmented shape fingerprint database into "
+      "one.\n"
+      "Global indices are unchanged, and searches already in progress are "
+      "not\n"
+      "disturbed.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .database_dir = filesystem::path(""),
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+    result.database_dir = database_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
+  }
+};
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  try {
+    const unsigned int num_merged =
+        mesaac::measures::shape::compact_segments(params.database_dir);
+    cerr << "Merged " << num_merged << " segments." << endl;
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
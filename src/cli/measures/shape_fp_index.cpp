@@ -0,0 +1,148 @@
+// Build a popcount-partitioned or MinHash search index of a shape
+// fingerprint database.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+
+#include "mesaac_measures/minhash_index.hpp"
+#include "mesaac_measures/popcount_index.hpp"
+#include "mesaac_measures/segmented_shape_fps.hpp"
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+
+// Indexes built from the same database and parameters are identical.
+const std::uint64_t LSHSeed = 20101118;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  // If set, write a MinHash index with this many bands.
+  optional<unsigned int> lsh_bands;
+  unsigned int lsh_rows;
+  filesystem::path database_path;
+  filesystem::path index_path;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Option<unsigned int>::Ptr bands_opt = Option<unsigned int>::create(
+      "-b", "--bands",
+      ("write an approximate MinHash index with BANDS locality-sensitive "
+       "hash bands,\n"
+       "        instead of an exact popcount index - more bands find more "
+       "similar shapes,\n"
+       "        but take longer to search"));
+
+  Option<unsigned int>::Ptr rows_opt = Option<unsigned int>::create(
+      "-r", "--rows",
+      ("MinHash values per band, with --bands - more rows admit fewer "
+       "dissimilar\n"
+       "        candidates - default is 4"));
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  Argument<filesystem::path>::Ptr database_arg =
+      Argument<filesystem::path>::create(
+          "database",
+          "packed shape fingerprint database from shape_fp_pack, or "
+          "segmented\n"
+          "        database directory from shape_fp_append");
+
+  Argument<filesystem::path>::Ptr index_arg =
+      Argument<filesystem::path>::create("index", "index file to create");
+
+  ArgParser parser = ArgParser(
+      {bands_opt, rows_opt, stats_opt}, {database_arg, index_arg},
+      "Index a shape fingerprint database by fingerprint popcount, for fast\n"
+      "threshold searches with measures_shape_fp --index and "
+      "shape_search_server.\n"
+      "With --bands, write an approximate MinHash index instead, which "
+      "rescores its\n"
+      "candidates against the database and so needs the database to stay "
+      "in place.\n"
+      "Indexed shapes keep their database indices.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .lsh_bands = nullopt,
+                     .lsh_rows = 4,
+                     .database_path = filesystem::path(""),
+                     .index_path = filesystem::path(""),
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+    if (bands_opt->has_value()) {
+      result.lsh_bands = bands_opt->value();
+    }
+    result.lsh_rows = rows_opt->value_or(4);
+    if ((result.lsh_bands && (result.lsh_bands.value() == 0)) ||
+        (result.lsh_rows == 0)) {
+      parser.show_usage("--bands and --rows must be greater than 0");
+      result.parse_status = 1;
+      return result;
+    }
+    result.database_path = database_arg->value();
+    result.index_path = index_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
+  }
+};
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  try {
+    const mesaac::measures::shape::SegmentedShapeFPs db(params.database_path);
+    if (params.lsh_bands) {
+      mesaac::measures::shape::write_minhash_index(
+          db, params.database_path, params.index_path,
+          {.num_bands = params.lsh_bands.value(),
+           .rows_per_band = params.lsh_rows,
+           .seed = LSHSeed});
+    } else {
+      mesaac::measures::shape::write_popcount_index(db, params.index_path);
+    }
+    cerr << "Indexed " << db.size() << " shape fingerprints." << endl;
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
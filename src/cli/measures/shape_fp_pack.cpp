@@ -0,0 +1,139 @@
+// Convert a plaintext shape fingerprint file to a packed or compressed
+// binary database.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+#include "mesaac_measures/compressed_shape_fps.hpp"
+#include "mesaac_measures/packed_shape_fps.hpp"
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+
+#include "fingerprint_reader.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+using mesaac::measures::shape::CompressedShapeFPWriter;
+using mesaac::measures::shape::PackedShapeFPWriter;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  filesystem::path fingerprints_path;
+  filesystem::path database_path;
+  bool compressed;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Argument<filesystem::path>::Ptr fingerprints_arg =
+      Argument<filesystem::path>::create(
+          "shape_fingerprints",
+          "plaintext file of shape fingerprints - '-' for standard input");
+
+  Argument<filesystem::path>::Ptr database_arg =
+      Argument<filesystem::path>::create(
+          "database", "packed shape fingerprint database file to create");
+
+  Flag::Ptr compressed_flag = Flag::create(
+      "-c", "--compressed",
+      "write a compressed database, for measures_shape_fp - low-density\n"
+      "        fingerprints take a fraction of the space of a packed "
+      "database");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  ArgParser parser = ArgParser(
+      {compressed_flag, stats_opt}, {fingerprints_arg, database_arg},
+      "Convert a plaintext shape fingerprint file to a packed binary "
+      "database,\n"
+      "for use with measures_sfp_band, or to a compressed database.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .fingerprints_path = filesystem::path(""),
+                     .database_path = filesystem::path(""),
+                     .compressed = false,
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+    result.fingerprints_path = fingerprints_arg->value();
+    result.database_path = database_arg->value();
+    result.compressed = compressed_flag->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
+  }
+};
+
+// Write the shape fingerprints to a database, returning the number written.
+template <typename Writer>
+std::uint64_t write_database(const CmdParams &params) {
+  // The fingerprint size is not known until the first block is read.
+  unique_ptr<Writer> writer;
+  const auto on_block =
+      [&writer, &params](const mesaac::shape_defs::ArrayBitVectors &block) {
+        if (!writer) {
+          writer = make_unique<Writer>(params.database_path, block[0].size());
+        }
+        writer->write(block);
+      };
+  mesaac::cli::measures::for_each_fingerprint_block(params.fingerprints_path,
+                                                    on_block);
+
+  if (!writer) {
+    writer = make_unique<Writer>(params.database_path, 0);
+  }
+  writer->close();
+  return writer->size();
+}
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  try {
+    const auto num_shapes =
+        params.compressed ? write_database<CompressedShapeFPWriter>(params)
+                          : write_database<PackedShapeFPWriter>(params);
+    cerr << (params.compressed ? "Compressed " : "Packed ") << num_shapes
+         << " shape fingerprints." << endl;
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,508 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "shape_search.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "mesaac_common/stats.hpp"
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+#include "measure_type_converter.hpp"
+
+using namespace std;
+
+namespace mesaac::cli::measures {
+
+namespace {
+using Word = std::uint64_t;
+using mesaac::measures::shape::FPsPerShape;
+
+// Guards against allocating absurd buffers for corrupt length prefixes.
+const std::uint32_t MaxPayloadBytes = 1U << 30;
+
+runtime_error socket_error(const string &action,
+                           const filesystem::path &path) {
+  return runtime_error(
+      format("Cannot {} {}: {}", action, path.string(), strerror(errno)));
+}
+
+// Fill sockaddr for path, which must fit in sun_path.
+sockaddr_un get_address(const filesystem::path &path) {
+  sockaddr_un result{};
+  result.sun_family = AF_UNIX;
+  const string &name(path.native());
+  if (name.size() >= sizeof(result.sun_path)) {
+    throw runtime_error(format("Socket path {} is too long.", name));
+  }
+  memcpy(result.sun_path, name.c_str(), name.size() + 1);
+  return result;
+}
+
+void write_all(int fd, const char *data, size_t size) {
+  while (size > 0) {
+    const ssize_t num_written = ::write(fd, data, size);
+    if (num_written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw runtime_error(
+          format("Cannot send search message: {}", strerror(errno)));
+    }
+    data += num_written;
+    size -= num_written;
+  }
+}
+
+// Returns false if the peer closed the connection before sending anything.
+bool read_all(int fd, char *data, size_t size) {
+  size_t num_read = 0;
+  while (num_read < size) {
+    const ssize_t count = ::read(fd, data + num_read, size - num_read);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw runtime_error(
+          format("Cannot receive search message: {}", strerror(errno)));
+    }
+    if (count == 0) {
+      if (num_read == 0) {
+        return false;
+      }
+      throw runtime_error("Connection closed in mid-message.");
+    }
+    num_read += count;
+  }
+  return true;
+}
+
+void send_message(int fd, const string &payload) {
+  const std::uint32_t size = payload.size();
+  string message(reinterpret_cast<const char *>(&size), sizeof(size));
+  message += payload;
+  write_all(fd, message.data(), message.size());
+}
+
+// Returns false if the peer closed the connection between messages.
+bool receive_message(int fd, string &payload) {
+  std::uint32_t size;
+  if (!read_all(fd, reinterpret_cast<char *>(&size), sizeof(size))) {
+    return false;
+  }
+  if (size > MaxPayloadBytes) {
+    throw runtime_error(
+        format("Search message of {} bytes is too large.", size));
+  }
+  payload.resize(size);
+  if (!read_all(fd, payload.data(), size)) {
+    throw runtime_error("Connection closed in mid-message.");
+  }
+  return true;
+}
+
+class PayloadWriter {
+public:
+  template <typename T> void put(const T &value) {
+    static_assert(is_trivially_copyable_v<T>);
+    m_bytes.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  }
+
+  void put_string(const string &value) {
+    put(std::uint32_t(value.size()));
+    m_bytes += value;
+  }
+
+  void put_shape_fp(const mesaac::shape::ShapeFingerprint &sfp) {
+    const std::uint32_t num_bits = sfp.empty() ? 0 : sfp[0].size();
+    put(std::uint32_t(sfp.size()));
+    put(num_bits);
+    vector<Word> words;
+    for (const auto &fp : sfp) {
+      if (fp.size() != num_bits) {
+        throw invalid_argument(
+            "All fingerprints of a query must have the same number of bits.");
+      }
+      words.clear();
+      boost::to_block_range(fp, back_inserter(words));
+      m_bytes.append(reinterpret_cast<const char *>(words.data()),
+                     words.size() * sizeof(Word));
+    }
+  }
+
+  const string &bytes() const { return m_bytes; }
+
+private:
+  string m_bytes;
+};
+
+class PayloadReader {
+public:
+  explicit PayloadReader(const string &bytes) : m_bytes(bytes), m_offset(0) {}
+
+  template <typename T> T get() {
+    static_assert(is_trivially_copyable_v<T>);
+    T result;
+    memcpy(&result, take(sizeof(result)), sizeof(result));
+    return result;
+  }
+
+  string get_string() {
+    const auto size = get<std::uint32_t>();
+    return string(take(size), size);
+  }
+
+  void get_shape_fp(mesaac::shape::ShapeFingerprint &sfp) {
+    const auto num_fps = get<std::uint32_t>();
+    const auto num_bits = get<std::uint32_t>();
+    const size_t num_words = (size_t(num_bits) + 63) / 64;
+    if (num_fps > FPsPerShape) {
+      throw runtime_error(
+          format("Query has {} fingerprints; expected {}.", num_fps,
+                 FPsPerShape));
+    }
+    sfp.resize(num_fps);
+    vector<Word> words(num_words);
+    for (auto &fp : sfp) {
+      memcpy(words.data(), take(num_words * sizeof(Word)),
+             num_words * sizeof(Word));
+      fp = shape_defs::BitVector(words.begin(), words.end());
+      fp.resize(num_bits);
+    }
+  }
+
+  void expect_end() const {
+    if (m_offset != m_bytes.size()) {
+      throw runtime_error(
+          "Malformed search message: unexpected trailing data.");
+    }
+  }
+
+private:
+  const string &m_bytes;
+  size_t m_offset;
+
+  const char *take(size_t size) {
+    if (size > m_bytes.size() - m_offset) {
+      throw runtime_error("Malformed search message: too short.");
+    }
+    const char *result = m_bytes.data() + m_offset;
+    m_offset += size;
+    return result;
+  }
+};
+
+SearchRequest parse_request(const string &bytes) {
+  PayloadReader payload(bytes);
+  SearchRequest result{};
+  result.database = payload.get_string();
+  result.measure_code = payload.get<char>();
+  result.compute_similarity = payload.get<std::uint8_t>() != 0;
+  result.tversky_alpha = payload.get<float>();
+  result.threshold = payload.get<float>();
+  result.max_hits = payload.get<std::uint32_t>();
+  payload.get_shape_fp(result.query);
+  payload.expect_end();
+  return result;
+}
+
+// Returns a description of what is wrong with request, or an empty string.
+string check_request(const SearchRequest &request, unsigned int num_bits) {
+  if (request.query.size() != FPsPerShape) {
+    return format("Query has {} fingerprints; expected {}.",
+                  request.query.size(), FPsPerShape);
+  }
+  for (const auto &fp : request.query) {
+    if (fp.size() != num_bits) {
+      return format("Query fingerprints have {} bits; database fingerprints "
+                    "have {}.",
+                    fp.size(), num_bits);
+    }
+  }
+  try {
+    get_measure_type(request.measure_code);
+  } catch (const invalid_argument &e) {
+    return e.what();
+  }
+  return "";
+}
+
+// Ties go to the lower index, so results do not depend on scan order.
+struct BetterHit {
+  bool is_sim;
+
+  bool operator()(const SearchHit &a, const SearchHit &b) const {
+    if (a.value != b.value) {
+      return is_sim ? (a.value > b.value) : (a.value < b.value);
+    }
+    return a.index < b.index;
+  }
+};
+
+// Collects passing hits in database order, or keeps only the best
+// request.max_hits of them.
+class HitSelector {
+public:
+  explicit HitSelector(const SearchRequest &request)
+      : m_max_hits(request.max_hits),
+        m_better{.is_sim = request.compute_similarity} {}
+
+  void add(const SearchHit &hit, vector<SearchHit> &hits) const {
+    hits.push_back(hit);
+    if (m_max_hits > 0) {
+      // hits is a heap whose front is the worst hit kept.
+      push_heap(hits.begin(), hits.end(), m_better);
+      if (hits.size() > m_max_hits) {
+        pop_heap(hits.begin(), hits.end(), m_better);
+        hits.pop_back();
+      }
+    }
+  }
+
+  // Put the hits in their final order.
+  void finish(vector<SearchHit> &hits) const {
+    if (m_max_hits > 0) {
+      sort_heap(hits.begin(), hits.end(), m_better);
+    }
+  }
+
+private:
+  const unsigned int m_max_hits;
+  const BetterHit m_better;
+};
+} // namespace
+
+SearchResponse search(const mesaac::measures::shape::SegmentedShapeFPs &db,
+                      const SearchRequest &request) {
+  static common::stats::Stage &search_stage(
+      common::stats::stage("shape_search::search"));
+  const common::stats::ScopedTimer timer(search_stage, db.size());
+
+  SearchResponse result;
+  result.error = check_request(request, db.num_bits());
+  if (!result.error.empty()) {
+    return result;
+  }
+  const auto measurer = mesaac::measures::shape::get_shape_pair_measurer(
+      mesaac::measures::get_measures(get_measure_type(request.measure_code),
+                                     request.tversky_alpha),
+      request.compute_similarity);
+  if (!measurer) {
+    result.error = "Could not create a shape fingerprint measure.";
+    return result;
+  }
+
+  const bool is_sim = request.compute_similarity;
+  const float threshold = request.threshold;
+  const auto passes = [is_sim, threshold](float value) {
+    return is_sim ? (value >= threshold) : (value <= threshold);
+  };
+  const HitSelector selector(request);
+  mesaac::shape::ShapeFingerprint candidate;
+  for (unsigned int i = 0; i < db.size(); ++i) {
+    db.get(i, candidate);
+    const float value = measurer->value(request.query, candidate);
+    if (passes(value)) {
+      selector.add({.index = i, .value = value}, result.hits);
+    }
+  }
+  selector.finish(result.hits);
+  return result;
+}
+
+SearchResponse search(const mesaac::measures::shape::IShapeFPIndex &index,
+                      const SearchRequest &request) {
+  SearchResponse result;
+  result.error = check_request(request, index.num_bits());
+  if (!result.error.empty()) {
+    return result;
+  }
+  const HitSelector selector(request);
+  for (const auto &hit : index.search(
+           request.query, get_measure_type(request.measure_code),
+           request.tversky_alpha, request.compute_similarity,
+           request.threshold)) {
+    selector.add({.index = hit.index, .value = hit.value}, result.hits);
+  }
+  selector.finish(result.hits);
+  return result;
+}
+
+Socket::~Socket() {
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+Socket::Socket(Socket &&src) noexcept : m_fd(src.m_fd) { src.m_fd = -1; }
+
+Socket &Socket::operator=(Socket &&src) noexcept {
+  if (this != &src) {
+    if (m_fd >= 0) {
+      ::close(m_fd);
+    }
+    m_fd = src.m_fd;
+    src.m_fd = -1;
+  }
+  return *this;
+}
+
+Socket listen_at(const filesystem::path &socket_path) {
+  const sockaddr_un address(get_address(socket_path));
+  Socket result(::socket(AF_UNIX, SOCK_STREAM, 0));
+  if (result.fd() < 0) {
+    throw socket_error("create a socket for", socket_path);
+  }
+  if (filesystem::is_socket(socket_path)) {
+    filesystem::remove(socket_path);
+  }
+  if (::bind(result.fd(), reinterpret_cast<const sockaddr *>(&address),
+             sizeof(address)) != 0) {
+    throw socket_error("bind", socket_path);
+  }
+  if (::listen(result.fd(), SOMAXCONN) != 0) {
+    throw socket_error("listen at", socket_path);
+  }
+  return result;
+}
+
+Socket connect_to(const filesystem::path &socket_path) {
+  const sockaddr_un address(get_address(socket_path));
+  Socket result(::socket(AF_UNIX, SOCK_STREAM, 0));
+  if (result.fd() < 0) {
+    throw socket_error("create a socket for", socket_path);
+  }
+  if (::connect(result.fd(), reinterpret_cast<const sockaddr *>(&address),
+                sizeof(address)) != 0) {
+    throw socket_error("connect to", socket_path);
+  }
+  return result;
+}
+
+void send_request(int fd, const SearchRequest &request) {
+  if (request.database.size() > MaxDatabaseNameBytes) {
+    throw invalid_argument(
+        format("Database name '{}' is too long.", request.database));
+  }
+  PayloadWriter payload;
+  payload.put_string(request.database);
+  payload.put(request.measure_code);
+  payload.put(std::uint8_t(request.compute_similarity));
+  payload.put(request.tversky_alpha);
+  payload.put(request.threshold);
+  payload.put(std::uint32_t(request.max_hits));
+  payload.put_shape_fp(request.query);
+  send_message(fd, payload.bytes());
+}
+
+optional<SearchRequest> receive_request(int fd) {
+  string bytes;
+  if (!receive_message(fd, bytes)) {
+    return nullopt;
+  }
+  return parse_request(bytes);
+}
+
+std::uint32_t max_request_bytes(unsigned int num_bits) {
+  const size_t fp_bytes = (size_t(num_bits) + 63) / 64 * sizeof(Word);
+  // Name length and name, measure code, similarity flag, alpha,
+  // threshold, max hits, then the query's fingerprint count and bit count.
+  const size_t header_bytes = sizeof(std::uint32_t) + MaxDatabaseNameBytes +
+                              2 * sizeof(std::uint8_t) + 2 * sizeof(float) +
+                              3 * sizeof(std::uint32_t);
+  return header_bytes + FPsPerShape * fp_bytes;
+}
+
+bool RequestReader::read_available(int fd) {
+  while (!is_complete()) {
+    const size_t size_bytes = sizeof(m_size_bytes);
+    const bool in_size = m_num_read < size_bytes;
+    char *data = in_size ? (m_size_bytes + m_num_read)
+                         : (m_payload.data() + (m_num_read - size_bytes));
+    const size_t wanted = in_size
+                              ? (size_bytes - m_num_read)
+                              : (size_bytes + m_payload.size() - m_num_read);
+    const ssize_t count = ::recv(fd, data, wanted, MSG_DONTWAIT);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return true;
+      }
+      throw runtime_error(
+          format("Cannot receive search message: {}", strerror(errno)));
+    }
+    if (count == 0) {
+      if (m_num_read == 0) {
+        return false;
+      }
+      throw runtime_error("Connection closed in mid-message.");
+    }
+    m_num_read += count;
+    if (in_size && m_num_read == size_bytes) {
+      std::uint32_t size;
+      memcpy(&size, m_size_bytes, sizeof(size));
+      if (size > m_max_payload_bytes) {
+        throw runtime_error(
+            format("Search request of {} bytes is too large.", size));
+      }
+      m_payload.resize(size);
+    }
+  }
+  return true;
+}
+
+optional<SearchRequest> RequestReader::take_request() {
+  if (!is_complete()) {
+    return nullopt;
+  }
+  m_num_read = 0;
+  const SearchRequest result(parse_request(m_payload));
+  m_payload.clear();
+  return result;
+}
+
+void send_response(int fd, const SearchResponse &response) {
+  PayloadWriter payload;
+  payload.put_string(response.error);
+  payload.put(std::uint32_t(response.hits.size()));
+  for (const auto &hit : response.hits) {
+    payload.put(std::uint32_t(hit.index));
+    payload.put(hit.value);
+  }
+  send_message(fd, payload.bytes());
+}
+
+SearchResponse receive_response(int fd) {
+  string bytes;
+  if (!receive_message(fd, bytes)) {
+    throw runtime_error("The search server closed the connection.");
+  }
+  PayloadReader payload(bytes);
+  SearchResponse result;
+  result.error = payload.get_string();
+  const auto num_hits = payload.get<std::uint32_t>();
+  result.hits.reserve(min<size_t>(num_hits, bytes.size()));
+  for (std::uint32_t i = 0; i < num_hits; ++i) {
+    const auto index = payload.get<std::uint32_t>();
+    const auto value = payload.get<float>();
+    result.hits.push_back({.index = index, .value = value});
+  }
+  payload.expect_end();
+  return result;
+}
+} // namespace mesaac::cli::measures
@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mesaac_measures/segmented_shape_fps.hpp"
+#include "mesaac_measures/shape_fp_index.hpp"
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::cli::measures {
+// A similarity search of one shape fingerprint database, as sent by
+// shape_search_client to shape_search_server.
+struct SearchRequest {
+  // Name of the database to search -- the file or directory name, without
+  // extension, of one of the server's databases.  Empty means the server's
+  // first database.
+  std::string database;
+  // Measure code, as for measures_shape_fp --measure, e.g. 'T'.
+  char measure_code;
+  float tversky_alpha;
+  bool compute_similarity;
+  // Report only hits at least this similar, or no more than this distant.
+  float threshold;
+  // If greater than 0, report only this many of the best hits.
+  unsigned int max_hits;
+  mesaac::shape::ShapeFingerprint query;
+};
+
+// index is the global index of a shape fingerprint within the database.
+struct SearchHit {
+  unsigned int index;
+  float value;
+};
+
+struct SearchResponse {
+  // Non-empty if the request could not be satisfied.
+  std::string error;
+  // In database order, or best first if the request set max_hits.
+  std::vector<SearchHit> hits;
+};
+
+// Search db, returning hits or an error description.  Never throws for a
+// malformed request.
+SearchResponse search(const mesaac::measures::shape::SegmentedShapeFPs &db,
+                      const SearchRequest &request);
+
+// Search a shape fingerprint index.  Results from a popcount index are the
+// same as for searching the indexed database; a MinHash index may miss some
+// hits.
+SearchResponse search(const mesaac::measures::shape::IShapeFPIndex &index,
+                      const SearchRequest &request);
+
+// An owned socket descriptor, closed on destruction.
+class Socket {
+public:
+  explicit Socket(int fd = -1) : m_fd(fd) {}
+  ~Socket();
+
+  Socket(Socket &&src) noexcept;
+  Socket &operator=(Socket &&src) noexcept;
+  Socket(const Socket &src) = delete;
+  Socket &operator=(const Socket &src) = delete;
+
+  int fd() const { return m_fd; }
+
+private:
+  int m_fd;
+};
+
+// Create a Unix domain socket listening at socket_path.  An existing socket
+// file at socket_path is replaced.
+// Throws std::runtime_error on failure.
+Socket listen_at(const std::filesystem::path &socket_path);
+
+// Connect to a server listening at socket_path.
+// Throws std::runtime_error on failure.
+Socket connect_to(const std::filesystem::path &socket_path);
+
+// Requests and responses are framed as a 32-bit payload length followed by
+// the payload, both in native byte order; client and server always share a
+// host.  A connection carries any number of request/response exchanges.
+// These functions throw std::runtime_error on I/O errors or malformed
+// messages.
+void send_request(int fd, const SearchRequest &request);
+void send_response(int fd, const SearchResponse &response);
+
+// Returns nullopt if the peer closed the connection between requests.
+std::optional<SearchRequest> receive_request(int fd);
+SearchResponse receive_response(int fd);
+
+// Requests name their database in at most this many bytes.
+constexpr std::uint32_t MaxDatabaseNameBytes = 255;
+
+// The payload size of the largest valid request whose query fingerprints
+// have num_bits bits.
+std::uint32_t max_request_bytes(unsigned int num_bits);
+
+// Assembles requests from a connection using only the bytes that have
+// already arrived, so that one thread can wait on many connections with
+// poll().  At most one request is buffered at a time.
+class RequestReader {
+public:
+  // Requests whose payload is larger than max_payload_bytes are rejected.
+  explicit RequestReader(std::uint32_t max_payload_bytes)
+      : m_max_payload_bytes(max_payload_bytes), m_num_read(0) {}
+
+  // Read as much of the next request as fd has available, without
+  // blocking.  Returns false if the peer closed the connection between
+  // requests.  Throws std::runtime_error on I/O errors, on oversized
+  // requests, and if the peer closed the connection in mid-message.
+  bool read_available(int fd);
+
+  // Returns the next request, once it has been read completely.
+  // Throws std::runtime_error if the request is malformed.
+  std::optional<SearchRequest> take_request();
+
+private:
+  std::uint32_t m_max_payload_bytes;
+  // The payload length prefix, then the payload.
+  char m_size_bytes[sizeof(std::uint32_t)];
+  std::string m_payload;
+  std::size_t m_num_read;
+
+  bool is_complete() const {
+    return m_num_read == sizeof(m_size_bytes) + m_payload.size();
+  }
+};
+} // namespace mesaac::cli::measures
@@ -0,0 +1,225 @@
+// Search the databases of a running shape_search_server.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+
+#include "fingerprint_reader.hpp"
+#include "shape_search.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+using mesaac::cli::measures::SearchRequest;
+using mesaac::cli::measures::SearchResponse;
+
+enum class OutputFormat {
+  sparse_matrix,
+  pvm,
+};
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  char measure_code;
+  float tversky_alpha;
+  bool compute_similarity;
+  float threshold;
+  unsigned int max_hits;
+  string database;
+  OutputFormat out_format;
+  filesystem::path socket_path;
+  filesystem::path queries_path;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Choice::Ptr measure_choice = Choice::create(
+      "-m", "--measure", "the measure to use",
+      {
+          {"B", "BUB measure"},
+          {"C", "Cosine measure"},
+          {"E", "Euclidean measure"},
+          {"H", "Hamann measure"},
+          {"T", "Tanimoto measure - default"},
+          {"V",
+           "Tversky measure - can be used in conjunction with -a | --alpha"},
+      });
+
+  Option<float>::Ptr alpha_opt = Option<float>::create(
+      "-a", "--alpha",
+      "alpha value to use for measure V (Tversky) - default is 0.0");
+
+  Flag::Ptr dissim = Flag::create(
+      "-d", "--dissimilarity",
+      "compute dissimilarity values - default is to compute similarity");
+
+  Option<float>::Ptr threshold_opt = Option<float>::create(
+      "-t", "--threshold",
+      ("report only hits at least this similar, or no more than this "
+       "dissimilar -\n"
+       "        default is 0.0 for similarity, 1.0 for dissimilarity"));
+
+  Option<unsigned int>::Ptr max_hits_opt = Option<unsigned int>::create(
+      "-k", "--max-hits",
+      ("report only the MAX-HITS best hits for each query, best first - "
+       "default is to\n"
+       "        report every hit, in database order"));
+
+  Option<string>::Ptr database_opt = Option<string>::create(
+      "-D", "--database",
+      ("name of the server database to search, i.e. its file name without "
+       "extension -\n"
+       "        default is the server's first database"));
+
+  Choice::Ptr format_choice =
+      Choice::create("-f", "--format", "how to format the output",
+                     {
+                         {"S", "sparse matrix, as for measures_shape_fp "
+                               "--search - default"},
+                         {"P", "PVM"},
+                     });
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  Argument<filesystem::path>::Ptr socket_arg =
+      Argument<filesystem::path>::create(
+          "socket", "Unix domain socket of a running shape_search_server");
+
+  Argument<filesystem::path>::Ptr queries_arg =
+      Argument<filesystem::path>::create(
+          "query_fingerprints",
+          "plaintext file of query shape fingerprints - '-' for standard "
+          "input");
+
+  ArgParser parser = ArgParser(
+      {measure_choice, alpha_opt, dissim, threshold_opt, max_hits_opt,
+       database_opt, format_choice, stats_opt},
+      {socket_arg, queries_arg},
+      "Search a shape_search_server database with each query shape "
+      "fingerprint,\n"
+      "printing one row of hits per query.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .measure_code = 'T',
+                     .tversky_alpha = 0.0,
+                     .compute_similarity = true,
+                     .threshold = 0.0,
+                     .max_hits = 0,
+                     .database = "",
+                     .out_format = OutputFormat::sparse_matrix,
+                     .socket_path = filesystem::path(""),
+                     .queries_path = filesystem::path(""),
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+
+    result.measure_code = measure_choice->value_or("T").at(0);
+    result.tversky_alpha = alpha_opt->value_or(0.0);
+    result.compute_similarity = !dissim->value();
+    result.threshold =
+        threshold_opt->value_or(result.compute_similarity ? 0.0 : 1.0);
+    result.max_hits = max_hits_opt->value_or(0);
+    result.database = database_opt->value_or("");
+    result.out_format = (format_choice->value_or("S") == "P")
+                            ? OutputFormat::pvm
+                            : OutputFormat::sparse_matrix;
+    result.socket_path = socket_arg->value();
+    result.queries_path = queries_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
+  }
+};
+
+void write_hits(const CmdParams &params, unsigned int query_index,
+                const SearchResponse &response) {
+  if (params.out_format == OutputFormat::sparse_matrix) {
+    cout << query_index << " ";
+  }
+  for (const auto &hit : response.hits) {
+    cout << hit.index << " " << hit.value << " ";
+  }
+  cout << -1 << endl;
+}
+
+void run_queries(const CmdParams &params) {
+  static mesaac::common::stats::Stage &query_stage(
+      mesaac::common::stats::stage("shape_search_client::query"));
+
+  // Report a lost server as an error, not a fatal signal.
+  signal(SIGPIPE, SIG_IGN);
+  const auto connection =
+      mesaac::cli::measures::connect_to(params.socket_path);
+  SearchRequest request{.database = params.database,
+                        .measure_code = params.measure_code,
+                        .tversky_alpha = params.tversky_alpha,
+                        .compute_similarity = params.compute_similarity,
+                        .threshold = params.threshold,
+                        .max_hits = params.max_hits,
+                        .query = {}};
+  unsigned int query_index = 0;
+  mesaac::cli::measures::for_each_fingerprint_block(
+      params.queries_path,
+      [&](const mesaac::shape_defs::ArrayBitVectors &block) {
+        request.query = block;
+        SearchResponse response;
+        {
+          const mesaac::common::stats::ScopedTimer timer(query_stage);
+          mesaac::cli::measures::send_request(connection.fd(), request);
+          response = mesaac::cli::measures::receive_response(connection.fd());
+        }
+        if (!response.error.empty()) {
+          throw runtime_error(response.error);
+        }
+        write_hits(params, query_index, response);
+        query_index++;
+      });
+}
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  try {
+    run_queries(params);
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
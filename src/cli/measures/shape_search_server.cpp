@@ -0,0 +1,500 @@
+// Answer shape fingerprint similarity searches over a Unix domain socket,
+// keeping packed and segmented databases memory-mapped between queries.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+
+#include <algorithm>
+#include <condition_variable>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "mesaac_measures/segmented_shape_fps.hpp"
+#include "mesaac_measures/shape_fp_index.hpp"
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+
+#include "shape_search.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+using mesaac::cli::measures::RequestReader;
+using mesaac::cli::measures::SearchRequest;
+using mesaac::cli::measures::SearchResponse;
+using mesaac::cli::measures::Socket;
+using mesaac::measures::shape::IShapeFPIndex;
+using mesaac::measures::shape::SegmentedShapeFPs;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  unsigned int num_threads;
+  filesystem::path socket_path;
+  vector<filesystem::path> database_paths;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Option<unsigned int>::Ptr threads_opt = Option<unsigned int>::create(
+      "-j", "--threads",
+      "number of requests to answer concurrently - default is the number "
+      "of processors");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  Argument<filesystem::path>::Ptr socket_arg =
+      Argument<filesystem::path>::create(
+          "socket", "path of the Unix domain socket at which to listen");
+
+  MultiValuedArgument<filesystem::path>::Ptr databases_arg =
+      MultiValuedArgument<filesystem::path>::create(
+          "database",
+          "packed shape fingerprint database from shape_fp_pack, segmented\n"
+          "        database directory from shape_fp_append, or index from\n"
+          "        shape_fp_index - clients choose a database by its name "
+          "without\n"
+          "        extension; the first is the default");
+
+  ArgParser parser = ArgParser(
+      {threads_opt, stats_opt}, {socket_arg, databases_arg},
+      "Load packed shape fingerprint databases once, and answer threshold "
+      "and\n"
+      "best-hits similarity searches from shape_search_client until "
+      "interrupted.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .num_threads = 0,
+                     .socket_path = filesystem::path(""),
+                     .database_paths = {},
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+
+    result.num_threads =
+        threads_opt->value_or(max(1U, thread::hardware_concurrency()));
+    if (result.num_threads == 0) {
+      parser.show_usage("THREADS must be greater than 0");
+      result.parse_status = 1;
+      return result;
+    }
+    result.socket_path = socket_arg->value();
+    result.database_paths = databases_arg->values();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
+  }
+};
+
+volatile sig_atomic_t g_stop_requested = 0;
+
+extern "C" void request_stop(int) { g_stop_requested = 1; }
+
+// The memory-mapped databases, by name.
+class Databases {
+public:
+  explicit Databases(const vector<filesystem::path> &paths) {
+    for (const auto &path : paths) {
+      const string name(get_name(path));
+      if (m_dbs.contains(name)) {
+        throw runtime_error(
+            format("More than one database is named '{}'.", name));
+      }
+      Entry &entry(m_dbs[name]);
+      entry.path = path;
+      if (mesaac::measures::shape::is_shape_fp_index(path)) {
+        entry.index = mesaac::measures::shape::open_shape_fp_index(path);
+      } else {
+        entry.db = make_shared<const SegmentedShapeFPs>(path);
+      }
+      if (m_default_name.empty()) {
+        m_default_name = name;
+      }
+      cerr << "Loaded " << entry.size() << " shape fingerprints from "
+           << path.string() << " as '" << name << "'." << endl;
+    }
+  }
+
+  // A database is either an index or a packed or segmented
+  // database.  Searches hold their own references, so a reload never pulls
+  // segments out from under a search in progress.
+  struct Entry {
+    filesystem::path path;
+    shared_ptr<const IShapeFPIndex> index;
+    shared_ptr<const SegmentedShapeFPs> db;
+
+    unsigned int size() const { return index ? index->size() : db->size(); }
+    unsigned int num_bits() const {
+      return index ? index->num_bits() : db->num_bits();
+    }
+  };
+
+  // The largest number of bits in any database's fingerprints.
+  unsigned int max_num_bits() {
+    const lock_guard<mutex> guard(m_lock);
+    unsigned int result = 0;
+    for (const auto &[name, entry] : m_dbs) {
+      result = max(result, entry.num_bits());
+    }
+    return result;
+  }
+
+  // Returns nullopt if there is no such database.  A segmented database
+  // that has been appended to or compacted is reopened first, so searches
+  // always cover its live segments.  The staleness check and the reload
+  // happen outside the lock, so other searches are not held up by file I/O.
+  optional<Entry> find(const string &name) {
+    const string key(name.empty() ? m_default_name : name);
+    Entry entry;
+    {
+      const lock_guard<mutex> guard(m_lock);
+      const auto found = m_dbs.find(key);
+      if (found == m_dbs.end()) {
+        return nullopt;
+      }
+      entry = found->second;
+    }
+    if (!entry.db || !entry.db->is_stale()) {
+      return entry;
+    }
+    return reload(key, entry.db);
+  }
+private:
+  mutex m_lock;
+  map<string, Entry> m_dbs;
+  string m_default_name;
+
+  // Names of databases being reloaded.  Meanwhile, searches of them use
+  // the previous segments.
+  set<string> m_reloading;
+
+  // Reopen a stale segmented database, unless another thread already has.
+  Entry reload(const string &key,
+               const shared_ptr<const SegmentedShapeFPs> &stale) {
+    filesystem::path path;
+    {
+      const lock_guard<mutex> guard(m_lock);
+      const Entry &current(m_dbs.at(key));
+      if ((current.db != stale) || m_reloading.contains(key)) {
+        return current;
+      }
+      m_reloading.insert(key);
+      path = current.path;
+    }
+
+    shared_ptr<const SegmentedShapeFPs> db;
+    try {
+      db = make_shared<const SegmentedShapeFPs>(path);
+      cerr << "Reloaded " << db->size() << " shape fingerprints from "
+           << path.string() << "." << endl;
+    } catch (const exception &e) {
+      // Keep serving the previous segments until a reload succeeds.
+      cerr << "Warning: cannot reload " << path.string() << ": " << e.what()
+           << endl;
+    }
+
+    const lock_guard<mutex> guard(m_lock);
+    m_reloading.erase(key);
+    Entry &current(m_dbs.at(key));
+    if (db) {
+      current.db = db;
+    }
+    return current;
+  }
+
+  // A database is named by its file or directory name, without extension.
+  static string get_name(const filesystem::path &path) {
+    const filesystem::path named(path.has_filename() ? path
+                                                     : path.parent_path());
+    return named.stem().string();
+  }
+};
+
+// A client connection, and whatever part of its next request has arrived.
+struct Connection {
+  Socket socket;
+  RequestReader reader;
+};
+
+// A request, and the connection on which to answer it.
+struct Work {
+  Connection connection;
+  SearchRequest request;
+};
+
+// Requests wait here for a worker thread.  A connection is held by a worker
+// only while one of its requests is answered; the worker then hands it back
+// for the poller to wait on, so idle clients never tie up a worker.
+class WorkQueue {
+public:
+  WorkQueue() {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      throw runtime_error(
+          format("Cannot create wakeup socket: {}", strerror(errno)));
+    }
+    m_wake_reader = Socket(fds[0]);
+    m_wake_writer = Socket(fds[1]);
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(fds[1], F_SETFL, O_NONBLOCK);
+  }
+
+  void push(Work &&work) {
+    {
+      const lock_guard<mutex> guard(m_lock);
+      m_waiting.push_back(std::move(work));
+    }
+    m_ready.notify_one();
+  }
+
+  // Get the next request to answer.  Returns nullopt once the queue has
+  // been closed.  Callers must call finished() when done with the result.
+  optional<Work> pop() {
+    unique_lock<mutex> guard(m_lock);
+    m_ready.wait(guard, [this]() { return m_closed || !m_waiting.empty(); });
+    if (m_closed) {
+      return nullopt;
+    }
+    Work result(std::move(m_waiting.front()));
+    m_waiting.pop_front();
+    m_active.insert(result.connection.socket.fd());
+    return result;
+  }
+
+  // Hand back a connection whose request has been answered.  Unless
+  // keep_open is false, the poller waits for its next request.
+  void finished(Connection &&connection, bool keep_open) {
+    const lock_guard<mutex> guard(m_lock);
+    m_active.erase(connection.socket.fd());
+    if (keep_open && !m_closed) {
+      m_returned.push_back(std::move(connection));
+      // A full wakeup socket already has the poller's attention.
+      [[maybe_unused]] const auto written =
+          ::write(m_wake_writer.fd(), "", 1);
+    }
+  }
+
+  // Readable when connections have been handed back.
+  int wakeup_fd() const { return m_wake_reader.fd(); }
+
+  // Move handed-back connections to idle.
+  void take_returned(vector<Connection> &idle) {
+    char buffer[256];
+    while (::read(m_wake_reader.fd(), buffer, sizeof(buffer)) > 0) {
+    }
+    const lock_guard<mutex> guard(m_lock);
+    for (auto &connection : m_returned) {
+      idle.push_back(std::move(connection));
+    }
+    m_returned.clear();
+  }
+
+  // Stop handing out requests, and wake workers blocked on clients.
+  void close() {
+    {
+      const lock_guard<mutex> guard(m_lock);
+      m_closed = true;
+      m_waiting.clear();
+      m_returned.clear();
+      for (const int fd : m_active) {
+        ::shutdown(fd, SHUT_RDWR);
+      }
+    }
+    m_ready.notify_all();
+  }
+
+private:
+  mutex m_lock;
+  condition_variable m_ready;
+  deque<Work> m_waiting;
+  set<int> m_active;
+  vector<Connection> m_returned;
+  Socket m_wake_reader;
+  Socket m_wake_writer;
+  bool m_closed = false;
+};
+
+// A client that stops reading its response is dropped after this long,
+// rather than holding up a worker.
+constexpr int SendTimeoutSecs = 10;
+
+void set_send_timeout(int fd) {
+  const timeval timeout{.tv_sec = SendTimeoutSecs, .tv_usec = 0};
+  ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+// Read what has arrived on a readable connection.  A complete request is
+// queued for a worker; otherwise the connection goes back to idle, unless
+// the client has closed it or sent a bad request.
+void receive(Connection &&connection, WorkQueue &queue,
+             vector<Connection> &idle) {
+  try {
+    if (!connection.reader.read_available(connection.socket.fd())) {
+      return;
+    }
+    if (auto request = connection.reader.take_request()) {
+      queue.push({std::move(connection), std::move(request.value())});
+    } else {
+      idle.push_back(std::move(connection));
+    }
+  } catch (const exception &e) {
+    cerr << "Warning: dropping connection: " << e.what() << endl;
+  }
+}
+
+// Returns false if the response could not be sent.
+bool answer(Databases &databases, int fd, const SearchRequest &request) {
+  SearchResponse response;
+  const auto entry = databases.find(request.database);
+  if (entry && entry->index) {
+    response = mesaac::cli::measures::search(*entry->index, request);
+  } else if (entry) {
+    response = mesaac::cli::measures::search(*entry->db, request);
+  } else {
+    response.error = format("No database is named '{}'.", request.database);
+  }
+  try {
+    mesaac::cli::measures::send_response(fd, response);
+  } catch (const exception &e) {
+    if (!g_stop_requested) {
+      cerr << "Warning: dropping connection: " << e.what() << endl;
+    }
+    return false;
+  }
+  return true;
+}
+
+void serve(const CmdParams &params) {
+  Databases databases(params.database_paths);
+  const Socket listener(mesaac::cli::measures::listen_at(params.socket_path));
+
+  struct sigaction action{};
+  action.sa_handler = request_stop;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+  // A client that disconnects early must not kill the server.
+  signal(SIGPIPE, SIG_IGN);
+
+  WorkQueue queue;
+  vector<thread> workers;
+  for (unsigned int i = 0; i < params.num_threads; ++i) {
+    workers.emplace_back([&queue, &databases]() {
+      while (auto work = queue.pop()) {
+        const bool keep_open =
+            answer(databases, work->connection.socket.fd(), work->request);
+        queue.finished(std::move(work->connection), keep_open);
+      }
+    });
+  }
+  cerr << "Listening at " << params.socket_path.string() << " with "
+       << params.num_threads << " threads." << endl;
+
+  // Wait for new connections and for requests on idle ones, reading only
+  // what has arrived so that no client can hold up the others.  Poll with
+  // a timeout, so that a stop request is noticed promptly.
+  const std::uint32_t max_request_bytes =
+      mesaac::cli::measures::max_request_bytes(databases.max_num_bits());
+  vector<Connection> idle;
+  vector<pollfd> polled;
+  while (!g_stop_requested) {
+    polled.clear();
+    polled.push_back({.fd = listener.fd(), .events = POLLIN, .revents = 0});
+    polled.push_back({.fd = queue.wakeup_fd(), .events = POLLIN, .revents = 0});
+    for (const auto &connection : idle) {
+      polled.push_back(
+          {.fd = connection.socket.fd(), .events = POLLIN, .revents = 0});
+    }
+    if (poll(polled.data(), polled.size(), 250) <= 0) {
+      continue;
+    }
+
+    vector<Connection> still_idle;
+    for (size_t i = 0; i < idle.size(); ++i) {
+      if (polled[i + 2].revents == 0) {
+        still_idle.push_back(std::move(idle[i]));
+      } else {
+        receive(std::move(idle[i]), queue, still_idle);
+      }
+    }
+    idle.swap(still_idle);
+
+    if (polled[1].revents != 0) {
+      queue.take_returned(idle);
+    }
+    if (polled[0].revents != 0) {
+      const int fd = ::accept(listener.fd(), nullptr, nullptr);
+      if (fd >= 0) {
+        set_send_timeout(fd);
+        idle.push_back({Socket(fd), RequestReader(max_request_bytes)});
+      }
+    }
+  }
+
+  queue.close();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  filesystem::remove(params.socket_path);
+  cerr << "Stopped." << endl;
+}
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  try {
+    serve(params);
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
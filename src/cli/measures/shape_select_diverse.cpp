@@ -0,0 +1,179 @@
+// Select a diverse subset of a set of shape fingerprints.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mesaac_measures/diverse_selector.hpp"
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+
+#include "fingerprint_reader.hpp"
+#include "measure_type_converter.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac::arg_parser;
+using mesaac::measures::shape::DiverseSelectionMethod;
+using mesaac::measures::shape::DiverseSelectionParams;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  mesaac::measures::MeasureType measure_type;
+  float tversky_alpha;
+  DiverseSelectionParams selection;
+  filesystem::path fingerprints_path;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Choice::Ptr measure_choice = Choice::create(
+      "-m", "--measure", "the measure to use",
+      {
+          {"B", "BUB measure"},
+          {"C", "Cosine measure"},
+          {"E", "Euclidean measure"},
+          {"H", "Hamann measure"},
+          {"T", "Tanimoto measure - default"},
+          {"V",
+           "Tversky measure - can be used in conjunction with -a | --alpha"},
+      });
+
+  Option<float>::Ptr alpha_opt = Option<float>::create(
+      "-a", "--alpha",
+      "alpha value to use for measure V (Tversky) - default is 0.0");
+
+  Choice::Ptr method_choice = Choice::create(
+      "-p", "--picker", "the selection algorithm to use",
+      {
+          {"M", "MaxMin - default"},
+          {"S", "sphere exclusion"},
+      });
+
+  Option<unsigned int>::Ptr num_opt = Option<unsigned int>::create(
+      "-n", "--num-selected",
+      "maximum number of shapes to select - default is 0, for no limit");
+
+  Option<float>::Ptr threshold_opt = Option<float>::create(
+      "-t", "--threshold",
+      ("dissimilarity threshold - for MaxMin, stop when no remaining shape "
+       "is at least this far from the selected shapes;\n"
+       "        for sphere exclusion, the exclusion radius - default is 0.0"));
+
+  Option<unsigned int>::Ptr first_opt = Option<unsigned int>::create(
+      "-i", "--first", "index of the first shape to select - default is 0");
+
+  Argument<filesystem::path>::Ptr fingerprints_arg =
+      Argument<filesystem::path>::create(
+          "shape_fingerprints",
+          "plaintext file of shape fingerprints, or a packed, compressed or\n"
+          "        segmented database");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  ArgParser parser =
+      ArgParser({measure_choice, alpha_opt, method_choice, num_opt,
+                 threshold_opt, first_opt, stats_opt},
+                {fingerprints_arg},
+                "Print the 0-based indices of a diverse subset of a set of "
+                "shape fingerprints, in order of selection.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{.parse_status = 0,
+                     .usage_requested = false,
+                     .measure_type = mesaac::measures::MeasureType::tanimoto,
+                     .tversky_alpha = 0.0,
+                     .selection = DiverseSelectionParams(),
+                     .fingerprints_path = filesystem::path(""),
+                     .stats_file = nullopt};
+
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
+    }
+
+    const auto measure_str = measure_choice->value_or("T");
+    result.measure_type =
+        mesaac::cli::measures::get_measure_type(measure_str.at(0));
+    result.tversky_alpha = alpha_opt->value_or(0.0);
+
+    const auto method_str = method_choice->value_or("M");
+    result.selection.method = (method_str == "S")
+                                  ? DiverseSelectionMethod::sphere_exclusion
+                                  : DiverseSelectionMethod::max_min;
+    result.selection.max_selected = num_opt->value_or(0);
+    result.selection.threshold = threshold_opt->value_or(0.0);
+    result.selection.first_index = first_opt->value_or(0);
+
+    result.fingerprints_path = fingerprints_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
+  }
+};
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  mesaac::shape_defs::ShapeFPBlocks fingerprints;
+  mesaac::cli::measures::read_fingerprint_blocks(params.fingerprints_path,
+                                                 fingerprints);
+
+  auto measure =
+      mesaac::measures::get_measures(params.measure_type, params.tversky_alpha);
+  // Diversity selection always works with distances.
+  auto measurer =
+      mesaac::measures::shape::get_shape_measurer(measure, false, fingerprints);
+  if (0 == measurer) {
+    cerr << "Internal error - could not create shape measurer." << endl;
+    return 2;
+  }
+
+  try {
+    const auto selected = mesaac::measures::shape::select_diverse(
+        *measurer, fingerprints.size(), params.selection);
+    for (const auto index : selected) {
+      cout << index << endl;
+    }
+  } catch (const invalid_argument &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  if (params.stats_file) {
+    try {
+      mesaac::common::stats::write_report(params.stats_file.value());
+    } catch (const exception &e) {
+      cerr << "Error: " << e.what() << endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,198 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "shard.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace mesaac::cli::measures {
+
+namespace {
+const string HeaderTag("#shard");
+const string SectionTag("#section");
+const string TrailerTag("#end");
+
+bool parse_uint(const string &str, unsigned int &result) {
+  const char *const end = str.data() + str.size();
+  const auto [ptr, ec] = from_chars(str.data(), end, result);
+  return (ec == errc()) && (ptr == end) && !str.empty();
+}
+
+struct ShardFile {
+  filesystem::path path;
+  ifstream inf;
+  Shard shard;
+  RowRange rows;
+  unsigned int num_rows;
+};
+
+using ShardFilePtr = unique_ptr<ShardFile>;
+
+ShardFilePtr open_shard_file(const filesystem::path &path) {
+  auto result = make_unique<ShardFile>();
+  result->path = path;
+  result->inf.open(path);
+  if (!result->inf) {
+    throw runtime_error(format("Cannot open shard file {}.", path.string()));
+  }
+
+  string line;
+  getline(result->inf, line);
+  istringstream ins(line);
+  string tag, shard_spec, rows_tag, of_tag;
+  auto &rows(result->rows);
+  if (!(ins >> tag >> shard_spec >> rows_tag >> rows.begin >> rows.end >>
+        of_tag >> result->num_rows) ||
+      (tag != HeaderTag) || (rows_tag != "rows") || (of_tag != "of")) {
+    throw runtime_error(
+        format("{} is not a shard output file.", path.string()));
+  }
+  try {
+    result->shard = parse_shard(shard_spec);
+  } catch (const invalid_argument &e) {
+    throw runtime_error(format("{}: {}", path.string(), e.what()));
+  }
+  return result;
+}
+
+// A shard whose process was killed or ran out of disk space has no trailer.
+bool has_trailer(const filesystem::path &path) {
+  const string expected(TrailerTag + "\n");
+  ifstream inf(path, ios::binary | ios::ate);
+  const auto size = inf.tellg();
+  if (!inf || (size < streamoff(expected.size()))) {
+    return false;
+  }
+  string actual(expected.size(), '\0');
+  inf.seekg(size - streamoff(expected.size()));
+  inf.read(actual.data(), actual.size());
+  return inf && (actual == expected);
+}
+
+void verify_complete_job(const vector<ShardFilePtr> &shard_files) {
+  const auto &first(*shard_files.front());
+  const unsigned int count = first.shard.count;
+  if (shard_files.size() != count) {
+    throw runtime_error(format("Expected {} shard files, got {}.", count,
+                               shard_files.size()));
+  }
+  for (unsigned int i = 0; i != shard_files.size(); ++i) {
+    const auto &shard_file(*shard_files[i]);
+    const auto &path_str(shard_file.path.string());
+    if ((shard_file.shard.count != count) ||
+        (shard_file.num_rows != first.num_rows)) {
+      throw runtime_error(format("{} belongs to a different job than {}.",
+                                 path_str, first.path.string()));
+    }
+    if (shard_file.shard.index != i + 1) {
+      throw runtime_error(format("Shard {}/{} is missing or duplicated.",
+                                 i + 1, count));
+    }
+    const RowRange expected(
+        get_shard_rows(shard_file.shard, shard_file.num_rows));
+    if ((shard_file.rows.begin != expected.begin) ||
+        (shard_file.rows.end != expected.end)) {
+      throw runtime_error(
+          format("{} has rows {}..{}; expected {}..{}.", path_str,
+                 shard_file.rows.begin, shard_file.rows.end, expected.begin,
+                 expected.end));
+    }
+    if (!has_trailer(shard_file.path)) {
+      throw runtime_error(format("{} is incomplete.", path_str));
+    }
+  }
+}
+
+// Copy lines from shard_file to outs up to the next section break or
+// trailer.  Return true if the section ended with a section break.
+bool copy_section(ShardFile &shard_file, ostream &outs) {
+  string line;
+  while (getline(shard_file.inf, line)) {
+    if (line == SectionTag) {
+      return true;
+    }
+    if (line == TrailerTag) {
+      return false;
+    }
+    outs << line << '\n';
+  }
+  throw runtime_error(
+      format("{} ended unexpectedly.", shard_file.path.string()));
+}
+} // namespace
+
+Shard parse_shard(const string &spec) {
+  const auto slash = spec.find('/');
+  Shard result{.index = 0, .count = 0};
+  if ((slash == string::npos) ||
+      !parse_uint(spec.substr(0, slash), result.index) ||
+      !parse_uint(spec.substr(slash + 1), result.count) ||
+      (result.index < 1) || (result.index > result.count)) {
+    throw invalid_argument(format(
+        "Invalid shard '{}': expected I/N with 1 <= I <= N.", spec));
+  }
+  return result;
+}
+
+RowRange get_shard_rows(const Shard &shard, unsigned int num_rows) {
+  // Every row of a matrix job compares one fingerprint against the same set
+  // of fingerprints, so equal row counts mean equal work.
+  const uint64_t rows(num_rows);
+  return RowRange{
+      .begin = static_cast<unsigned int>(rows * (shard.index - 1) /
+                                         shard.count),
+      .end = static_cast<unsigned int>(rows * shard.index / shard.count)};
+}
+
+void write_shard_header(ostream &outs, const Shard &shard,
+                        const RowRange &rows, unsigned int num_rows) {
+  outs << HeaderTag << " " << shard.index << "/" << shard.count << " rows "
+       << rows.begin << " " << rows.end << " of " << num_rows << '\n';
+}
+
+void write_shard_section_break(ostream &outs) { outs << SectionTag << '\n'; }
+
+void write_shard_trailer(ostream &outs) { outs << TrailerTag << endl; }
+
+void merge_shards(const vector<filesystem::path> &shard_paths,
+                  ostream &outs) {
+  if (shard_paths.empty()) {
+    throw runtime_error("No shard files to merge.");
+  }
+  vector<ShardFilePtr> shard_files;
+  for (const auto &path : shard_paths) {
+    shard_files.push_back(open_shard_file(path));
+  }
+  sort(shard_files.begin(), shard_files.end(),
+       [](const ShardFilePtr &a, const ShardFilePtr &b) {
+         return a->shard.index < b->shard.index;
+       });
+  verify_complete_job(shard_files);
+
+  // Each section of the merged output is that section of every shard, in
+  // shard order.
+  bool more_sections = true;
+  while (more_sections) {
+    more_sections = copy_section(*shard_files.front(), outs);
+    for (size_t i = 1; i != shard_files.size(); ++i) {
+      if (copy_section(*shard_files[i], outs) != more_sections) {
+        throw runtime_error(
+            format("{} and {} have different numbers of sections.",
+                   shard_files.front()->path.string(),
+                   shard_files[i]->path.string()));
+      }
+    }
+  }
+  outs.flush();
+}
+} // namespace mesaac::cli::measures
@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mesaac::cli::measures {
+// One of several independent processes that together compute a job.
+// index is 1-based: "--shard 2/4" is Shard{.index = 2, .count = 4}.
+struct Shard {
+  unsigned int index;
+  unsigned int count;
+};
+
+// The half-open range of output rows begin..(end - 1) computed by a shard.
+struct RowRange {
+  unsigned int begin;
+  unsigned int end;
+};
+
+// Parse a shard specification of the form "I/N", 1 <= I <= N.
+// Throws std::invalid_argument if spec is malformed.
+Shard parse_shard(const std::string &spec);
+
+// Get the rows of a num_rows-row job that shard should compute.  Every
+// shard gets a contiguous range, and shard sizes differ by at most one row.
+RowRange get_shard_rows(const Shard &shard, unsigned int num_rows);
+
+// Sharded output is framed by a header, optional section breaks, and a
+// trailer, so that measures_merge can verify that it has a complete set of
+// shards and interleave their sections.  A shard that writes several
+// sections -- e.g. measures_sim's Tversky complement rows -- must write the
+// same number of sections as every other shard in its job.
+void write_shard_header(std::ostream &outs, const Shard &shard,
+                        const RowRange &rows, unsigned int num_rows);
+void write_shard_section_break(std::ostream &outs);
+void write_shard_trailer(std::ostream &outs);
+
+// Combine the outputs of every shard of a job into the output the job
+// would have produced as a single process.  Shard files may be listed in
+// any order.
+// Throws std::runtime_error if the shard files are unreadable, incomplete,
+// or do not form exactly one complete job.
+void merge_shards(const std::vector<std::filesystem::path> &shard_paths,
+                  std::ostream &outs);
+} // namespace mesaac::cli::measures
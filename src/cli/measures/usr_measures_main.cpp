@@ -1,201 +1,226 @@
-#include <fstream>
-#include <string>
-#include <vector>
-#include <iostream>
-#include <cmath>
+// Print USR (Ultrafast Shape Recognition) measures for a set of descriptor
+// vectors.
+// Copyright (c) 2011 Mesa Analytics & Computing, Inc.  All rights reserved
+
 #include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "mesaac_measures/usr_measures.hpp"
 
-#include "USR_Smeasure.h"
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
 
-#include "mesaac_common/mesaac_common.h"
+#include "matrix_writer.hpp"
+#include "shard.hpp"
+#include "usr_vector_reader.hpp"
 
 using namespace std;
 
-string Version = "1.0";
-string CreationDate = "April, 2011";
-
-typedef vector< float > FloatVector;
-typedef vector< FloatVector > VectorList;
-
-int main(int argc, char **argv){
-  
-  unsigned int i,j, number_Vectors = 0;
-  float SparseThreshold;
-  float tmpmeasure;
-  float value;
-  FloatVector floatVector;
-  VectorList ArrayFloatVectors;
-
-  mesaac::MesaacFeatures f;
-  f.set(mesaac::MFE_GroupingModule);
-  mesaac::initCommon(f);
-
-  cerr << "RunningUSR  Measures.  Source code Copyright (c) 2011 Mesa Analytics & Computing, Inc" << endl
-       << "Version number " << Version << " Creation Date: " << CreationDate << endl
-       << "Expiration Date: " << mesaac::expirationDateStr() << endl;
-
-  if (argc != 7){
-    cerr << "Usage: " << argv[0]
-         << "featurevectorfile.txt measure similarity format sparsethreshold vector_size" << endl
-         << "measure = '-S' for S USR measure,'-E' for Euclidean, '-C' for Cosine" << endl
-         << "similarity = '-S' for similarity, '-D' for dissimilarity" << endl
-         << "format = '-M' for Matrix, '-O' for Ordered Pairs, '-S' for Sparse Matrix" << endl
-         << "sparsethreshold is in the range of (0,1), and format must be = '-S'" << endl
-	 << "vector_size is the length of the feature vector" << endl;
-    exit(1);
-  }
-  
-  // Input from either stdin or file
-  string inputstring = argv[1];
-  ifstream ifs1;
-  if(inputstring != "-"){
-    ifs1.open(argv[1]);
-    if(!ifs1){
-      cerr << "Cannot open feature vector file. Abort." << endl;
-      exit(1);
+namespace {
+using namespace mesaac::arg_parser;
+using mesaac::cli::measures::MatrixFormat;
+using mesaac::cli::measures::OutputFormat;
+using mesaac::cli::measures::RowRange;
+using mesaac::cli::measures::Shard;
+using mesaac::measures::UsrVectors;
+
+struct CmdParams {
+  int parse_status;
+  bool usage_requested;
+
+  bool compute_similarity;
+  OutputFormat out_format;
+  optional<float> sparse_threshold;
+  unsigned int top_k;
+  optional<Shard> shard;
+  optional<filesystem::path> query_file;
+  filesystem::path usr_file;
+  optional<filesystem::path> stats_file;
+};
+
+struct CmdLineParser {
+  Flag::Ptr dissim = Flag::create(
+      "-d", "--dissimilarity",
+      "compute dissimilarity values - default is to compute similarity");
+
+  Choice::Ptr format_choice = Choice::create(
+      "-f", "--format", "how to format the output - default is 'S'",
+      {
+          {"M", "full matrix"},
+          {"S", "sparse matrix"},
+          {"O", "ordered pairs"},
+      });
+
+  Option<float>::Ptr sparse_opt = Option<float>::create(
+      "-t", "--threshold",
+      "(dis)similarity sparse threshold to use for output format S - "
+      "default is 1.0, or no threshold if --top is given");
+
+  Option<unsigned int>::Ptr top_k_opt = Option<unsigned int>::create(
+      "-k", "--top",
+      "for output format S, list only the K nearest vectors of each row, "
+      "nearest first");
+
+  Option<filesystem::path>::Ptr query_opt = Option<filesystem::path>::create(
+      "-q", "--queries",
+      "file of query vectors - if given, output rows are queries and "
+      "columns are the vectors of usr_file");
+
+  Option<string>::Ptr shard_opt = Option<string>::create(
+      "-p", "--shard",
+      ("compute only part I of N of the output rows, for combining with "
+       "measures_merge -\n"
+       "        given as I/N, e.g. 2/4"));
+
+  Argument<filesystem::path>::Ptr usr_path_arg =
+      Argument<filesystem::path>::create(
+          "usr_file",
+          "USR descriptor vectors, either packed by usr_descriptors or as "
+          "plain text with one vector per line");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  ArgParser parser = ArgParser(
+      {dissim, format_choice, sparse_opt, top_k_opt, query_opt, shard_opt,
+       stats_opt},
+      {usr_path_arg},
+      "Print USR (Ultrafast Shape Recognition) measures for a set of "
+      "descriptor vectors.");
+
+  CmdParams parse_args(int argc, const char *argv[]) {
+    CmdParams result{
+        .parse_status = 0,
+        .usage_requested = false,
+        .compute_similarity = true,
+        .out_format = OutputFormat::sparse_matrix,
+        .sparse_threshold = 1.0,
+        .top_k = 0,
+        .shard = nullopt,
+        .query_file = nullopt,
+        .usr_file = filesystem::path(""),
+        .stats_file = nullopt,
+    };
+    result.parse_status = parser.parse_args(argc, argv);
+    result.usage_requested = parser.usage_requested();
+    if (result.parse_status != 0 || result.usage_requested) {
+      return result;
     }
-  }                       
-  
-  string distanceMeasure = argv[2];
-  string similarity = argv[3];
-  string format = argv[4];
-
-  if(similarity[1] != 'S' && similarity[1] != 'D'){
-    cerr << "similarity option is not either S or D. Default to Dissimilarity" << endl;
-  }    
-  SparseThreshold = atof(argv[5]);
-  unsigned int vector_size = atoi(argv[6]);
-
-  //Read in feature vectors from feature vector file. 
-  if(inputstring == "-"){
-    //Read in single value from vector from standard input
-    i = 0;
-    while(cin >> value){
-      if(i < vector_size){
-	floatVector.push_back(value);
-	i++;
-      }
-      else{
-	ArrayFloatVectors.push_back(floatVector);
-	floatVector.erase(floatVector.begin(),floatVector.end());
-	floatVector.push_back(value);
-	i = 1;
-	number_Vectors++;
+    result.compute_similarity = !dissim->value();
+
+    const auto format_str = format_choice->value_or("S");
+    if (format_str == "M") {
+      result.out_format = OutputFormat::matrix;
+    } else if (format_str == "O") {
+      result.out_format = OutputFormat::ordered_pair;
+    } else if (format_str == "S") {
+      result.out_format = OutputFormat::sparse_matrix;
+    } else {
+      // Should not get here.
+      parser.show_usage("Unknown format value '" + format_str + "'");
+      result.parse_status = 1;
+      return result;
+    }
+    result.top_k = top_k_opt->value_or(0);
+    if (sparse_opt->has_value()) {
+      result.sparse_threshold = sparse_opt->value();
+    } else if (result.top_k > 0) {
+      result.sparse_threshold = nullopt;
+    }
+    if (query_opt->has_value()) {
+      result.query_file = query_opt->value();
+    }
+    if (shard_opt->has_value()) {
+      try {
+        result.shard = mesaac::cli::measures::parse_shard(shard_opt->value());
+      } catch (invalid_argument &e) {
+        parser.show_usage(e);
+        result.parse_status = 1;
+        return result;
       }
     }
-    //Insert the last remaining floatVector and erase the floatVector.
-    ArrayFloatVectors.push_back(floatVector);
-    floatVector.erase(floatVector.begin(),floatVector.end());
-    number_Vectors++;
+    result.usr_file = usr_path_arg->value();
+    if (stats_opt->has_value()) {
+      result.stats_file = stats_opt->value();
+    }
+    return result;
   }
-  else{// Same as above, only read in from a file.
-    i = 0;
-    while(ifs1 >> value){
-      if(i < vector_size){
-        floatVector.push_back(value);
-        i++;
-      }
-      else{
-        ArrayFloatVectors.push_back(floatVector);
-        floatVector.erase(floatVector.begin(),floatVector.end());
-        floatVector.push_back(value);
-	i = 1;
-        number_Vectors++;
+};
+
+void compute_and_output(const CmdParams &params, const UsrVectors &rows,
+                        const UsrVectors &cols) {
+  const unsigned int num_rows = rows.size();
+  RowRange row_range{.begin = 0, .end = num_rows};
+  if (params.shard) {
+    row_range =
+        mesaac::cli::measures::get_shard_rows(params.shard.value(), num_rows);
+    mesaac::cli::measures::write_shard_header(cout, params.shard.value(),
+                                              row_range, num_rows);
+  }
+
+  const bool compute_sim = params.compute_similarity;
+  const auto compute_rows = [&rows, &cols, compute_sim](
+                                unsigned int begin, unsigned int end,
+                                span<float> values) {
+    mesaac::measures::usr_similarities(rows, begin, end, cols, values);
+    if (!compute_sim) {
+      const size_t num_values = size_t(end - begin) * cols.size();
+      for (size_t k = 0; k < num_values; k++) {
+        values[k] = 1.0 - values[k];
       }
     }
-    //Insert the last remaining floatVector and erase the floatVector.
-    ArrayFloatVectors.push_back(floatVector);
-    floatVector.erase(floatVector.begin(),floatVector.end());
-    number_Vectors++;
+  };
+  const MatrixFormat format{
+      .format = params.out_format,
+      .is_similarity = compute_sim,
+      .sparse_threshold = params.sparse_threshold,
+      .top_k = params.top_k,
+      // A query is not the same vector as the column of the same index.
+      .skip_diagonal = !params.query_file,
+  };
+  mesaac::cli::measures::write_matrix_rows(cout, format, row_range,
+                                           cols.size(), compute_rows);
+  if (params.shard) {
+    mesaac::cli::measures::write_shard_trailer(cout);
   }
-  
-
-  if(distanceMeasure[1] == 'S'){
-    usr_smeasure smeasure;
-    smeasure.init(vector_size);
-    if(similarity[1] == 'S'){//similarity
-      if(format[1] == 'O'){//ordered pair format
-	for(i=0; i < number_Vectors; i++){
-	  for(j=0; j < number_Vectors; j++){
-	    smeasure.init(vector_size);
-	    cout << i << " " << j << " " << 
-	      smeasure.computeMeasure(ArrayFloatVectors[i],ArrayFloatVectors[j]) << endl;
-	  }
-	}
-      }
-      else if(format[1] == 'M'){//Matrix format
-	for(i=0; i < number_Vectors; i++){
-	  for(j=0; j < number_Vectors; j++){
-	    smeasure.init(vector_size);
-            
-	    if(j != number_Vectors - 1)
-	      cout << 
-		smeasure.computeMeasure(ArrayFloatVectors[i],ArrayFloatVectors[j]) << " ";
-	    else
-	      cout << smeasure.computeMeasure(ArrayFloatVectors[i],ArrayFloatVectors[j]);
-	  }
-	  cout << endl;
-	}
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-	for(i=0; i < number_Vectors; i++){
-	  for(j=0; j < number_Vectors; j++){
-	    if(i!=j){
-	      smeasure.init(vector_size);             
-	      tmpmeasure = 
-		smeasure.computeMeasure(ArrayFloatVectors[i],ArrayFloatVectors[j]);      
-	      if(SparseThreshold < tmpmeasure)
-		cout << j << " " << tmpmeasure << " ";
-	    }
-	  }
-	  cout << -1 << endl;
-	}
-      }
+}
+} // namespace
+
+int main(int argc, const char **argv) {
+  CmdLineParser parser;
+  const CmdParams params = parser.parse_args(argc, argv);
+
+  if (params.usage_requested) {
+    return 0;
+  }
+  if (params.parse_status != 0) {
+    return params.parse_status;
+  }
+  if (params.stats_file) {
+    mesaac::common::stats::enable();
+  }
+
+  try {
+    const auto vectors =
+        mesaac::cli::measures::read_usr_vectors(params.usr_file);
+    if (params.query_file) {
+      const auto queries =
+          mesaac::cli::measures::read_usr_vectors(params.query_file.value());
+      compute_and_output(params, queries, vectors);
+    } else {
+      compute_and_output(params, vectors, vectors);
     }
-    else{// dissimilarity
-      if(format[1] == 'O'){//ordered pair format
-	for(i=0; i < number_Vectors; i++){
-	  for(j=0; j < number_Vectors; j++){
-	    smeasure.init(vector_size);
-	    cout << i << " " << j << " " << 
-	      1.0 - smeasure.computeMeasure(ArrayFloatVectors[i],ArrayFloatVectors[j]) << endl;
-	  }
-	}
-      }
-      else if(format[1] == 'M'){//Matrix format
-	for(i=0; i < number_Vectors; i++){
-	  for(j=0; j < number_Vectors; j++){
-	    smeasure.init(vector_size);
-            
-	    if(j != number_Vectors - 1)
-	      cout << 
-		1.0 - smeasure.computeMeasure(ArrayFloatVectors[i],ArrayFloatVectors[j]) << " ";
-	    //1.0 - smeasure.computeMeasure(ArrayFloatVectors[i],ArrayFloatVectors[j]) << " ";
-	    
-	    else
-	      cout << (1.0 - smeasure.computeMeasure(ArrayFloatVectors[i],ArrayFloatVectors[j]));
-	  }
-	  cout << endl;
-	}
-      }
-      else if(format[1] == 'S'){//Sparse Matrix
-	for(i=0; i < number_Vectors; i++){
-	  for(j=0; j < number_Vectors; j++){
-	    if(i!=j){
-	      smeasure.init(vector_size);             
-	      tmpmeasure = 
-		1.0 - smeasure.computeMeasure(ArrayFloatVectors[i],ArrayFloatVectors[j]);        
-	      if(SparseThreshold >= tmpmeasure)
-		cout << j << " " << tmpmeasure << " ";
-	    }
-	  }
-	  cout << -1 << endl;
-	}
-      }
+    if (params.stats_file) {
+      mesaac::common::stats::write_report(params.stats_file.value());
     }
-  }
-  else {
-    cerr << "No measure chosen, check that - option set to either S, E, or C\n";
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
     return 1;
   }
   return 0;
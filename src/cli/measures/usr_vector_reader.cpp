@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "usr_vector_reader.hpp"
+
+#include <format>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace mesaac::cli::measures {
+using mesaac::measures::UsrVectors;
+
+UsrVectors read_usr_vectors(const string &pathname) {
+  if (UsrVectors::is_packed(pathname)) {
+    return UsrVectors(pathname);
+  }
+
+  ifstream inf(pathname);
+  if (!inf) {
+    throw runtime_error(format("Cannot open USR vector file {}", pathname));
+  }
+  optional<UsrVectors> result;
+  vector<float> line_values;
+  unsigned int line_num = 0;
+  string line;
+  while (getline(inf, line)) {
+    line_num++;
+    if (line.find_first_not_of(" \t\r") == string::npos) {
+      continue;
+    }
+    line_values.clear();
+    istringstream line_ins(line);
+    float value;
+    while (line_ins >> value) {
+      line_values.push_back(value);
+    }
+    if (!line_ins.eof()) {
+      throw runtime_error(format("Line {} of {}: values must be numbers",
+                                 line_num, pathname));
+    }
+    if (!result) {
+      result.emplace(line_values.size());
+    } else if (line_values.size() != result->num_features()) {
+      throw runtime_error(format("Line {} of {} has {} values; expected {}",
+                                 line_num, pathname, line_values.size(),
+                                 result->num_features()));
+    }
+    result->push_back(line_values);
+  }
+  return result ? std::move(result.value()) : UsrVectors(0);
+}
+} // namespace mesaac::cli::measures
@@ -0,0 +1,18 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <string>
+
+#include "mesaac_measures/usr_vectors.hpp"
+
+namespace mesaac::cli::measures {
+// Read USR vectors from the named file.  A packed file written by
+// UsrVectorWriter is memory-mapped.  Otherwise the file must be plain text,
+// with one vector per line and values separated by whitespace.  Every line
+// must have the same number of values.
+// Throws std::runtime_error if the file cannot be read or parsed.
+mesaac::measures::UsrVectors read_usr_vectors(const std::string &pathname);
+} // namespace mesaac::cli::measures
@@ -6,11 +6,15 @@
 
 #include "mesaac_common/b64.hpp"
 #include "mesaac_common/gzip.hpp"
+#include "mesaac_common/stats.hpp"
 #include "mesaac_mol/io/sdreader.hpp"
+#include "mesaac_shape/point_set.hpp"
 
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
 
 #include "mol_fingerprinter.hpp"
 
@@ -19,21 +23,16 @@ using namespace std;
 namespace mesaac::shape_fingerprinter {
 namespace {
 void read_points(string &pathname, string description, PointList &points) {
-  ifstream inf(pathname);
-  if (!inf) {
+  try {
+    points = shape::get_point_cloud(pathname);
+  } catch (const invalid_argument &e) {
+    cerr << e.what() << endl;
+    exit(1);
+  } catch (const runtime_error &e) {
     cerr << "Cannot open " << description << " '" << pathname
          << "' for reading." << endl;
     exit(1);
   }
-
-  float coord;
-  while (inf >> coord) {
-    FloatVector p(3, 0.0);
-    p[0] = coord;
-    inf >> p[1] >> p[2];
-    points.push_back(p);
-  }
-  inf.close();
 }
 
 inline string compressed_fp(shape_defs::BitVector &fp) {
@@ -92,6 +91,8 @@ void SDFShapeFingerprinter::process_molecules(PointList &ellipsoid,
   }
   mol::SDReader reader(inf, m_sd_pathname);
   MolFingerprinter mfp(ellipsoid, sphere, m_epsilon_sqr, m_num_folds);
+  common::stats::Stage &write_stage(
+      common::stats::stage("SDFShapeFingerprinter::write"));
 
   int i = 0;
   while (i < start_index) {
@@ -104,16 +105,22 @@ void SDFShapeFingerprinter::process_molecules(PointList &ellipsoid,
   }
 
   // If end_index < 0, just process everything.
+  mol::Mol mol;
   while (((end_index < 0) || (i < end_index))) {
-    const auto read_result = reader.read();
+    const auto read_result = reader.read(mol);
     if (!read_result.is_ok()) {
       std::cerr << read_result.error() << std::endl;
       break;
     }
-    auto mol = read_result.value();
     mfp.set_molecule(mol);
-    shape_defs::BitVector fp;
-    while (mfp.get_next_fp(fp)) {
+    vector<shape_defs::BitVector> fps;
+    shape_defs::BitVector next_fp;
+    while (mfp.get_next_fp(next_fp)) {
+      fps.push_back(next_fp);
+    }
+
+    const common::stats::ScopedTimer timer(write_stage, fps.size());
+    for (auto &fp : fps) {
       switch (m_format) {
       case FMT_COMPRESSED_ASCII:
         cout << "C" << cbinascii_fp(fp);
@@ -24,6 +24,7 @@
 //     eigenvalues, and rotation matrix per conformer).
 //
 
+#include <filesystem>
 #include <iostream>
 #include <libgen.h>
 #include <sstream>
@@ -33,6 +34,7 @@
 #include "shared_types.hpp"
 
 #include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
 
 using namespace std;
 
@@ -62,13 +64,21 @@ struct CmdLine {
       "use points from the named file, containing 3D Hammersley "
       "ellipsoid points, "
       "one point per line with space-separated coords, for "
-      "fingerprint generation");
+      "fingerprint generation; or use cloud:N,SCALE,A,B,C to generate N "
+      "ellipsoid points in memory; or use halton:N,SCALE,A,B,C to generate N "
+      "prefix-nested Halton points, whose fingerprint prefixes are "
+      "lower-resolution fingerprints");
   MultiValuedOption<unsigned int, 2>::Ptr records_opt =
       MultiValuedOption<unsigned int, 2>::create(
           "-r", "--records",
           "indices of first and last SD file records to process (default: "
           "process "
           "all records)");
+  Option<std::filesystem::path>::Ptr stats_opt =
+      Option<std::filesystem::path>::create(
+          "-S", "--stats",
+          "write a JSON summary of per-stage times and item counts to the "
+          "named file");
 
   Argument<string>::Ptr sd_file = Argument<std::string>::create(
       "sd_file", "file of conformers in SD format, with 3D coordinates");
@@ -76,13 +86,15 @@ struct CmdLine {
       "hamms_sphere_file",
       "file of 3D Hammersley sphere points, one point "
       "per line with space-separated coordinates, for principal "
-      "axes generation via SVD and fingerprint generation");
+      "axes generation via SVD and fingerprint generation; or "
+      "cloud:N,SCALE,A,B,C to generate N sphere points in memory");
   Argument<float>::Ptr atom_scale = Argument<float>::create(
       "atom_scale", "amount (1.0...2.0) by which to "
                     "increase atom radii for alignment");
 
   ArgParser parser = ArgParser(
-      {id_flag, format_opt, num_folds_opt, ellipsoid_opt, records_opt},
+      {id_flag, format_opt, num_folds_opt, ellipsoid_opt, records_opt,
+       stats_opt},
       {sd_file, hamms_sphere_file, atom_scale},
       "Generate shape fingerprints for 3D conformers.");
 };
@@ -132,9 +144,22 @@ int main(int argc, const char **const argv) {
     return 1;
   }
 
+  if (opts.stats_opt->has_value()) {
+    mesaac::common::stats::enable();
+  }
+
   SDFShapeFingerprinter sfper(opts.sd_file->value(), ellipsoid, spheroid,
                               atom_scale, opts.id_flag->value(), format,
                               opts.num_folds_opt->value_or(0));
   sfper.run(start_index, end_index);
+
+  if (opts.stats_opt->has_value()) {
+    try {
+      mesaac::common::stats::write_report(opts.stats_opt->value());
+    } catch (const exception &e) {
+      cerr << "Error: " << e.what() << endl;
+      return 1;
+    }
+  }
   return 0;
 }
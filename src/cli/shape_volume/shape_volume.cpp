@@ -12,7 +12,8 @@
 // 2.  Calculate Hammersley points sphere volume.
 //
 // 3.  Find Hammersley points in atom defined volumes of conformer and count
-// them.
+// them.  The points are bucketed in a VolBox grid, so each atom is tested
+// only against nearby points.
 //
 // 4.  Multiply the Hammersley points sphere volume by the count of the points
 // in
@@ -23,24 +24,30 @@
 // 1 or 2% In general, there is no need to calculate multiple conformers for a
 // single molecule.
 
-#include <cmath>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <numbers>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "mesaac_common/stats.hpp"
 #include "mesaac_mol/io/sdreader.hpp"
 #include "mesaac_mol/mol.hpp"
+#include "mesaac_shape/point_set.hpp"
+#include "mesaac_shape/shared_types.hpp"
+#include "mesaac_shape/vol_box.hpp"
 
 using namespace std;
 using namespace mesaac;
 
-static void show_usage(const char *exename, string msg = "") {
+namespace {
+void show_usage(const char *exename, string msg = "") {
   const std::filesystem::path prog_path(exename);
   const std::string prog_name(prog_path.stem());
-  cerr << "Usage: " << prog_name << " sd_file hamms_sphere_file " << endl
+  cerr << "Usage: " << prog_name << " [-S|--stats STATS_FILE] sd_file "
+       << "hamms_sphere_file" << endl
        << "       sphere_radius atom_scale" << endl
        << "Print the volumes of a set of conformers." << endl
        << endl
@@ -50,90 +57,130 @@ static void show_usage(const char *exename, string msg = "") {
        << "hamms_sphere_file - a file containing 3D Hammersley sphere points, "
           "one point"
        << endl
-       << "                    per line with space-separated coordinates, for "
-          "principal"
+       << "                    per line with space-separated coordinates, or "
+          "cloud:N,SCALE,A,B,C"
        << endl
-       << "                    axes generation via SVD" << endl
+       << "                    to generate N sphere points in memory" << endl
        << "sphere_radius     - radius of Hammersley sphere points (see " << endl
        << "                    hammersley_spheroid options)" << endl
        << "atom_scale        - factor by which to increase/decrease atom "
           "radii, relative"
        << endl
-       << "                    to their van der Waals radii" << endl;
+       << "                    to their van der Waals radii" << endl
+       << "STATS_FILE        - if given, a file to which to write a JSON "
+          "summary of"
+       << endl
+       << "                    per-stage times and item counts" << endl;
   if (!msg.empty()) {
     cerr << endl << msg << endl;
   }
   exit(1);
 }
 
-typedef vector<float> FloatVector;
-typedef vector<FloatVector> CoordsList;
+// Remove "-S|--stats STATS_FILE", which may appear anywhere on the command
+// line, leaving the remaining arguments in args.  Returns STATS_FILE, or an
+// empty string if it was not given.
+string extract_stats_path(int argc, const char **const argv,
+                          vector<const char *> &args) {
+  string result;
+  for (int k = 0; k < argc; ++k) {
+    const string arg(argv[k]);
+    if (arg != "-S" && arg != "--stats") {
+      args.push_back(argv[k]);
+    } else if (k + 1 >= argc) {
+      show_usage(argv[0], arg + " requires 1 value");
+    } else {
+      result = argv[++k];
+    }
+  }
+  return result;
+}
 
-void read_sphere_points(const string &sdf_pathname, CoordsList &sphere_points) {
-  sphere_points.clear();
-  ifstream inf(sdf_pathname);
-  if (!inf) {
-    cerr << "Could not open sphere points file '" << sdf_pathname
+// Molecules are read a batch at a time, and each batch's volumes are
+// computed in parallel.
+const unsigned int BatchSize = 256;
+
+void read_sphere_points(const string &pathname, shape::PointList &points) {
+  try {
+    points = shape::get_point_cloud(pathname);
+  } catch (const invalid_argument &e) {
+    cerr << e.what() << endl;
+    exit(1);
+  } catch (const runtime_error &e) {
+    cerr << "Could not open sphere points file '" << pathname
          << "' for reading." << endl;
     exit(1);
   }
+}
 
-  float coord;
-  while (inf >> coord) {
-    FloatVector point;
-    point.push_back(coord);
-    inf >> coord;
-    point.push_back(coord);
-    inf >> coord;
-    point.push_back(coord);
-    sphere_points.push_back(point);
+// Get the mean-centered heavy atom spheres of a conformer, as x, y, z,
+// radius.
+shape::PointList get_heavy_atom_spheres(const mol::Mol &mol) {
+  shape::PointList result;
+  float x_sum = 0.0, y_sum = 0.0, z_sum = 0.0;
+  for (const auto &atom : mol.atoms()) {
+    if (!atom.is_hydrogen()) {
+      const auto &pos(atom.pos());
+      const float x(pos.x()), y(pos.y()), z(pos.z()), r(atom.radius());
+      result.push_back({x, y, z, r});
+      x_sum += x;
+      y_sum += y;
+      z_sum += z;
+    }
   }
-  inf.close();
-}
 
-bool sphere_intersects_compound(const FloatVector &sphere_point,
-                                const CoordsList &compound_coords,
-                                const float epsilon) {
-  for (const auto &point : compound_coords) {
-    // boundarizing limit
-    const float curr_atom_radius(point[3]);
-    const float max_boundary = curr_atom_radius * epsilon;
-    // Only bother to calc distance if inside boundary
-    if (fabs(sphere_point[0] - point[0]) <= max_boundary) {
-      const float dx = (sphere_point[0] - point[0]),
-                  dy = (sphere_point[1] - point[1]),
-                  dz = (sphere_point[2] - point[2]),
-                  distance = ::sqrtf((dx * dx) + (dy * dy) + (dz * dz));
-
-      if (distance <= max_boundary) {
-        // Count each sphere point only once.
-        return true;
-      }
+  if (!result.empty()) {
+    const float x_mean = x_sum / result.size();
+    const float y_mean = y_sum / result.size();
+    const float z_mean = z_sum / result.size();
+    for (auto &sphere : result) {
+      sphere[0] -= x_mean;
+      sphere[1] -= y_mean;
+      sphere[2] -= z_mean;
     }
   }
-  return false;
+  return result;
 }
 
-unsigned int count_mol_sphere_points(const CoordsList &hamms_sphere_coords,
-                                     const CoordsList &compound_coords,
-                                     const float epsilon) {
-  // Calculate volume fraction that the conformer takes up inside the sphere
-  unsigned int count = 0.0;
-  for (const auto &sphere_point : hamms_sphere_coords) {
-    if (sphere_intersects_compound(sphere_point, compound_coords, epsilon)) {
-      count++;
-    }
+// Count the sphere points which lie within the (scaled) heavy atoms of
+// mol.  vol_box does the heavy lifting:  it tests only the points in grid
+// cells overlapped by each atom, and compares squared distances.
+unsigned int count_mol_sphere_points(const shape::VolBox &vol_box,
+                                     const mol::Mol &mol,
+                                     shape_defs::BitVector &bits) {
+  const shape::PointList spheres(get_heavy_atom_spheres(mol));
+  if (spheres.empty()) {
+    return 0;
   }
-  return count;
+  vol_box.set_bits_for_spheres(spheres, bits, true, 0);
+  return bits.count();
 }
 
-int main(int argc, const char **const argv) {
-  // Point and coordinate variables and objects
-  CoordsList hamms_sphere_coords;
+// Read up to BatchSize molecules.  Returns the number read.
+unsigned int read_batch(mol::SDReader &reader, vector<mol::Mol> &batch) {
+  unsigned int result = 0;
+  while (result < BatchSize) {
+    // Refill the batch's molecules, to reuse their storage.
+    if (!reader.read(batch[result]).is_ok()) {
+      break;
+    }
+    result++;
+  }
+  return result;
+}
+} // namespace
 
+int main(int argc, const char **const all_argv) {
+  vector<const char *> args;
+  const string stats_pathname(extract_stats_path(argc, all_argv, args));
+  argc = args.size();
+  const char **const argv = args.data();
   if (argc != 5) {
     show_usage(argv[0], "Wrong number of arguments.");
   }
+  if (!stats_pathname.empty()) {
+    common::stats::enable();
+  }
   // TODO  Should size be fixed?  Should volume be fixed?
 
   const std::filesystem::path sdf_pathname(argv[1]);
@@ -141,10 +188,12 @@ int main(int argc, const char **const argv) {
   const float radius = std::stof(argv[3]);
   const float epsilon = std::stof(argv[4]); // AKA atom_scale
 
+  shape::PointList hamms_sphere_coords;
   read_sphere_points(sphere_points_pathname, hamms_sphere_coords);
   const unsigned int hamms_sphere_seq_size = hamms_sphere_coords.size();
   const float volume =
       std::numbers::pi * (4.0 / 3.0) * radius * radius * radius;
+  const shape::VolBox vol_box(hamms_sphere_coords, epsilon);
 
   ifstream sdf_inf(sdf_pathname);
   if (!sdf_inf) {
@@ -154,47 +203,46 @@ int main(int argc, const char **const argv) {
   }
   mol::SDReader reader(sdf_inf);
 
+  vector<mol::Mol> batch(BatchSize);
+  vector<unsigned int> counts(BatchSize);
+  common::stats::Stage &output_stage(common::stats::stage("output_volumes"));
   for (;;) {
-    const auto read_result = reader.read();
-    if (!read_result.is_ok()) {
-      break;
-    }
-
-    const auto mol = read_result.value();
-    CoordsList compound_coords;
-    float x_sum = 0.0, y_sum = 0.0, z_sum = 0.0;
-    for (const auto &atom : mol.atoms()) {
-      if (!atom.is_hydrogen()) {
-        const auto &pos(atom.pos());
-        const float x(pos.x()), y(pos.y()), z(pos.z()), r(atom.radius());
-        compound_coords.push_back({x, y, z, r});
-        x_sum += x;
-        y_sum += y;
-        z_sum += z;
+    const unsigned int num_mols = read_batch(reader, batch);
+#if HAVE_OPENMP
+#pragma omp parallel
+#endif
+    {
+      // Each thread rasterizes into its own bits.
+      shape_defs::BitVector bits;
+#if HAVE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (int i = 0; i < int(num_mols); i++) {
+        counts[i] = count_mol_sphere_points(vol_box, batch[i], bits);
       }
     }
 
-    // Mean center points.
-    const unsigned int compound_coords_size = compound_coords.size();
-    const float x_mean = x_sum / compound_coords_size;
-    const float y_mean = y_sum / compound_coords_size;
-    const float z_mean = z_sum / compound_coords_size;
-    for (auto &coords : compound_coords) {
-      coords[0] -= x_mean;
-      coords[1] -= y_mean;
-      coords[2] -= z_mean;
-    }
-
-    // Calculate volume fraction that the conformer takes up inside the sphere
-    const unsigned int count =
-        count_mol_sphere_points(hamms_sphere_coords, compound_coords, epsilon);
-
-    // Output volumes in cubic Angstroms.  Note, Blobby (space filling)
-    // fudge factor epsilon will alter volumes.
+    // Output volumes in cubic Angstroms, in input order.  Note, Blobby
+    // (space filling) fudge factor epsilon will alter volumes.
 
     // TODO what should epsilon be to approximate generally accepted volume
     // calculation?
-    cout << ((volume * count) / hamms_sphere_seq_size) << endl;
+    const common::stats::ScopedTimer timer(output_stage, num_mols);
+    for (unsigned int i = 0; i < num_mols; i++) {
+      cout << ((volume * counts[i]) / hamms_sphere_seq_size) << endl;
+    }
+    if (num_mols < BatchSize) {
+      break;
+    }
+  }
+
+  if (!stats_pathname.empty()) {
+    try {
+      common::stats::write_report(stats_pathname);
+    } catch (const exception &e) {
+      cerr << "Error: " << e.what() << endl;
+      return 1;
+    }
   }
   return 0;
 }
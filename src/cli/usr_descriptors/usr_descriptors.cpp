@@ -0,0 +1,210 @@
+// Compute USR (Ultrafast Shape Recognition) descriptors for 3D conformers.
+// Copyright (c) 2011 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+#include "mesaac_common/stats.hpp"
+#include "mesaac_measures/usr_vectors.hpp"
+#include "mesaac_mol/io/sdreader.hpp"
+#include "mesaac_shape/usr_descriptors.hpp"
+
+using namespace std;
+
+namespace {
+using namespace mesaac;
+using namespace mesaac::arg_parser;
+
+// Molecules are read a batch at a time, and each batch's descriptors are
+// computed in parallel.
+const unsigned int BatchSize = 256;
+
+struct CmdLine {
+  Flag::Ptr usrcat_flag = Flag::create(
+      "-c", "--usrcat",
+      "compute USRCAT descriptors, which add USR descriptors for several "
+      "atom classes - default is to compute USR descriptors only");
+
+  Choice::Ptr format_opt =
+      Choice::create("-f", "--format", "write descriptors in this format",
+                     {{.value = "B",
+                       .help = "packed binary, which usr_measures can "
+                               "memory-map (default)"},
+                      {.value = "A",
+                       .help = "ASCII, one conformer per line"}});
+
+  Option<filesystem::path>::Ptr names_opt = Option<filesystem::path>::create(
+      "-n", "--names",
+      "write the name of each conformer, one per line, to the named file");
+
+  Option<filesystem::path>::Ptr stats_opt = Option<filesystem::path>::create(
+      "-S", "--stats",
+      "write a JSON summary of per-stage times and item counts to the named "
+      "file");
+
+  Argument<filesystem::path>::Ptr sd_file = Argument<filesystem::path>::create(
+      "sd_file", "file of conformers in SD format, with 3D coordinates");
+  Argument<filesystem::path>::Ptr output_file =
+      Argument<filesystem::path>::create("output_file",
+                                         "file to which to write descriptors");
+
+  ArgParser parser =
+      ArgParser({usrcat_flag, format_opt, names_opt, stats_opt},
+                {sd_file, output_file},
+                "Compute USR (Ultrafast Shape Recognition) moment descriptors "
+                "for 3D conformers.");
+};
+
+// Writes descriptors in either packed binary or ASCII format.
+class DescriptorWriter {
+public:
+  DescriptorWriter(const filesystem::path &path, unsigned int num_features,
+                   bool packed) {
+    if (packed) {
+      m_packed = make_unique<measures::UsrVectorWriter>(path, num_features);
+    } else {
+      m_outf.open(path);
+      if (!m_outf) {
+        throw runtime_error(format("Cannot open {} for writing.",
+                                   path.string()));
+      }
+    }
+  }
+
+  void write(span<const float> values) {
+    if (m_packed) {
+      m_packed->write(values);
+    } else {
+      const char *sep = "";
+      for (const float value : values) {
+        m_outf << sep << value;
+        sep = " ";
+      }
+      m_outf << "\n";
+    }
+  }
+
+  void close() {
+    if (m_packed) {
+      m_packed->close();
+    } else {
+      m_outf.close();
+    }
+  }
+
+private:
+  unique_ptr<measures::UsrVectorWriter> m_packed;
+  ofstream m_outf;
+};
+
+// Read up to BatchSize molecules.  Returns the number read.
+unsigned int read_batch(mol::SDReader &reader, vector<mol::Mol> &batch) {
+  unsigned int result = 0;
+  while (result < BatchSize) {
+    // Refill the batch's molecules, to reuse their storage.
+    const auto read_result = reader.read(batch[result]);
+    if (!read_result.is_ok()) {
+      if (!reader.eof()) {
+        throw runtime_error(read_result.error());
+      }
+      break;
+    }
+    result++;
+  }
+  return result;
+}
+
+void compute_descriptors(const filesystem::path &sd_path, bool usrcat,
+                         DescriptorWriter &writer, ostream *names_outs) {
+  ifstream inf(sd_path);
+  if (!inf) {
+    throw runtime_error(
+        format("Cannot open SD file {} for reading.", sd_path.string()));
+  }
+  mol::SDReader reader(inf, sd_path.string());
+
+  const unsigned int num_features =
+      usrcat ? shape::NumUsrcatDescriptors : shape::NumUsrDescriptors;
+  vector<mol::Mol> batch(BatchSize);
+  vector<float> values(BatchSize * num_features);
+  common::stats::Stage &write_stage(
+      common::stats::stage("DescriptorWriter::write"));
+  for (;;) {
+    const unsigned int num_mols = read_batch(reader, batch);
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < int(num_mols); i++) {
+      const span<float> mol_values(values.data() + i * num_features,
+                                   num_features);
+      if (usrcat) {
+        shape::get_usrcat_descriptors(batch[i], mol_values);
+      } else {
+        shape::get_usr_descriptors(batch[i], mol_values);
+      }
+    }
+
+    // Serialize output.
+    const common::stats::ScopedTimer timer(write_stage, num_mols);
+    for (unsigned int i = 0; i < num_mols; i++) {
+      writer.write(span<const float>(values.data() + i * num_features,
+                                     num_features));
+      if (names_outs) {
+        *names_outs << batch[i].name() << "\n";
+      }
+    }
+    if (num_mols < BatchSize) {
+      break;
+    }
+  }
+  writer.close();
+}
+} // namespace
+
+int main(int argc, const char **const argv) {
+  CmdLine opts;
+  const int status = opts.parser.parse_args(argc, argv);
+  if (status != 0 || opts.parser.usage_requested()) {
+    return status;
+  }
+
+  const bool usrcat = opts.usrcat_flag->value();
+  const bool packed = (opts.format_opt->value_or("B") == "B");
+  if (opts.stats_opt->has_value()) {
+    common::stats::enable();
+  }
+  try {
+    const unsigned int num_features =
+        usrcat ? shape::NumUsrcatDescriptors : shape::NumUsrDescriptors;
+    DescriptorWriter writer(opts.output_file->value(), num_features, packed);
+
+    ofstream names_outf;
+    if (opts.names_opt->has_value()) {
+      const auto names_path = opts.names_opt->value();
+      names_outf.open(names_path);
+      if (!names_outf) {
+        throw runtime_error(format("Cannot open {} for writing.",
+                                   names_path.string()));
+      }
+    }
+    compute_descriptors(opts.sd_file->value(), usrcat, writer,
+                        names_outf.is_open() ? &names_outf : nullptr);
+    if (opts.stats_opt->has_value()) {
+      common::stats::write_report(opts.stats_opt->value());
+    }
+  } catch (const exception &e) {
+    cerr << "Error: " << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -17,6 +17,7 @@
 #include "mesaac_arg_parser/flag.hpp"
 #include "mesaac_arg_parser/i_argument.hpp"
 #include "mesaac_arg_parser/i_option.hpp"
+#include "mesaac_arg_parser/multi_valued_argument.hpp"
 #include "mesaac_arg_parser/multi_valued_option.hpp"
 #include "mesaac_arg_parser/option.hpp"
 
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "mesaac_arg_parser/common_types.hpp"
+#include "mesaac_arg_parser/i_argument.hpp"
+#include "mesaac_arg_parser/value_converter.hpp"
+
+#include <sstream>
+#include <vector>
+
+namespace mesaac::arg_parser {
+/**
+ * @brief A positional parameter that matches one or more consecutive
+ * command-line arguments.  It should be the last positional parameter given
+ * to an ArgParser.
+ */
+template <typename ValueType> struct MultiValuedArgument : public IArgument {
+  using Ptr = std::shared_ptr<MultiValuedArgument>;
+
+  static Ptr create(std::string_view name, std::string_view help) {
+    return std::make_shared<MultiValuedArgument>(name, help);
+  }
+
+  MultiValuedArgument(std::string_view name, std::string_view help)
+      : m_name(name), m_help(help) {}
+
+  [[nodiscard]] ParseResult parse(CLIArgs &remaining_args) override {
+    if (remaining_args.size() > 0) {
+      const auto value(remaining_args.front());
+      try {
+        std::optional<ValueType> converted;
+        value_converter::convert(value, converted);
+        m_values.push_back(converted.value());
+        remaining_args.pop_front();
+        return ParseResult::match();
+      } catch (std::exception &e) {
+        std::ostringstream msg;
+        msg << "Invalid literal value for " << m_name << ": '" << value << "'";
+        return ParseResult::match_with_error(msg.str());
+      }
+    }
+    return ParseResult::no_match();
+  }
+
+  [[nodiscard]] std::string name() const override { return m_name; }
+
+  [[nodiscard]] std::string usage() const override {
+    return m_name + " [" + m_name + " ...]";
+  }
+
+  [[nodiscard]] std::string help() const override {
+    std::ostringstream msg;
+
+    msg << m_name << std::endl << "        " << m_help;
+    return msg.str();
+  }
+
+  [[nodiscard]] bool has_value() const override { return !m_values.empty(); }
+
+  /**
+   * @brief Call this method after parsing to get the values of the
+   * command-line arguments to which this parameter was matched.
+   * @return the matched command-line argument values, in command-line order
+   */
+  [[nodiscard]] std::vector<ValueType> values() const { return m_values; }
+
+private:
+  const std::string m_name;
+  const std::string m_help;
+
+  std::vector<ValueType> m_values;
+};
+
+} // namespace mesaac::arg_parser
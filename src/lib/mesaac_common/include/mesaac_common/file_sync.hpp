@@ -0,0 +1,29 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <filesystem>
+
+namespace mesaac::common {
+
+/// @brief Flush a file's content to stable storage.
+/// @param path path of the file, which must already have been written and
+/// closed
+/// @throw std::runtime_error if the file cannot be opened or flushed
+void sync_file(const std::filesystem::path &path);
+
+/// @brief Flush a directory's entries to stable storage, e.g. after files
+/// have been created in, renamed into or removed from it.
+/// @throw std::runtime_error if the directory cannot be opened or flushed
+void sync_directory(const std::filesystem::path &dir);
+
+/// @brief Replace dest with src so that, even after a crash, dest holds
+/// either its old content or all of src's.  src is flushed before it is
+/// renamed, and dest's directory is flushed after.
+/// @throw std::runtime_error or std::filesystem::filesystem_error on failure
+void rename_durably(const std::filesystem::path &src,
+                    const std::filesystem::path &dest);
+
+} // namespace mesaac::common
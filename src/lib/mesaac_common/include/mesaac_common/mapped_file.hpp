@@ -0,0 +1,36 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace mesaac::common {
+
+/// @brief A read-only memory mapping of an entire file.
+class MappedFile {
+public:
+  /// @brief Map a file into memory.
+  /// @param path path of the file to map
+  /// @throw std::runtime_error if the file cannot be opened or mapped
+  explicit MappedFile(const std::filesystem::path &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &src) = delete;
+  MappedFile &operator=(const MappedFile &src) = delete;
+
+  /// @return the start of the mapped file content, or nullptr if the file
+  /// is empty
+  const std::byte *data() const { return m_data; }
+
+  /// @return the size of the mapped file, in bytes
+  std::size_t size() const { return m_size; }
+
+private:
+  const std::byte *m_data;
+  std::size_t m_size;
+};
+
+} // namespace mesaac::common
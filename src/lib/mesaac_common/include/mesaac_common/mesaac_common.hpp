@@ -3,4 +3,6 @@
 #include "b32.hpp"
 #include "b64.hpp"
 #include "gzip.hpp"
-#include "shape_defs.hpp"
\ No newline at end of file
+#include "mapped_file.hpp"
+#include "shape_defs.hpp"
+#include "stats.hpp"
\ No newline at end of file
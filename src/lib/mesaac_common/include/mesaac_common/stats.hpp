@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// @brief Per-stage timing and item counts.
+///
+/// Collection is off until enable() is called.  Until then a ScopedTimer
+/// costs one relaxed atomic load, so timers can stay in hot loops.
+namespace mesaac::common::stats {
+
+/// @brief Accumulated measurements for one stage.
+struct Totals {
+  /// Number of timed intervals recorded
+  std::uint64_t calls = 0;
+  /// Number of items processed, e.g., molecules read or values computed
+  std::uint64_t items = 0;
+  /// Total time, summed over all threads
+  std::uint64_t nanoseconds = 0;
+};
+
+/// @brief A named stage of processing, e.g., "SDReader::read".
+///
+/// Measurements are spread across several cache-line-sized slots, chosen
+/// per thread, so that parallel loops rarely contend for a counter.
+class Stage {
+public:
+  /// @brief Create an unregistered stage.  Most clients should use stage().
+  explicit Stage(const std::string &name);
+
+  Stage(const Stage &src) = delete;
+  Stage &operator=(const Stage &src) = delete;
+
+  const std::string &name() const { return m_name; }
+
+  /// @brief Record one timed interval.
+  /// @param nanoseconds duration of the interval
+  /// @param items number of items processed during the interval
+  void record(std::uint64_t nanoseconds, std::uint64_t items);
+
+  /// @return the measurements accumulated over all threads
+  Totals totals() const;
+
+  /// @brief Discard all accumulated measurements.
+  void reset();
+
+private:
+  static constexpr unsigned int NumSlots = 16;
+
+  struct alignas(64) Slot {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> items{0};
+    std::atomic<std::uint64_t> nanoseconds{0};
+  };
+
+  const std::string m_name;
+  std::array<Slot, NumSlots> m_slots;
+};
+
+namespace internal {
+extern std::atomic<bool> g_enabled;
+} // namespace internal
+
+/// @return whether measurements are being collected
+inline bool is_enabled() {
+  return internal::g_enabled.load(std::memory_order_relaxed);
+}
+
+/// @brief Start collecting measurements, and start the wall clock for
+/// write_report.
+void enable();
+
+/// @brief Stop collecting measurements.
+void disable();
+
+/// @brief Get a registered stage, creating it if necessary.
+/// @param name name of the stage
+/// @return the stage, which lives until program exit
+/// @note Lookup takes a lock.  Hot code should cache the result, e.g., in
+/// a function-local static.
+Stage &stage(const std::string &name);
+
+/// @brief Discard the measurements of all registered stages.
+void reset();
+
+/// @brief Write a JSON summary of all registered stages which have recorded
+/// measurements.
+/// @param outs stream to which to write
+/// @param wall_seconds elapsed wall clock time to report
+void write_json(std::ostream &outs, double wall_seconds);
+
+/// @brief Write a JSON summary, with the wall clock time since enable(), to
+/// a file.
+/// @param path path of the file to write
+/// @throw std::runtime_error if the file cannot be written
+void write_report(const std::filesystem::path &path);
+
+/// @brief Records the lifetime of a scope as one interval of a stage.
+class ScopedTimer {
+public:
+  /// @param stage the stage to which to add the interval
+  /// @param items number of items processed within the scope
+  explicit ScopedTimer(Stage &stage, std::uint64_t items = 1)
+      : m_stage(is_enabled() ? &stage : nullptr), m_items(items) {
+    if (m_stage) {
+      m_start = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedTimer() {
+    if (m_stage) {
+      const auto elapsed = std::chrono::steady_clock::now() - m_start;
+      m_stage->record(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+              .count(),
+          m_items);
+    }
+  }
+
+  ScopedTimer(const ScopedTimer &src) = delete;
+  ScopedTimer &operator=(const ScopedTimer &src) = delete;
+
+  /// @brief Change the number of items to record, e.g., once a batch has
+  /// been read.
+  void set_items(std::uint64_t items) { m_items = items; }
+
+private:
+  Stage *const m_stage;
+  std::uint64_t m_items;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace mesaac::common::stats
@@ -0,0 +1,53 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_common/file_sync.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace mesaac::common {
+
+namespace {
+runtime_error sync_error(const string &action, const filesystem::path &path) {
+  return runtime_error(
+      format("Cannot {} {}: {}", action, path.string(), strerror(errno)));
+}
+
+void sync_path(const filesystem::path &path, int flags) {
+  const int fd = open(path.c_str(), flags);
+  if (fd < 0) {
+    throw sync_error("open", path);
+  }
+  if (fsync(fd) != 0) {
+    const auto error = sync_error("flush", path);
+    close(fd);
+    throw error;
+  }
+  close(fd);
+}
+} // namespace
+
+void sync_file(const filesystem::path &path) { sync_path(path, O_RDONLY); }
+
+void sync_directory(const filesystem::path &dir) {
+  sync_path(dir.empty() ? filesystem::path(".") : dir,
+            O_RDONLY | O_DIRECTORY);
+}
+
+void rename_durably(const filesystem::path &src,
+                    const filesystem::path &dest) {
+  sync_file(src);
+  filesystem::rename(src, dest);
+  sync_directory(dest.parent_path());
+}
+
+} // namespace mesaac::common
@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_common/mapped_file.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace mesaac::common {
+
+namespace {
+runtime_error map_error(const string &action,
+                        const filesystem::path &path) {
+  return runtime_error(
+      format("Cannot {} {}: {}", action, path.string(), strerror(errno)));
+}
+} // namespace
+
+MappedFile::MappedFile(const filesystem::path &path)
+    : m_data(nullptr), m_size(0) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw map_error("open", path);
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    const auto error = map_error("stat", path);
+    close(fd);
+    throw error;
+  }
+  m_size = info.st_size;
+  if (m_size > 0) {
+    void *addr = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      const auto error = map_error("map", path);
+      close(fd);
+      throw error;
+    }
+    m_data = static_cast<const std::byte *>(addr);
+  }
+  // The mapping remains valid after the descriptor is closed.
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (m_data) {
+    munmap(const_cast<std::byte *>(m_data), m_size);
+  }
+}
+
+} // namespace mesaac::common
@@ -0,0 +1,158 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_common/stats.hpp"
+
+#include <format>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+using namespace std;
+
+namespace mesaac::common::stats {
+
+namespace internal {
+atomic<bool> g_enabled{false};
+} // namespace internal
+
+namespace {
+struct Registry {
+  mutex lock;
+  // Ordered by name, so reports are stable from run to run.
+  map<string, unique_ptr<Stage>> stages;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+};
+
+Registry &registry() {
+  static Registry result;
+  return result;
+}
+
+unsigned int this_thread_slot(unsigned int num_slots) {
+  static atomic<unsigned int> next_slot{0};
+  thread_local const unsigned int slot =
+      next_slot.fetch_add(1, memory_order_relaxed);
+  return slot % num_slots;
+}
+
+// Stage names are plain identifiers, but quote them defensively.
+string json_string(const string &value) {
+  string result = "\"";
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    }
+    result += c;
+  }
+  return result + "\"";
+}
+} // namespace
+
+Stage::Stage(const string &name) : m_name(name) {}
+
+void Stage::record(std::uint64_t nanoseconds, std::uint64_t items) {
+  Slot &slot(m_slots[this_thread_slot(NumSlots)]);
+  slot.calls.fetch_add(1, memory_order_relaxed);
+  slot.items.fetch_add(items, memory_order_relaxed);
+  slot.nanoseconds.fetch_add(nanoseconds, memory_order_relaxed);
+}
+
+Totals Stage::totals() const {
+  Totals result;
+  for (const auto &slot : m_slots) {
+    result.calls += slot.calls.load(memory_order_relaxed);
+    result.items += slot.items.load(memory_order_relaxed);
+    result.nanoseconds += slot.nanoseconds.load(memory_order_relaxed);
+  }
+  return result;
+}
+
+void Stage::reset() {
+  for (auto &slot : m_slots) {
+    slot.calls.store(0, memory_order_relaxed);
+    slot.items.store(0, memory_order_relaxed);
+    slot.nanoseconds.store(0, memory_order_relaxed);
+  }
+}
+
+void enable() {
+  {
+    Registry &reg(registry());
+    const lock_guard<mutex> guard(reg.lock);
+    reg.start = chrono::steady_clock::now();
+  }
+  internal::g_enabled.store(true, memory_order_relaxed);
+}
+
+void disable() { internal::g_enabled.store(false, memory_order_relaxed); }
+
+Stage &stage(const string &name) {
+  Registry &reg(registry());
+  const lock_guard<mutex> guard(reg.lock);
+  auto &entry = reg.stages[name];
+  if (!entry) {
+    entry = make_unique<Stage>(name);
+  }
+  return *entry;
+}
+
+void reset() {
+  Registry &reg(registry());
+  const lock_guard<mutex> guard(reg.lock);
+  for (auto &[name, entry] : reg.stages) {
+    entry->reset();
+  }
+}
+
+void write_json(ostream &outs, double wall_seconds) {
+  Registry &reg(registry());
+  const lock_guard<mutex> guard(reg.lock);
+
+  outs << "{\n"
+       << "  \"wall_seconds\": " << format("{:.6f}", wall_seconds) << ",\n"
+       << "  \"stages\": [";
+  const char *sep = "\n";
+  for (const auto &[name, entry] : reg.stages) {
+    const Totals totals = entry->totals();
+    if (!totals.calls) {
+      continue;
+    }
+    const double seconds = totals.nanoseconds * 1.0e-9;
+    const double items_per_second =
+        (seconds > 0.0) ? (totals.items / seconds) : 0.0;
+    outs << sep << "    {\"name\": " << json_string(name)
+         << ", \"calls\": " << totals.calls << ", \"items\": " << totals.items
+         << ", \"seconds\": " << format("{:.6f}", seconds)
+         << ", \"items_per_second\": " << format("{:.1f}", items_per_second)
+         << "}";
+    sep = ",\n";
+  }
+  outs << "\n  ]\n}\n";
+}
+
+void write_report(const filesystem::path &path) {
+  chrono::steady_clock::time_point start;
+  {
+    Registry &reg(registry());
+    const lock_guard<mutex> guard(reg.lock);
+    start = reg.start;
+  }
+  const chrono::duration<double> wall = chrono::steady_clock::now() - start;
+
+  ofstream outf(path);
+  if (!outf) {
+    throw runtime_error(
+        format("Cannot open {} for writing statistics.", path.string()));
+  }
+  write_json(outf, wall.count());
+  if (!outf) {
+    throw runtime_error(
+        format("Error writing statistics to {}.", path.string()));
+  }
+}
+
+} // namespace mesaac::common::stats
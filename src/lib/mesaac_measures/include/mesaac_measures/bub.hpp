@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <cmath>
+
 #include "mesaac_measures/measures_base.hpp"
 
 namespace mesaac::measures {
@@ -13,7 +15,19 @@ namespace mesaac::measures {
 class BUB : public MeasuresBase {
 public:
   std::string name() const override { return "BUB"; }
-  float similarity(const shape_defs::BitVector &v1,
-                   const shape_defs::BitVector &v2) const override;
+  using MeasuresBase::similarity;
+  float similarity(const ContingencyCounts &counts) const override {
+    float result = 0.0;
+    unsigned int a = counts.a;
+    unsigned int d = counts.d();
+    unsigned int either = counts.a + counts.b + counts.c;
+
+    float s = ::sqrt(a * d);
+    float denom = s + either;
+    if (denom > 0) {
+      result = (s + a) / denom;
+    }
+    return result;
+  }
 };
 } // namespace mesaac::measures
\ No newline at end of file
@@ -0,0 +1,40 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <vector>
+
+#include "mesaac_measures/neighbor_lists.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief The result of Taylor-Butina clustering.
+ */
+struct ButinaClusters {
+  /// The centroid index of each cluster, in order of cluster creation.
+  std::vector<unsigned int> centroids;
+
+  /// The cluster index of each fingerprint.
+  std::vector<unsigned int> assignments;
+
+  /// The number of members, including the centroid, of each cluster.
+  std::vector<unsigned int> sizes;
+};
+
+/**
+ * @brief Cluster fingerprints using the Taylor-Butina algorithm.
+ *
+ * Fingerprints are visited in order of decreasing neighbor count, ties
+ * broken by lowest index.  Each fingerprint not yet assigned to a cluster
+ * becomes the centroid of a new cluster, which also claims all of the
+ * centroid's still-unassigned neighbors.  Fingerprints with no unassigned
+ * neighbors end up as singleton clusters.
+ * @param neighbors thresholded neighbor lists of the fingerprints
+ * @return the clusters
+ */
+ButinaClusters cluster_taylor_butina(const NeighborLists &neighbors);
+
+} // namespace mesaac::measures::shape
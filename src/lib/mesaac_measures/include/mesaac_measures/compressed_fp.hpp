@@ -0,0 +1,136 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <vector>
+
+#include "mesaac_common/shape_defs.hpp"
+#include "mesaac_measures/contingency_counts.hpp"
+
+namespace mesaac::measures {
+
+/**
+ * @brief A read-only bit vector which chooses, block by block, the
+ * smaller of a dense or a sparse encoding.
+ *
+ * Low-density fingerprints -- folded feature fingerprints, or small
+ * ligands in a large point cloud -- set only a small fraction of their
+ * bits.  A CompressedFP splits its bits into blocks of BlockBits bits.
+ * An empty block takes no storage, a block with few bits set stores the
+ * sorted offsets of those bits, and any other block stores its words.
+ * Intersection counts work directly on mixed encodings.
+ */
+class CompressedFP {
+public:
+  /// @brief The number of bits in each block.
+  static constexpr unsigned int BlockBits = 1024;
+
+  /// @brief Blocks with fewer than this many bits set are stored as bit
+  /// offsets: at two bytes per offset, that is smaller than the block's
+  /// words.  A partial last block has a proportionally smaller limit.
+  static constexpr unsigned int MaxSparseBits = BlockBits / 16;
+
+  /// @brief Create an empty, zero-bit fingerprint.
+  CompressedFP();
+
+  /// @brief Compress a bit vector.
+  explicit CompressedFP(const shape_defs::BitVector &fp);
+
+  /**
+   * @brief Compress a packed bit vector, as stored by
+   * shape::PackedShapeFPWriter.
+   * @param words the vector's words; bit k is bit (k % 64) of word (k / 64)
+   * @param num_bits the number of bits in the vector
+   * @throw std::invalid_argument if words is not the right size for
+   * num_bits
+   */
+  CompressedFP(std::span<const std::uint64_t> words, unsigned int num_bits);
+
+  /// @return the number of bits in the fingerprint
+  unsigned int num_bits() const { return m_num_bits; }
+
+  /// @return the number of bits set
+  unsigned int count() const { return m_count; }
+
+  /// @return the number of blocks stored as words
+  unsigned int num_dense_blocks() const;
+
+  /// @return the number of blocks stored as bit offsets
+  unsigned int num_sparse_blocks() const;
+
+  /// @return the number of bytes of storage used by the fingerprint
+  std::size_t memory_bytes() const;
+
+  /// @brief Decompress into fp.  fp's storage is reused, so decoding many
+  /// fingerprints into one fp does not allocate.
+  void decode(shape_defs::BitVector &fp) const;
+
+  bool operator==(const CompressedFP &other) const = default;
+
+  /**
+   * @brief Write the fingerprint in binary form, in native byte order.
+   * The number of bits is not written.
+   * @throw std::runtime_error if outs fails
+   */
+  void write(std::ostream &outs) const;
+
+  /**
+   * @brief Read a fingerprint written by write.
+   * @param num_bits the number of bits in the fingerprint
+   * @throw std::runtime_error if ins fails or holds an invalid fingerprint
+   */
+  static CompressedFP read(std::istream &ins, unsigned int num_bits);
+
+  friend unsigned int intersection_count(const CompressedFP &fp1,
+                                         const CompressedFP &fp2);
+
+private:
+  enum class Encoding : std::uint8_t { empty, sparse, dense };
+
+  struct Block {
+    // Index of the block's first offset or word.
+    std::uint32_t start;
+    std::uint16_t count;
+    Encoding encoding;
+
+    bool operator==(const Block &other) const = default;
+  };
+
+  unsigned int m_num_bits;
+  unsigned int m_count;
+  std::vector<Block> m_blocks;
+  std::vector<std::uint16_t> m_offsets;
+  std::vector<std::uint64_t> m_words;
+
+  unsigned int block_words(std::size_t block) const;
+  void append_block(std::span<const std::uint64_t> words);
+};
+
+/**
+ * @return the number of bits set in both fp1 and fp2
+ * @throw std::invalid_argument if fp1 and fp2 differ in size
+ */
+unsigned int intersection_count(const CompressedFP &fp1,
+                                const CompressedFP &fp2);
+
+/**
+ * @return the number of bits set in either fp1 or fp2
+ * @throw std::invalid_argument if fp1 and fp2 differ in size
+ */
+unsigned int union_count(const CompressedFP &fp1, const CompressedFP &fp2);
+
+/**
+ * @brief Get the contingency counts of two compressed fingerprints, for
+ * use with MeasuresBase::similarity.
+ * @throw std::invalid_argument if fp1 and fp2 differ in size
+ */
+ContingencyCounts get_contingency_counts(const CompressedFP &fp1,
+                                         const CompressedFP &fp2);
+
+} // namespace mesaac::measures
@@ -0,0 +1,124 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "mesaac_measures/compressed_fp.hpp"
+#include "mesaac_measures/packed_shape_fps.hpp"
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief An in-memory collection of shape fingerprints, each stored as
+ * FPsPerShape CompressedFPs.
+ *
+ * Low-density shape fingerprints take a fraction of the memory of
+ * decoded or packed fingerprints, so large sparse databases can be
+ * measured entirely in memory.
+ */
+class CompressedShapeFPs {
+public:
+  /**
+   * @brief Create an empty collection.
+   * @param num_bits the number of bits in each fingerprint
+   */
+  explicit CompressedShapeFPs(unsigned int num_bits);
+
+  /**
+   * @brief Read a compressed database file written by
+   * CompressedShapeFPWriter.
+   * @throw std::runtime_error if the file cannot be read or is not a valid
+   * compressed database
+   */
+  explicit CompressedShapeFPs(const std::filesystem::path &path);
+
+  /// @return whether path appears to be a compressed database file
+  static bool is_compressed(const std::filesystem::path &path);
+
+  /**
+   * @brief Compress and append a shape fingerprint.
+   * @throw std::invalid_argument if sfp has the wrong number of
+   * fingerprints or bits
+   */
+  void push_back(const mesaac::shape::ShapeFingerprint &sfp);
+
+  /// @return the number of shape fingerprints
+  unsigned int size() const { return m_fps.size() / FPsPerShape; }
+
+  /// @return the number of bits in each fingerprint
+  unsigned int num_bits() const { return m_num_bits; }
+
+  /// @return fingerprint k of shape fingerprint i
+  const CompressedFP &fp(unsigned int i, unsigned int k) const {
+    return m_fps[std::size_t(i) * FPsPerShape + k];
+  }
+
+  /// @brief Decode shape fingerprint i.  sfp's storage is reused, as for
+  /// PackedShapeFPs::get.
+  void get(unsigned int i, mesaac::shape::ShapeFingerprint &sfp) const;
+
+  /// @brief Decode shape fingerprints begin..(end - 1), appending them to
+  /// sfps.
+  void append_range(unsigned int begin, unsigned int end,
+                    mesaac::shape::ShapeFingerprintVector &sfps) const;
+
+  /// @return the number of bytes of storage used by all fingerprints
+  std::size_t memory_bytes() const;
+
+private:
+  unsigned int m_num_bits;
+  std::vector<CompressedFP> m_fps;
+};
+
+/**
+ * @brief Writes shape fingerprints to a compressed binary database file.
+ *
+ * The file holds a fixed-size header followed by each shape's
+ * FPsPerShape fingerprints, each as written by CompressedFP::write.
+ */
+class CompressedShapeFPWriter {
+public:
+  /**
+   * @brief Create a compressed database file.
+   * @param path the file to create; an existing file is replaced
+   * @param num_bits the number of bits in each fingerprint
+   * @throw std::runtime_error if the file cannot be created
+   */
+  CompressedShapeFPWriter(const std::filesystem::path &path,
+                          unsigned int num_bits);
+  ~CompressedShapeFPWriter();
+
+  CompressedShapeFPWriter(const CompressedShapeFPWriter &src) = delete;
+  CompressedShapeFPWriter &
+  operator=(const CompressedShapeFPWriter &src) = delete;
+
+  /**
+   * @brief Append a shape fingerprint.
+   * @throw std::invalid_argument if sfp has the wrong number of
+   * fingerprints or bits
+   * @throw std::runtime_error if the fingerprint cannot be written
+   */
+  void write(const mesaac::shape::ShapeFingerprint &sfp);
+
+  /// @brief Finish the file header and close the file.
+  /// @throw std::runtime_error if the file cannot be completed
+  void close();
+
+  std::uint64_t size() const { return m_num_shapes; }
+
+private:
+  const std::filesystem::path m_path;
+  const unsigned int m_num_bits;
+  std::uint64_t m_num_shapes;
+  std::ofstream m_outf;
+};
+
+} // namespace mesaac::measures::shape
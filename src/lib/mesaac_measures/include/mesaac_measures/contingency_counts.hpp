@@ -0,0 +1,70 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "mesaac_common/shape_defs.hpp"
+
+namespace mesaac::measures {
+
+/**
+ * @brief The 2x2 contingency table of a pair of bit vectors v1, v2.
+ *
+ * Every bit vector measure is a closed-form function of these counts, so
+ * several measures of one pair can share a single pass over its bits.
+ */
+struct ContingencyCounts {
+  /// @brief number of bits set in both v1 and v2
+  unsigned int a;
+  /// @brief number of bits set in v1 and unset in v2
+  unsigned int b;
+  /// @brief number of bits unset in v1 and set in v2
+  unsigned int c;
+  /// @brief number of bits in each vector
+  unsigned int n;
+
+  /// @return the number of bits unset in both v1 and v2
+  unsigned int d() const { return n - a - b - c; }
+};
+
+/**
+ * @brief Get the contingency counts of two bit vectors, in one pass over
+ * their blocks and without creating temporary bit vectors.
+ * @throw std::invalid_argument if v1 and v2 differ in size
+ */
+ContingencyCounts get_contingency_counts(const shape_defs::BitVector &v1,
+                                         const shape_defs::BitVector &v2);
+
+/**
+ * @brief Get the contingency counts of two packed bit vectors, as stored by
+ * shape::PackedShapeFPWriter: bit k is bit (k % 64) of word (k / 64), and
+ * unused bits of the last word are zero.
+ * @param words1 the words of the first vector
+ * @param words2 the words of the second vector, as many as words1
+ * @param num_bits the number of bits in each vector
+ * @note This is defined inline so that batch measures can inline it.
+ */
+inline ContingencyCounts
+get_contingency_counts(std::span<const std::uint64_t> words1,
+                       std::span<const std::uint64_t> words2,
+                       unsigned int num_bits) {
+  unsigned int both = 0;
+  unsigned int count1 = 0;
+  unsigned int count2 = 0;
+  for (std::size_t i = 0; i < words1.size(); i++) {
+    const std::uint64_t w1 = words1[i];
+    const std::uint64_t w2 = words2[i];
+    both += std::popcount(w1 & w2);
+    count1 += std::popcount(w1);
+    count2 += std::popcount(w2);
+  }
+  return {.a = both, .b = count1 - both, .c = count2 - both, .n = num_bits};
+}
+
+} // namespace mesaac::measures
@@ -4,13 +4,25 @@
 
 #pragma once
 
+#include <cmath>
+
 #include "mesaac_measures/measures_base.hpp"
 
 namespace mesaac::measures {
 class Cosine : public MeasuresBase {
 public:
   std::string name() const override { return "Cosine"; }
-  float similarity(const shape_defs::BitVector &v1,
-                   const shape_defs::BitVector &v2) const override;
+  using MeasuresBase::similarity;
+  float similarity(const ContingencyCounts &counts) const override {
+    float result = 0.0;
+    float a = counts.a + counts.b;
+    float b = counts.a + counts.c;
+    float c = counts.a;
+    float denom = sqrt(a * b);
+    if (denom > 0) {
+      result = c / denom;
+    }
+    return result;
+  }
 };
 } // namespace mesaac::measures
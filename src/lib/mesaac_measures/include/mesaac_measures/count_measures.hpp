@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include "mesaac_measures/count_vectors.hpp"
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+namespace mesaac::measures {
+
+/**
+ * @brief Get an indexed measure for a collection of count vectors.
+ *
+ * With a_k and b_k the k'th counts of two vectors:
+ * - Tanimoto sums min(a_k, b_k) / max(a_k, b_k) over the features present
+ *   in both, normalized by the largest number of features present in any
+ *   vector of the collection.
+ * - Tversky sums a_k / (beta * b_k) where a_k < b_k, and b_k / (alpha *
+ *   a_k) otherwise, over the features present in both, with beta = 2 -
+ *   alpha.  It is normalized by the largest self-similarity in the
+ *   collection, for either alpha or beta.
+ * - Euclidean is the distance between the vectors, normalized by the
+ *   largest possible distance between vectors of the collection's length
+ *   whose counts are no greater than the largest count in the collection.
+ *   For counts of 0 and 1 this is the bit vector Euclidean measure.
+ * - Cosine is the cosine of the angle between the vectors.
+ *
+ * Distances are 1 - similarity.  Every vector has similarity 1 and
+ * distance 0 to itself.  Normalizations are computed once, when the
+ * measure is created.  The measure holds a reference to counts, which must
+ * outlive it.
+ *
+ * @param measure_type one of tanimoto, tversky, euclidean, cosine
+ * @param tversky_alpha the Tversky alpha value, in (0, 2)
+ * @param compute_sim whether to compute similarity or distance values
+ * @param counts the collection of count vectors to measure
+ * @throw std::invalid_argument if measure_type is not supported for count
+ * vectors, or tversky_alpha is out of range
+ */
+shape::IIndexedShapeFPMeasure::Ptr
+get_count_measurer(MeasureType measure_type, float tversky_alpha,
+                   bool compute_sim, const CountVectors8 &counts);
+
+shape::IIndexedShapeFPMeasure::Ptr
+get_count_measurer(MeasureType measure_type, float tversky_alpha,
+                   bool compute_sim, const CountVectors16 &counts);
+
+} // namespace mesaac::measures
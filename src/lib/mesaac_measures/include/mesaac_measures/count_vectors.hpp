@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace mesaac::measures {
+
+/**
+ * @brief A collection of equal-length feature count vectors, stored
+ * contiguously.
+ *
+ * Each vector is zero-padded to a whole number of SIMD-friendly chunks, so
+ * that measure kernels can process rows without remainder loops.  Zero
+ * padding does not change any count measure.
+ *
+ * @tparam CountType the unsigned integer type used to store each count
+ */
+template <typename CountType> class CountVectors {
+public:
+  /// The number of counts by which row lengths are padded.
+  static constexpr std::size_t Chunk = 32;
+
+  /**
+   * @brief Create an empty collection.
+   * @param num_features the number of counts in each vector
+   */
+  explicit CountVectors(unsigned int num_features)
+      : m_num_features(num_features),
+        m_stride((num_features + Chunk - 1) / Chunk * Chunk) {}
+
+  /**
+   * @brief Append a count vector.
+   * @throw std::invalid_argument if counts has the wrong length
+   * @throw std::out_of_range if a count cannot be stored as a CountType
+   */
+  template <typename T> void push_back(std::span<const T> counts) {
+    if (counts.size() != m_num_features) {
+      throw std::invalid_argument(
+          std::format("Count vector has {} counts; expected {}",
+                      counts.size(), m_num_features));
+    }
+    const std::size_t offset = m_counts.size();
+    m_counts.resize(offset + m_stride, 0);
+    for (std::size_t k = 0; k != counts.size(); ++k) {
+      const unsigned int max_count = std::numeric_limits<CountType>::max();
+      if (std::cmp_less(counts[k], 0) ||
+          std::cmp_greater(counts[k], max_count)) {
+        throw std::out_of_range(std::format(
+            "Count {} is outside the range 0..{}", counts[k], max_count));
+      }
+      m_counts[offset + k] = static_cast<CountType>(counts[k]);
+    }
+  }
+
+  /// @return the number of count vectors
+  unsigned int size() const {
+    return m_stride ? m_counts.size() / m_stride : 0;
+  }
+
+  /// @return the number of counts in each vector, excluding padding
+  unsigned int num_features() const { return m_num_features; }
+
+  /// @return the padded length of each vector
+  std::size_t stride() const { return m_stride; }
+
+  /// @return the padded counts of vector i
+  const CountType *operator[](unsigned int i) const {
+    return m_counts.data() + std::size_t(i) * m_stride;
+  }
+
+private:
+  unsigned int m_num_features;
+  std::size_t m_stride;
+  std::vector<CountType> m_counts;
+};
+
+using CountVectors8 = CountVectors<std::uint8_t>;
+using CountVectors16 = CountVectors<std::uint16_t>;
+
+} // namespace mesaac::measures
@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <vector>
+
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief The algorithm with which to pick a diverse subset.
+ */
+enum class DiverseSelectionMethod {
+  /// Repeatedly pick the candidate whose distance to its nearest
+  /// already-selected neighbor is greatest.
+  max_min,
+  /// Visit candidates in index order, picking each one that lies outside
+  /// the exclusion sphere of every already-selected fingerprint.
+  sphere_exclusion,
+};
+
+/**
+ * @brief Parameters for select_diverse.
+ */
+struct DiverseSelectionParams {
+  DiverseSelectionMethod method = DiverseSelectionMethod::max_min;
+
+  /// Maximum number of fingerprints to select.  0 means no limit.
+  unsigned int max_selected = 0;
+
+  /// For max_min, stop once the greatest nearest-neighbor distance falls
+  /// below this value.  For sphere_exclusion, the exclusion radius:
+  /// candidates at distance <= threshold from a selected fingerprint are
+  /// excluded.
+  float threshold = 0.0;
+
+  /// Index of the first fingerprint to select.
+  unsigned int first_index = 0;
+};
+
+/**
+ * @brief Select a diverse subset of an indexed fingerprint collection.
+ * @param measurer measures the distance between two collection members;
+ * it must be a distance (not similarity) measurer, as returned by e.g.
+ * get_shape_measurer(measure, false, fingerprints)
+ * @param num_fps the number of fingerprints in the collection
+ * @param params selection parameters
+ * @return the indices of the selected fingerprints, in order of selection
+ * @note Memory use is O(num_fps): only each candidate's distance to its
+ * nearest selected neighbor is retained.  Distances are computed as
+ * `measurer.value(selected, candidate)`, so shape measurers compare the
+ * selected fingerprint's canonical orientation to every orientation of
+ * the candidate.  Candidate updates run in parallel when OpenMP is
+ * available.
+ */
+std::vector<unsigned int> select_diverse(const IIndexedShapeFPMeasure &measurer,
+                                         unsigned int num_fps,
+                                         const DiverseSelectionParams &params);
+
+} // namespace mesaac::measures::shape
@@ -4,13 +4,19 @@
 
 #pragma once
 
+#include <cmath>
+
 #include "mesaac_measures/measures_base.hpp"
 
 namespace mesaac::measures {
 class Euclidean : public MeasuresBase {
 public:
   std::string name() const override { return "Euclidean"; }
-  float similarity(const shape_defs::BitVector &v1,
-                   const shape_defs::BitVector &v2) const override;
+  using MeasuresBase::similarity;
+  float similarity(const ContingencyCounts &counts) const override {
+    float a = counts.b + counts.c;
+    float distance = sqrt(a / counts.n);
+    return 1.0 - distance;
+  }
 };
 } // namespace mesaac::measures
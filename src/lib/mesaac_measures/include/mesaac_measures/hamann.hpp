@@ -11,7 +11,23 @@ namespace mesaac::measures {
 class Hamann : public MeasuresBase {
 public:
   std::string name() const override { return "Hamann"; }
-  float similarity(const shape_defs::BitVector &v1,
-                   const shape_defs::BitVector &v2) const override;
+  using MeasuresBase::similarity;
+  float similarity(const ContingencyCounts &counts) const override {
+    // This definition is from
+    // https://www.stata.com/manuals/mvmeasure_option.pdf
+    // a - the number of bits which are set in both v1 and v2
+    // b - the number of bits which are set in v1 and unset in v2
+    // c - the number of bits which are unset in v1 and set in v2
+    // d - the number of bits which are unset in both v1 and v2
+    // In this definition, the range of values is from -1 (perfectly
+    // dissimilar) to +1 (perfectly similar).
+    const float a = counts.a;
+    const float b = counts.b;
+    const float c = counts.c;
+    const float d = counts.d();
+    const float result = ((a + d) - (b + c)) / (a + b + c + d);
+
+    return result;
+  }
 };
 } // namespace mesaac::measures
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "mesaac_common/shape_defs.hpp"
+#include "mesaac_measures/contingency_counts.hpp"
 
 namespace mesaac::measures {
 
@@ -30,7 +31,27 @@ public:
    * @return the similarity measure for bit vectors `v1` and `v2`
    */
   virtual float similarity(const shape_defs::BitVector &v1,
-                           const shape_defs::BitVector &v2) const;
+                           const shape_defs::BitVector &v2) const {
+    return similarity(get_contingency_counts(v1, v2));
+  }
+
+  /**
+   * @brief Get the similarity measure for two bit vectors from their
+   * contingency counts.  Subclasses need only override this method.
+   * @param counts the contingency counts of the bit vectors
+   * @return the similarity measure for the bit vectors
+   * @note Overrides are defined inline so that batch measurers, which
+   * know the dynamic type of their measure, can inline them.
+   */
+  virtual float similarity(const ContingencyCounts &counts) const {
+    float result = 0.0;
+    float b = counts.a + counts.b + counts.c;
+    if (0 != b) {
+      float a = counts.a;
+      result = a / b;
+    }
+    return result;
+  }
 
   /**
    * @brief Get the distance measure for two bit vectors.
@@ -42,6 +63,16 @@ public:
                          const shape_defs::BitVector &v2) const {
     return 1.0 - similarity(v1, v2);
   }
+
+  /**
+   * @brief Get the distance measure for two bit vectors from their
+   * contingency counts.
+   * @param counts the contingency counts of the bit vectors
+   * @return the distance measure for the bit vectors
+   */
+  virtual float distance(const ContingencyCounts &counts) const {
+    return 1.0 - similarity(counts);
+  }
 };
 
 } // namespace mesaac::measures
\ No newline at end of file
@@ -1,11 +1,27 @@
 #pragma once
 
 #include "bub.hpp"
+#include "butina_clusterer.hpp"
+#include "compressed_fp.hpp"
+#include "compressed_shape_fps.hpp"
+#include "contingency_counts.hpp"
 #include "cosine.hpp"
+#include "count_measures.hpp"
+#include "count_vectors.hpp"
+#include "diverse_selector.hpp"
 #include "euclidean.hpp"
 #include "hamann.hpp"
 #include "measures_base.hpp"
 #include "measures_factory.hpp"
+#include "minhash_index.hpp"
+#include "neighbor_lists.hpp"
+#include "packed_shape_fps.hpp"
+#include "popcount_index.hpp"
+#include "prefix_screen.hpp"
+#include "segmented_shape_fps.hpp"
+#include "shape_fp_index.hpp"
 #include "shape_measures_factory.hpp"
 #include "tanimoto.hpp"
-#include "tversky.hpp"
\ No newline at end of file
+#include "tversky.hpp"
+#include "usr_measures.hpp"
+#include "usr_vectors.hpp"
\ No newline at end of file
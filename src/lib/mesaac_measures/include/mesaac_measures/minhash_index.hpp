@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "mesaac_common/mapped_file.hpp"
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/packed_shape_fps.hpp"
+#include "mesaac_measures/segmented_shape_fps.hpp"
+#include "mesaac_measures/shape_fp_index.hpp"
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief Locality-sensitive hashing parameters for a MinHash index.
+ *
+ * Each fingerprint gets num_bands * rows_per_band MinHash values.  Two
+ * fingerprints with Jaccard (Tanimoto) similarity s share all the values of
+ * a band with probability s^rows_per_band, so they become search candidates
+ * with probability 1 - (1 - s^rows_per_band)^num_bands.  More bands raise
+ * recall; more rows per band cut the number of dissimilar candidates.
+ */
+struct MinHashParams {
+  unsigned int num_bands;
+  unsigned int rows_per_band;
+  std::uint64_t seed;
+};
+
+/**
+ * @brief Write an approximate MinHash/LSH search index of db.
+ *
+ * For each of the FPsPerShape orientations and each band, the index holds a
+ * table of band hashes, sorted, with the global index of each shape.  The
+ * index records db's path: searches rescore their candidates exactly
+ * against db, which must remain in place.  The index is a snapshot: shapes
+ * appended to db later are not included.
+ *
+ * Tables are built and written one at a time, so building takes memory for
+ * one table -- 16 bytes per shape -- beyond db.  Signatures are computed,
+ * and tables sorted, in parallel when OpenMP is available.
+ *
+ * @param db the shape fingerprints to index
+ * @param db_path the path from which db was opened
+ * @param path the index file to create; an existing file is replaced
+ * @param params the LSH parameters
+ * @throw std::invalid_argument if params has no bands or rows
+ * @throw std::runtime_error if the index cannot be written
+ */
+void write_minhash_index(const SegmentedShapeFPs &db,
+                         const std::filesystem::path &db_path,
+                         const std::filesystem::path &path,
+                         const MinHashParams &params);
+
+/// @return true if path is a MinHash index file
+bool is_minhash_index(const std::filesystem::path &path);
+
+/**
+ * @brief A read-only, memory-mapped MinHash index, as written by
+ * write_minhash_index, together with the database it indexes.
+ *
+ * A search looks up the band hashes of the query's first fingerprint in
+ * every orientation's tables, then computes the exact measure of each
+ * candidate shape.  Every reported hit is exact, but shapes which share no
+ * band with the query are missed, so recall is below 100%.
+ */
+class MinHashIndex : public IShapeFPIndex {
+public:
+  /**
+   * @brief Map a MinHash index and open its database.
+   * @throw std::runtime_error if the file cannot be mapped, is not a valid
+   * MinHash index, or its database cannot be opened or does not match
+   */
+  explicit MinHashIndex(const std::filesystem::path &path);
+
+  unsigned int size() const override { return m_num_shapes; }
+
+  unsigned int num_bits() const override { return m_num_bits; }
+
+  /// @return the LSH parameters with which the index was written
+  const MinHashParams &params() const { return m_params; }
+
+  /**
+   * @brief Get the shapes which share at least one band with query's first
+   * fingerprint, in any orientation.
+   * @return global indices, in increasing order
+   * @throw std::invalid_argument if query has the wrong number of bits
+   */
+  std::vector<unsigned int>
+  candidates(const mesaac::shape::ShapeFingerprint &query) const;
+
+  /**
+   * @brief Find candidate shapes whose measure against query passes
+   * threshold, as for IShapeFPIndex::search.  Every measure type is
+   * accepted, but candidates are chosen by Tanimoto similarity.
+   */
+  std::vector<IndexHit> search(const mesaac::shape::ShapeFingerprint &query,
+                               MeasureType type, float alpha,
+                               bool compute_sim,
+                               float threshold) const override;
+
+private:
+  struct Band {
+    // keys are sorted; ids[p] is the global index of the shape with key
+    // keys[p].
+    const std::uint64_t *keys;
+    const std::uint32_t *ids;
+  };
+
+  common::MappedFile m_file;
+  unsigned int m_num_bits;
+  unsigned int m_num_shapes;
+  MinHashParams m_params;
+  std::vector<std::uint32_t> m_bit_hashes;
+  std::array<std::vector<Band>, FPsPerShape> m_bands;
+  std::unique_ptr<SegmentedShapeFPs> m_db;
+};
+
+} // namespace mesaac::measures::shape
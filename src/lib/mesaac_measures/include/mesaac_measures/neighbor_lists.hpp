@@ -0,0 +1,89 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief Thresholded neighbor lists for an indexed fingerprint collection.
+ *
+ * Row i lists, in increasing order, the indices j != i for which
+ * `measurer.value(i, j)` meets the threshold.  Rows are stored
+ * contiguously.  Once their total size exceeds a memory budget, rows are
+ * spilled to a binary temporary file and read back on demand.
+ */
+class NeighborLists {
+public:
+  using Index = std::uint32_t;
+  using IndexList = std::vector<Index>;
+
+  struct Params {
+    /// Neighbors have similarity >= threshold if the measurer computes
+    /// similarities, or distance <= threshold if it computes distances.
+    float threshold = 0.0;
+    bool is_similarity = true;
+
+    /// Maximum number of bytes of neighbor indices to hold in memory.  Rows
+    /// are also computed in batches small enough to fit within it.
+    std::size_t memory_budget = 1 << 30;
+
+    /// Directory in which to create the spill file, if one is needed.
+    /// Empty means std::filesystem::temp_directory_path().
+    std::filesystem::path spill_dir;
+  };
+
+  /**
+   * @brief Build neighbor lists.  Rows are computed in parallel when
+   * OpenMP is available.
+   * @param measurer measures pairs of collection members
+   * @param num_fps the number of fingerprints in the collection
+   * @param params threshold and storage parameters
+   * @throw std::runtime_error if the spill file cannot be written
+   */
+  NeighborLists(const IIndexedShapeFPMeasure &measurer, unsigned int num_fps,
+                const Params &params);
+  ~NeighborLists();
+
+  NeighborLists(const NeighborLists &src) = delete;
+  NeighborLists &operator=(const NeighborLists &src) = delete;
+
+  unsigned int size() const { return m_counts.size(); }
+
+  unsigned int count(unsigned int i) const { return m_counts[i]; }
+
+  /**
+   * @brief Get the neighbors of a fingerprint.
+   * @param i index of a fingerprint
+   * @param neighbors on return, the neighbors of fingerprint i
+   * @note Not thread-safe if the lists have been spilled to disk.
+   */
+  void neighbors(unsigned int i, IndexList &neighbors) const;
+
+  /// @return whether any rows have been spilled to disk
+  bool is_spilled() const { return m_spill_file.is_open(); }
+
+private:
+  std::vector<Index> m_counts;
+  // Offset of each row within the concatenated (in-memory, then spilled)
+  // neighbor indices.
+  std::vector<std::uint64_t> m_offsets;
+  IndexList m_in_memory;
+
+  std::filesystem::path m_spill_path;
+  mutable std::fstream m_spill_file;
+
+  void append_row(const IndexList &row, const Params &params);
+  void spill(const Params &params);
+};
+
+} // namespace mesaac::measures::shape
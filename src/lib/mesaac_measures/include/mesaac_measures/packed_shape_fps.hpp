@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+
+#include "mesaac_common/mapped_file.hpp"
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief The number of fingerprints, one per canonical orientation, in a
+ * shape fingerprint.
+ */
+const unsigned int FPsPerShape = 4;
+
+/**
+ * @brief Writes shape fingerprints to a packed binary database file.
+ *
+ * The file holds a fixed-size header followed by each shape's
+ * FPsPerShape fingerprints, each stored as 64-bit words in native byte
+ * order.  Bit k of a fingerprint is bit (k % 64) of word (k / 64).
+ */
+class PackedShapeFPWriter {
+public:
+  /**
+   * @brief Create a packed database file.
+   * @param path the file to create; an existing file is replaced
+   * @param num_bits the number of bits in each fingerprint
+   * @throw std::runtime_error if the file cannot be created
+   */
+  PackedShapeFPWriter(const std::filesystem::path &path,
+                      unsigned int num_bits);
+  ~PackedShapeFPWriter();
+
+  PackedShapeFPWriter(const PackedShapeFPWriter &src) = delete;
+  PackedShapeFPWriter &operator=(const PackedShapeFPWriter &src) = delete;
+
+  /**
+   * @brief Append a shape fingerprint.
+   * @throw std::invalid_argument if sfp has the wrong number of
+   * fingerprints or bits
+   */
+  void write(const mesaac::shape::ShapeFingerprint &sfp);
+
+  /// @brief Finish the file header and close the file.
+  /// @throw std::runtime_error if the file cannot be completed
+  void close();
+
+  std::uint64_t size() const { return m_num_shapes; }
+
+private:
+  const std::filesystem::path m_path;
+  const unsigned int m_num_bits;
+  std::uint64_t m_num_shapes;
+  std::ofstream m_outf;
+};
+
+/**
+ * @brief A read-only, memory-mapped packed shape fingerprint database, as
+ * written by PackedShapeFPWriter.
+ *
+ * Shape fingerprints are decoded on demand, so callers can work through
+ * databases larger than available memory a range at a time.
+ */
+class PackedShapeFPs {
+public:
+  /**
+   * @brief Map a packed database.
+   * @throw std::runtime_error if the file cannot be mapped or is not a
+   * valid packed database
+   */
+  explicit PackedShapeFPs(const std::filesystem::path &path);
+
+  /// @return whether path appears to be a packed database file
+  static bool is_packed(const std::filesystem::path &path);
+
+  /// @return the number of shape fingerprints in the database
+  unsigned int size() const { return m_num_shapes; }
+
+  /// @return the number of bits in each fingerprint
+  unsigned int num_bits() const { return m_num_bits; }
+
+  /// @return the number of 64-bit words in each packed fingerprint
+  unsigned int words_per_fp() const { return m_words_per_fp; }
+
+  /// @return the number of bytes occupied by one decoded shape fingerprint
+  std::size_t shape_bytes() const;
+
+  /// @return the packed words of shape fingerprint i: its FPsPerShape
+  /// fingerprints of words_per_fp() words each, without decoding
+  std::span<const std::uint64_t> words(unsigned int i) const;
+
+  /// @brief Decode shape fingerprint i.  sfp's storage is reused, so
+  /// decoding many shapes into one sfp does not allocate.
+  void get(unsigned int i, mesaac::shape::ShapeFingerprint &sfp) const;
+
+  /// @brief Decode shape fingerprints begin..(end - 1), appending them to
+  /// sfps.
+  void append_range(unsigned int begin, unsigned int end,
+                    mesaac::shape::ShapeFingerprintVector &sfps) const;
+
+private:
+  common::MappedFile m_file;
+  unsigned int m_num_bits;
+  unsigned int m_num_shapes;
+  unsigned int m_words_per_fp;
+  const std::uint64_t *m_words;
+};
+
+} // namespace mesaac::measures::shape
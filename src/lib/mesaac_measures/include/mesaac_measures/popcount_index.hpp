@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "mesaac_common/mapped_file.hpp"
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/packed_shape_fps.hpp"
+#include "mesaac_measures/segmented_shape_fps.hpp"
+#include "mesaac_measures/shape_fp_index.hpp"
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief A range of fingerprint popcounts, min_count..max_count inclusive.
+ * The range is empty if min_count > max_count.
+ */
+struct PopcountWindow {
+  unsigned int min_count;
+  unsigned int max_count;
+};
+
+/**
+ * @brief Get the popcounts which a fingerprint must have for its similarity
+ * to a query fingerprint to reach min_similarity.
+ *
+ * The bounds follow from each measure's definition, e.g. a Tanimoto
+ * similarity can be no greater than the ratio of the smaller to the larger
+ * popcount.  They are widened slightly to allow for floating point
+ * rounding.  BUB has no useful bound, so its window spans every popcount.
+ *
+ * @param type the measure
+ * @param alpha the Tversky alpha, if type is MeasureType::tversky
+ * @param min_similarity the least similarity of interest
+ * @param query_count the popcount of the query fingerprint
+ * @param num_bits the number of bits in each fingerprint
+ */
+PopcountWindow get_popcount_window(MeasureType type, float alpha,
+                                   float min_similarity,
+                                   unsigned int query_count,
+                                   unsigned int num_bits);
+
+/**
+ * @brief Write a popcount-partitioned search index of db.
+ *
+ * For each of the FPsPerShape orientations, the index holds that
+ * orientation's fingerprints sorted by popcount, an offset table giving
+ * where each popcount's bucket begins, and the global index in db of each
+ * fingerprint.  The index is a snapshot: shapes appended to db later are not
+ * included.
+ *
+ * @param db the shape fingerprints to index
+ * @param path the index file to create; an existing file is replaced
+ * @throw std::runtime_error if the index cannot be written
+ */
+void write_popcount_index(const SegmentedShapeFPs &db,
+                          const std::filesystem::path &path);
+
+/// @return true if path is a popcount index file, as opposed to some other
+/// kind of database
+bool is_popcount_index(const std::filesystem::path &path);
+
+/**
+ * @brief A read-only, memory-mapped popcount index, as written by
+ * write_popcount_index.
+ *
+ * A threshold search reads, for each orientation, only the popcount
+ * buckets in the query's feasible window.  Those buckets are contiguous, so
+ * the search touches a compact range of memory rather than candidates
+ * scattered through the database.
+ */
+class PopcountIndex : public IShapeFPIndex {
+public:
+  /**
+   * @brief Map a popcount index.
+   * @throw std::runtime_error if the file cannot be mapped or is not a
+   * valid popcount index
+   */
+  explicit PopcountIndex(const std::filesystem::path &path);
+
+  unsigned int size() const override { return m_num_shapes; }
+
+  unsigned int num_bits() const override { return m_num_bits; }
+
+  /**
+   * @brief Find the shapes whose measure against query passes threshold,
+   * as for IShapeFPIndex::search.  The results are the same as for a full
+   * scan.
+   */
+  std::vector<IndexHit> search(const mesaac::shape::ShapeFingerprint &query,
+                               MeasureType type, float alpha,
+                               bool compute_sim,
+                               float threshold) const override;
+
+private:
+  struct Orientation {
+    // offsets[c] is the position of the first fingerprint with popcount c.
+    const std::uint64_t *offsets;
+    const std::uint32_t *ids;
+    const std::uint64_t *words;
+  };
+
+  common::MappedFile m_file;
+  unsigned int m_num_bits;
+  unsigned int m_num_shapes;
+  unsigned int m_words_per_fp;
+  std::array<Orientation, FPsPerShape> m_orientations;
+};
+
+} // namespace mesaac::measures::shape
@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include "mesaac_measures/measures_base.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief Describes how to screen shape fingerprint pairs by measuring only
+ * a prefix of each fingerprint.
+ *
+ * This is meaningful for fingerprints built from a prefix-nested point
+ * cloud, such as a Halton cloud (see mesaac::shape::get_halton_ellipsoid),
+ * whose prefixes are themselves lower-resolution fingerprints.
+ */
+struct PrefixScreen {
+  /**
+   * @brief number of leading bits to measure when screening
+   */
+  unsigned int num_bits;
+
+  /**
+   * @brief the (dis)similarity threshold of interest
+   */
+  float threshold;
+
+  /**
+   * @brief how far the prefix measure must lie beyond the threshold
+   * before a pair is dropped
+   */
+  float margin;
+};
+
+/**
+ * @brief Get an indexed shape fingerprint measure which screens pairs on
+ * fingerprint prefixes.
+ *
+ * Each pair is first measured on the leading screen.num_bits bits of its
+ * fingerprints.  If the prefix similarity is less than
+ * screen.threshold - screen.margin (or the prefix distance is greater than
+ * screen.threshold + screen.margin) the pair is taken to be hopeless, and
+ * the prefix measure is returned.  Otherwise the full fingerprints are
+ * measured.
+ *
+ * Screening is a heuristic: a prefix measure only estimates the full
+ * measure, so a larger margin drops fewer pairs which would have passed
+ * the threshold.  If screen.num_bits is not less than the fingerprint
+ * length, no screening is done.
+ *
+ * @param measure the measure to compute
+ * @param compute_sim whether to compute similarity or distance values
+ * @param fingerprints the collection of shape fingerprints for which to
+ * compute measures; it must outlive the result
+ * @param screen describes how to screen pairs
+ * @return the measure, or nullptr if measure is null
+ */
+IIndexedShapeFPMeasure::Ptr get_prefix_screened_measurer(
+    MeasuresBase::Ptr measure, bool compute_sim,
+    const mesaac::shape::ShapeFingerprintVector &fingerprints,
+    const PrefixScreen &screen);
+
+} // namespace mesaac::measures::shape
@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "mesaac_common/mapped_file.hpp"
+#include "mesaac_measures/packed_shape_fps.hpp"
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief The number of bits set in each of a shape's fingerprints.
+ */
+using ShapePopcounts = std::array<std::uint32_t, FPsPerShape>;
+
+/**
+ * @brief Appends a segment of shape fingerprints to a segmented database.
+ *
+ * A segmented database is a directory holding a manifest and a set of
+ * immutable segments.  Each segment is a packed database, as written by
+ * PackedShapeFPWriter, with a popcount index alongside it.  The global index
+ * of a shape is its position in the concatenation of all live segments, in
+ * manifest order.  Appending and compacting never change the global index of
+ * an existing shape.
+ *
+ * A writer holds the database's lock from construction until close(), so
+ * appends and compactions are serialized.  Readers never take the lock: the
+ * manifest is replaced atomically, so readers see either the old or the new
+ * set of segments.
+ */
+class SegmentedShapeFPWriter {
+public:
+  /**
+   * @brief Begin a new segment, creating the database if necessary.
+   * @param dir the database directory
+   * @param num_bits the number of bits in each fingerprint
+   * @throw std::runtime_error if the database cannot be created or locked,
+   * or if it holds fingerprints of a different size
+   */
+  SegmentedShapeFPWriter(const std::filesystem::path &dir,
+                         unsigned int num_bits);
+
+  /// @brief Discard the new segment if close() has not been called.
+  ~SegmentedShapeFPWriter();
+
+  SegmentedShapeFPWriter(const SegmentedShapeFPWriter &src) = delete;
+  SegmentedShapeFPWriter &
+  operator=(const SegmentedShapeFPWriter &src) = delete;
+
+  /**
+   * @brief Append a shape fingerprint to the new segment.
+   * @throw std::invalid_argument if sfp has the wrong number of
+   * fingerprints or bits
+   */
+  void write(const mesaac::shape::ShapeFingerprint &sfp);
+
+  /// @brief Publish the new segment and release the database lock.  An
+  /// empty segment is discarded rather than published.
+  /// @throw std::runtime_error if the segment cannot be completed
+  void close();
+
+  /// @return the global index of the first shape in the new segment
+  std::uint64_t first_index() const { return m_first_index; }
+
+  /// @return the number of shapes written to the new segment
+  std::uint64_t size() const { return m_fps->size(); }
+
+private:
+  const std::filesystem::path m_dir;
+  const unsigned int m_num_bits;
+  int m_lock_fd;
+  std::uint64_t m_first_index;
+  std::string m_segment_name;
+  std::unique_ptr<PackedShapeFPWriter> m_fps;
+  std::ofstream m_popcounts_outf;
+
+  void discard();
+};
+
+/**
+ * @brief Merge all live segments of a segmented database into one.
+ *
+ * The merged segment is published before the old segments are removed.
+ * Readers that already have the old segments open can keep using them.
+ * @return the number of segments merged, or 0 if there were fewer than two
+ * @throw std::runtime_error if the database cannot be locked, read or
+ * written
+ */
+unsigned int compact_segments(const std::filesystem::path &dir);
+
+/**
+ * @return the path of the manifest of the segmented database in dir.  The
+ * manifest is rewritten whenever the set of live segments changes.
+ */
+std::filesystem::path segment_manifest_path(const std::filesystem::path &dir);
+
+/**
+ * @brief All live segments of a segmented database, read-only and
+ * memory-mapped, viewed as one database indexed by global index.
+ *
+ * A single packed database file, as written by shape_fp_pack, can be opened
+ * too.  It is treated as a database with one segment, and its popcount index
+ * is computed when it is opened.
+ */
+class SegmentedShapeFPs {
+public:
+  /**
+   * @brief Open a segmented database directory or a packed database file.
+   * @throw std::runtime_error if path is not a valid database
+   */
+  explicit SegmentedShapeFPs(const std::filesystem::path &path);
+
+  /// @return whether path appears to be a segmented database directory or
+  /// a packed database file
+  static bool is_database(const std::filesystem::path &path);
+
+  /// @return the number of shape fingerprints in all live segments
+  unsigned int size() const { return m_num_shapes; }
+
+  /// @return the number of bits in each fingerprint
+  unsigned int num_bits() const { return m_num_bits; }
+
+  /// @return the number of bytes occupied by one decoded shape fingerprint
+  std::size_t shape_bytes() const;
+
+  /// @return the number of live segments
+  unsigned int num_segments() const { return m_segments.size(); }
+
+  /// @brief Decode the shape fingerprint with global index i.  sfp's
+  /// storage is reused, as for PackedShapeFPs::get.
+  void get(unsigned int i, mesaac::shape::ShapeFingerprint &sfp) const;
+
+  /// @brief Decode shape fingerprints begin..(end - 1), appending them to
+  /// sfps.
+  void append_range(unsigned int begin, unsigned int end,
+                    mesaac::shape::ShapeFingerprintVector &sfps) const;
+
+  /// @return the packed words of the shape fingerprint with global index i,
+  /// as for PackedShapeFPs::words
+  std::span<const std::uint64_t> words(unsigned int i) const;
+
+  /// @return the popcounts of the shape fingerprint with global index i,
+  /// from its segment's popcount index
+  ShapePopcounts popcounts(unsigned int i) const;
+
+  /// @return true if segments have been appended or compacted since this
+  /// database was opened.  Reopen to see the changes.  This checks only the
+  /// manifest's file status, so it is cheap enough to call for every search.
+  bool is_stale() const;
+
+private:
+  struct Segment {
+    unsigned int first_index;
+    std::unique_ptr<PackedShapeFPs> fps;
+    std::unique_ptr<common::MappedFile> popcounts_file;
+    // Computed popcounts, for a packed database file without an index.
+    std::vector<std::uint32_t> computed_popcounts;
+    const std::uint32_t *popcounts;
+  };
+
+  // Identifies one version of a manifest.  Each update replaces the
+  // manifest file, so at least its inode or modification time changes.
+  struct ManifestStamp {
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    std::int64_t size = -1;
+    std::int64_t mtime_ns = 0;
+
+    bool operator==(const ManifestStamp &other) const = default;
+  };
+
+  const std::filesystem::path m_path;
+  std::string m_manifest;
+  ManifestStamp m_manifest_stamp;
+  std::vector<Segment> m_segments;
+  unsigned int m_num_bits;
+  unsigned int m_num_shapes;
+
+  void open_packed_file();
+  void open_segments();
+  const Segment &find_segment(unsigned int i) const;
+  static ManifestStamp get_manifest_stamp(const std::filesystem::path &dir);
+};
+
+} // namespace mesaac::measures::shape
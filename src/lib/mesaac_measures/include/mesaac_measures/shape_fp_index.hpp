@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::measures::shape {
+
+/**
+ * @brief A search hit: the global index of a shape, and its measure.
+ */
+struct IndexHit {
+  unsigned int index;
+  float value;
+};
+
+/**
+ * @brief This is the interface for on-disk indexes of a shape fingerprint
+ * database, which answer threshold searches without scanning every shape.
+ */
+class IShapeFPIndex {
+public:
+  using Ptr = std::shared_ptr<IShapeFPIndex>;
+
+  virtual ~IShapeFPIndex() = default;
+
+  /// @return the number of indexed shape fingerprints
+  virtual unsigned int size() const = 0;
+
+  /// @return the number of bits in each fingerprint
+  virtual unsigned int num_bits() const = 0;
+
+  /**
+   * @brief Find the shapes whose measure against query passes threshold.
+   *
+   * Shape measures are computed as for get_shape_pair_measurer: the best
+   * similarity of query's first fingerprint to any orientation of the
+   * shape.
+   *
+   * @param query the query shape fingerprint; it must have num_bits() bits
+   * @param type the measure
+   * @param alpha the Tversky alpha, if type is MeasureType::tversky
+   * @param compute_sim whether to compute similarity or distance values
+   * @param threshold report only values at least this similar, or no more
+   * than this distant
+   * @return the hits, in global index order
+   * @throw std::invalid_argument if query has the wrong number of bits
+   */
+  virtual std::vector<IndexHit>
+  search(const mesaac::shape::ShapeFingerprint &query, MeasureType type,
+         float alpha, bool compute_sim, float threshold) const = 0;
+};
+
+/// @return true if path is a shape fingerprint index file of any kind, as
+/// opposed to a database
+bool is_shape_fp_index(const std::filesystem::path &path);
+
+/**
+ * @brief Open a shape fingerprint index of any kind.
+ * @throw std::runtime_error if path is not a valid index
+ */
+IShapeFPIndex::Ptr open_shape_fp_index(const std::filesystem::path &path);
+
+} // namespace mesaac::measures::shape
@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 
+#include "mesaac_measures/compressed_shape_fps.hpp"
 #include "mesaac_measures/measures_base.hpp"
 #include "mesaac_shape/shared_types.hpp"
 
@@ -50,6 +51,35 @@ public:
    * @return the similarity/distance measure of the two shape fingerprints
    */
   virtual float value(unsigned int i, unsigned int j) const = 0;
+
+  /**
+   * @brief Get the measures of one fingerprint against a range of
+   * fingerprints.
+   *
+   * Measurers from get_fp_measurer and get_shape_measurer dispatch once
+   * per call to a kernel specialized for their measure, so this is much
+   * faster than calling value for each pair.  The default implementation
+   * calls value for each pair.
+   *
+   * @param i index of a shape fingerprint
+   * @param j_begin index of the first shape fingerprint to measure against
+   * @param j_end one past the index of the last shape fingerprint
+   * @param out receives the j_end - j_begin values, value(i, j) at
+   * out[j - j_begin]
+   */
+  virtual void value_row(unsigned int i, unsigned int j_begin,
+                         unsigned int j_end, float *out) const;
+
+  /**
+   * @brief Get the measures of a block of fingerprints against a range of
+   * fingerprints, as for value_row.  The default implementation calls
+   * value_row for each row.
+   * @param out receives (i_end - i_begin) * (j_end - j_begin) values in
+   * row-major order
+   */
+  virtual void value_block(unsigned int i_begin, unsigned int i_end,
+                           unsigned int j_begin, unsigned int j_end,
+                           float *out) const;
 };
 
 /**
@@ -71,6 +101,15 @@ IIndexedShapeFPMeasure::Ptr
 get_shape_measurer(MeasuresBase::Ptr measure, bool compute_sim,
                    const mesaac::shape::ShapeFingerprintVector &fingerprints);
 
+/**
+ * @brief Get a shape fingerprint measure which works directly on
+ * compressed fingerprints.  Its values are the same as those of
+ * get_shape_measurer for the decoded fingerprints.
+ */
+IIndexedShapeFPMeasure::Ptr
+get_shape_measurer(MeasuresBase::Ptr measure, bool compute_sim,
+                   const CompressedShapeFPs &fingerprints);
+
 IShapeFPMeasure::Ptr get_shape_pair_measurer(MeasuresBase::Ptr measure,
                                              bool compute_sim);
 
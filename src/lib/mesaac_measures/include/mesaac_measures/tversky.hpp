@@ -17,8 +17,19 @@ public:
   Tversky(float a);
 
   std::string name() const override { return "Tversky"; }
-  float similarity(const shape_defs::BitVector &v1,
-                   const shape_defs::BitVector &v2) const override;
+  using MeasuresBase::similarity;
+  float similarity(const ContingencyCounts &counts) const override {
+    float a = counts.a;
+    float b = counts.b;
+    float c = counts.c;
+
+    float result = 1.0; // if denom is zero, v1 and v2 must be zero, and ==.
+    float denom = (a + alpha * b + beta * c);
+    if (denom) {
+      result = a / denom;
+    }
+    return result;
+  }
 };
 
 } // namespace mesaac::measures
\ No newline at end of file
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "mesaac_measures/shape_measures_factory.hpp"
+#include "mesaac_measures/usr_vectors.hpp"
+
+namespace mesaac::measures {
+
+/**
+ * @brief Compute the USR similarity of two vectors:
+ * 1 / (1 + (sum of |a_k - b_k|) / num_features).
+ * @param a padded values of one vector
+ * @param b padded values of another vector
+ * @param stride the padded length of both vectors
+ * @param num_features the number of descriptors in each vector
+ */
+float usr_similarity(const float *a, const float *b, std::size_t stride,
+                     unsigned int num_features);
+
+/**
+ * @brief Compute the USR similarities of rows begin..(end - 1) of one
+ * collection to every vector of another.  The work is divided into tiles
+ * of rows and columns, which are computed in parallel when OpenMP is
+ * available.
+ * @param rows the row vectors
+ * @param begin index of the first row vector
+ * @param end one past the index of the last row vector
+ * @param cols the column vectors
+ * @param values on return, (end - begin) * cols.size() similarities, in row
+ * major order
+ * @throw std::invalid_argument if the collections' vector lengths differ,
+ * or values is too small
+ */
+void usr_similarities(const UsrVectors &rows, unsigned int begin,
+                      unsigned int end, const UsrVectors &cols,
+                      std::span<float> values);
+
+/// @brief A search result.
+struct UsrHit {
+  unsigned int index;
+  float similarity;
+};
+
+/**
+ * @brief Find the k vectors most similar to a query.
+ * @return up to k hits, most similar first; ties are ordered by index
+ * @throw std::invalid_argument if query has the wrong length
+ */
+std::vector<UsrHit> usr_top_k(const UsrVectors &vectors,
+                              std::span<const float> query, unsigned int k);
+
+/**
+ * @brief Find the vectors whose similarity to a query is at least
+ * min_similarity.
+ * @return the hits, in index order
+ * @throw std::invalid_argument if query has the wrong length
+ */
+std::vector<UsrHit> usr_within(const UsrVectors &vectors,
+                               std::span<const float> query,
+                               float min_similarity);
+
+/**
+ * @brief Get an indexed USR measure for a collection of vectors.
+ *
+ * Distances are 1 - similarity.  Every vector has similarity 1 and
+ * distance 0 to itself.  The measure holds a reference to vectors, which
+ * must outlive it.
+ */
+shape::IIndexedShapeFPMeasure::Ptr get_usr_measurer(bool compute_sim,
+                                                    const UsrVectors &vectors);
+
+} // namespace mesaac::measures
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "mesaac_common/mapped_file.hpp"
+
+namespace mesaac::measures {
+
+/**
+ * @brief A collection of equal-length USR (Ultrafast Shape Recognition)
+ * descriptor vectors, stored as one contiguous float matrix.
+ *
+ * Each vector is zero-padded to a whole number of SIMD-friendly chunks.
+ * Zero padding does not change USR measures.  A collection either owns its
+ * values or maps a packed file written by UsrVectorWriter.
+ */
+class UsrVectors {
+public:
+  /// The number of floats by which row lengths are padded.
+  static constexpr std::size_t Chunk = 16;
+
+  /**
+   * @brief Create an empty collection.
+   * @param num_features the number of descriptors in each vector
+   */
+  explicit UsrVectors(unsigned int num_features);
+
+  /**
+   * @brief Map a packed USR vector file.
+   * @throw std::runtime_error if the file cannot be mapped or is not a
+   * valid packed USR vector file
+   */
+  explicit UsrVectors(const std::filesystem::path &packed_path);
+
+  /// @return whether path appears to be a packed USR vector file
+  static bool is_packed(const std::filesystem::path &path);
+
+  /**
+   * @brief Append a vector.
+   * @throw std::invalid_argument if values has the wrong length
+   * @throw std::logic_error if the collection is a mapped file
+   */
+  void push_back(std::span<const float> values);
+
+  /// @return the number of vectors
+  unsigned int size() const { return m_size; }
+
+  /// @return the number of descriptors in each vector, excluding padding
+  unsigned int num_features() const { return m_num_features; }
+
+  /// @return the padded length of each vector
+  std::size_t stride() const { return m_stride; }
+
+  /// @return the padded values of vector i
+  const float *operator[](unsigned int i) const {
+    return data() + std::size_t(i) * m_stride;
+  }
+
+private:
+  unsigned int m_num_features;
+  std::size_t m_stride;
+  unsigned int m_size;
+  std::vector<float> m_values;
+  std::unique_ptr<common::MappedFile> m_file;
+  const float *m_mapped;
+
+  const float *data() const { return m_file ? m_mapped : m_values.data(); }
+};
+
+/**
+ * @brief Writes USR vectors to a packed binary file, which UsrVectors can
+ * memory-map.
+ *
+ * The file holds a fixed-size header followed by each vector, padded to
+ * UsrVectors::Chunk floats, in native byte order.
+ */
+class UsrVectorWriter {
+public:
+  /**
+   * @brief Create a packed USR vector file.
+   * @param path the file to create; an existing file is replaced
+   * @param num_features the number of descriptors in each vector
+   * @throw std::runtime_error if the file cannot be created
+   */
+  UsrVectorWriter(const std::filesystem::path &path,
+                  unsigned int num_features);
+  ~UsrVectorWriter();
+
+  UsrVectorWriter(const UsrVectorWriter &src) = delete;
+  UsrVectorWriter &operator=(const UsrVectorWriter &src) = delete;
+
+  /**
+   * @brief Append a vector.
+   * @throw std::invalid_argument if values has the wrong length
+   * @throw std::runtime_error if the vector cannot be written
+   */
+  void write(std::span<const float> values);
+
+  /// @brief Finish the file header and close the file.
+  /// @throw std::runtime_error if the file cannot be completed
+  void close();
+
+  std::uint64_t size() const { return m_size; }
+
+private:
+  const std::filesystem::path m_path;
+  const unsigned int m_num_features;
+  std::vector<float> m_row;
+  std::uint64_t m_size;
+  std::ofstream m_outf;
+};
+
+} // namespace mesaac::measures
@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/butina_clusterer.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+namespace mesaac::measures::shape {
+
+ButinaClusters cluster_taylor_butina(const NeighborLists &neighbors) {
+  const unsigned int num_fps = neighbors.size();
+  const unsigned int unassigned = numeric_limits<unsigned int>::max();
+
+  ButinaClusters result;
+  result.assignments.assign(num_fps, unassigned);
+
+  vector<unsigned int> order(num_fps);
+  iota(order.begin(), order.end(), 0);
+  stable_sort(order.begin(), order.end(),
+              [&neighbors](unsigned int i1, unsigned int i2) {
+                return neighbors.count(i1) > neighbors.count(i2);
+              });
+
+  NeighborLists::IndexList members;
+  for (const unsigned int centroid : order) {
+    if (result.assignments[centroid] != unassigned) {
+      continue;
+    }
+    const unsigned int cluster = result.centroids.size();
+    result.centroids.push_back(centroid);
+    result.assignments[centroid] = cluster;
+    unsigned int size = 1;
+
+    neighbors.neighbors(centroid, members);
+    for (const auto j : members) {
+      if (result.assignments[j] == unassigned) {
+        result.assignments[j] = cluster;
+        size++;
+      }
+    }
+    result.sizes.push_back(size);
+  }
+  return result;
+}
+
+} // namespace mesaac::measures::shape
@@ -0,0 +1,345 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/compressed_fp.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <format>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace mesaac::measures {
+
+namespace {
+using Word = std::uint64_t;
+static_assert(sizeof(shape_defs::BitVector::block_type) == sizeof(Word),
+              "Compressed fingerprints assume 64-bit BitVector blocks");
+
+const unsigned int WordBits = 8 * sizeof(Word);
+const unsigned int WordsPerBlock = CompressedFP::BlockBits / WordBits;
+
+unsigned int num_words_for(unsigned int num_bits) {
+  return (num_bits + WordBits - 1) / WordBits;
+}
+
+unsigned int num_blocks_for(unsigned int num_bits) {
+  return (num_bits + CompressedFP::BlockBits - 1) / CompressedFP::BlockBits;
+}
+
+// dynamic_bitset offers no read access to its blocks short of copying
+// them.
+span<const Word> get_words(const shape_defs::BitVector &fp) {
+  thread_local vector<Word> words;
+  words.resize(fp.num_blocks());
+  boost::to_block_range(fp, words.begin());
+  return words;
+}
+
+// Whether a block of num_words words with count bits set is smaller
+// stored as offsets.  The last block may be partial.
+bool is_sparse(unsigned int count, unsigned int num_words) {
+  return count < CompressedFP::MaxSparseBits * num_words / WordsPerBlock;
+}
+
+bool has_bit(const Word *words, std::uint16_t offset) {
+  return (words[offset / WordBits] >> (offset % WordBits)) & 1;
+}
+
+unsigned int dense_dense_count(const Word *words1, const Word *words2,
+                               unsigned int num_words) {
+  unsigned int result = 0;
+  for (unsigned int i = 0; i < num_words; i++) {
+    result += popcount(words1[i] & words2[i]);
+  }
+  return result;
+}
+
+unsigned int dense_sparse_count(const Word *words,
+                                const std::uint16_t *offsets,
+                                unsigned int num_offsets) {
+  unsigned int result = 0;
+  for (unsigned int i = 0; i < num_offsets; i++) {
+    result += has_bit(words, offsets[i]);
+  }
+  return result;
+}
+
+unsigned int sparse_sparse_count(const std::uint16_t *offsets1,
+                                 unsigned int num_offsets1,
+                                 const std::uint16_t *offsets2,
+                                 unsigned int num_offsets2) {
+  unsigned int result = 0;
+  unsigned int i1 = 0;
+  unsigned int i2 = 0;
+  while (i1 < num_offsets1 && i2 < num_offsets2) {
+    const std::uint16_t o1 = offsets1[i1];
+    const std::uint16_t o2 = offsets2[i2];
+    result += (o1 == o2);
+    i1 += (o1 <= o2);
+    i2 += (o2 <= o1);
+  }
+  return result;
+}
+
+template <typename T>
+void write_values(ostream &outs, const vector<T> &values) {
+  outs.write(reinterpret_cast<const char *>(values.data()),
+             values.size() * sizeof(T));
+}
+
+template <typename T> void read_values(istream &ins, vector<T> &values) {
+  ins.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(T));
+  if (!ins) {
+    throw runtime_error("Compressed fingerprint is truncated.");
+  }
+}
+} // namespace
+
+CompressedFP::CompressedFP() : m_num_bits(0), m_count(0) {}
+
+CompressedFP::CompressedFP(const shape_defs::BitVector &fp)
+    : CompressedFP(get_words(fp), fp.size()) {}
+
+CompressedFP::CompressedFP(span<const Word> words, unsigned int num_bits)
+    : m_num_bits(num_bits), m_count(0) {
+  if (words.size() != num_words_for(num_bits)) {
+    throw invalid_argument(
+        format("{} words cannot hold a {}-bit fingerprint.", words.size(),
+               num_bits));
+  }
+  const unsigned int num_blocks = num_blocks_for(m_num_bits);
+  const unsigned int tail_bits = m_num_bits % WordBits;
+  m_blocks.reserve(num_blocks);
+  for (unsigned int block = 0; block < num_blocks; block++) {
+    const auto block_span =
+        words.subspan(block * WordsPerBlock, block_words(block));
+    if ((block + 1 == num_blocks) && tail_bits) {
+      // Don't trust the unused bits of the last word to be clear.
+      array<Word, WordsPerBlock> last;
+      copy(block_span.begin(), block_span.end(), last.begin());
+      last[block_span.size() - 1] &= (Word(1) << tail_bits) - 1;
+      append_block(span<const Word>(last.data(), block_span.size()));
+    } else {
+      append_block(block_span);
+    }
+  }
+  // Growing the payloads block by block leaves spare capacity.
+  m_offsets.shrink_to_fit();
+  m_words.shrink_to_fit();
+}
+
+unsigned int CompressedFP::block_words(size_t block) const {
+  return min<size_t>(WordsPerBlock,
+                     num_words_for(m_num_bits) - block * WordsPerBlock);
+}
+
+void CompressedFP::append_block(span<const Word> words) {
+  unsigned int count = 0;
+  for (const Word word : words) {
+    count += popcount(word);
+  }
+  m_count += count;
+
+  Block block{.start = 0, .count = std::uint16_t(count),
+              .encoding = Encoding::empty};
+  if (count == 0) {
+    // Nothing to store.
+  } else if (is_sparse(count, words.size())) {
+    block.start = m_offsets.size();
+    block.encoding = Encoding::sparse;
+    for (unsigned int i = 0; i < words.size(); i++) {
+      for (Word word = words[i]; word; word &= word - 1) {
+        m_offsets.push_back(i * WordBits + countr_zero(word));
+      }
+    }
+  } else {
+    block.start = m_words.size();
+    block.encoding = Encoding::dense;
+    m_words.insert(m_words.end(), words.begin(), words.end());
+  }
+  m_blocks.push_back(block);
+}
+
+unsigned int CompressedFP::num_dense_blocks() const {
+  return count_if(m_blocks.begin(), m_blocks.end(), [](const Block &block) {
+    return block.encoding == Encoding::dense;
+  });
+}
+
+unsigned int CompressedFP::num_sparse_blocks() const {
+  return count_if(m_blocks.begin(), m_blocks.end(), [](const Block &block) {
+    return block.encoding == Encoding::sparse;
+  });
+}
+
+size_t CompressedFP::memory_bytes() const {
+  return sizeof(*this) + m_blocks.size() * sizeof(Block) +
+         m_offsets.size() * sizeof(std::uint16_t) +
+         m_words.size() * sizeof(Word);
+}
+
+void CompressedFP::decode(shape_defs::BitVector &fp) const {
+  thread_local vector<Word> words;
+  words.assign(num_words_for(m_num_bits), 0);
+  for (size_t b = 0; b < m_blocks.size(); b++) {
+    const Block &block = m_blocks[b];
+    Word *block_words_out = words.data() + b * WordsPerBlock;
+    if (block.encoding == Encoding::dense) {
+      copy_n(m_words.begin() + block.start, block_words(b), block_words_out);
+    } else if (block.encoding == Encoding::sparse) {
+      for (unsigned int i = 0; i < block.count; i++) {
+        const std::uint16_t offset = m_offsets[block.start + i];
+        block_words_out[offset / WordBits] |= Word(1) << (offset % WordBits);
+      }
+    }
+  }
+  // Refill in place, as for shape::PackedShapeFPs::get.
+  fp.clear();
+  fp.append(words.begin(), words.end());
+  fp.resize(m_num_bits);
+}
+
+void CompressedFP::write(ostream &outs) const {
+  // A directory of (encoding, count) pairs, one per block, followed by
+  // all offsets and then all words.  Block starts are implied.
+  vector<std::uint16_t> directory;
+  directory.reserve(2 * m_blocks.size());
+  for (const Block &block : m_blocks) {
+    directory.push_back(std::uint16_t(block.encoding));
+    directory.push_back(block.count);
+  }
+  write_values(outs, directory);
+  write_values(outs, m_offsets);
+  write_values(outs, m_words);
+  if (!outs) {
+    throw runtime_error("Cannot write compressed fingerprint.");
+  }
+}
+
+CompressedFP CompressedFP::read(istream &ins, unsigned int num_bits) {
+  CompressedFP result;
+  result.m_num_bits = num_bits;
+  vector<std::uint16_t> directory(2 * num_blocks_for(num_bits));
+  read_values(ins, directory);
+
+  size_t num_offsets = 0;
+  size_t num_words = 0;
+  result.m_blocks.resize(directory.size() / 2);
+  for (size_t b = 0; b < result.m_blocks.size(); b++) {
+    Block &block = result.m_blocks[b];
+    const std::uint16_t encoding = directory[2 * b];
+    block.count = directory[2 * b + 1];
+    if (encoding == std::uint16_t(Encoding::empty) && block.count == 0) {
+      block.start = 0;
+      block.encoding = Encoding::empty;
+    } else if (encoding == std::uint16_t(Encoding::sparse) &&
+               block.count > 0 &&
+               is_sparse(block.count, result.block_words(b))) {
+      block.start = num_offsets;
+      block.encoding = Encoding::sparse;
+      num_offsets += block.count;
+    } else if (encoding == std::uint16_t(Encoding::dense)) {
+      block.start = num_words;
+      block.encoding = Encoding::dense;
+      num_words += result.block_words(b);
+    } else {
+      throw runtime_error(
+          format("Compressed fingerprint block {} is invalid.", b));
+    }
+    result.m_count += block.count;
+  }
+  result.m_offsets.resize(num_offsets);
+  read_values(ins, result.m_offsets);
+  result.m_words.resize(num_words);
+  read_values(ins, result.m_words);
+
+  // Check the payload against the directory, so that corrupt input
+  // cannot produce out-of-range offsets or miscounts.
+  for (size_t b = 0; b < result.m_blocks.size(); b++) {
+    const Block &block = result.m_blocks[b];
+    const unsigned int bits_in_block =
+        min<size_t>(BlockBits, num_bits - b * BlockBits);
+    bool valid = true;
+    if (block.encoding == Encoding::sparse) {
+      const auto *offsets = result.m_offsets.data() + block.start;
+      // Offsets must be strictly increasing, and within the block.
+      valid = (adjacent_find(offsets, offsets + block.count,
+                             greater_equal<std::uint16_t>()) ==
+               offsets + block.count) &&
+              (offsets[block.count - 1] < bits_in_block);
+    } else if (block.encoding == Encoding::dense) {
+      const auto *words = result.m_words.data() + block.start;
+      const unsigned int n = result.block_words(b);
+      valid = (dense_dense_count(words, words, n) == block.count) &&
+              ((bits_in_block % WordBits == 0) ||
+               (words[n - 1] >> (bits_in_block % WordBits)) == 0);
+    }
+    if (!valid) {
+      throw runtime_error(
+          format("Compressed fingerprint block {} is invalid.", b));
+    }
+  }
+  return result;
+}
+
+unsigned int intersection_count(const CompressedFP &fp1,
+                                const CompressedFP &fp2) {
+  using Encoding = CompressedFP::Encoding;
+  if (fp1.m_num_bits != fp2.m_num_bits) {
+    throw invalid_argument(
+        format("Cannot compare fingerprints of {} and {} bits.",
+               fp1.m_num_bits, fp2.m_num_bits));
+  }
+  unsigned int result = 0;
+  for (size_t b = 0; b < fp1.m_blocks.size(); b++) {
+    const auto &block1 = fp1.m_blocks[b];
+    const auto &block2 = fp2.m_blocks[b];
+    if (block1.encoding == Encoding::empty ||
+        block2.encoding == Encoding::empty) {
+      continue;
+    }
+    const bool dense1 = block1.encoding == Encoding::dense;
+    const bool dense2 = block2.encoding == Encoding::dense;
+    if (dense1 && dense2) {
+      result += dense_dense_count(fp1.m_words.data() + block1.start,
+                                  fp2.m_words.data() + block2.start,
+                                  fp1.block_words(b));
+    } else if (dense1) {
+      result += dense_sparse_count(fp1.m_words.data() + block1.start,
+                                   fp2.m_offsets.data() + block2.start,
+                                   block2.count);
+    } else if (dense2) {
+      result += dense_sparse_count(fp2.m_words.data() + block2.start,
+                                   fp1.m_offsets.data() + block1.start,
+                                   block1.count);
+    } else {
+      result += sparse_sparse_count(fp1.m_offsets.data() + block1.start,
+                                    block1.count,
+                                    fp2.m_offsets.data() + block2.start,
+                                    block2.count);
+    }
+  }
+  return result;
+}
+
+unsigned int union_count(const CompressedFP &fp1, const CompressedFP &fp2) {
+  return fp1.count() + fp2.count() - intersection_count(fp1, fp2);
+}
+
+ContingencyCounts get_contingency_counts(const CompressedFP &fp1,
+                                         const CompressedFP &fp2) {
+  const unsigned int both = intersection_count(fp1, fp2);
+  return {.a = both,
+          .b = fp1.count() - both,
+          .c = fp2.count() - both,
+          .n = fp1.num_bits()};
+}
+
+} // namespace mesaac::measures
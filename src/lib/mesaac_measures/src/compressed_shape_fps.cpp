@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/compressed_shape_fps.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#include "mesaac_common/stats.hpp"
+
+using namespace std;
+
+namespace mesaac::measures::shape {
+
+namespace {
+const char Magic[8] = {'M', 'E', 'S', 'A', 'S', 'F', 'P', 'Z'};
+const std::uint32_t Version = 1;
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t fps_per_shape;
+  std::uint32_t num_bits;
+  std::uint32_t reserved;
+  std::uint64_t num_shapes;
+};
+static_assert(sizeof(Header) == 32);
+
+Header make_header(unsigned int num_bits, std::uint64_t num_shapes) {
+  Header result{};
+  memcpy(result.magic, Magic, sizeof(Magic));
+  result.version = Version;
+  result.fps_per_shape = FPsPerShape;
+  result.num_bits = num_bits;
+  result.num_shapes = num_shapes;
+  return result;
+}
+
+void check_shape(const mesaac::shape::ShapeFingerprint &sfp,
+                 unsigned int num_bits) {
+  if (sfp.size() != FPsPerShape) {
+    throw invalid_argument(format("Shape fingerprint has {} fingerprints; "
+                                  "expected {}",
+                                  sfp.size(), FPsPerShape));
+  }
+  for (const auto &fp : sfp) {
+    if (fp.size() != num_bits) {
+      throw invalid_argument(format("Fingerprint has {} bits; expected {}",
+                                    fp.size(), num_bits));
+    }
+  }
+}
+} // namespace
+
+CompressedShapeFPs::CompressedShapeFPs(unsigned int num_bits)
+    : m_num_bits(num_bits) {}
+
+CompressedShapeFPs::CompressedShapeFPs(const filesystem::path &path)
+    : m_num_bits(0) {
+  static common::stats::Stage &read_stage(
+      common::stats::stage("CompressedShapeFPs::read"));
+
+  ifstream inf(path, ios::binary);
+  Header header;
+  inf.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!inf || (memcmp(header.magic, Magic, sizeof(Magic)) != 0) ||
+      (header.fps_per_shape != FPsPerShape)) {
+    throw runtime_error(format(
+        "{} is not a compressed shape fingerprint file.", path.string()));
+  }
+  if (header.version != Version) {
+    throw runtime_error(format("{} has unsupported version {}.",
+                               path.string(), header.version));
+  }
+
+  const common::stats::ScopedTimer timer(read_stage, header.num_shapes);
+  m_num_bits = header.num_bits;
+  try {
+    // Don't let a corrupt shape count size the allocation.
+    m_fps.reserve(min<std::uint64_t>(header.num_shapes * FPsPerShape,
+                                     filesystem::file_size(path)));
+    for (std::uint64_t i = 0; i < header.num_shapes * FPsPerShape; i++) {
+      m_fps.push_back(CompressedFP::read(inf, m_num_bits));
+    }
+  } catch (const runtime_error &e) {
+    throw runtime_error(format("{} is truncated or corrupt: {}",
+                               path.string(), e.what()));
+  }
+  if (inf.peek() != ifstream::traits_type::eof()) {
+    throw runtime_error(format("{} is corrupt: unexpected data after {} "
+                               "shape fingerprints.",
+                               path.string(), header.num_shapes));
+  }
+}
+
+bool CompressedShapeFPs::is_compressed(const filesystem::path &path) {
+  char magic[sizeof(Magic)] = {};
+  ifstream inf(path, ios::binary);
+  inf.read(magic, sizeof(magic));
+  return inf && (memcmp(magic, Magic, sizeof(Magic)) == 0);
+}
+
+void CompressedShapeFPs::push_back(
+    const mesaac::shape::ShapeFingerprint &sfp) {
+  check_shape(sfp, m_num_bits);
+  for (const auto &fp : sfp) {
+    m_fps.emplace_back(fp);
+  }
+}
+
+void CompressedShapeFPs::get(unsigned int i,
+                             mesaac::shape::ShapeFingerprint &sfp) const {
+  if (i >= size()) {
+    throw out_of_range(
+        format("Shape index {} is out of range (0..{})", i, size()));
+  }
+  sfp.resize(FPsPerShape);
+  for (unsigned int k = 0; k != FPsPerShape; k++) {
+    fp(i, k).decode(sfp[k]);
+  }
+}
+
+void CompressedShapeFPs::append_range(
+    unsigned int begin, unsigned int end,
+    mesaac::shape::ShapeFingerprintVector &sfps) const {
+  sfps.reserve(sfps.size() + (end - begin));
+  for (unsigned int i = begin; i < end; ++i) {
+    sfps.emplace_back();
+    get(i, sfps.back());
+  }
+}
+
+size_t CompressedShapeFPs::memory_bytes() const {
+  size_t result = sizeof(*this);
+  for (const auto &fp : m_fps) {
+    result += fp.memory_bytes();
+  }
+  return result;
+}
+
+CompressedShapeFPWriter::CompressedShapeFPWriter(const filesystem::path &path,
+                                                 unsigned int num_bits)
+    : m_path(path), m_num_bits(num_bits), m_num_shapes(0),
+      m_outf(path, ios::binary | ios::trunc) {
+  if (!m_outf) {
+    throw runtime_error(
+        format("Cannot open {} for writing.", m_path.string()));
+  }
+  // Write a provisional header; close() fills in the shape count.
+  const Header header(make_header(m_num_bits, 0));
+  m_outf.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+CompressedShapeFPWriter::~CompressedShapeFPWriter() {
+  if (m_outf.is_open()) {
+    try {
+      close();
+    } catch (const exception &) {
+      // Destructors must not throw.
+    }
+  }
+}
+
+void CompressedShapeFPWriter::write(
+    const mesaac::shape::ShapeFingerprint &sfp) {
+  static common::stats::Stage &write_stage(
+      common::stats::stage("CompressedShapeFPWriter::write"));
+  const common::stats::ScopedTimer timer(write_stage);
+
+  check_shape(sfp, m_num_bits);
+  try {
+    for (const auto &fp : sfp) {
+      CompressedFP(fp).write(m_outf);
+    }
+  } catch (const runtime_error &) {
+    throw runtime_error(format("Cannot write to {}", m_path.string()));
+  }
+  m_num_shapes++;
+}
+
+void CompressedShapeFPWriter::close() {
+  const Header header(make_header(m_num_bits, m_num_shapes));
+  m_outf.seekp(0);
+  m_outf.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  m_outf.close();
+  if (!m_outf) {
+    throw runtime_error(format("Cannot complete {}", m_path.string()));
+  }
+}
+
+} // namespace mesaac::measures::shape
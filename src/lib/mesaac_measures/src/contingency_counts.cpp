@@ -0,0 +1,39 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/contingency_counts.hpp"
+
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace mesaac::measures {
+
+namespace {
+using Word = std::uint64_t;
+static_assert(sizeof(shape_defs::BitVector::block_type) == sizeof(Word),
+              "Contingency counts assume 64-bit BitVector blocks");
+} // namespace
+
+ContingencyCounts get_contingency_counts(const shape_defs::BitVector &v1,
+                                         const shape_defs::BitVector &v2) {
+  if (v1.size() != v2.size()) {
+    throw invalid_argument(format(
+        "Cannot compare bit vectors of {} and {} bits.", v1.size(), v2.size()));
+  }
+  // dynamic_bitset offers no read access to its blocks short of copying
+  // them.  Copying into per-thread buffers which outlive the call is
+  // still far cheaper than allocating a temporary bit vector per count.
+  thread_local vector<Word> words1;
+  thread_local vector<Word> words2;
+  words1.resize(v1.num_blocks());
+  words2.resize(v2.num_blocks());
+  boost::to_block_range(v1, words1.begin());
+  boost::to_block_range(v2, words2.begin());
+  return get_contingency_counts(words1, words2, v1.size());
+}
+
+} // namespace mesaac::measures
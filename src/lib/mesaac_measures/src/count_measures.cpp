@@ -0,0 +1,290 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/count_measures.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace mesaac::measures {
+
+namespace {
+// Kernels over padded count vectors.  Each loop body is branch-free so
+// that it can be vectorized; "omp simd" lets the compiler reorder the
+// floating point reductions to do so.  Counts are compared as 32-bit
+// integers, which vectorizes more readily than narrow types.
+
+template <typename CountType>
+float tanimoto_sum(const CountType *a, const CountType *b, size_t n) {
+  float sum = 0.0;
+#if HAVE_OPENMP
+#pragma omp simd reduction(+ : sum)
+#endif
+  for (size_t k = 0; k < n; ++k) {
+    // Where neither vector has a feature, lo is 0 and hi is replaced by 1,
+    // so the feature contributes nothing.
+    const int32_t x = a[k], y = b[k];
+    const int32_t lo = (x < y) ? x : y;
+    const int32_t hi = (x < y) ? y : x;
+    sum += float(lo) / float(hi | (hi == 0));
+  }
+  return sum;
+}
+
+template <typename CountType>
+float tversky_sum(const CountType *a, const CountType *b, size_t n,
+                  float alpha, float beta) {
+  float sum = 0.0;
+#if HAVE_OPENMP
+#pragma omp simd reduction(+ : sum)
+#endif
+  for (size_t k = 0; k < n; ++k) {
+    const int32_t x = a[k], y = b[k];
+    const int32_t lo = (x < y) ? x : y;
+    const int32_t hi = (x < y) ? y : x;
+    const float weight = (x < y) ? beta : alpha;
+    sum += float(lo) / (weight * float(hi | (hi == 0)));
+  }
+  return sum;
+}
+
+template <typename CountType>
+int64_t squared_distance(const CountType *a, const CountType *b, size_t n) {
+  int64_t sum = 0;
+#if HAVE_OPENMP
+#pragma omp simd reduction(+ : sum)
+#endif
+  for (size_t k = 0; k < n; ++k) {
+    const int64_t diff = int64_t(a[k]) - int64_t(b[k]);
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+template <typename CountType>
+uint64_t dot_product(const CountType *a, const CountType *b, size_t n) {
+  uint64_t sum = 0;
+#if HAVE_OPENMP
+#pragma omp simd reduction(+ : sum)
+#endif
+  for (size_t k = 0; k < n; ++k) {
+    sum += uint64_t(a[k]) * uint64_t(b[k]);
+  }
+  return sum;
+}
+
+template <typename CountType>
+unsigned int num_present(const CountType *a, size_t n) {
+  unsigned int sum = 0;
+#if HAVE_OPENMP
+#pragma omp simd reduction(+ : sum)
+#endif
+  for (size_t k = 0; k < n; ++k) {
+    sum += (a[k] > 0) ? 1 : 0;
+  }
+  return sum;
+}
+
+template <typename CountType>
+unsigned int max_count(const CountType *a, size_t n) {
+  CountType result = 0;
+#if HAVE_OPENMP
+#pragma omp simd reduction(max : result)
+#endif
+  for (size_t k = 0; k < n; ++k) {
+    result = (a[k] > result) ? a[k] : result;
+  }
+  return result;
+}
+
+// Get the largest value of stat(counts[i]) for all i.
+template <typename CountType, typename Stat>
+auto max_stat(const CountVectors<CountType> &counts, Stat stat) {
+  decltype(stat(counts[0], counts.stride())) result = 0;
+  const int num_vectors = counts.size();
+#if HAVE_OPENMP
+#pragma omp parallel for reduction(max : result)
+#endif
+  for (int i = 0; i < num_vectors; ++i) {
+    result = max(result, stat(counts[i], counts.stride()));
+  }
+  return result;
+}
+
+template <typename CountType>
+class CountMeasurer : public shape::IIndexedShapeFPMeasure {
+public:
+  CountMeasurer(const CountVectors<CountType> &counts, bool compute_sim)
+      : m_counts(counts), m_compute_sim(compute_sim) {}
+
+  float value(unsigned int i, unsigned int j) const override {
+    if (i == j) {
+      return m_compute_sim ? 1.0 : 0.0;
+    }
+    const float sim = similarity(i, j);
+    return m_compute_sim ? sim : 1.0 - sim;
+  }
+
+protected:
+  const CountVectors<CountType> &m_counts;
+
+  virtual float similarity(unsigned int i, unsigned int j) const = 0;
+
+private:
+  const bool m_compute_sim;
+};
+
+template <typename CountType>
+class TanimotoCountMeasurer : public CountMeasurer<CountType> {
+public:
+  TanimotoCountMeasurer(const CountVectors<CountType> &counts,
+                        bool compute_sim)
+      : CountMeasurer<CountType>(counts, compute_sim),
+        m_norm(max(1u, max_stat(counts, num_present<CountType>))) {}
+
+protected:
+  float similarity(unsigned int i, unsigned int j) const override {
+    const auto &counts(this->m_counts);
+    return tanimoto_sum(counts[i], counts[j], counts.stride()) / m_norm;
+  }
+
+private:
+  const float m_norm;
+};
+
+template <typename CountType>
+class TverskyCountMeasurer : public CountMeasurer<CountType> {
+public:
+  TverskyCountMeasurer(const CountVectors<CountType> &counts,
+                       bool compute_sim, float alpha)
+      : CountMeasurer<CountType>(counts, compute_sim), m_alpha(alpha),
+        m_beta(2.0 - alpha),
+        // Each feature contributes 1 / alpha to a vector's self-similarity,
+        // or 1 / beta if alpha and beta are exchanged.
+        m_norm(max(1u, max_stat(counts, num_present<CountType>)) /
+               min(m_alpha, m_beta)) {}
+
+protected:
+  float similarity(unsigned int i, unsigned int j) const override {
+    const auto &counts(this->m_counts);
+    return tversky_sum(counts[i], counts[j], counts.stride(), m_alpha,
+                       m_beta) /
+           m_norm;
+  }
+
+private:
+  const float m_alpha;
+  const float m_beta;
+  const float m_norm;
+};
+
+template <typename CountType>
+class EuclideanCountMeasurer : public CountMeasurer<CountType> {
+public:
+  EuclideanCountMeasurer(const CountVectors<CountType> &counts,
+                         bool compute_sim)
+      : CountMeasurer<CountType>(counts, compute_sim),
+        // The largest possible distance between vectors whose counts are
+        // no greater than the largest count in the collection.
+        m_norm(max<unsigned int>(1, max_stat(counts, max_count<CountType>)) *
+               sqrt(double(max(1u, counts.num_features())))) {}
+
+protected:
+  float similarity(unsigned int i, unsigned int j) const override {
+    const auto &counts(this->m_counts);
+    const double dist =
+        sqrt(double(squared_distance(counts[i], counts[j], counts.stride())));
+    return 1.0 - dist / m_norm;
+  }
+
+private:
+  const double m_norm;
+};
+
+template <typename CountType>
+class CosineCountMeasurer : public CountMeasurer<CountType> {
+public:
+  CosineCountMeasurer(const CountVectors<CountType> &counts, bool compute_sim)
+      : CountMeasurer<CountType>(counts, compute_sim),
+        m_norms(counts.size()) {
+    const int num_vectors = counts.size();
+#if HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < num_vectors; ++i) {
+      m_norms[i] =
+          sqrt(double(dot_product(counts[i], counts[i], counts.stride())));
+    }
+  }
+
+protected:
+  float similarity(unsigned int i, unsigned int j) const override {
+    const auto &counts(this->m_counts);
+    const double denom = m_norms[i] * m_norms[j];
+    if (denom <= 0) {
+      return 0.0;
+    }
+    return double(dot_product(counts[i], counts[j], counts.stride())) / denom;
+  }
+
+private:
+  vector<double> m_norms;
+};
+
+template <typename CountType>
+shape::IIndexedShapeFPMeasure::Ptr
+make_count_measurer(MeasureType measure_type, float tversky_alpha,
+                    bool compute_sim, const CountVectors<CountType> &counts) {
+  switch (measure_type) {
+  case MeasureType::tanimoto:
+    return make_shared<TanimotoCountMeasurer<CountType>>(counts, compute_sim);
+
+  case MeasureType::tversky:
+    if (!((tversky_alpha > 0.0) && (tversky_alpha < 2.0))) {
+      throw invalid_argument(
+          format("Tversky alpha for count vectors must be greater than 0 "
+                 "and less than 2; got {}",
+                 tversky_alpha));
+    }
+    return make_shared<TverskyCountMeasurer<CountType>>(counts, compute_sim,
+                                                        tversky_alpha);
+
+  case MeasureType::euclidean:
+    return make_shared<EuclideanCountMeasurer<CountType>>(counts,
+                                                          compute_sim);
+
+  case MeasureType::cosine:
+    return make_shared<CosineCountMeasurer<CountType>>(counts, compute_sim);
+
+  default:
+    break;
+  }
+  throw invalid_argument(
+      format("Measure type {} is not supported for count vectors",
+             static_cast<unsigned int>(measure_type)));
+}
+} // namespace
+
+shape::IIndexedShapeFPMeasure::Ptr
+get_count_measurer(MeasureType measure_type, float tversky_alpha,
+                   bool compute_sim, const CountVectors8 &counts) {
+  return make_count_measurer(measure_type, tversky_alpha, compute_sim,
+                             counts);
+}
+
+shape::IIndexedShapeFPMeasure::Ptr
+get_count_measurer(MeasureType measure_type, float tversky_alpha,
+                   bool compute_sim, const CountVectors16 &counts) {
+  return make_count_measurer(measure_type, tversky_alpha, compute_sim,
+                             counts);
+}
+
+} // namespace mesaac::measures
@@ -0,0 +1,177 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/diverse_selector.hpp"
+
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace mesaac::measures::shape {
+
+namespace {
+struct Candidate {
+  long index;
+  float distance;
+
+  // Prefer the more distant candidate; break ties by lowest index so
+  // that results do not depend on the number of threads.
+  bool is_better_than(const Candidate &other) const {
+    if (index < 0) {
+      return false;
+    }
+    if (other.index < 0) {
+      return true;
+    }
+    if (distance != other.distance) {
+      return distance > other.distance;
+    }
+    return index < other.index;
+  }
+};
+
+// Fold the distances to the most recently selected fingerprint into
+// nearest, and return the unselected candidate that is farthest from its
+// nearest selected neighbor.
+Candidate update_nearest(const IIndexedShapeFPMeasure &measurer,
+                         unsigned int last_selected,
+                         const vector<char> &selected, vector<float> &nearest) {
+  const long num_fps = nearest.size();
+  Candidate best{-1, 0.0};
+
+#if HAVE_OPENMP
+#pragma omp parallel
+  {
+    Candidate thread_best{-1, 0.0};
+#pragma omp for schedule(static)
+    for (long k = 0; k < num_fps; k++) {
+      if (!selected[k]) {
+        const float d = measurer.value(last_selected, k);
+        nearest[k] = min(nearest[k], d);
+        const Candidate c{k, nearest[k]};
+        if (c.is_better_than(thread_best)) {
+          thread_best = c;
+        }
+      }
+    }
+#pragma omp critical
+    {
+      if (thread_best.is_better_than(best)) {
+        best = thread_best;
+      }
+    }
+  }
+#else
+  for (long k = 0; k < num_fps; k++) {
+    if (!selected[k]) {
+      const float d = measurer.value(last_selected, k);
+      nearest[k] = min(nearest[k], d);
+      const Candidate c{k, nearest[k]};
+      if (c.is_better_than(best)) {
+        best = c;
+      }
+    }
+  }
+#endif
+  return best;
+}
+
+vector<unsigned int> select_max_min(const IIndexedShapeFPMeasure &measurer,
+                                    unsigned int num_fps,
+                                    const DiverseSelectionParams &params,
+                                    unsigned int max_selected) {
+  vector<unsigned int> result;
+  vector<float> nearest(num_fps, numeric_limits<float>::infinity());
+  vector<char> selected(num_fps, 0);
+
+  unsigned int next = params.first_index;
+  while (true) {
+    result.push_back(next);
+    selected[next] = 1;
+    if (result.size() >= max_selected) {
+      break;
+    }
+    const Candidate best = update_nearest(measurer, next, selected, nearest);
+    if ((best.index < 0) || (best.distance < params.threshold)) {
+      break;
+    }
+    next = best.index;
+  }
+  return result;
+}
+
+// Mark every unexcluded candidate within threshold of last_selected as
+// excluded.
+void exclude_neighbors(const IIndexedShapeFPMeasure &measurer,
+                       unsigned int last_selected, float threshold,
+                       vector<char> &excluded) {
+  const long num_fps = excluded.size();
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (long k = 0; k < num_fps; k++) {
+    if (!excluded[k] && (measurer.value(last_selected, k) <= threshold)) {
+      excluded[k] = 1;
+    }
+  }
+}
+
+vector<unsigned int>
+select_sphere_exclusion(const IIndexedShapeFPMeasure &measurer,
+                        unsigned int num_fps,
+                        const DiverseSelectionParams &params,
+                        unsigned int max_selected) {
+  vector<unsigned int> result;
+  vector<char> excluded(num_fps, 0);
+
+  unsigned int next = params.first_index;
+  unsigned int cursor = 0;
+  while (true) {
+    result.push_back(next);
+    excluded[next] = 1;
+    if (result.size() >= max_selected) {
+      break;
+    }
+    exclude_neighbors(measurer, next, params.threshold, excluded);
+    while ((cursor < num_fps) && excluded[cursor]) {
+      cursor++;
+    }
+    if (cursor >= num_fps) {
+      break;
+    }
+    next = cursor;
+  }
+  return result;
+}
+} // namespace
+
+vector<unsigned int> select_diverse(const IIndexedShapeFPMeasure &measurer,
+                                    unsigned int num_fps,
+                                    const DiverseSelectionParams &params) {
+  if (num_fps == 0) {
+    return {};
+  }
+  if (params.first_index >= num_fps) {
+    throw invalid_argument(
+        format("First index ({}) must be less than the number of "
+               "fingerprints ({})",
+               params.first_index, num_fps));
+  }
+
+  const unsigned int max_selected =
+      (params.max_selected == 0) ? num_fps : min(params.max_selected, num_fps);
+
+  switch (params.method) {
+  case DiverseSelectionMethod::max_min:
+    return select_max_min(measurer, num_fps, params, max_selected);
+  case DiverseSelectionMethod::sphere_exclusion:
+    return select_sphere_exclusion(measurer, num_fps, params, max_selected);
+  }
+  throw invalid_argument("Unknown diverse selection method");
+}
+
+} // namespace mesaac::measures::shape
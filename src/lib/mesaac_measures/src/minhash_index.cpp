@@ -0,0 +1,392 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/minhash_index.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "mesaac_common/stats.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+using namespace std;
+
+namespace mesaac::measures::shape {
+
+namespace {
+using Word = std::uint64_t;
+
+const char Magic[8] = {'M', 'E', 'S', 'A', 'S', 'F', 'P', 'H'};
+const std::uint32_t Version = 1;
+
+// The header is followed by the database path, padded to a whole number of
+// Words, then by FPsPerShape * num_bands tables, one per orientation and
+// band, each holding
+//   Word keys[num_shapes], sorted
+//   uint32 ids[num_shapes], padded to a whole number of Words
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t fps_per_shape;
+  std::uint32_t num_bits;
+  std::uint32_t num_bands;
+  std::uint32_t rows_per_band;
+  std::uint32_t db_path_size;
+  std::uint64_t num_shapes;
+  std::uint64_t seed;
+};
+static_assert(sizeof(Header) == 48);
+
+unsigned int words_per_fp(unsigned int num_bits) {
+  const unsigned int word_bits = 8 * sizeof(Word);
+  return (num_bits + word_bits - 1) / word_bits;
+}
+
+size_t padded_words(size_t num_bytes) {
+  return (num_bytes + sizeof(Word) - 1) / sizeof(Word);
+}
+
+size_t table_words(size_t num_shapes) {
+  return num_shapes + padded_words(num_shapes * sizeof(std::uint32_t));
+}
+
+// SplitMix64 finalizer.
+std::uint64_t mix(std::uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// result[b * num_hashes + k] is the k'th hash of bit b.
+vector<std::uint32_t> make_bit_hashes(unsigned int num_bits,
+                                      unsigned int num_hashes,
+                                      std::uint64_t seed) {
+  vector<std::uint32_t> result(size_t(num_bits) * num_hashes);
+  for (size_t i = 0; i < result.size(); ++i) {
+    result[i] = static_cast<std::uint32_t>(mix(seed ^ mix(i)) >> 32);
+  }
+  return result;
+}
+
+// Get the MinHash signature of a packed fingerprint: for each hash, the
+// least hash of any set bit.  Only signature[first_hash..(end_hash - 1)]
+// is computed.
+void get_signature(const Word *words, unsigned int num_bits,
+                   const vector<std::uint32_t> &bit_hashes,
+                   vector<std::uint32_t> &signature, size_t first_hash = 0,
+                   size_t end_hash = numeric_limits<size_t>::max()) {
+  const size_t num_hashes = signature.size();
+  end_hash = min(end_hash, num_hashes);
+  fill(signature.begin() + first_hash, signature.begin() + end_hash,
+       numeric_limits<std::uint32_t>::max());
+  const unsigned int word_bits = 8 * sizeof(Word);
+  for (unsigned int w = 0; w < words_per_fp(num_bits); ++w) {
+    for (Word bits = words[w]; bits != 0; bits &= bits - 1) {
+      const unsigned int b = w * word_bits + countr_zero(bits);
+      const std::uint32_t *hashes = bit_hashes.data() + b * num_hashes;
+      for (size_t k = first_hash; k < end_hash; ++k) {
+        signature[k] = min(signature[k], hashes[k]);
+      }
+    }
+  }
+}
+
+std::uint64_t get_band_key(const vector<std::uint32_t> &signature,
+                           unsigned int band, unsigned int rows_per_band) {
+  std::uint64_t result = band;
+  for (unsigned int r = 0; r < rows_per_band; ++r) {
+    result = mix(result ^ signature[band * rows_per_band + r]);
+  }
+  return result;
+}
+
+struct KeyedShape {
+  std::uint64_t key;
+  std::uint32_t id;
+
+  bool operator<(const KeyedShape &other) const {
+    return (key != other.key) ? (key < other.key) : (id < other.id);
+  }
+};
+
+// Sort a table by key, then id.  Keys are hashes, so distributing the
+// table in place over buckets by the keys' top bits gives buckets of
+// similar size, which are then sorted in parallel.
+void sort_table(vector<KeyedShape> &table) {
+  const unsigned int bucket_bits = 8;
+  const size_t num_buckets = size_t(1) << bucket_bits;
+  const auto bucket_of = [](const KeyedShape &entry) {
+    return size_t(entry.key >> (64 - bucket_bits));
+  };
+
+  vector<size_t> starts(num_buckets + 1, 0);
+  for (const auto &entry : table) {
+    starts[bucket_of(entry) + 1]++;
+  }
+  partial_sum(starts.begin(), starts.end(), starts.begin());
+  // Swap each entry into the next free slot of its bucket.
+  vector<size_t> next(starts.begin(), starts.end() - 1);
+  for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+    while (next[bucket] < starts[bucket + 1]) {
+      KeyedShape &entry(table[next[bucket]]);
+      const size_t dest = bucket_of(entry);
+      if (dest == bucket) {
+        next[bucket]++;
+      } else {
+        swap(entry, table[next[dest]++]);
+      }
+    }
+  }
+
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int bucket = 0; bucket < int(num_buckets); bucket++) {
+    sort(table.begin() + starts[bucket], table.begin() + starts[bucket + 1]);
+  }
+}
+
+void write_padding(ofstream &outf, size_t num_bytes) {
+  const size_t padding = padded_words(num_bytes) * sizeof(Word) - num_bytes;
+  const char zeros[sizeof(Word)] = {};
+  outf.write(zeros, padding);
+}
+
+void write_words(ofstream &outf, const void *data, size_t num_bytes) {
+  outf.write(static_cast<const char *>(data), num_bytes);
+  write_padding(outf, num_bytes);
+}
+
+// Write a sorted table's keys, then its ids, a chunk at a time.
+void write_table(ofstream &outf, const vector<KeyedShape> &table) {
+  const size_t chunk_size = 1 << 16;
+  vector<Word> keys;
+  vector<std::uint32_t> ids;
+  for (size_t start = 0; start < table.size(); start += chunk_size) {
+    const size_t end = min(table.size(), start + chunk_size);
+    keys.clear();
+    for (size_t pos = start; pos < end; ++pos) {
+      keys.push_back(table[pos].key);
+    }
+    outf.write(reinterpret_cast<const char *>(keys.data()),
+               keys.size() * sizeof(Word));
+  }
+  for (size_t start = 0; start < table.size(); start += chunk_size) {
+    const size_t end = min(table.size(), start + chunk_size);
+    ids.clear();
+    for (size_t pos = start; pos < end; ++pos) {
+      ids.push_back(table[pos].id);
+    }
+    outf.write(reinterpret_cast<const char *>(ids.data()),
+               ids.size() * sizeof(std::uint32_t));
+  }
+  write_padding(outf, table.size() * sizeof(std::uint32_t));
+}
+} // namespace
+
+void write_minhash_index(const SegmentedShapeFPs &db,
+                         const filesystem::path &db_path,
+                         const filesystem::path &path,
+                         const MinHashParams &params) {
+  static common::stats::Stage &write_stage(
+      common::stats::stage("write_minhash_index"));
+  const common::stats::ScopedTimer timer(write_stage, db.size());
+
+  if ((params.num_bands == 0) || (params.rows_per_band == 0)) {
+    throw invalid_argument(
+        format("MinHash index needs at least one band and one row per band; "
+               "got {} bands of {} rows.",
+               params.num_bands, params.rows_per_band));
+  }
+  ofstream outf(path, ios::binary | ios::trunc);
+  if (!outf) {
+    throw runtime_error(format("Cannot open {} for writing.", path.string()));
+  }
+  const unsigned int num_bits = db.num_bits();
+  const unsigned int num_shapes = db.size();
+  const unsigned int fp_words = words_per_fp(num_bits);
+  const unsigned int num_hashes = params.num_bands * params.rows_per_band;
+  const string abs_db_path = filesystem::absolute(db_path).string();
+
+  Header header{};
+  memcpy(header.magic, Magic, sizeof(Magic));
+  header.version = Version;
+  header.fps_per_shape = FPsPerShape;
+  header.num_bits = num_bits;
+  header.num_bands = params.num_bands;
+  header.rows_per_band = params.rows_per_band;
+  header.db_path_size = abs_db_path.size();
+  header.num_shapes = num_shapes;
+  header.seed = params.seed;
+  outf.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  write_words(outf, abs_db_path.data(), abs_db_path.size());
+
+  // Tables are built one at a time, in file order, so that building needs
+  // memory for only one table.  Each shape's signature is computed only for
+  // the current band's hashes.
+  const auto bit_hashes = make_bit_hashes(num_bits, num_hashes, params.seed);
+  vector<KeyedShape> table(num_shapes);
+  for (unsigned int k = 0; k < FPsPerShape; ++k) {
+    for (unsigned int band = 0; band < params.num_bands; ++band) {
+      const size_t first_hash = size_t(band) * params.rows_per_band;
+#if HAVE_OPENMP
+#pragma omp parallel
+#endif
+      {
+        vector<std::uint32_t> signature(num_hashes);
+#if HAVE_OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (int i = 0; i < int(num_shapes); i++) {
+          get_signature(db.words(i).data() + k * fp_words, num_bits,
+                        bit_hashes, signature, first_hash,
+                        first_hash + params.rows_per_band);
+          table[i] = {
+              .key = get_band_key(signature, band, params.rows_per_band),
+              .id = std::uint32_t(i)};
+        }
+      }
+      sort_table(table);
+      write_table(outf, table);
+    }
+  }
+  outf.close();
+  if (!outf) {
+    throw runtime_error(format("Cannot write {}", path.string()));
+  }
+}
+
+bool is_minhash_index(const filesystem::path &path) {
+  ifstream inf(path, ios::binary);
+  char magic[sizeof(Magic)];
+  return inf.read(magic, sizeof(magic)) &&
+         (memcmp(magic, Magic, sizeof(Magic)) == 0);
+}
+
+MinHashIndex::MinHashIndex(const filesystem::path &path)
+    : m_file(path), m_num_bits(0), m_num_shapes(0), m_params{}, m_bands{} {
+  Header header;
+  if (m_file.size() < sizeof(header)) {
+    throw runtime_error(
+        format("{} is not a MinHash index file.", path.string()));
+  }
+  memcpy(&header, m_file.data(), sizeof(header));
+  if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) ||
+      (header.fps_per_shape != FPsPerShape)) {
+    throw runtime_error(
+        format("{} is not a MinHash index file.", path.string()));
+  }
+  if (header.version != Version) {
+    throw runtime_error(format("{} has unsupported version {}.",
+                               path.string(), header.version));
+  }
+
+  m_num_bits = header.num_bits;
+  m_num_shapes = header.num_shapes;
+  m_params = {.num_bands = header.num_bands,
+              .rows_per_band = header.rows_per_band,
+              .seed = header.seed};
+  const size_t path_words = padded_words(header.db_path_size);
+  const size_t expected_size =
+      sizeof(header) +
+      (path_words + size_t(FPsPerShape) * m_params.num_bands *
+                        table_words(m_num_shapes)) *
+          sizeof(Word);
+  if ((m_params.num_bands == 0) || (m_params.rows_per_band == 0) ||
+      (m_file.size() != expected_size)) {
+    throw runtime_error(format("{} is truncated or corrupt: expected {} "
+                               "bytes, found {}.",
+                               path.string(), expected_size, m_file.size()));
+  }
+
+  const char *db_path_chars =
+      reinterpret_cast<const char *>(m_file.data() + sizeof(header));
+  const filesystem::path db_path(
+      string(db_path_chars, db_path_chars + header.db_path_size));
+  m_db = make_unique<SegmentedShapeFPs>(db_path);
+  if ((m_db->num_bits() != m_num_bits) || (m_db->size() < m_num_shapes)) {
+    throw runtime_error(format("{} does not match its database {}: expected "
+                               "at least {} shapes of {} bits.",
+                               path.string(), db_path.string(), m_num_shapes,
+                               m_num_bits));
+  }
+
+  m_bit_hashes = make_bit_hashes(
+      m_num_bits, m_params.num_bands * m_params.rows_per_band, m_params.seed);
+  const Word *table =
+      reinterpret_cast<const Word *>(db_path_chars) + path_words;
+  for (auto &bands : m_bands) {
+    bands.resize(m_params.num_bands);
+    for (auto &band : bands) {
+      band.keys = table;
+      band.ids = reinterpret_cast<const std::uint32_t *>(table + m_num_shapes);
+      table += table_words(m_num_shapes);
+    }
+  }
+}
+
+vector<unsigned int>
+MinHashIndex::candidates(const mesaac::shape::ShapeFingerprint &query) const {
+  if (query.empty() || (query[0].size() != m_num_bits)) {
+    throw invalid_argument(
+        format("Query fingerprint has {} bits; expected {}.",
+               query.empty() ? 0 : query[0].size(), m_num_bits));
+  }
+  vector<Word> words(words_per_fp(m_num_bits));
+  boost::to_block_range(query[0], words.begin());
+  vector<std::uint32_t> signature(m_params.num_bands *
+                                  m_params.rows_per_band);
+  get_signature(words.data(), m_num_bits, m_bit_hashes, signature);
+
+  vector<unsigned int> result;
+  for (unsigned int band = 0; band < m_params.num_bands; ++band) {
+    const std::uint64_t key =
+        get_band_key(signature, band, m_params.rows_per_band);
+    for (const auto &bands : m_bands) {
+      const Band &table(bands[band]);
+      const auto [first, last] =
+          equal_range(table.keys, table.keys + m_num_shapes, key);
+      for (auto pos = first; pos != last; ++pos) {
+        result.push_back(table.ids[pos - table.keys]);
+      }
+    }
+  }
+  sort(result.begin(), result.end());
+  result.erase(unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+vector<IndexHit>
+MinHashIndex::search(const mesaac::shape::ShapeFingerprint &query,
+                     MeasureType type, float alpha, bool compute_sim,
+                     float threshold) const {
+  static common::stats::Stage &search_stage(
+      common::stats::stage("MinHashIndex::search"));
+  // Items are the candidate shapes rescored.
+  common::stats::ScopedTimer timer(search_stage, 0);
+
+  const auto ids = candidates(query);
+  timer.set_items(ids.size());
+  const auto measurer =
+      get_shape_pair_measurer(get_measures(type, alpha), compute_sim);
+  vector<IndexHit> result;
+  mesaac::shape::ShapeFingerprint candidate;
+  for (const unsigned int id : ids) {
+    m_db->get(id, candidate);
+    const float value = measurer->value(query, candidate);
+    if (compute_sim ? (value >= threshold) : (value <= threshold)) {
+      result.push_back({.index = id, .value = value});
+    }
+  }
+  return result;
+}
+
+} // namespace mesaac::measures::shape
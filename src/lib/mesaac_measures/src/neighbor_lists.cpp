@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/neighbor_lists.hpp"
+
+#include <algorithm>
+#include <format>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+
+namespace mesaac::measures::shape {
+
+namespace {
+// Maximum number of rows to compute per parallel batch.
+const unsigned int RowsPerBatch = 256;
+
+filesystem::path get_spill_path(const filesystem::path &spill_dir) {
+  const filesystem::path dir =
+      spill_dir.empty() ? filesystem::temp_directory_path() : spill_dir;
+  random_device rd;
+  filesystem::path result;
+  do {
+    result = dir / format("mesaac_neighbors_{:08x}{:08x}.bin", rd(), rd());
+  } while (filesystem::exists(result));
+  return result;
+}
+
+void compute_row(const IIndexedShapeFPMeasure &measurer, unsigned int i,
+                 unsigned int num_fps, float threshold, bool is_similarity,
+                 NeighborLists::IndexList &row) {
+  thread_local vector<float> values;
+  values.resize(num_fps);
+  measurer.value_row(i, 0, num_fps, values.data());
+  row.clear();
+  for (unsigned int j = 0; j != num_fps; ++j) {
+    if (i != j) {
+      const float value = values[j];
+      if (is_similarity ? (value >= threshold) : (value <= threshold)) {
+        row.push_back(j);
+      }
+    }
+  }
+}
+} // namespace
+
+NeighborLists::NeighborLists(const IIndexedShapeFPMeasure &measurer,
+                             unsigned int num_fps, const Params &params) {
+  m_counts.reserve(num_fps);
+  m_offsets.reserve(num_fps + 1);
+  m_offsets.push_back(0);
+
+  // A row lists at most num_fps - 1 neighbors.  Limit each batch so that
+  // even if every row were full, the batch would fit within the budget.
+  const size_t max_row_bytes = max<size_t>(1, num_fps) * sizeof(Index);
+  const unsigned int rows_per_batch = clamp<size_t>(
+      params.memory_budget / max_row_bytes, 1, RowsPerBatch);
+
+  vector<IndexList> batch(rows_per_batch);
+  for (unsigned int i_start = 0; i_start < num_fps;
+       i_start += rows_per_batch) {
+    const int batch_size = min(rows_per_batch, num_fps - i_start);
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int b = 0; b < batch_size; b++) {
+      compute_row(measurer, i_start + b, num_fps, params.threshold,
+                  params.is_similarity, batch[b]);
+    }
+    // Serialize storage of the batch, preserving row order.  Each row's
+    // storage is released once stored, so that the batch does not keep its
+    // peak size for the rest of the run.
+    for (int b = 0; b < batch_size; b++) {
+      append_row(batch[b], params);
+      IndexList().swap(batch[b]);
+    }
+  }
+  if (is_spilled()) {
+    m_spill_file.flush();
+  }
+}
+
+NeighborLists::~NeighborLists() {
+  if (is_spilled()) {
+    m_spill_file.close();
+    error_code ec;
+    filesystem::remove(m_spill_path, ec);
+  }
+}
+
+void NeighborLists::neighbors(unsigned int i, IndexList &neighbors) const {
+  const uint64_t offset = m_offsets.at(i);
+  const Index num_neighbors = m_counts.at(i);
+  neighbors.resize(num_neighbors);
+  if (!is_spilled()) {
+    copy_n(m_in_memory.begin() + offset, num_neighbors, neighbors.begin());
+  } else if (num_neighbors > 0) {
+    m_spill_file.seekg(offset * sizeof(Index));
+    m_spill_file.read(reinterpret_cast<char *>(neighbors.data()),
+                      num_neighbors * sizeof(Index));
+    if (!m_spill_file) {
+      throw runtime_error(format("Could not read neighbors of {} from {}", i,
+                                 m_spill_path.string()));
+    }
+  }
+}
+
+void NeighborLists::append_row(const IndexList &row, const Params &params) {
+  m_counts.push_back(row.size());
+  m_offsets.push_back(m_offsets.back() + row.size());
+  if (is_spilled()) {
+    m_spill_file.write(reinterpret_cast<const char *>(row.data()),
+                       row.size() * sizeof(Index));
+  } else {
+    m_in_memory.insert(m_in_memory.end(), row.begin(), row.end());
+    if (m_in_memory.size() * sizeof(Index) > params.memory_budget) {
+      spill(params);
+    }
+  }
+  if (m_spill_file.fail()) {
+    throw runtime_error(
+        format("Could not write neighbor lists to {}", m_spill_path.string()));
+  }
+}
+
+void NeighborLists::spill(const Params &params) {
+  m_spill_path = get_spill_path(params.spill_dir);
+  m_spill_file.open(m_spill_path, ios::in | ios::out | ios::binary |
+                                      ios::trunc);
+  if (!m_spill_file) {
+    throw runtime_error(
+        format("Could not create spill file {}", m_spill_path.string()));
+  }
+  m_spill_file.write(reinterpret_cast<const char *>(m_in_memory.data()),
+                     m_in_memory.size() * sizeof(Index));
+  IndexList().swap(m_in_memory);
+}
+
+} // namespace mesaac::measures::shape
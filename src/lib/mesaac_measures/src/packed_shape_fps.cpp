@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/packed_shape_fps.hpp"
+
+#include <cstring>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_common/stats.hpp"
+
+using namespace std;
+
+namespace mesaac::measures::shape {
+
+namespace {
+using Word = std::uint64_t;
+static_assert(sizeof(shape_defs::BitVector::block_type) == sizeof(Word),
+              "Packed fingerprints assume 64-bit BitVector blocks");
+
+const char Magic[8] = {'M', 'E', 'S', 'A', 'S', 'F', 'P', 'B'};
+const std::uint32_t Version = 1;
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t fps_per_shape;
+  std::uint32_t num_bits;
+  std::uint32_t reserved;
+  std::uint64_t num_shapes;
+};
+static_assert(sizeof(Header) == 32);
+
+unsigned int num_words_per_fp(unsigned int num_bits) {
+  const unsigned int word_bits = 8 * sizeof(Word);
+  return (num_bits + word_bits - 1) / word_bits;
+}
+
+Header make_header(unsigned int num_bits, std::uint64_t num_shapes) {
+  Header result{};
+  memcpy(result.magic, Magic, sizeof(Magic));
+  result.version = Version;
+  result.fps_per_shape = FPsPerShape;
+  result.num_bits = num_bits;
+  result.num_shapes = num_shapes;
+  return result;
+}
+} // namespace
+
+PackedShapeFPWriter::PackedShapeFPWriter(const filesystem::path &path,
+                                         unsigned int num_bits)
+    : m_path(path), m_num_bits(num_bits), m_num_shapes(0),
+      m_outf(path, ios::binary | ios::trunc) {
+  if (!m_outf) {
+    throw runtime_error(
+        format("Cannot open {} for writing.", m_path.string()));
+  }
+  // Write a provisional header; close() fills in the shape count.
+  const Header header(make_header(m_num_bits, 0));
+  m_outf.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+PackedShapeFPWriter::~PackedShapeFPWriter() {
+  if (m_outf.is_open()) {
+    try {
+      close();
+    } catch (const exception &) {
+      // Destructors must not throw.
+    }
+  }
+}
+
+void PackedShapeFPWriter::write(const mesaac::shape::ShapeFingerprint &sfp) {
+  static common::stats::Stage &write_stage(
+      common::stats::stage("PackedShapeFPWriter::write"));
+  const common::stats::ScopedTimer timer(write_stage);
+
+  if (sfp.size() != FPsPerShape) {
+    throw invalid_argument(format("Shape fingerprint has {} fingerprints; "
+                                  "expected {}",
+                                  sfp.size(), FPsPerShape));
+  }
+  vector<Word> words;
+  words.reserve(num_words_per_fp(m_num_bits));
+  for (const auto &fp : sfp) {
+    if (fp.size() != m_num_bits) {
+      throw invalid_argument(format(
+          "Fingerprint has {} bits; expected {}", fp.size(), m_num_bits));
+    }
+    words.clear();
+    boost::to_block_range(fp, back_inserter(words));
+    m_outf.write(reinterpret_cast<const char *>(words.data()),
+                 words.size() * sizeof(Word));
+  }
+  if (!m_outf) {
+    throw runtime_error(format("Cannot write to {}", m_path.string()));
+  }
+  m_num_shapes++;
+}
+
+void PackedShapeFPWriter::close() {
+  const Header header(make_header(m_num_bits, m_num_shapes));
+  m_outf.seekp(0);
+  m_outf.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  m_outf.close();
+  if (!m_outf) {
+    throw runtime_error(format("Cannot complete {}", m_path.string()));
+  }
+}
+
+PackedShapeFPs::PackedShapeFPs(const filesystem::path &path)
+    : m_file(path), m_num_bits(0), m_num_shapes(0), m_words_per_fp(0),
+      m_words(nullptr) {
+  Header header;
+  if (m_file.size() < sizeof(header)) {
+    throw runtime_error(
+        format("{} is not a packed shape fingerprint file.", path.string()));
+  }
+  memcpy(&header, m_file.data(), sizeof(header));
+  if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) ||
+      (header.fps_per_shape != FPsPerShape)) {
+    throw runtime_error(
+        format("{} is not a packed shape fingerprint file.", path.string()));
+  }
+  if (header.version != Version) {
+    throw runtime_error(format("{} has unsupported version {}.",
+                               path.string(), header.version));
+  }
+
+  m_num_bits = header.num_bits;
+  m_num_shapes = header.num_shapes;
+  m_words_per_fp = num_words_per_fp(m_num_bits);
+  const size_t expected_size =
+      sizeof(header) +
+      size_t(m_num_shapes) * FPsPerShape * m_words_per_fp * sizeof(Word);
+  if (m_file.size() != expected_size) {
+    throw runtime_error(format("{} is truncated or corrupt: expected {} "
+                               "bytes, found {}.",
+                               path.string(), expected_size, m_file.size()));
+  }
+  m_words = reinterpret_cast<const Word *>(m_file.data() + sizeof(header));
+}
+
+bool PackedShapeFPs::is_packed(const filesystem::path &path) {
+  char magic[sizeof(Magic)] = {};
+  ifstream inf(path, ios::binary);
+  inf.read(magic, sizeof(magic));
+  return inf && (memcmp(magic, Magic, sizeof(Magic)) == 0);
+}
+
+size_t PackedShapeFPs::shape_bytes() const {
+  return sizeof(mesaac::shape::ShapeFingerprint) +
+         FPsPerShape * (sizeof(shape_defs::BitVector) +
+                        m_words_per_fp * sizeof(Word));
+}
+
+span<const Word> PackedShapeFPs::words(unsigned int i) const {
+  if (i >= m_num_shapes) {
+    throw out_of_range(format("Shape index {} is out of range (0..{})", i,
+                              m_num_shapes));
+  }
+  const size_t words_per_shape = FPsPerShape * m_words_per_fp;
+  return {m_words + i * words_per_shape, words_per_shape};
+}
+
+void PackedShapeFPs::get(unsigned int i,
+                         mesaac::shape::ShapeFingerprint &sfp) const {
+  if (i >= m_num_shapes) {
+    throw out_of_range(format("Shape index {} is out of range (0..{})", i,
+                              m_num_shapes));
+  }
+  sfp.resize(FPsPerShape);
+  const Word *words = m_words + size_t(i) * FPsPerShape * m_words_per_fp;
+  for (auto &fp : sfp) {
+    // Refill in place, so that repeated calls reuse sfp's storage.
+    fp.clear();
+    fp.append(words, words + m_words_per_fp);
+    fp.resize(m_num_bits);
+    words += m_words_per_fp;
+  }
+}
+
+void PackedShapeFPs::append_range(
+    unsigned int begin, unsigned int end,
+    mesaac::shape::ShapeFingerprintVector &sfps) const {
+  sfps.reserve(sfps.size() + (end - begin));
+  for (unsigned int i = begin; i < end; ++i) {
+    sfps.emplace_back();
+    get(i, sfps.back());
+  }
+}
+
+} // namespace mesaac::measures::shape
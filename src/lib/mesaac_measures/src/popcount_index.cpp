@@ -0,0 +1,297 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/popcount_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+#include "mesaac_common/stats.hpp"
+
+using namespace std;
+
+namespace mesaac::measures::shape {
+
+namespace {
+using Word = std::uint64_t;
+
+const char Magic[8] = {'M', 'E', 'S', 'A', 'S', 'F', 'P', 'I'};
+const std::uint32_t Version = 1;
+
+// The header is followed by one section per orientation, each holding
+//   Word offsets[num_bits + 2]
+//   uint32 ids[num_shapes], padded to a whole number of Words
+//   Word words[num_shapes * words_per_fp]
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t fps_per_shape;
+  std::uint32_t num_bits;
+  std::uint32_t reserved;
+  std::uint64_t num_shapes;
+};
+static_assert(sizeof(Header) == 32);
+
+// Allow for rounding in float measure computations.
+const double WindowSlack = 1.0e-5;
+
+unsigned int words_per_fp(unsigned int num_bits) {
+  const unsigned int word_bits = 8 * sizeof(Word);
+  return (num_bits + word_bits - 1) / word_bits;
+}
+
+size_t num_offsets(unsigned int num_bits) { return size_t(num_bits) + 2; }
+
+size_t id_words(size_t num_shapes) {
+  return (num_shapes * sizeof(std::uint32_t) + sizeof(Word) - 1) /
+         sizeof(Word);
+}
+
+size_t section_words(unsigned int num_bits, size_t num_shapes) {
+  return num_offsets(num_bits) + id_words(num_shapes) +
+         num_shapes * words_per_fp(num_bits);
+}
+
+// Clamp a real-valued popcount range to 0..num_bits.
+PopcountWindow make_window(double min_count, double max_count,
+                           unsigned int num_bits) {
+  const double lo = max(0.0, ceil(min_count));
+  const double hi = min(double(num_bits), floor(max_count));
+  if (lo > hi) {
+    return {.min_count = 1, .max_count = 0};
+  }
+  return {.min_count = static_cast<unsigned int>(lo),
+          .max_count = static_cast<unsigned int>(hi)};
+}
+
+void write_words(ofstream &outf, const void *data, size_t num_words) {
+  outf.write(static_cast<const char *>(data), num_words * sizeof(Word));
+}
+} // namespace
+
+PopcountWindow get_popcount_window(MeasureType type, float alpha,
+                                   float min_similarity,
+                                   unsigned int query_count,
+                                   unsigned int num_bits) {
+  const double s = double(min_similarity) - WindowSlack;
+  const double q = query_count;
+  const double n = num_bits;
+  const PopcountWindow all{.min_count = 0, .max_count = num_bits};
+
+  switch (type) {
+  case MeasureType::tanimoto:
+    // |a & b| / |a | b| <= min(|a|, |b|) / max(|a|, |b|)
+    return (s <= 0.0) ? all : make_window(s * q, q / s, num_bits);
+
+  case MeasureType::cosine:
+    // |a & b| / sqrt(|a| |b|) <= sqrt(min(|a|, |b|) / max(|a|, |b|))
+    return (s <= 0.0) ? all : make_window(s * s * q, q / (s * s), num_bits);
+
+  case MeasureType::tversky: {
+    // The similarity is greatest when the smaller fingerprint is a subset of
+    // the larger.
+    const double beta = 2.0 - alpha;
+    if ((s <= 0.0) || (alpha < 0.0) || (beta < 0.0)) {
+      return all;
+    }
+    const double lo =
+        (alpha > 0.0) ? s * alpha * q / (1.0 - s + s * alpha) : 0.0;
+    const double hi = (beta > 0.0) ? q * (1.0 - s + s * beta) / (s * beta) : n;
+    return make_window(lo, hi, num_bits);
+  }
+
+  case MeasureType::euclidean: {
+    // 1 - sqrt(|a ^ b| / n), and |a ^ b| >= ||a| - |b||
+    if (s > 1.0) {
+      return make_window(1.0, 0.0, num_bits);
+    }
+    const double max_diff = n * (1.0 - s) * (1.0 - s);
+    return make_window(q - max_diff, q + max_diff, num_bits);
+  }
+
+  case MeasureType::hamann: {
+    // (n - 2 |a ^ b|) / n
+    const double max_diff = n * (1.0 - s) / 2.0;
+    return make_window(q - max_diff, q + max_diff, num_bits);
+  }
+
+  case MeasureType::bub:
+    break;
+  }
+  return all;
+}
+
+void write_popcount_index(const SegmentedShapeFPs &db,
+                          const filesystem::path &path) {
+  static common::stats::Stage &write_stage(
+      common::stats::stage("write_popcount_index"));
+  const common::stats::ScopedTimer timer(write_stage, db.size());
+
+  ofstream outf(path, ios::binary | ios::trunc);
+  if (!outf) {
+    throw runtime_error(format("Cannot open {} for writing.", path.string()));
+  }
+  const unsigned int num_bits = db.num_bits();
+  const unsigned int num_shapes = db.size();
+  const unsigned int fp_words = words_per_fp(num_bits);
+
+  Header header{};
+  memcpy(header.magic, Magic, sizeof(Magic));
+  header.version = Version;
+  header.fps_per_shape = FPsPerShape;
+  header.num_bits = num_bits;
+  header.num_shapes = num_shapes;
+  outf.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  vector<Word> offsets(num_offsets(num_bits));
+  vector<std::uint32_t> ids;
+  for (unsigned int k = 0; k < FPsPerShape; ++k) {
+    // Counting sort by popcount keeps equal popcounts in global index
+    // order.
+    fill(offsets.begin(), offsets.end(), 0);
+    for (unsigned int i = 0; i < num_shapes; ++i) {
+      offsets[db.popcounts(i)[k] + 1]++;
+    }
+    partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    ids.assign(id_words(num_shapes) * sizeof(Word) / sizeof(std::uint32_t),
+               0);
+    vector<Word> next(offsets.begin(), offsets.end() - 1);
+    for (unsigned int i = 0; i < num_shapes; ++i) {
+      ids[next[db.popcounts(i)[k]]++] = i;
+    }
+
+    write_words(outf, offsets.data(), offsets.size());
+    write_words(outf, ids.data(), id_words(num_shapes));
+    for (unsigned int pos = 0; pos < num_shapes; ++pos) {
+      const auto words = db.words(ids[pos]);
+      write_words(outf, words.data() + k * fp_words, fp_words);
+    }
+  }
+  outf.close();
+  if (!outf) {
+    throw runtime_error(format("Cannot write {}", path.string()));
+  }
+}
+
+bool is_popcount_index(const filesystem::path &path) {
+  ifstream inf(path, ios::binary);
+  char magic[sizeof(Magic)];
+  return inf.read(magic, sizeof(magic)) &&
+         (memcmp(magic, Magic, sizeof(Magic)) == 0);
+}
+
+PopcountIndex::PopcountIndex(const filesystem::path &path)
+    : m_file(path), m_num_bits(0), m_num_shapes(0), m_words_per_fp(0),
+      m_orientations{} {
+  Header header;
+  if (m_file.size() < sizeof(header)) {
+    throw runtime_error(
+        format("{} is not a popcount index file.", path.string()));
+  }
+  memcpy(&header, m_file.data(), sizeof(header));
+  if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) ||
+      (header.fps_per_shape != FPsPerShape)) {
+    throw runtime_error(
+        format("{} is not a popcount index file.", path.string()));
+  }
+  if (header.version != Version) {
+    throw runtime_error(format("{} has unsupported version {}.",
+                               path.string(), header.version));
+  }
+
+  m_num_bits = header.num_bits;
+  m_num_shapes = header.num_shapes;
+  m_words_per_fp = words_per_fp(m_num_bits);
+  const size_t words_per_section = section_words(m_num_bits, m_num_shapes);
+  const size_t expected_size =
+      sizeof(header) + FPsPerShape * words_per_section * sizeof(Word);
+  if (m_file.size() != expected_size) {
+    throw runtime_error(format("{} is truncated or corrupt: expected {} "
+                               "bytes, found {}.",
+                               path.string(), expected_size, m_file.size()));
+  }
+
+  const Word *section =
+      reinterpret_cast<const Word *>(m_file.data() + sizeof(header));
+  for (auto &orientation : m_orientations) {
+    orientation.offsets = section;
+    orientation.ids = reinterpret_cast<const std::uint32_t *>(
+        section + num_offsets(m_num_bits));
+    orientation.words =
+        section + num_offsets(m_num_bits) + id_words(m_num_shapes);
+    if (orientation.offsets[num_offsets(m_num_bits) - 1] != m_num_shapes) {
+      throw runtime_error(
+          format("{} has a corrupt offset table.", path.string()));
+    }
+    section += words_per_section;
+  }
+}
+
+vector<IndexHit>
+PopcountIndex::search(const mesaac::shape::ShapeFingerprint &query,
+                      MeasureType type, float alpha, bool compute_sim,
+                      float threshold) const {
+  static common::stats::Stage &search_stage(
+      common::stats::stage("PopcountIndex::search"));
+  // Items are the candidate fingerprints examined.
+  common::stats::ScopedTimer timer(search_stage, 0);
+
+  if (query.empty() || (query[0].size() != m_num_bits)) {
+    throw invalid_argument(
+        format("Query fingerprint has {} bits; expected {}.",
+               query.empty() ? 0 : query[0].size(), m_num_bits));
+  }
+  const auto measure = get_measures(type, alpha);
+  const float min_similarity = compute_sim ? threshold : 1.0 - threshold;
+  const PopcountWindow window = get_popcount_window(
+      type, alpha, min_similarity, query[0].count(), m_num_bits);
+
+  // As for get_shape_pair_measurer, a shape's measure is its best
+  // similarity over all orientations.  An orientation outside the window
+  // cannot pass the threshold, so if a shape passes, its best orientation
+  // is among those examined here.
+  vector<IndexHit> passed;
+  size_t num_examined = 0;
+  if (window.min_count <= window.max_count) {
+    shape_defs::BitVector candidate;
+    for (const auto &orientation : m_orientations) {
+      const size_t begin = orientation.offsets[window.min_count];
+      const size_t end = orientation.offsets[window.max_count + 1];
+      num_examined += end - begin;
+      for (size_t pos = begin; pos < end; ++pos) {
+        const Word *words = orientation.words + pos * m_words_per_fp;
+        candidate.clear();
+        candidate.append(words, words + m_words_per_fp);
+        candidate.resize(m_num_bits);
+        const float similarity = (*measure)(query[0], candidate);
+        const float value = compute_sim ? similarity : 1.0 - similarity;
+        if (compute_sim ? (value >= threshold) : (value <= threshold)) {
+          passed.push_back({.index = orientation.ids[pos], .value = value});
+        }
+      }
+    }
+  }
+  timer.set_items(num_examined);
+
+  // Keep the best orientation of each shape.
+  sort(passed.begin(), passed.end(),
+       [compute_sim](const IndexHit &a, const IndexHit &b) {
+         if (a.index != b.index) {
+           return a.index < b.index;
+         }
+         return compute_sim ? (a.value > b.value) : (a.value < b.value);
+       });
+  const auto last = unique(
+      passed.begin(), passed.end(),
+      [](const IndexHit &a, const IndexHit &b) { return a.index == b.index; });
+  passed.erase(last, passed.end());
+  return passed;
+}
+
+} // namespace mesaac::measures::shape
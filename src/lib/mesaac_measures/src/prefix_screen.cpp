@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/prefix_screen.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace mesaac::shape;
+
+namespace mesaac::measures::shape {
+
+namespace {
+// Build each prefix from the leading blocks of its fingerprint.  Copying
+// and resizing whole fingerprints would keep their full storage.
+ShapeFingerprintVector
+get_prefixes(const ShapeFingerprintVector &fingerprints,
+             unsigned int num_bits) {
+  using BitVector = shape_defs::BitVector;
+  const size_t prefix_blocks =
+      (num_bits + BitVector::bits_per_block - 1) / BitVector::bits_per_block;
+
+  vector<BitVector::block_type> blocks;
+  ShapeFingerprintVector result;
+  result.reserve(fingerprints.size());
+  for (const auto &sfp : fingerprints) {
+    auto &prefixes = result.emplace_back();
+    prefixes.reserve(sfp.size());
+    for (const auto &fp : sfp) {
+      blocks.resize(fp.num_blocks());
+      boost::to_block_range(fp, blocks.begin());
+      const auto blocks_end =
+          blocks.begin() + min(prefix_blocks, blocks.size());
+      // Shrinking to num_bits clears the bits past the prefix.
+      prefixes.emplace_back(blocks.begin(), blocks_end).resize(num_bits);
+    }
+  }
+  return result;
+}
+
+class PrefixScreenedMeasurer : public IIndexedShapeFPMeasure {
+public:
+  PrefixScreenedMeasurer(MeasuresBase::Ptr measure, bool compute_sim,
+                         const ShapeFingerprintVector &fingerprints,
+                         const PrefixScreen &screen)
+      : m_prefixes(get_prefixes(fingerprints, screen.num_bits)),
+        m_prefix_measurer(
+            get_shape_measurer(measure, compute_sim, m_prefixes)),
+        m_full_measurer(get_shape_measurer(measure, compute_sim, fingerprints)),
+        m_compute_sim(compute_sim),
+        m_cutoff(compute_sim ? (screen.threshold - screen.margin)
+                             : (screen.threshold + screen.margin)) {}
+
+  float value(unsigned int i, unsigned int j) const override {
+    const float prefix_value = m_prefix_measurer->value(i, j);
+    const bool hopeless = m_compute_sim ? (prefix_value < m_cutoff)
+                                        : (prefix_value > m_cutoff);
+    return hopeless ? prefix_value : m_full_measurer->value(i, j);
+  }
+
+  void value_row(unsigned int i, unsigned int j_begin, unsigned int j_end,
+                 float *out) const override {
+    // Screen the whole row in one batch, then measure the survivors.
+    m_prefix_measurer->value_row(i, j_begin, j_end, out);
+    for (unsigned int j = j_begin; j < j_end; j++) {
+      const float prefix_value = out[j - j_begin];
+      const bool hopeless = m_compute_sim ? (prefix_value < m_cutoff)
+                                          : (prefix_value > m_cutoff);
+      if (!hopeless) {
+        out[j - j_begin] = m_full_measurer->value(i, j);
+      }
+    }
+  }
+
+protected:
+  // m_prefix_measurer refers to m_prefixes, so m_prefixes must be
+  // initialized first.
+  const ShapeFingerprintVector m_prefixes;
+  const IIndexedShapeFPMeasure::Ptr m_prefix_measurer;
+  const IIndexedShapeFPMeasure::Ptr m_full_measurer;
+  const bool m_compute_sim;
+  const float m_cutoff;
+};
+
+bool is_shorter(unsigned int num_bits,
+                const ShapeFingerprintVector &fingerprints) {
+  return !fingerprints.empty() && !fingerprints[0].empty() &&
+         (num_bits < fingerprints[0][0].size());
+}
+} // namespace
+
+IIndexedShapeFPMeasure::Ptr get_prefix_screened_measurer(
+    MeasuresBase::Ptr measure, bool compute_sim,
+    const ShapeFingerprintVector &fingerprints, const PrefixScreen &screen) {
+  IIndexedShapeFPMeasure::Ptr result = nullptr;
+  if (measure) {
+    if (is_shorter(screen.num_bits, fingerprints)) {
+      result = make_shared<PrefixScreenedMeasurer>(measure, compute_sim,
+                                                   fingerprints, screen);
+    } else {
+      result = get_shape_measurer(measure, compute_sim, fingerprints);
+    }
+  }
+  return result;
+}
+} // namespace mesaac::measures::shape
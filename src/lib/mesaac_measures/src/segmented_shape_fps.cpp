@@ -0,0 +1,536 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/segmented_shape_fps.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mesaac_common/file_sync.hpp"
+#include "mesaac_common/stats.hpp"
+
+using namespace std;
+
+namespace mesaac::measures::shape {
+
+namespace {
+// The manifest is a short text file:
+//   MESASFPS 1
+//   num_bits <bits per fingerprint>
+//   next_segment <sequence number for the next segment file>
+//   segment <file name> <global index of first shape> <number of shapes>
+//   ...
+const string ManifestMagic = "MESASFPS";
+const unsigned int ManifestVersion = 1;
+
+struct SegmentEntry {
+  string name;
+  std::uint64_t first_index;
+  std::uint64_t num_shapes;
+};
+
+struct Manifest {
+  unsigned int num_bits;
+  std::uint64_t next_segment;
+  vector<SegmentEntry> segments;
+
+  std::uint64_t num_shapes() const {
+    return segments.empty() ? 0
+                            : segments.back().first_index +
+                                  segments.back().num_shapes;
+  }
+};
+
+string segment_name(std::uint64_t sequence) {
+  return format("segment_{:06}.sfp", sequence);
+}
+
+filesystem::path popcounts_path(const filesystem::path &dir,
+                                const string &segment_name) {
+  return (dir / segment_name).replace_extension(".pop");
+}
+
+void remove_segment_files(const filesystem::path &dir, const string &name) {
+  // Best effort: a leftover file is harmless, as it is not in the manifest.
+  error_code ignored;
+  filesystem::remove(dir / name, ignored);
+  filesystem::remove(popcounts_path(dir, name), ignored);
+}
+
+// Flush a new segment's files to disk, before the manifest refers to them.
+void sync_segment_files(const filesystem::path &dir, const string &name) {
+  common::sync_file(dir / name);
+  common::sync_file(popcounts_path(dir, name));
+}
+
+// Returns an empty string if the manifest does not exist.
+string read_manifest_text(const filesystem::path &dir) {
+  ifstream inf(segment_manifest_path(dir));
+  if (!inf) {
+    return "";
+  }
+  ostringstream result;
+  result << inf.rdbuf();
+  return result.str();
+}
+
+Manifest parse_manifest(const filesystem::path &dir, const string &text) {
+  const auto invalid = [&dir](const string &reason) {
+    return runtime_error(
+        format("{} is not a valid segmented shape fingerprint database: {}.",
+               dir.string(), reason));
+  };
+
+  istringstream ins(text);
+  string magic, key;
+  unsigned int version;
+  if (!(ins >> magic >> version) || (magic != ManifestMagic)) {
+    throw invalid("missing manifest header");
+  }
+  if (version != ManifestVersion) {
+    throw invalid(format("unsupported manifest version {}", version));
+  }
+  Manifest result{.num_bits = 0, .next_segment = 0, .segments = {}};
+  if (!(ins >> key >> result.num_bits) || (key != "num_bits") ||
+      !(ins >> key >> result.next_segment) || (key != "next_segment")) {
+    throw invalid("malformed manifest header");
+  }
+  SegmentEntry entry;
+  while (ins >> key >> entry.name >> entry.first_index >> entry.num_shapes) {
+    if (key != "segment") {
+      throw invalid(format("unexpected manifest entry '{}'", key));
+    }
+    if (filesystem::path(entry.name).filename() != entry.name) {
+      throw invalid(format("segment '{}' is outside the database", entry.name));
+    }
+    if (entry.first_index != result.num_shapes()) {
+      throw invalid(format("segment {} does not follow its predecessor",
+                           entry.name));
+    }
+    result.segments.push_back(entry);
+  }
+  if (!ins.eof()) {
+    throw invalid("malformed segment entry");
+  }
+  return result;
+}
+
+// Write the manifest to a temporary file, then rename it into place so that
+// readers never see a partial manifest.  The manifest and the directory
+// entries of any segments it lists are flushed to disk before the rename,
+// so that a crash cannot leave the manifest naming missing files.
+void write_manifest(const filesystem::path &dir, const Manifest &manifest) {
+  const filesystem::path path(segment_manifest_path(dir));
+  filesystem::path tmp_path(path);
+  tmp_path += ".tmp";
+  {
+    ofstream outf(tmp_path, ios::trunc);
+    outf << ManifestMagic << " " << ManifestVersion << "\n"
+         << "num_bits " << manifest.num_bits << "\n"
+         << "next_segment " << manifest.next_segment << "\n";
+    for (const auto &entry : manifest.segments) {
+      outf << "segment " << entry.name << " " << entry.first_index << " "
+           << entry.num_shapes << "\n";
+    }
+    outf.close();
+    if (!outf) {
+      throw runtime_error(format("Cannot write {}", tmp_path.string()));
+    }
+  }
+  common::sync_file(tmp_path);
+  common::sync_directory(dir);
+  filesystem::rename(tmp_path, path);
+  common::sync_directory(dir);
+}
+
+// Take the database's exclusive writer lock, waiting if necessary.
+int lock_database(const filesystem::path &dir) {
+  const filesystem::path path(dir / "lock");
+  const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    throw runtime_error(
+        format("Cannot open {}: {}", path.string(), strerror(errno)));
+  }
+  while (::flock(fd, LOCK_EX) != 0) {
+    if (errno != EINTR) {
+      const string reason(strerror(errno));
+      ::close(fd);
+      throw runtime_error(format("Cannot lock {}: {}", path.string(), reason));
+    }
+  }
+  return fd;
+}
+
+void unlock_database(int fd) {
+  if (fd >= 0) {
+    ::flock(fd, LOCK_UN);
+    ::close(fd);
+  }
+}
+
+struct LockGuard {
+  const int fd;
+  ~LockGuard() { unlock_database(fd); }
+};
+
+ShapePopcounts get_popcounts(const mesaac::shape::ShapeFingerprint &sfp) {
+  ShapePopcounts result{};
+  for (unsigned int k = 0; k < FPsPerShape; ++k) {
+    result[k] = sfp[k].count();
+  }
+  return result;
+}
+
+void write_popcounts(ofstream &outf, const ShapePopcounts &popcounts) {
+  outf.write(reinterpret_cast<const char *>(popcounts.data()),
+             sizeof(popcounts));
+}
+} // namespace
+
+filesystem::path segment_manifest_path(const filesystem::path &dir) {
+  return dir / "manifest.txt";
+}
+
+SegmentedShapeFPWriter::SegmentedShapeFPWriter(const filesystem::path &dir,
+                                               unsigned int num_bits)
+    : m_dir(dir), m_num_bits(num_bits), m_lock_fd(-1), m_first_index(0) {
+  filesystem::create_directories(m_dir);
+  m_lock_fd = lock_database(m_dir);
+  try {
+    const string text(read_manifest_text(m_dir));
+    if (!text.empty()) {
+      const Manifest manifest(parse_manifest(m_dir, text));
+      if (!manifest.segments.empty() && (manifest.num_bits != m_num_bits)) {
+        throw runtime_error(
+            format("{} holds {}-bit fingerprints; cannot append {}-bit "
+                   "fingerprints.",
+                   m_dir.string(), manifest.num_bits, m_num_bits));
+      }
+      m_first_index = manifest.num_shapes();
+      m_segment_name = segment_name(manifest.next_segment);
+    } else {
+      m_segment_name = segment_name(0);
+    }
+    m_fps = make_unique<PackedShapeFPWriter>(m_dir / m_segment_name,
+                                             m_num_bits);
+    const auto path(popcounts_path(m_dir, m_segment_name));
+    m_popcounts_outf.open(path, ios::binary | ios::trunc);
+    if (!m_popcounts_outf) {
+      throw runtime_error(format("Cannot open {} for writing.", path.string()));
+    }
+  } catch (const exception &) {
+    discard();
+    throw;
+  }
+}
+
+SegmentedShapeFPWriter::~SegmentedShapeFPWriter() {
+  if (m_lock_fd >= 0) {
+    discard();
+  }
+}
+
+void SegmentedShapeFPWriter::write(const mesaac::shape::ShapeFingerprint &sfp) {
+  m_fps->write(sfp);
+  write_popcounts(m_popcounts_outf, get_popcounts(sfp));
+  if (!m_popcounts_outf) {
+    throw runtime_error(format(
+        "Cannot write to {}", popcounts_path(m_dir, m_segment_name).string()));
+  }
+}
+
+void SegmentedShapeFPWriter::close() {
+  if (m_lock_fd < 0) {
+    return;
+  }
+  try {
+    m_fps->close();
+    m_popcounts_outf.close();
+    if (!m_popcounts_outf) {
+      throw runtime_error(
+          format("Cannot complete {}",
+                 popcounts_path(m_dir, m_segment_name).string()));
+    }
+
+    const string text(read_manifest_text(m_dir));
+    Manifest manifest{
+        .num_bits = m_num_bits, .next_segment = 0, .segments = {}};
+    if (!text.empty()) {
+      manifest = parse_manifest(m_dir, text);
+      manifest.num_bits = m_num_bits;
+    }
+    if (m_fps->size() > 0) {
+      sync_segment_files(m_dir, m_segment_name);
+      manifest.segments.push_back({.name = m_segment_name,
+                                   .first_index = m_first_index,
+                                   .num_shapes = m_fps->size()});
+      manifest.next_segment++;
+      write_manifest(m_dir, manifest);
+    } else {
+      remove_segment_files(m_dir, m_segment_name);
+      if (text.empty()) {
+        // Create an empty database, so that it can be opened.
+        write_manifest(m_dir, manifest);
+      }
+    }
+  } catch (const exception &) {
+    discard();
+    throw;
+  }
+  unlock_database(m_lock_fd);
+  m_lock_fd = -1;
+}
+
+void SegmentedShapeFPWriter::discard() {
+  m_fps.reset();
+  m_popcounts_outf.close();
+  if (!m_segment_name.empty()) {
+    remove_segment_files(m_dir, m_segment_name);
+  }
+  unlock_database(m_lock_fd);
+  m_lock_fd = -1;
+}
+
+unsigned int compact_segments(const filesystem::path &dir) {
+  static common::stats::Stage &compact_stage(
+      common::stats::stage("compact_segments"));
+
+  const LockGuard lock{lock_database(dir)};
+  const string text(read_manifest_text(dir));
+  if (text.empty()) {
+    throw runtime_error(format(
+        "{} is not a segmented shape fingerprint database.", dir.string()));
+  }
+  const Manifest manifest(parse_manifest(dir, text));
+  if (manifest.segments.size() < 2) {
+    return 0;
+  }
+  const common::stats::ScopedTimer timer(compact_stage,
+                                         manifest.num_shapes());
+
+  const string merged_name(segment_name(manifest.next_segment));
+  try {
+    PackedShapeFPWriter writer(dir / merged_name, manifest.num_bits);
+    ofstream popcounts_outf(popcounts_path(dir, merged_name),
+                            ios::binary | ios::trunc);
+    mesaac::shape::ShapeFingerprint sfp;
+    for (const auto &entry : manifest.segments) {
+      const PackedShapeFPs fps(dir / entry.name);
+      for (unsigned int i = 0; i < fps.size(); ++i) {
+        fps.get(i, sfp);
+        writer.write(sfp);
+        write_popcounts(popcounts_outf, get_popcounts(sfp));
+      }
+    }
+    writer.close();
+    popcounts_outf.close();
+    if (!popcounts_outf) {
+      throw runtime_error(format(
+          "Cannot write {}", popcounts_path(dir, merged_name).string()));
+    }
+    sync_segment_files(dir, merged_name);
+
+    const Manifest merged{
+        .num_bits = manifest.num_bits,
+        .next_segment = manifest.next_segment + 1,
+        .segments = {{.name = merged_name,
+                      .first_index = 0,
+                      .num_shapes = manifest.num_shapes()}}};
+    write_manifest(dir, merged);
+  } catch (const exception &) {
+    remove_segment_files(dir, merged_name);
+    throw;
+  }
+
+  // The merged segment and its manifest are on disk, so the old segments
+  // are no longer needed.
+  for (const auto &entry : manifest.segments) {
+    remove_segment_files(dir, entry.name);
+  }
+  return manifest.segments.size();
+}
+
+SegmentedShapeFPs::SegmentedShapeFPs(const filesystem::path &path)
+    : m_path(path), m_num_bits(0), m_num_shapes(0) {
+  if (filesystem::is_directory(m_path)) {
+    open_segments();
+  } else {
+    open_packed_file();
+  }
+}
+
+bool SegmentedShapeFPs::is_database(const filesystem::path &path) {
+  error_code ignored;
+  if (filesystem::is_directory(path, ignored)) {
+    return filesystem::is_regular_file(segment_manifest_path(path), ignored);
+  }
+  return PackedShapeFPs::is_packed(path);
+}
+
+void SegmentedShapeFPs::open_packed_file() {
+  auto fps = make_unique<PackedShapeFPs>(m_path);
+  vector<std::uint32_t> popcounts;
+  popcounts.reserve(size_t(fps->size()) * FPsPerShape);
+  const unsigned int words_per_fp = fps->words_per_fp();
+  for (unsigned int i = 0; i < fps->size(); ++i) {
+    const auto words = fps->words(i);
+    for (unsigned int k = 0; k < FPsPerShape; ++k) {
+      std::uint32_t count = 0;
+      for (unsigned int w = 0; w < words_per_fp; ++w) {
+        count += popcount(words[k * words_per_fp + w]);
+      }
+      popcounts.push_back(count);
+    }
+  }
+
+  m_num_bits = fps->num_bits();
+  m_num_shapes = fps->size();
+  m_segments.push_back({.first_index = 0,
+                        .fps = std::move(fps),
+                        .popcounts_file = nullptr,
+                        .computed_popcounts = std::move(popcounts),
+                        .popcounts = nullptr});
+  m_segments.back().popcounts = m_segments.back().computed_popcounts.data();
+}
+
+void SegmentedShapeFPs::open_segments() {
+  // A concurrent compaction may remove segments between reading the
+  // manifest and opening them.  If so, the manifest will have changed; retry
+  // with the new one.
+  const unsigned int max_attempts = 3;
+  for (unsigned int attempt = 1;; ++attempt) {
+    // Stamp the manifest before reading it, so that a concurrent update
+    // makes the database look stale rather than current.
+    m_manifest_stamp = get_manifest_stamp(m_path);
+    m_manifest = read_manifest_text(m_path);
+    if (m_manifest.empty()) {
+      throw runtime_error(
+          format("{} is not a segmented shape fingerprint database.",
+                 m_path.string()));
+    }
+    const Manifest manifest(parse_manifest(m_path, m_manifest));
+    if (manifest.num_shapes() > numeric_limits<unsigned int>::max()) {
+      throw runtime_error(format("{} holds too many shape fingerprints.",
+                                 m_path.string()));
+    }
+    m_num_bits = manifest.num_bits;
+    m_num_shapes = manifest.num_shapes();
+    m_segments.clear();
+    try {
+      for (const auto &entry : manifest.segments) {
+        Segment segment{
+            .first_index = static_cast<unsigned int>(entry.first_index),
+            .fps = make_unique<PackedShapeFPs>(m_path / entry.name),
+            .popcounts_file = make_unique<common::MappedFile>(
+                popcounts_path(m_path, entry.name)),
+            .computed_popcounts = {},
+            .popcounts = nullptr};
+        const size_t expected_popcounts_size =
+            entry.num_shapes * sizeof(ShapePopcounts);
+        if ((segment.fps->size() != entry.num_shapes) ||
+            (segment.fps->num_bits() != m_num_bits) ||
+            (segment.popcounts_file->size() != expected_popcounts_size)) {
+          throw runtime_error(
+              format("Segment {} of {} does not match its manifest entry.",
+                     entry.name, m_path.string()));
+        }
+        segment.popcounts = reinterpret_cast<const std::uint32_t *>(
+            segment.popcounts_file->data());
+        m_segments.push_back(std::move(segment));
+      }
+      return;
+    } catch (const runtime_error &) {
+      if ((attempt >= max_attempts) ||
+          (read_manifest_text(m_path) == m_manifest)) {
+        throw;
+      }
+    }
+  }
+}
+
+const SegmentedShapeFPs::Segment &
+SegmentedShapeFPs::find_segment(unsigned int i) const {
+  if (i >= m_num_shapes) {
+    throw out_of_range(format("Shape index {} is out of range (0..{})", i,
+                              m_num_shapes));
+  }
+  // Find the last segment that starts at or before i.
+  const auto found = upper_bound(
+      m_segments.begin(), m_segments.end(), i,
+      [](unsigned int index, const Segment &segment) {
+        return index < segment.first_index;
+      });
+  return *(found - 1);
+}
+
+size_t SegmentedShapeFPs::shape_bytes() const {
+  const size_t words_per_fp = (size_t(m_num_bits) + 63) / 64;
+  return sizeof(mesaac::shape::ShapeFingerprint) +
+         FPsPerShape * (sizeof(shape_defs::BitVector) +
+                        words_per_fp * sizeof(std::uint64_t));
+}
+
+void SegmentedShapeFPs::get(unsigned int i,
+                            mesaac::shape::ShapeFingerprint &sfp) const {
+  const Segment &segment(find_segment(i));
+  segment.fps->get(i - segment.first_index, sfp);
+}
+
+void SegmentedShapeFPs::append_range(
+    unsigned int begin, unsigned int end,
+    mesaac::shape::ShapeFingerprintVector &sfps) const {
+  sfps.reserve(sfps.size() + (end - begin));
+  for (unsigned int i = begin; i < end; ++i) {
+    sfps.emplace_back();
+    get(i, sfps.back());
+  }
+}
+
+span<const std::uint64_t> SegmentedShapeFPs::words(unsigned int i) const {
+  const Segment &segment(find_segment(i));
+  return segment.fps->words(i - segment.first_index);
+}
+
+ShapePopcounts SegmentedShapeFPs::popcounts(unsigned int i) const {
+  const Segment &segment(find_segment(i));
+  const std::uint32_t *counts =
+      segment.popcounts + size_t(i - segment.first_index) * FPsPerShape;
+  ShapePopcounts result;
+  copy(counts, counts + FPsPerShape, result.begin());
+  return result;
+}
+
+bool SegmentedShapeFPs::is_stale() const {
+  // Only a segmented database directory has a manifest.
+  return !m_manifest.empty() &&
+         (get_manifest_stamp(m_path) != m_manifest_stamp);
+}
+
+SegmentedShapeFPs::ManifestStamp
+SegmentedShapeFPs::get_manifest_stamp(const filesystem::path &dir) {
+  struct stat info;
+  if (::stat(segment_manifest_path(dir).c_str(), &info) != 0) {
+    // A missing manifest never matches the stamp of an opened database.
+    return {};
+  }
+  return {.device = std::uint64_t(info.st_dev),
+          .inode = std::uint64_t(info.st_ino),
+          .size = std::int64_t(info.st_size),
+          .mtime_ns = std::int64_t(info.st_mtim.tv_sec) * 1000000000 +
+                      info.st_mtim.tv_nsec};
+}
+
+} // namespace mesaac::measures::shape
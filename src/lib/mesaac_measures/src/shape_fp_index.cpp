@@ -0,0 +1,32 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/shape_fp_index.hpp"
+
+#include <format>
+#include <stdexcept>
+
+#include "mesaac_measures/minhash_index.hpp"
+#include "mesaac_measures/popcount_index.hpp"
+
+using namespace std;
+
+namespace mesaac::measures::shape {
+
+bool is_shape_fp_index(const filesystem::path &path) {
+  return is_popcount_index(path) || is_minhash_index(path);
+}
+
+IShapeFPIndex::Ptr open_shape_fp_index(const filesystem::path &path) {
+  if (is_popcount_index(path)) {
+    return make_shared<PopcountIndex>(path);
+  }
+  if (is_minhash_index(path)) {
+    return make_shared<MinHashIndex>(path);
+  }
+  throw runtime_error(
+      format("{} is not a shape fingerprint index.", path.string()));
+}
+
+} // namespace mesaac::measures::shape
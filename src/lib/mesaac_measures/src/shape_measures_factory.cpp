@@ -2,11 +2,21 @@
 // Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
 //
 
+#include <algorithm>
+#include <cstdint>
+#include <format>
 #include <memory>
+#include <span>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
 
 #include "mesaac_measures/shape_measures_factory.hpp"
 
+#include "mesaac_common/stats.hpp"
 #include "mesaac_measures/bub.hpp"
+#include "mesaac_measures/compressed_fp.hpp"
+#include "mesaac_measures/contingency_counts.hpp"
 #include "mesaac_measures/cosine.hpp"
 #include "mesaac_measures/euclidean.hpp"
 #include "mesaac_measures/hamann.hpp"
@@ -19,149 +29,340 @@ using namespace mesaac::shape;
 
 namespace mesaac::measures::shape {
 
+void IIndexedShapeFPMeasure::value_row(unsigned int i, unsigned int j_begin,
+                                       unsigned int j_end, float *out) const {
+  for (unsigned int j = j_begin; j < j_end; j++) {
+    out[j - j_begin] = value(i, j);
+  }
+}
+
+void IIndexedShapeFPMeasure::value_block(unsigned int i_begin,
+                                         unsigned int i_end,
+                                         unsigned int j_begin,
+                                         unsigned int j_end,
+                                         float *out) const {
+  const size_t num_cols = j_end - j_begin;
+  for (unsigned int i = i_begin; i < i_end; i++) {
+    value_row(i, j_begin, j_end, out + (i - i_begin) * num_cols);
+  }
+}
+
 namespace {
 using MeasuresPtr = MeasuresBase::Ptr;
+using Word = std::uint64_t;
+static_assert(sizeof(shape_defs::BitVector::block_type) == sizeof(Word),
+              "Batch measurers assume 64-bit BitVector blocks");
+
+// Each measurer value is recorded as one measure evaluation.
+common::stats::Stage &value_stage() {
+  static common::stats::Stage &result(
+      common::stats::stage("ShapeFPMeasure::value"));
+  return result;
+}
 
-class Measurer : public IIndexedShapeFPMeasure {
+// This probably belongs in Globals...
+const unsigned int ShapeMeasurerBlockSize = 4;
 
-public:
-  Measurer(const shape_defs::ArrayBitVectors &fingerprints, MeasuresPtr measure)
-      : m_fps(fingerprints), m_measure(measure) {}
+// Columns per tile in value_block.  A tile's fingerprints are unpacked
+// once and stay in cache while every row of the block is measured
+// against them.
+const unsigned int TileCols = 64;
 
-  float value(unsigned int i, unsigned int j) const override {
-    float result = 1.0;
-    if (i != j) {
-      result = (*m_measure)(m_fps[i], m_fps[j]);
-    }
-    return result;
+// Evaluates a built-in measure from contingency counts with a
+// non-virtual call, so that kernels can inline its closed form.
+template <typename M> struct ExactEval {
+  M measure;
+
+  float operator()(const ContingencyCounts &counts) const {
+    return measure.M::similarity(counts);
   }
+};
 
-protected:
-  const shape_defs::ArrayBitVectors &m_fps;
-  const MeasuresPtr m_measure;
+// Evaluates any other MeasuresBase subclass, through its vtable.
+struct VirtualEval {
+  MeasuresPtr measure;
+
+  float operator()(const ContingencyCounts &counts) const {
+    return measure->similarity(counts);
+  }
 };
 
-class DistMeasurer : public IIndexedShapeFPMeasure {
+// Call make with the evaluator for measure's dynamic type.  This is the
+// only point at which measurers dispatch on the measure.
+template <typename Make>
+auto with_evaluator(const MeasuresPtr &measure, Make make) {
+  const MeasuresBase &m(*measure);
+  const type_info &type(typeid(m));
+  if (type == typeid(Tanimoto)) {
+    return make(ExactEval<Tanimoto>{m});
+  }
+  if (type == typeid(BUB)) {
+    return make(ExactEval<BUB>{static_cast<const BUB &>(m)});
+  }
+  if (type == typeid(Cosine)) {
+    return make(ExactEval<Cosine>{static_cast<const Cosine &>(m)});
+  }
+  if (type == typeid(Euclidean)) {
+    return make(ExactEval<Euclidean>{static_cast<const Euclidean &>(m)});
+  }
+  if (type == typeid(Hamann)) {
+    return make(ExactEval<Hamann>{static_cast<const Hamann &>(m)});
+  }
+  if (type == typeid(Tversky)) {
+    return make(ExactEval<Tversky>{static_cast<const Tversky &>(m)});
+  }
+  return make(VirtualEval{measure});
+}
+
+template <bool Sim> float to_value(float similarity) {
+  if constexpr (Sim) {
+    return similarity;
+  } else {
+    return 1.0 - similarity;
+  }
+}
+
+// The value of any fingerprint against itself.
+template <bool Sim> float self_value() { return Sim ? 1.0 : 0.0; }
+
+// Unpacks fingerprints into runs of num_words words, for counting.
+class FPPacker {
 public:
-  DistMeasurer(const shape_defs::ArrayBitVectors &fingerprints,
-               MeasuresPtr measure)
-      : m_fps(fingerprints), m_measure(measure) {}
-
-  float value(unsigned int i, unsigned int j) const {
-    float result = 0.0;
-    if (i != j) {
-      result = 1.0 - (*m_measure)(m_fps[i], m_fps[j]);
+  explicit FPPacker(const shape_defs::BitVector &model)
+      : m_num_bits(model.size()), m_num_words(model.num_blocks()) {}
+
+  unsigned int num_bits() const { return m_num_bits; }
+
+  unsigned int num_words() const { return m_num_words; }
+
+  void pack(const shape_defs::BitVector &fp, Word *words) const {
+    if (fp.size() != m_num_bits) {
+      throw invalid_argument(format(
+          "Cannot compare fingerprints of {} and {} bits.", m_num_bits,
+          fp.size()));
     }
-    return result;
+    boost::to_block_range(fp, words);
   }
 
-protected:
-  const shape_defs::ArrayBitVectors &m_fps;
-  MeasuresPtr m_measure;
-};
+  ContingencyCounts counts(const Word *words1, const Word *words2) const {
+    return get_contingency_counts(span<const Word>(words1, m_num_words),
+                                  span<const Word>(words2, m_num_words),
+                                  m_num_bits);
+  }
 
-// This probably belongs in Globals...
-const unsigned int ShapeMeasurerBlockSize = 4;
+private:
+  unsigned int m_num_bits;
+  unsigned int m_num_words;
+};
 
-class ShapeMeasurer : public IIndexedShapeFPMeasure {
+// Measures plain fingerprints.  value and value_row are special cases of
+// value_block, whose loops are specialized for the measure and for
+// similarity or distance.
+template <typename Eval, bool Sim>
+class FPMeasurer : public IIndexedShapeFPMeasure {
 public:
-  ShapeMeasurer(const shape_defs::ShapeFPBlocks &fingerprints,
-                MeasuresPtr measure)
-      : m_fps(fingerprints), m_measure(measure) {}
+  FPMeasurer(const shape_defs::ArrayBitVectors &fingerprints, Eval eval)
+      : m_fps(fingerprints), m_eval(eval) {}
 
   float value(unsigned int i, unsigned int j) const override {
-    float result = 1.0;
-    if (i != j) {
-      MeasuresBase &m(*m_measure);
-      const shape_defs::ArrayBitVectors &i_fps(m_fps[i]);
-      const shape_defs::ArrayBitVectors &j_fps(m_fps[j]);
-      // Check the first fingerprint from group i against all
-      // members of group j, looking for the highest similarity.
-      result = m(i_fps[0], j_fps[0]);
-      for (unsigned int k = 1; k != ShapeMeasurerBlockSize; k++) {
-        float pair_result = m(i_fps[0], j_fps[k]);
-        result = (result > pair_result) ? result : pair_result;
+    float result;
+    value_block(i, i + 1, j, j + 1, &result);
+    return result;
+  }
+
+  void value_row(unsigned int i, unsigned int j_begin, unsigned int j_end,
+                 float *out) const override {
+    value_block(i, i + 1, j_begin, j_end, out);
+  }
+
+  void value_block(unsigned int i_begin, unsigned int i_end,
+                   unsigned int j_begin, unsigned int j_end,
+                   float *out) const override {
+    if (i_begin >= i_end || j_begin >= j_end) {
+      return;
+    }
+    const unsigned int num_cols = j_end - j_begin;
+    const common::stats::ScopedTimer timer(value_stage(),
+                                           size_t(i_end - i_begin) * num_cols);
+    const FPPacker packer(m_fps[i_begin]);
+    const size_t num_words = packer.num_words();
+
+    thread_local vector<Word> row_words;
+    thread_local vector<Word> tile_words;
+    row_words.resize((i_end - i_begin) * num_words);
+    for (unsigned int i = i_begin; i < i_end; i++) {
+      packer.pack(m_fps[i], &row_words[(i - i_begin) * num_words]);
+    }
+    for (unsigned int tile = j_begin; tile < j_end; tile += TileCols) {
+      const unsigned int tile_end = min(j_end, tile + TileCols);
+      tile_words.resize((tile_end - tile) * num_words);
+      for (unsigned int j = tile; j < tile_end; j++) {
+        packer.pack(m_fps[j], &tile_words[(j - tile) * num_words]);
+      }
+      for (unsigned int i = i_begin; i < i_end; i++) {
+        const Word *words1 = &row_words[(i - i_begin) * num_words];
+        float *row_out = out + size_t(i - i_begin) * num_cols;
+        for (unsigned int j = tile; j < tile_end; j++) {
+          const Word *words2 = &tile_words[(j - tile) * num_words];
+          row_out[j - j_begin] =
+              (i == j) ? self_value<Sim>()
+                       : to_value<Sim>(m_eval(packer.counts(words1, words2)));
+        }
       }
     }
-    return result;
   }
 
 protected:
-  const shape_defs::ShapeFPBlocks &m_fps;
-  MeasuresPtr m_measure;
+  const shape_defs::ArrayBitVectors &m_fps;
+  const Eval m_eval;
 };
 
-class ShapeDistMeasurer : public IIndexedShapeFPMeasure {
+template <typename Eval> using Measurer = FPMeasurer<Eval, true>;
+template <typename Eval> using DistMeasurer = FPMeasurer<Eval, false>;
+
+// Measures shape fingerprints: the first fingerprint of shape i against
+// each member of shape j, taking the highest similarity.
+template <typename Eval, bool Sim>
+class ShapeFPMeasurer : public IIndexedShapeFPMeasure {
 public:
-  ShapeDistMeasurer(const shape_defs::ShapeFPBlocks &fingerprints,
-                    MeasuresPtr measure)
-      : m_fps(fingerprints), m_measure(measure) {}
+  ShapeFPMeasurer(const shape_defs::ShapeFPBlocks &fingerprints, Eval eval)
+      : m_fps(fingerprints), m_eval(eval) {}
 
   float value(unsigned int i, unsigned int j) const override {
-    float result = 0.0;
-    if (i != j) {
-      MeasuresBase &m(*m_measure);
-      const shape_defs::ArrayBitVectors &i_fps(m_fps[i]);
-      const shape_defs::ArrayBitVectors &j_fps(m_fps[j]);
-      // Check the first fingerprint from group i against all
-      // members of group j, looking for the highest similarity.
-      float best = m(i_fps[0], j_fps[0]);
-      for (unsigned int k = 1; k != ShapeMeasurerBlockSize; k++) {
-        float curr_pair = m(i_fps[0], j_fps[k]);
-        best = (best > curr_pair) ? best : curr_pair;
+    float result;
+    value_block(i, i + 1, j, j + 1, &result);
+    return result;
+  }
+
+  void value_row(unsigned int i, unsigned int j_begin, unsigned int j_end,
+                 float *out) const override {
+    value_block(i, i + 1, j_begin, j_end, out);
+  }
+
+  void value_block(unsigned int i_begin, unsigned int i_end,
+                   unsigned int j_begin, unsigned int j_end,
+                   float *out) const override {
+    if (i_begin >= i_end || j_begin >= j_end) {
+      return;
+    }
+    const unsigned int num_cols = j_end - j_begin;
+    const common::stats::ScopedTimer timer(value_stage(),
+                                           size_t(i_end - i_begin) * num_cols);
+    const FPPacker packer(m_fps[i_begin][0]);
+    const size_t num_words = packer.num_words();
+    const size_t shape_words = ShapeMeasurerBlockSize * num_words;
+
+    thread_local vector<Word> row_words;
+    thread_local vector<Word> tile_words;
+    row_words.resize((i_end - i_begin) * num_words);
+    for (unsigned int i = i_begin; i < i_end; i++) {
+      packer.pack(m_fps[i][0], &row_words[(i - i_begin) * num_words]);
+    }
+    for (unsigned int tile = j_begin; tile < j_end; tile += TileCols) {
+      const unsigned int tile_end = min(j_end, tile + TileCols);
+      tile_words.resize((tile_end - tile) * shape_words);
+      for (unsigned int j = tile; j < tile_end; j++) {
+        Word *words = &tile_words[(j - tile) * shape_words];
+        for (unsigned int k = 0; k != ShapeMeasurerBlockSize; k++) {
+          packer.pack(m_fps[j][k], words + k * num_words);
+        }
+      }
+      for (unsigned int i = i_begin; i < i_end; i++) {
+        const Word *words1 = &row_words[(i - i_begin) * num_words];
+        float *row_out = out + size_t(i - i_begin) * num_cols;
+        for (unsigned int j = tile; j < tile_end; j++) {
+          if (i == j) {
+            row_out[j - j_begin] = self_value<Sim>();
+            continue;
+          }
+          // Check the first fingerprint from group i against all
+          // members of group j, looking for the highest similarity.
+          const Word *words2 = &tile_words[(j - tile) * shape_words];
+          float best = m_eval(packer.counts(words1, words2));
+          for (unsigned int k = 1; k != ShapeMeasurerBlockSize; k++) {
+            const float curr_pair =
+                m_eval(packer.counts(words1, words2 + k * num_words));
+            best = (best > curr_pair) ? best : curr_pair;
+          }
+          row_out[j - j_begin] = to_value<Sim>(best);
+        }
       }
-      result = 1.0 - best;
     }
-    return result;
   }
 
 protected:
   const shape_defs::ShapeFPBlocks &m_fps;
-  MeasuresPtr m_measure;
+  const Eval m_eval;
 };
 
-// Pairwise measurers are for clients which do not have full shape
-// fingerprints arrays.
-class ShapePairMeasurer : public IShapeFPMeasure {
+template <typename Eval> using ShapeMeasurer = ShapeFPMeasurer<Eval, true>;
+template <typename Eval>
+using ShapeDistMeasurer = ShapeFPMeasurer<Eval, false>;
+
+// Measures compressed shape fingerprints, as for ShapeFPMeasurer.
+template <typename Eval, bool Sim>
+class CompressedShapeFPMeasurer : public IIndexedShapeFPMeasure {
 public:
-  ShapePairMeasurer(MeasuresPtr measure) : m_measure(measure) {}
+  CompressedShapeFPMeasurer(const CompressedShapeFPs &fingerprints, Eval eval)
+      : m_fps(fingerprints), m_eval(eval) {}
 
-  float value(const ShapeFingerprint &sfp1,
-              const ShapeFingerprint &sfp2) const override {
-    MeasuresBase &m(*m_measure);
-    // Check the first fingerprint from sfp1 against all
-    // members of sfp2, looking for the highest similarity.
-    float result = m(sfp1[0], sfp2[0]);
-    for (unsigned int k = 1; k != ShapeMeasurerBlockSize; k++) {
-      float pair_result = m(sfp1[0], sfp2[k]);
-      result = max(result, pair_result);
+  float value(unsigned int i, unsigned int j) const override {
+    const common::stats::ScopedTimer timer(value_stage());
+    return (i == j) ? self_value<Sim>() : pair_value(m_fps.fp(i, 0), j);
+  }
+
+  void value_row(unsigned int i, unsigned int j_begin, unsigned int j_end,
+                 float *out) const override {
+    if (j_begin >= j_end) {
+      return;
+    }
+    const common::stats::ScopedTimer timer(value_stage(), j_end - j_begin);
+    const CompressedFP &fp1(m_fps.fp(i, 0));
+    for (unsigned int j = j_begin; j < j_end; j++) {
+      out[j - j_begin] = (i == j) ? self_value<Sim>() : pair_value(fp1, j);
     }
-    return result;
   }
 
 protected:
-  MeasuresPtr m_measure;
+  const CompressedShapeFPs &m_fps;
+  const Eval m_eval;
+
+  // Check fp1 against all members of group j, looking for the highest
+  // similarity.
+  float pair_value(const CompressedFP &fp1, unsigned int j) const {
+    float best = m_eval(get_contingency_counts(fp1, m_fps.fp(j, 0)));
+    for (unsigned int k = 1; k != ShapeMeasurerBlockSize; k++) {
+      const float curr_pair =
+          m_eval(get_contingency_counts(fp1, m_fps.fp(j, k)));
+      best = (best > curr_pair) ? best : curr_pair;
+    }
+    return to_value<Sim>(best);
+  }
 };
 
-class ShapePairDistMeasurer : public IShapeFPMeasure {
+// Pairwise measurers are for clients which do not have full shape
+// fingerprints arrays.
+template <typename Eval, bool Sim>
+class ShapePairMeasurer : public IShapeFPMeasure {
 public:
-  ShapePairDistMeasurer(MeasuresPtr measure) : m_measure(measure) {}
+  ShapePairMeasurer(Eval eval) : m_eval(eval) {}
 
   float value(const ShapeFingerprint &sfp1,
               const ShapeFingerprint &sfp2) const override {
-    MeasuresBase &m(*m_measure);
-    float best = m(sfp1[0], sfp2[0]);
+    const common::stats::ScopedTimer timer(value_stage());
+    // Check the first fingerprint from sfp1 against all
+    // members of sfp2, looking for the highest similarity -- the least
+    // distance.
+    float best = m_eval(get_contingency_counts(sfp1[0], sfp2[0]));
     for (unsigned int k = 1; k != ShapeMeasurerBlockSize; k++) {
-      float curr_pair = m(sfp1[0], sfp2[k]);
-      // Find the highest similarity to sfp1[0] -- the least distance.
+      float curr_pair = m_eval(get_contingency_counts(sfp1[0], sfp2[k]));
       best = max(best, curr_pair);
     }
-    float result = 1.0 - best;
-    return result;
+    return to_value<Sim>(best);
   }
 
 protected:
-  MeasuresPtr m_measure;
+  const Eval m_eval;
 };
 } // namespace
 
@@ -173,11 +374,14 @@ get_fp_measurer(MeasuresBase::Ptr measure, bool compute_sim,
   // a measure corresponding to dist_type.
   IIndexedShapeFPMeasure::Ptr result = nullptr;
   if (measure) {
-    if (compute_sim) {
-      result = std::make_shared<Measurer>(fingerprints, measure);
-    } else {
-      result = std::make_shared<DistMeasurer>(fingerprints, measure);
-    }
+    result = with_evaluator(
+        measure, [&](auto eval) -> IIndexedShapeFPMeasure::Ptr {
+          using Eval = decltype(eval);
+          if (compute_sim) {
+            return std::make_shared<Measurer<Eval>>(fingerprints, eval);
+          }
+          return std::make_shared<DistMeasurer<Eval>>(fingerprints, eval);
+        });
   }
   return result;
 }
@@ -190,11 +394,34 @@ get_shape_measurer(MeasuresBase::Ptr measure, bool compute_sim,
   // a measure corresponding to dist_type.
   IIndexedShapeFPMeasure::Ptr result = nullptr;
   if (measure) {
-    if (compute_sim) {
-      result = std::make_shared<ShapeMeasurer>(fingerprints, measure);
-    } else {
-      result = std::make_shared<ShapeDistMeasurer>(fingerprints, measure);
-    }
+    result = with_evaluator(
+        measure, [&](auto eval) -> IIndexedShapeFPMeasure::Ptr {
+          using Eval = decltype(eval);
+          if (compute_sim) {
+            return std::make_shared<ShapeMeasurer<Eval>>(fingerprints, eval);
+          }
+          return std::make_shared<ShapeDistMeasurer<Eval>>(fingerprints,
+                                                           eval);
+        });
+  }
+  return result;
+}
+
+IIndexedShapeFPMeasure::Ptr
+get_shape_measurer(MeasuresBase::Ptr measure, bool compute_sim,
+                   const CompressedShapeFPs &fingerprints) {
+  IIndexedShapeFPMeasure::Ptr result = nullptr;
+  if (measure) {
+    result = with_evaluator(
+        measure, [&](auto eval) -> IIndexedShapeFPMeasure::Ptr {
+          using Eval = decltype(eval);
+          if (compute_sim) {
+            return std::make_shared<CompressedShapeFPMeasurer<Eval, true>>(
+                fingerprints, eval);
+          }
+          return std::make_shared<CompressedShapeFPMeasurer<Eval, false>>(
+              fingerprints, eval);
+        });
   }
   return result;
 }
@@ -206,11 +433,14 @@ IShapeFPMeasure::Ptr get_shape_pair_measurer(MeasuresBase::Ptr measure,
   // a measure corresponding to dist_type.
   IShapeFPMeasure::Ptr result = nullptr;
   if (measure) {
-    if (compute_sim) {
-      result = std::make_shared<ShapePairMeasurer>(measure);
-    } else {
-      result = std::make_shared<ShapePairDistMeasurer>(measure);
-    }
+    result =
+        with_evaluator(measure, [&](auto eval) -> IShapeFPMeasure::Ptr {
+          using Eval = decltype(eval);
+          if (compute_sim) {
+            return std::make_shared<ShapePairMeasurer<Eval, true>>(eval);
+          }
+          return std::make_shared<ShapePairMeasurer<Eval, false>>(eval);
+        });
   }
   return result;
 }
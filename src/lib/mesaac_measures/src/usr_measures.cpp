@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/usr_measures.hpp"
+
+#include <algorithm>
+#include <format>
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+
+namespace mesaac::measures {
+
+namespace {
+// Tile sizes for usr_similarities.  A tile's column vectors stay in L1
+// cache while each of its rows is compared to them.
+const unsigned int RowTile = 16;
+const unsigned int ColTile = 256;
+
+float l1_distance(const float *a, const float *b, size_t n) {
+  float sum = 0.0;
+#if HAVE_OPENMP
+#pragma omp simd reduction(+ : sum)
+#endif
+  for (size_t k = 0; k < n; ++k) {
+    const float diff = a[k] - b[k];
+    sum += (diff < 0) ? -diff : diff;
+  }
+  return sum;
+}
+
+inline float similarity(const float *a, const float *b, size_t stride,
+                        float num_features) {
+  return 1.0 / (1.0 + l1_distance(a, b, stride) / num_features);
+}
+
+UsrVectors as_vectors(const UsrVectors &vectors,
+                      std::span<const float> query) {
+  if (query.size() != vectors.num_features()) {
+    throw invalid_argument(format("USR query has {} values; expected {}",
+                                  query.size(), vectors.num_features()));
+  }
+  UsrVectors result(vectors.num_features());
+  result.push_back(query);
+  return result;
+}
+
+vector<float> query_similarities(const UsrVectors &vectors,
+                                 std::span<const float> query) {
+  const UsrVectors queries(as_vectors(vectors, query));
+  vector<float> result(vectors.size());
+  usr_similarities(queries, 0, 1, vectors, result);
+  return result;
+}
+
+class UsrMeasurer : public shape::IIndexedShapeFPMeasure {
+public:
+  UsrMeasurer(const UsrVectors &vectors, bool compute_sim)
+      : m_vectors(vectors), m_compute_sim(compute_sim) {}
+
+  float value(unsigned int i, unsigned int j) const override {
+    if (i == j) {
+      return m_compute_sim ? 1.0 : 0.0;
+    }
+    const float sim =
+        usr_similarity(m_vectors[i], m_vectors[j], m_vectors.stride(),
+                       m_vectors.num_features());
+    return m_compute_sim ? sim : 1.0 - sim;
+  }
+
+private:
+  const UsrVectors &m_vectors;
+  const bool m_compute_sim;
+};
+} // namespace
+
+float usr_similarity(const float *a, const float *b, size_t stride,
+                     unsigned int num_features) {
+  return similarity(a, b, stride, max(1u, num_features));
+}
+
+void usr_similarities(const UsrVectors &rows, unsigned int begin,
+                      unsigned int end, const UsrVectors &cols,
+                      std::span<float> values) {
+  if (rows.num_features() != cols.num_features()) {
+    throw invalid_argument(
+        format("Cannot compare USR vectors of length {} to vectors of "
+               "length {}",
+               rows.num_features(), cols.num_features()));
+  }
+  if ((begin > end) || (end > rows.size())) {
+    throw invalid_argument(format("Invalid USR row range {}..{} of {}",
+                                  begin, end, rows.size()));
+  }
+  const size_t num_cols = cols.size();
+  if (values.size() < (end - begin) * num_cols) {
+    throw invalid_argument(format("Need room for {} USR similarities; got {}",
+                                  (end - begin) * num_cols, values.size()));
+  }
+
+  const size_t stride = rows.stride();
+  const float num_features = max(1u, rows.num_features());
+  const int row_tiles = (end - begin + RowTile - 1) / RowTile;
+  const int col_tiles = (num_cols + ColTile - 1) / ColTile;
+#if HAVE_OPENMP
+#pragma omp parallel for collapse(2) schedule(dynamic)
+#endif
+  for (int rt = 0; rt < row_tiles; ++rt) {
+    for (int ct = 0; ct < col_tiles; ++ct) {
+      const unsigned int r_begin = begin + rt * RowTile;
+      const unsigned int r_end = min(end, r_begin + RowTile);
+      const size_t c_begin = size_t(ct) * ColTile;
+      const size_t c_end = min(num_cols, c_begin + ColTile);
+      for (unsigned int r = r_begin; r < r_end; ++r) {
+        const float *row = rows[r];
+        float *row_values = values.data() + (r - begin) * num_cols;
+        for (size_t c = c_begin; c < c_end; ++c) {
+          row_values[c] = similarity(row, cols[c], stride, num_features);
+        }
+      }
+    }
+  }
+}
+
+vector<UsrHit> usr_top_k(const UsrVectors &vectors,
+                         std::span<const float> query, unsigned int k) {
+  const auto sims(query_similarities(vectors, query));
+  vector<UsrHit> result;
+  result.reserve(sims.size());
+  for (unsigned int i = 0; i < sims.size(); ++i) {
+    result.push_back({.index = i, .similarity = sims[i]});
+  }
+  const auto num_hits = min<size_t>(k, result.size());
+  partial_sort(result.begin(), result.begin() + num_hits, result.end(),
+               [](const UsrHit &a, const UsrHit &b) {
+                 return (a.similarity > b.similarity) ||
+                        ((a.similarity == b.similarity) &&
+                         (a.index < b.index));
+               });
+  result.resize(num_hits);
+  return result;
+}
+
+vector<UsrHit> usr_within(const UsrVectors &vectors,
+                          std::span<const float> query,
+                          float min_similarity) {
+  const auto sims(query_similarities(vectors, query));
+  vector<UsrHit> result;
+  for (unsigned int i = 0; i < sims.size(); ++i) {
+    if (sims[i] >= min_similarity) {
+      result.push_back({.index = i, .similarity = sims[i]});
+    }
+  }
+  return result;
+}
+
+shape::IIndexedShapeFPMeasure::Ptr get_usr_measurer(bool compute_sim,
+                                                    const UsrVectors &vectors) {
+  return make_shared<UsrMeasurer>(vectors, compute_sim);
+}
+
+} // namespace mesaac::measures
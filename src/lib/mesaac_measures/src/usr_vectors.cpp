@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_measures/usr_vectors.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+using namespace std;
+
+namespace mesaac::measures {
+
+namespace {
+const char Magic[8] = {'M', 'E', 'S', 'A', 'U', 'S', 'R', 'V'};
+const std::uint32_t Version = 1;
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t num_features;
+  std::uint32_t stride;
+  std::uint32_t reserved;
+  std::uint64_t num_vectors;
+};
+// The header size keeps mapped rows aligned for SIMD loads.
+static_assert(sizeof(Header) == 32);
+
+size_t padded_length(unsigned int num_features) {
+  const size_t chunk = UsrVectors::Chunk;
+  return (num_features + chunk - 1) / chunk * chunk;
+}
+
+Header make_header(unsigned int num_features, std::uint64_t num_vectors) {
+  Header result{};
+  memcpy(result.magic, Magic, sizeof(Magic));
+  result.version = Version;
+  result.num_features = num_features;
+  result.stride = padded_length(num_features);
+  result.num_vectors = num_vectors;
+  return result;
+}
+
+void check_length(std::span<const float> values, unsigned int num_features) {
+  if (values.size() != num_features) {
+    throw invalid_argument(format("USR vector has {} values; expected {}",
+                                  values.size(), num_features));
+  }
+}
+} // namespace
+
+UsrVectors::UsrVectors(unsigned int num_features)
+    : m_num_features(num_features), m_stride(padded_length(num_features)),
+      m_size(0), m_mapped(nullptr) {}
+
+UsrVectors::UsrVectors(const filesystem::path &packed_path)
+    : m_num_features(0), m_stride(0), m_size(0),
+      m_file(make_unique<common::MappedFile>(packed_path)),
+      m_mapped(nullptr) {
+  Header header;
+  if (m_file->size() < sizeof(header)) {
+    throw runtime_error(
+        format("{} is not a packed USR vector file.", packed_path.string()));
+  }
+  memcpy(&header, m_file->data(), sizeof(header));
+  if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) ||
+      (header.stride != padded_length(header.num_features))) {
+    throw runtime_error(
+        format("{} is not a packed USR vector file.", packed_path.string()));
+  }
+  if (header.version != Version) {
+    throw runtime_error(format("{} has unsupported version {}.",
+                               packed_path.string(), header.version));
+  }
+
+  m_num_features = header.num_features;
+  m_stride = header.stride;
+  m_size = header.num_vectors;
+  const size_t expected_size =
+      sizeof(header) + size_t(m_size) * m_stride * sizeof(float);
+  if (m_file->size() != expected_size) {
+    throw runtime_error(format("{} is truncated or corrupt: expected {} "
+                               "bytes, found {}.",
+                               packed_path.string(), expected_size,
+                               m_file->size()));
+  }
+  m_mapped = reinterpret_cast<const float *>(m_file->data() + sizeof(header));
+}
+
+bool UsrVectors::is_packed(const filesystem::path &path) {
+  char magic[sizeof(Magic)] = {};
+  ifstream inf(path, ios::binary);
+  inf.read(magic, sizeof(magic));
+  return inf && (memcmp(magic, Magic, sizeof(Magic)) == 0);
+}
+
+void UsrVectors::push_back(std::span<const float> values) {
+  if (m_file) {
+    throw logic_error("Cannot add vectors to a mapped USR vector file.");
+  }
+  check_length(values, m_num_features);
+  const size_t offset = m_values.size();
+  m_values.resize(offset + m_stride, 0.0);
+  copy(values.begin(), values.end(), m_values.begin() + offset);
+  m_size++;
+}
+
+UsrVectorWriter::UsrVectorWriter(const filesystem::path &path,
+                                 unsigned int num_features)
+    : m_path(path), m_num_features(num_features),
+      m_row(padded_length(num_features), 0.0), m_size(0),
+      m_outf(path, ios::binary | ios::trunc) {
+  if (!m_outf) {
+    throw runtime_error(
+        format("Cannot open {} for writing.", m_path.string()));
+  }
+  // Write a provisional header; close() fills in the vector count.
+  const Header header(make_header(m_num_features, 0));
+  m_outf.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+UsrVectorWriter::~UsrVectorWriter() {
+  if (m_outf.is_open()) {
+    try {
+      close();
+    } catch (const exception &) {
+      // Destructors must not throw.
+    }
+  }
+}
+
+void UsrVectorWriter::write(std::span<const float> values) {
+  check_length(values, m_num_features);
+  copy(values.begin(), values.end(), m_row.begin());
+  m_outf.write(reinterpret_cast<const char *>(m_row.data()),
+               m_row.size() * sizeof(float));
+  if (!m_outf) {
+    throw runtime_error(format("Cannot write to {}", m_path.string()));
+  }
+  m_size++;
+}
+
+void UsrVectorWriter::close() {
+  const Header header(make_header(m_num_features, m_size));
+  m_outf.seekp(0);
+  m_outf.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  m_outf.close();
+  if (!m_outf) {
+    throw runtime_error(format("Cannot complete {}", m_path.string()));
+  }
+}
+
+} // namespace mesaac::measures
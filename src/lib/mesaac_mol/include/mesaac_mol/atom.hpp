@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "mesaac_mol/atom_props.hpp"
@@ -18,13 +19,13 @@ public:
   /// @brief AtomParams defines parameters used to construct an Atom.
   struct AtomParams {
     /// @brief The atomic number of the Atom
-    const unsigned int atomic_num;
+    unsigned int atomic_num;
     /// @brief Position in 3-space
-    const Position pos;
+    Position pos;
     /// @brief Optional properties, as read from (for example) an SD file
-    const AtomProps props;
+    AtomProps props;
     /// @brief Any optional columns, as read from (for example) an SD file
-    const std::string optional_cols;
+    std::string optional_cols;
   };
 
   /// @brief Construct a "null" Atom with atomic number 0.
@@ -32,10 +33,25 @@ public:
 
   /// @brief Construct an Atom.
   /// @param params properties of the atom - atomic number, 3-space coordinates,
-  /// etc.
-  Atom(const AtomParams &&params)
+  /// etc.  Its strings are moved into the Atom.
+  Atom(AtomParams &&params)
       : m_atomic_num(params.atomic_num), m_pos(params.pos),
-        m_props(params.props), m_optional_cols(params.optional_cols) {}
+        m_props(std::move(params.props)),
+        m_optional_cols(std::move(params.optional_cols)) {}
+
+  /**
+   * @brief Replace all of an Atom's properties.
+   * @details Unlike assignment from a new Atom, this reuses the Atom's string
+   * storage, so readers can refill the atoms of an existing Mol without
+   * allocating.
+   */
+  void assign(unsigned int atomic_num, const Position &pos,
+              const AtomProps &props, std::string_view optional_cols) {
+    m_atomic_num = atomic_num;
+    m_pos = pos;
+    m_props = props;
+    m_optional_cols.assign(optional_cols);
+  }
 
   /// @brief Change the position of an Atom.
   /// @param new_value the new position
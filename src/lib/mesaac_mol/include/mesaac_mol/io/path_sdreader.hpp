@@ -25,6 +25,7 @@ struct PathSDReader {
   PathSDReader &operator=(PathSDReader &&src);
 
   Result<Mol> read();
+  Result<bool> read(Mol &mol);
   Result<bool> skip();
   bool eof() const;
   std::string pathname() const;
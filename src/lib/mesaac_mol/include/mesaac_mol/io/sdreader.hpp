@@ -43,6 +43,17 @@ struct SDReader {
    */
   MolResult read();
 
+  /**
+   * @brief Read the next molecule/structure into an existing Mol.
+   * @details mol's storage is reused, so reading a file one structure at a
+   * time into the same Mol allocates little memory after the first few
+   * structures.
+   * @param mol on success, holds the structure; on failure, its content is
+   * unspecified
+   * @return true if a structure was read, else an error msg
+   */
+  BoolResult read(Mol &mol);
+
   /**
    * @brief Find out whether the reader has reached the end of its input.
    * @return true if the reader has nothing more to read
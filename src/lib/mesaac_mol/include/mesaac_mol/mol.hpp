@@ -18,23 +18,31 @@ namespace mesaac::mol {
 class Mol {
 public:
   struct MolParams {
-    const AtomVector atoms;
-    const BondVector bonds;
-    const SDTagMap tags;
-
-    const std::string name;
-    const std::string metadata;
-    const std::string comments;
-    const std::string counts_line;
-    const std::string properties_block;
+    AtomVector atoms;
+    BondVector bonds;
+    SDTagMap tags;
+
+    std::string name;
+    std::string metadata;
+    std::string comments;
+    std::string counts_line;
+    std::string properties_block;
   };
 
   Mol() {}
-  Mol(const MolParams &&params)
-      : m_atoms(params.atoms), m_bonds(params.bonds), m_tags(params.tags),
-        m_name(params.name), m_metadata(params.metadata),
-        m_comments(params.comments), m_counts_line(params.counts_line),
-        m_properties_block(params.properties_block) {}
+  // params' vectors and strings are moved, not copied, into the Mol.
+  Mol(MolParams &&params)
+      : m_atoms(std::move(params.atoms)), m_bonds(std::move(params.bonds)),
+        m_tags(std::move(params.tags)), m_name(std::move(params.name)),
+        m_metadata(std::move(params.metadata)),
+        m_comments(std::move(params.comments)),
+        m_counts_line(std::move(params.counts_line)),
+        m_properties_block(std::move(params.properties_block)) {}
+
+  // Exchange a Mol's contents with params.  Readers fill params and swap
+  // it in; params then holds the Mol's old storage, which the next read
+  // can refill without allocating.
+  void swap(MolParams &params);
 
   std::string name() const { return m_name; }
   std::string metadata() const { return m_metadata; }
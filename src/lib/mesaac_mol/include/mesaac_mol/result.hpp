@@ -15,12 +15,17 @@ template <typename T, typename E> struct ResultBase {
 
   bool is_ok() const { return m_value.has_value(); }
 
-  const T value() const { return m_value.value(); }
-  const E error() const { return m_error.value(); }
+  const T &value() const & { return m_value.value(); }
+  // Move the value out of a Result that is about to expire, e.g.
+  // reader.read().value() or std::move(result).value().
+  T value() && { return std::move(m_value).value(); }
+
+  const E &error() const & { return m_error.value(); }
+  E error() && { return std::move(m_error).value(); }
 
 private:
-  const std::optional<T> m_value;
-  const std::optional<E> m_error;
+  std::optional<T> m_value;
+  std::optional<E> m_error;
 
   ResultBase(std::optional<T> value, std::optional<E> error)
       : m_value(std::move(value)), m_error(std::move(error)) {}
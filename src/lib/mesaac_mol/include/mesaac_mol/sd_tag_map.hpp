@@ -1,24 +1,192 @@
 #pragma once
 
-#include <map>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
 
 namespace mesaac::mol {
 
-class SDTagMap : public std::map<std::string, std::string> {
+/**
+ * @brief The data items, or tags, of an SD file record.
+ *
+ * Tags are kept in the order in which they were added.  Their header lines
+ * and values are stored end to end in a single buffer, so reading a
+ * record's tags into an existing SDTagMap does not allocate once the
+ * buffer is large enough.
+ *
+ * Tags can be looked up either by name, e.g. "Name", or by their whole
+ * header line, e.g. ">  <Name>".  Lookups are linear; records seldom have
+ * more than a few dozen tags.
+ */
+class SDTagMap {
 public:
+  /// @brief A view of one tag.  It is valid until its SDTagMap changes.
+  struct Tag {
+    /// @brief The tag's header line, e.g. ">  <Name>  (MFCD0001)".
+    std::string_view line;
+    /// @brief The tag's value.  Values read from SD files include the
+    /// newline of each value line.
+    std::string_view value;
+
+    /// @return the tag's name -- the text between the first '<' in line and
+    /// the following '>' -- or an empty view if line has no name
+    std::string_view name() const;
+
+    bool operator==(const Tag &other) const = default;
+  };
+
+  class const_iterator {
+  public:
+    using iterator_concept = std::forward_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Tag;
+    using difference_type = std::ptrdiff_t;
+    using reference = Tag;
+
+    // Tags are made on demand, so operator-> needs somewhere to keep one.
+    struct pointer {
+      Tag tag;
+      const Tag *operator->() const { return &tag; }
+    };
+
+    const_iterator() {}
+
+    Tag operator*() const { return m_tags->tag(m_index); }
+    pointer operator->() const { return {**this}; }
+
+    const_iterator &operator++() {
+      ++m_index;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator result(*this);
+      ++m_index;
+      return result;
+    }
+
+    bool operator==(const const_iterator &other) const = default;
+
+  private:
+    friend class SDTagMap;
+
+    const_iterator(const SDTagMap *tags, std::size_t index)
+        : m_tags(tags), m_index(index) {}
+
+    const SDTagMap *m_tags = nullptr;
+    std::size_t m_index = 0;
+  };
+
   SDTagMap() {}
 
-  void add(const std::string &name, const std::string &value);
+  bool empty() const { return m_entries.empty(); }
+  std::size_t size() const { return m_entries.size(); }
+
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, m_entries.size()}; }
 
-  template <typename T> void add(const std::string &name, const T &value) {
-    std::ostringstream outs;
-    outs << value;
-    add(name, outs.str());
+  /// @brief Remove all tags, keeping the storage for reuse.
+  void clear();
+
+  void swap(SDTagMap &other);
+
+  /// @return the first tag whose name or header line is key, or end()
+  const_iterator find(std::string_view key) const;
+
+  bool contains(std::string_view key) const { return find(key) != end(); }
+
+  /**
+   * @return the value of the first tag whose name or header line is key
+   * @throw std::out_of_range if there is no such tag
+   */
+  std::string_view at(std::string_view key) const;
+
+  /**
+   * @brief Get a tag's value as a number.  Leading whitespace is skipped,
+   * and anything following the number is ignored.
+   * @return the value of the first tag whose name or header line is key,
+   * or nothing if there is no such tag or its value is not a number
+   */
+  template <typename T>
+    requires(std::integral<T> && !std::same_as<T, bool>) ||
+            std::floating_point<T>
+  std::optional<T> get(std::string_view key) const {
+    const auto i = find(key);
+    if (i == end()) {
+      return std::nullopt;
+    }
+    std::string_view text(i->value);
+    const auto start = text.find_first_not_of(" \t\r\n");
+    if (start == std::string_view::npos) {
+      return std::nullopt;
+    }
+    text.remove_prefix(start);
+    if (text.starts_with('+') && !text.substr(1).starts_with('-')) {
+      text.remove_prefix(1);
+    }
+    T result{};
+    const auto [ptr, ec] =
+        std::from_chars(text.data(), text.data() + text.size(), result);
+    if (ec != std::errc()) {
+      return std::nullopt;
+    }
+    return result;
+  }
+
+  /// @brief Add a tag whose header line is ">  <name>".  If there already
+  /// is such a tag, its value is replaced.
+  void add(std::string_view name, std::string_view value);
+
+  /// @brief Add a tag whose value is formatted as by an ostream.
+  template <typename T> void add(std::string_view name, const T &value) {
+    if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      add(name, std::string_view(value));
+    } else if constexpr (std::floating_point<T> ||
+                         (std::integral<T> && (sizeof(T) > 1))) {
+      // to_chars with precision 6 matches an ostream's default format.
+      char buffer[64];
+      std::to_chars_result formatted;
+      if constexpr (std::floating_point<T>) {
+        formatted = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                  std::chars_format::general, 6);
+      } else {
+        formatted = std::to_chars(buffer, buffer + sizeof(buffer), value);
+      }
+      add(name, std::string_view(buffer, formatted.ptr));
+    } else {
+      std::ostringstream outs;
+      outs << value;
+      add(name, outs.str());
+    }
   }
 
-  void add_unparsed(const std::string &tag_line, const std::string &value);
+  /// @brief Add a tag with the given header line.  If there already is a
+  /// tag with that header line, its value is replaced.
+  void add_unparsed(std::string_view tag_line, std::string_view value);
+
+  /// @return true if both maps have the same tags, in the same order
+  bool operator==(const SDTagMap &other) const;
+
+private:
+  struct Entry {
+    std::size_t line_start;
+    std::size_t line_size;
+    std::size_t value_start;
+    std::size_t value_size;
+  };
+
+  std::string m_text;
+  std::vector<Entry> m_entries;
+
+  Tag tag(std::size_t index) const;
+  bool views_text(std::string_view s) const;
+  void add_value(std::size_t line_start, std::string_view value);
 };
 
-} // namespace mesaac::mol
\ No newline at end of file
+} // namespace mesaac::mol
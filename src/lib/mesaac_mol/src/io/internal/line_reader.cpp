@@ -12,14 +12,21 @@ LineReader::LineReader(std::istream &inf, const std::string &description)
     : m_inf(inf), m_description(description), m_line_num(0) {}
 
 RWResult LineReader::next() {
+  std::string line;
+  if (next(line)) {
+    return RWResult::Ok(std::move(line));
+  }
+  return RWResult::Err({"Could not read"});
+}
+
+bool LineReader::next(std::string &line) {
   if (m_inf.good() && !m_inf.eof()) {
-    std::string line;
     if (std::getline(m_inf, line)) {
       m_line_num += 1;
-      return RWResult::Ok(line);
+      return true;
     }
   }
-  return RWResult::Err({"Could not read"});
+  return false;
 }
 
 std::string LineReader::file_pos() const {
@@ -15,6 +15,12 @@ struct LineReader {
 
   RWResult next();
 
+  /**
+   * @brief Read the next line into line, reusing its storage.
+   * @return whether a line was read
+   */
+  [[nodiscard]] bool next(std::string &line);
+
   /**
    * @brief Get a message annotated w. current file position.
    * @param msg_text the message to be annotated
@@ -14,6 +14,8 @@ struct MolHeaderBlock {
 
   using Result = mesaac::mol::Result<MolHeaderBlock>;
 
+  MolHeaderBlock() {}
+
   MolHeaderBlock(const std::string &name, const std::string &metadata,
                  const std::string comments, const std::string counts_line)
       : m_name(name), m_metadata(metadata), m_comments(comments),
@@ -33,6 +35,17 @@ struct MolHeaderBlock {
     return Result::Err(lines.message("Could not read MolHeaderBlock"));
   }
 
+  // Read the next header block into block, reusing its storage.
+  [[nodiscard]] static mesaac::mol::Result<bool>
+  read(LineReader &lines, MolHeaderBlock &block) {
+    if (lines.next(block.m_name) && lines.next(block.m_metadata) &&
+        lines.next(block.m_comments) && lines.next(block.m_counts_line)) {
+      return mesaac::mol::Result<bool>::Ok(true);
+    }
+    return mesaac::mol::Result<bool>::Err(
+        lines.message("Could not read MolHeaderBlock"));
+  }
+
   const std::string &name() const { return m_name; }
   const std::string &metadata() const { return m_metadata; }
   const std::string &comments() const { return m_comments; }
@@ -44,11 +57,11 @@ struct MolHeaderBlock {
   }
 
 private:
-  const std::string m_name;
-  const std::string m_metadata;
-  const std::string m_comments;
+  std::string m_name;
+  std::string m_metadata;
+  std::string m_comments;
   // The counts line isn't really part of the header block, but it is
   // included here for convenience.
-  const std::string m_counts_line;
+  std::string m_counts_line;
 };
 } // namespace mesaac::mol::internal
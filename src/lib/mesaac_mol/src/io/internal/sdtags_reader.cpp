@@ -15,31 +15,23 @@ bool is_blank(std::string &line) {
   return (line.find_first_not_of(" \t") == std::string::npos);
 }
 
-bool read_one_tag(LineReader &lines, SDTagMap &tags, std::string &line) {
-  const auto result = lines.next();
-  if (!result.is_ok()) {
-    std::cerr << result.error() << std::endl;
+bool read_one_tag(LineReader &lines, SDTagMap &tags, std::string &line,
+                  std::string &tag, std::string &value) {
+  if (!lines.next(line)) {
+    std::cerr << "Could not read" << std::endl;
     return false;
   }
-  line = result.value();
-  if (line.substr(0, 1) == ">") {
-    std::string tag = line;
-    std::ostringstream value;
-    for (;;) {
-      const auto result = lines.next();
-      if (!result.is_ok()) {
-        break;
-      }
-      line = result.value();
-      if (is_blank(line)) {
-        break;
-      } else {
-        value << line << std::endl;
-      }
+  if (line.starts_with(">")) {
+    // Swap rather than copy, so both buffers are reused.
+    tag.swap(line);
+    value.clear();
+    while (lines.next(line) && !is_blank(line)) {
+      value += line;
+      value += '\n';
     }
-    // TODO:  Extract the actual tag, distinguishing between
-    // <TAG_NAME>, DTn field numbers and registry numbers
-    tags.add_unparsed(tag, value.str());
+    // SDTagMap parses <TAG_NAME> on demand.  DTn field numbers and
+    // registry numbers are kept only in the header line.
+    tags.add_unparsed(tag, value);
     return true;
   }
   return false;
@@ -49,15 +41,24 @@ bool read_one_tag(LineReader &lines, SDTagMap &tags, std::string &line) {
 
 SDTagsReader::Result SDTagsReader::read() {
   SDTagMap tags;
-  std::string line;
-  while (read_one_tag(m_lines, tags, line)) {
+  const auto result = read(tags);
+  if (!result.is_ok()) {
+    return SDTagsReader::Result::Err(result.error());
+  }
+  return SDTagsReader::Result::Ok(std::move(tags));
+}
+
+mesaac::mol::Result<bool> SDTagsReader::read(SDTagMap &tags) {
+  tags.clear();
+  m_line.clear();
+  while (read_one_tag(m_lines, tags, m_line, m_tag, m_value)) {
     // loop
   }
-  if (line != "$$$$") {
-    return SDTagsReader::Result::Err(
+  if (m_line != "$$$$") {
+    return mesaac::mol::Result<bool>::Err(
         m_lines.message("Did not find $$$$ delimiter."));
   }
-  return SDTagsReader::Result::Ok(tags);
+  return mesaac::mol::Result<bool>::Ok(true);
 }
 
 } // namespace mesaac::mol::internal
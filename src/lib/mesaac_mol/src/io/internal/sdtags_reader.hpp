@@ -19,8 +19,15 @@ struct SDTagsReader {
 
   [[nodiscard]] Result read();
 
+  // Read into tags, replacing their contents.
+  [[nodiscard]] mesaac::mol::Result<bool> read(SDTagMap &tags);
+
 private:
   LineReader &m_lines;
+  // Reused from one tag to the next.
+  std::string m_line;
+  std::string m_tag;
+  std::string m_value;
 };
 
 } // namespace mesaac::mol::internal
@@ -16,50 +16,57 @@ namespace mesaac::mol::internal {
 
 namespace {
 using CountResult = Result<std::pair<unsigned int, unsigned int>>;
-using AtomResult = mesaac::mol::Result<Atom>;
-using AtomsResult = mesaac::mol::Result<AtomVector>;
-
-using BondResult = mesaac::mol::Result<Bond>;
-using BondsResult = mesaac::mol::Result<BondVector>;
-
+using BoolResult = mesaac::mol::Result<bool>;
 using StrResult = mesaac::mol::Result<std::string>;
 
 } // namespace
 
 V2000CTabReader::Result
 V2000CTabReader::read(const MolHeaderBlock &header_block) {
+  Mol::MolParams params;
+  const auto result = read(header_block, params);
+  if (!result.is_ok()) {
+    return V2000CTabReader::Result::Err(result.error());
+  }
+  return V2000CTabReader::Result::Ok(
+      CTab{.name = std::move(params.name),
+           .metadata = std::move(params.metadata),
+           .comments = std::move(params.comments),
+           .counts_line = std::move(params.counts_line),
+           .atoms = std::move(params.atoms),
+           .bonds = std::move(params.bonds),
+           .raw_properties_block = std::move(params.properties_block),
+           .post_ctab_block = ""});
+}
+
+BoolResult V2000CTabReader::read(const MolHeaderBlock &header_block,
+                                 Mol::MolParams &params) {
   const auto count_result = get_counts(header_block.counts_line());
   if (!count_result.is_ok()) {
-    return V2000CTabReader::Result::Err(count_result.error());
+    return BoolResult::Err(count_result.error());
   }
   const auto [num_atoms, num_bonds] = count_result.value();
   // A molecule could be just an atom, but it can't
   // be just bonds.
-  const auto atoms_result = read_atoms(num_atoms);
+  const auto atoms_result = read_atoms(num_atoms, params.atoms);
   if (!atoms_result.is_ok()) {
-    return V2000CTabReader::Result::Err(atoms_result.error());
+    return atoms_result;
   }
-  const auto bonds_result = read_bonds(num_bonds);
+  const auto bonds_result = read_bonds(num_bonds, params.bonds);
   if (!bonds_result.is_ok()) {
-    return V2000CTabReader::Result::Err(bonds_result.error());
+    return bonds_result;
   }
 
-  auto atoms = atoms_result.value();
-  auto bonds = bonds_result.value();
-  const auto props_result = read_properties_block(atoms, bonds);
-
+  auto props_result = read_properties_block(params.atoms, params.bonds);
   if (!props_result.is_ok()) {
-    return V2000CTabReader::Result::Err(props_result.error());
+    return BoolResult::Err(props_result.error());
   }
-  return V2000CTabReader::Result::Ok(
-      CTab{.name = header_block.name(),
-           .metadata = header_block.metadata(),
-           .comments = header_block.comments(),
-           .counts_line = header_block.counts_line(),
-           .atoms = atoms,
-           .bonds = bonds,
-           .raw_properties_block = props_result.value(),
-           .post_ctab_block = ""});
+  params.name.assign(header_block.name());
+  params.metadata.assign(header_block.metadata());
+  params.comments.assign(header_block.comments());
+  params.counts_line.assign(header_block.counts_line());
+  params.properties_block = std::move(props_result).value();
+  return BoolResult::Ok(true);
 }
 
 CountResult V2000CTabReader::get_counts(const std::string &line) {
@@ -80,34 +87,37 @@ CountResult V2000CTabReader::get_counts(const std::string &line) {
   return CountResult::Ok(std::make_pair(num_atoms, num_bonds));
 }
 
-AtomsResult V2000CTabReader::read_atoms(unsigned int num_atoms) {
-  AtomVector atoms;
-  atoms.reserve(num_atoms);
+BoolResult V2000CTabReader::read_atoms(unsigned int num_atoms,
+                                       AtomVector &atoms) {
+  // Refill any existing atoms, to reuse their storage.
   for (unsigned int i = 0; i != num_atoms; i++) {
-    const auto atom = read_atom(i);
-    if (atom.is_ok()) {
-      atoms.emplace_back(atom.value());
-    } else {
+    if (i == atoms.size()) {
+      atoms.emplace_back();
+    }
+    const auto atom = read_atom(i, atoms[i]);
+    if (!atom.is_ok()) {
       // When an error is encountered, give up on the current
       // molecule.
-      return AtomsResult::Err(std::format("Could not read atom {}", i));
+      return BoolResult::Err(std::format("Could not read atom {}", i));
     }
   }
-  return AtomsResult::Ok(atoms);
+  atoms.resize(num_atoms);
+  return BoolResult::Ok(true);
 }
 
-BondsResult V2000CTabReader::read_bonds(unsigned int num_bonds) {
-  BondVector bonds;
-  bonds.reserve(num_bonds);
+BoolResult V2000CTabReader::read_bonds(unsigned int num_bonds,
+                                       BondVector &bonds) {
   for (unsigned int i = 0; i != num_bonds; i++) {
-    const auto bond = read_next_bond();
-    if (bond.is_ok()) {
-      bonds.emplace_back(bond.value());
-    } else {
-      return BondsResult::Err(std::format("Could not read bond {}", i));
+    if (i == bonds.size()) {
+      bonds.emplace_back();
+    }
+    const auto bond = read_next_bond(bonds[i]);
+    if (!bond.is_ok()) {
+      return BoolResult::Err(std::format("Could not read bond {}", i));
     }
   }
-  return BondsResult::Ok(bonds);
+  bonds.resize(num_bonds);
+  return BoolResult::Ok(true);
 }
 
 StrResult V2000CTabReader::read_properties_block(AtomVector &atoms,
@@ -120,22 +130,22 @@ StrResult V2000CTabReader::read_properties_block(AtomVector &atoms,
   return StrResult::Ok("");
 }
 
-AtomResult V2000CTabReader::read_atom(const unsigned int atom_index) {
-  const auto read_result = m_lines.next();
-  if (!read_result.is_ok()) {
-    return AtomResult::Err(read_result.error());
+BoolResult V2000CTabReader::read_atom(const unsigned int atom_index,
+                                      Atom &atom) {
+  if (!m_lines.next(m_line)) {
+    return BoolResult::Err("Could not read");
   }
-  const auto line = read_result.value();
+  const std::string &line = m_line;
   // TODO: Enough w. the inline literal constants.
   if (line.size() < 34) {
-    return AtomResult::Err(
+    return BoolResult::Err(
         m_lines.message(std::format("Atom line is too short: '{}'.", line)));
   }
 
   float x, y, z;
   if (!(float_field(line, 0, 10, x) && float_field(line, 10, 10, y) &&
         float_field(line, 20, 10, z))) {
-    return AtomResult::Err(m_lines.message(
+    return BoolResult::Err(m_lines.message(
         std::format(" Could not extract atom coords from '{}'", line)));
   }
 
@@ -162,14 +172,14 @@ AtomResult V2000CTabReader::read_atom(const unsigned int atom_index) {
   try {
     atomic_num = get_atomic_num(atomic_symbol);
   } catch (std::invalid_argument &e) {
-    return AtomResult::Err(m_lines.message(e.what()));
+    return BoolResult::Err(m_lines.message(e.what()));
   }
 
   float atomic_mass;
   try {
     atomic_mass = get_atomic_mass(atomic_num);
   } catch (std::invalid_argument &e) {
-    return AtomResult::Err(m_lines.message(e.what()));
+    return BoolResult::Err(m_lines.message(e.what()));
   }
 
   const int mass_diff = optional_int_field(line, 34, 2);
@@ -206,18 +216,16 @@ AtomResult V2000CTabReader::read_atom(const unsigned int atom_index) {
       .exachg = exact_change_flag,
   };
 
-  return AtomResult::Ok(Atom({.atomic_num = atomic_num,
-                              .pos = {x, y, z},
-                              .props = props,
-                              .optional_cols = line.substr(34)}));
+  atom.assign(atomic_num, {x, y, z}, props,
+              std::string_view(line).substr(34));
+  return BoolResult::Ok(true);
 }
 
-BondResult V2000CTabReader::read_next_bond() {
-  const auto read_result = m_lines.next();
-  if (!read_result.is_ok()) {
-    return BondResult::Err(read_result.error());
+BoolResult V2000CTabReader::read_next_bond(Bond &bond) {
+  if (!m_lines.next(m_line)) {
+    return BoolResult::Err("Could not read");
   }
-  const auto line = read_result.value();
+  const std::string &line = m_line;
 
   if (line.size() < 12) {
     std::cerr << m_lines.message(std::format(
@@ -236,16 +244,12 @@ BondResult V2000CTabReader::read_next_bond() {
       // So much for enum-driven value safety:
       uint_field(line, 6, 9, uint_bond_type) &&
       uint_field(line, 9, 12, uint_stereo)) {
-    std::string optional_cols(line.substr(12));
     bond_type = static_cast<BondType>(uint_bond_type);
     stereo = static_cast<BondStereo>(uint_stereo);
-    return BondResult::Ok(Bond({.a0 = a0,
-                                .a1 = a1,
-                                .bond_type = bond_type,
-                                .stereo = stereo,
-                                .optional_cols = optional_cols}));
+    bond.assign(a0, a1, bond_type, stereo, std::string_view(line).substr(12));
+    return BoolResult::Ok(true);
   }
-  return BondResult::Err(
+  return BoolResult::Err(
       m_lines.message(std::format("Could not parse bond from '{}'.", line)));
 }
 
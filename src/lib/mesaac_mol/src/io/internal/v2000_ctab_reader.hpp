@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include "mesaac_mol/mol.hpp"
 #include "mesaac_mol/result.hpp"
 
 #include <optional>
@@ -21,23 +22,31 @@ struct V2000CTabReader {
 
   Result read(const MolHeaderBlock &header_block);
 
+  // Read into everything but the tags of params, reusing its storage.
+  [[nodiscard]] mesaac::mol::Result<bool>
+  read(const MolHeaderBlock &header_block, Mol::MolParams &params);
+
 private:
+  using BoolResult = mesaac::mol::Result<bool>;
+
   [[nodiscard]] mesaac::mol::Result<std::pair<unsigned int, unsigned int>>
   get_counts(const std::string &line);
 
-  [[nodiscard]] mesaac::mol::Result<AtomVector>
-  read_atoms(unsigned int num_atoms);
-  [[nodiscard]] mesaac::mol::Result<BondVector>
-  read_bonds(unsigned int num_bonds);
+  [[nodiscard]] BoolResult read_atoms(unsigned int num_atoms,
+                                      AtomVector &atoms);
+  [[nodiscard]] BoolResult read_bonds(unsigned int num_bonds,
+                                      BondVector &bonds);
   [[nodiscard]] mesaac::mol::Result<std::string>
   read_properties_block(AtomVector &atoms, BondVector &bonds);
-  [[nodiscard]] mesaac::mol::Result<Atom>
-  read_atom(const unsigned int atom_index);
-  [[nodiscard]] mesaac::mol::Result<Bond> read_next_bond();
+  [[nodiscard]] BoolResult read_atom(const unsigned int atom_index,
+                                     Atom &atom);
+  [[nodiscard]] BoolResult read_next_bond(Bond &bond);
 
 private:
   LineReader &m_lines;
   SDTagsReader m_tags;
+  // Reused for each atom and bond line.
+  std::string m_line;
 };
 
 } // namespace mesaac::mol::internal
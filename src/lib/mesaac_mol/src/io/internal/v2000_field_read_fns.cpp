@@ -1,44 +1,89 @@
 
 #include "v2000_field_read_fns.hpp"
 
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
 namespace mesaac::mol::internal {
 
-bool float_field(const std::string &line, unsigned int i_start,
-                 unsigned int i_len, float &value) {
-  try {
-    value = std::stof(line.substr(i_start, i_len));
-    return true;
-  } catch (std::exception &e) {
+namespace {
+// Parse a number from the start of line.substr(i_start, i_len), as
+// std::stoi and std::stof do:  leading whitespace and a '+' sign are
+// skipped, and anything after the number is ignored.  Unlike them, this
+// neither allocates nor throws, which matters because most optional
+// fields are missing from most atom lines.
+template <typename T>
+bool parse_field(const std::string &line, unsigned int i_start,
+                 unsigned int i_len, T &value) {
+  if (i_start > line.size()) {
+    return false;
+  }
+  const std::string_view field = std::string_view(line).substr(i_start, i_len);
+  const char *first = field.data();
+  const char *const last = field.data() + field.size();
+  while ((first != last) && std::isspace(static_cast<unsigned char>(*first))) {
+    ++first;
+  }
+  if ((first != last) && (*first == '+')) {
+    ++first;
+    if ((first != last) && (*first == '-')) {
+      return false;
+    }
+  }
+  T result;
+  if constexpr (std::is_floating_point_v<T>) {
+    // std::stof also accepts hexadecimal, e.g. "-0x1.8p1".
+    const bool negative = (first != last) && (*first == '-');
+    const char *digits = negative ? first + 1 : first;
+    if ((last - digits > 2) && (digits[0] == '0') &&
+        ((digits[1] == 'x') || (digits[1] == 'X')) &&
+        (std::isxdigit(static_cast<unsigned char>(digits[2])) ||
+         (digits[2] == '.')) &&
+        (std::from_chars(digits + 2, last, result, std::chars_format::hex)
+             .ec == std::errc())) {
+      result = negative ? -result : result;
+    } else if (std::from_chars(first, last, result).ec != std::errc()) {
+      return false;
+    }
+    // Like std::stof, treat underflow to a subnormal value as out of range.
+    if (std::fpclassify(result) == FP_SUBNORMAL) {
+      return false;
+    }
+  } else if (std::from_chars(first, last, result).ec != std::errc()) {
     return false;
   }
+  value = result;
+  return true;
+}
+} // namespace
+
+bool float_field(const std::string &line, unsigned int i_start,
+                 unsigned int i_len, float &value) {
+  return parse_field(line, i_start, i_len, value);
 }
 
 bool uint_field(const std::string &line, unsigned int i_start,
                 unsigned int i_len, unsigned int &value) {
-  try {
-    // stoul does not reject negative numeric literals.
-    // It wraps them.  Hence this.
-    int s_value = std::stoi(line.substr(i_start, i_len));
-    if (s_value < 0) {
-      value = 0;
-      return false;
-    }
-
-    value = s_value;
-    return true;
-  } catch (std::exception &e) {
+  // Reject negative numeric literals, rather than wrapping them.
+  int s_value = 0;
+  if (!parse_field(line, i_start, i_len, s_value)) {
+    return false;
+  }
+  if (s_value < 0) {
+    value = 0;
     return false;
   }
+  value = s_value;
+  return true;
 }
 
 bool int_field(const std::string &line, unsigned int i_start,
                unsigned int i_len, int &value) {
-  try {
-    value = std::stoi(line.substr(i_start, i_len));
-    return true;
-  } catch (std::exception &e) {
-    return false;
-  }
+  return parse_field(line, i_start, i_len, value);
 }
 
 int optional_int_field(const std::string &line, unsigned int i_start,
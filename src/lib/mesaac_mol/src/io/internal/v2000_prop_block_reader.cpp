@@ -93,13 +93,9 @@ bool reset_charges_and_rads(AtomVector &atoms, bool already_reset) {
 V2000PropBlockReader::Result V2000PropBlockReader::read() {
   const auto prefix = "M  ";
   bool has_reset_charges = false;
-  for (;;) {
-    const auto read_result = m_lines.next();
-    if (!read_result.is_ok()) {
-      // Presume end of file.
-      break;
-    }
-    const auto line = read_result.value();
+  std::string line;
+  // If no line can be read, presume end of file.
+  while (m_lines.next(line)) {
     if (!line.starts_with(prefix)) {
       // Unsupported: "not used in current products" lines A, and G.
       // Unsupported: V (atom value) lines
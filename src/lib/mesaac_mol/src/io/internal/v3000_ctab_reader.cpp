@@ -13,12 +13,6 @@ namespace mesaac::mol::internal {
 
 namespace {
 using BoolResult = mesaac::mol::Result<bool>;
-using AtomResult = mesaac::mol::Result<Atom>;
-using AtomsResult = mesaac::mol::Result<AtomVector>;
-
-using BondResult = mesaac::mol::Result<Bond>;
-using BondsResult = mesaac::mol::Result<BondVector>;
-
 using StrResult = mesaac::mol::Result<std::string>;
 
 static constexpr std::string v3000_prefix = "M  V30 ";
@@ -55,14 +49,39 @@ bool unsupported_atom_type(const std::string &atom_type) {
 
 V3000CTabReader::Result
 V3000CTabReader::read(const MolHeaderBlock &header_block) {
+  Mol::MolParams params;
+  std::string post_ctab_block;
+  const auto result = read(header_block, params, post_ctab_block);
+  if (!result.is_ok()) {
+    return V3000CTabReader::Result::Err(result.error());
+  }
+  return V3000CTabReader::Result::Ok(
+      CTab{.name = std::move(params.name),
+           .metadata = std::move(params.metadata),
+           .comments = std::move(params.comments),
+           .counts_line = std::move(params.counts_line),
+           .atoms = std::move(params.atoms),
+           .bonds = std::move(params.bonds),
+           .raw_properties_block = std::move(params.properties_block),
+           .post_ctab_block = std::move(post_ctab_block)});
+}
+
+BoolResult V3000CTabReader::read(const MolHeaderBlock &header_block,
+                                 Mol::MolParams &params) {
+  return read(header_block, params, m_post_ctab_block);
+}
+
+BoolResult V3000CTabReader::read(const MolHeaderBlock &header_block,
+                                 Mol::MolParams &params,
+                                 std::string &post_ctab_block) {
   const auto begin_ctab = check_v30_line_eq("BEGIN CTAB");
   if (!begin_ctab.is_ok()) {
-    return V3000CTabReader::Result::Err(begin_ctab.error());
+    return BoolResult::Err(begin_ctab.error());
   }
 
   const auto next_line = next_v30_line();
   if (!next_line.is_ok()) {
-    return V3000CTabReader::Result::Err(next_line.error());
+    return BoolResult::Err(next_line.error());
   }
 
   size_t num_atoms;
@@ -70,38 +89,36 @@ V3000CTabReader::read(const MolHeaderBlock &header_block) {
   const auto counts_result =
       get_counts(next_line.value(), num_atoms, num_bonds);
   if (!counts_result.is_ok()) {
-    return V3000CTabReader::Result::Err(counts_result.error());
+    return BoolResult::Err(counts_result.error());
   }
 
-  const auto atoms_result = read_atoms(num_atoms);
+  const auto atoms_result = read_atoms(num_atoms, params.atoms);
   if (!atoms_result.is_ok()) {
-    return V3000CTabReader::Result::Err(atoms_result.error());
+    return atoms_result;
   }
-  const auto bonds_result = read_bonds(num_bonds);
+  const auto bonds_result = read_bonds(num_bonds, params.bonds);
   if (!bonds_result.is_ok()) {
-    return V3000CTabReader::Result::Err(bonds_result.error());
+    return bonds_result;
   }
-  const auto props_result = read_other_blocks("M  V30 END CTAB");
+  auto props_result = read_other_blocks("M  V30 END CTAB");
   if (!props_result.is_ok()) {
-    return V3000CTabReader::Result::Err(props_result.error());
+    return BoolResult::Err(props_result.error());
   }
-  const auto rgroups_result = read_other_blocks("M  END");
+  auto rgroups_result = read_other_blocks("M  END");
   if (!rgroups_result.is_ok()) {
-    return V3000CTabReader::Result::Err(rgroups_result.error());
+    return BoolResult::Err(rgroups_result.error());
   }
 
   // XXX FIX THIS - neither blocks within the main CTAB nor
   // subsequent block such as Rgroups are preserved for later
   // writing.
-  return V3000CTabReader::Result::Ok(
-      CTab{.name = header_block.name(),
-           .metadata = header_block.metadata(),
-           .comments = header_block.comments(),
-           .counts_line = header_block.counts_line(),
-           .atoms = atoms_result.value(),
-           .bonds = bonds_result.value(),
-           .raw_properties_block = props_result.value(),
-           .post_ctab_block = rgroups_result.value()});
+  params.name.assign(header_block.name());
+  params.metadata.assign(header_block.metadata());
+  params.comments.assign(header_block.comments());
+  params.counts_line.assign(header_block.counts_line());
+  params.properties_block = std::move(props_result).value();
+  post_ctab_block = std::move(rgroups_result).value();
+  return BoolResult::Ok(true);
 }
 
 StrResult V3000CTabReader::get_counts(const std::string &counts_line,
@@ -133,124 +150,125 @@ StrResult V3000CTabReader::get_counts(const std::string &counts_line,
   return StrResult::Ok("");
 }
 
-AtomsResult V3000CTabReader::read_atoms(unsigned int num_atoms) {
+BoolResult V3000CTabReader::read_atoms(unsigned int num_atoms,
+                                       AtomVector &atoms) {
 
   const auto begin_atom = check_v30_line_eq("BEGIN ATOM");
   if (!begin_atom.is_ok()) {
-    return AtomsResult::Err(begin_atom.error());
+    return BoolResult::Err(begin_atom.error());
   }
 
-  AtomVector atoms;
-  atoms.reserve(num_atoms);
+  // Refill any existing atoms, to reuse their storage.
   for (unsigned int i = 0; i != num_atoms; i++) {
-    const auto atom_result = read_next_atom();
-    if (atom_result.is_ok()) {
-      atoms.emplace_back(atom_result.value());
-    } else {
+    if (i == atoms.size()) {
+      atoms.emplace_back();
+    }
+    const auto atom_result = read_next_atom(atoms[i]);
+    if (!atom_result.is_ok()) {
       // When an error is encountered, give up on the current
       // molecule.
-      return AtomsResult::Err(atom_result.error());
+      return atom_result;
     }
   }
+  atoms.resize(num_atoms);
   const auto end_atom = check_v30_line_eq("END ATOM");
   if (!end_atom.is_ok()) {
-    return AtomsResult::Err(end_atom.error());
+    return BoolResult::Err(end_atom.error());
   }
-  return AtomsResult::Ok(atoms);
+  return BoolResult::Ok(true);
 }
 
-AtomResult V3000CTabReader::read_next_atom() {
+BoolResult V3000CTabReader::read_next_atom(Atom &atom) {
   const auto v30_line = next_v30_line();
   if (!v30_line.is_ok()) {
-    return AtomResult::Err(v30_line.error());
+    return BoolResult::Err(v30_line.error());
   }
   // There are a lot of V3000 atom attributes that are not relevant
   // for mesaac_mol, which is focused mainly on geometry /volume of molecules.
   // TODO record these attributes so they can be preserved when writing
   // to SD files.
   unsigned int atom_index = 0;
-  std::string line = v30_line.value();
+  const std::string &line = v30_line.value();
   m_atom_bond_ins.clear();
   m_atom_bond_ins.str(line);
 
   if (!(m_atom_bond_ins >> atom_index)) {
-    return AtomResult::Err(m_lines.message(
+    return BoolResult::Err(m_lines.message(
         std::format("Could not read atom index from '{}'.", line)));
   }
 
   std::string atom_type;
   if (!read_atom_type(m_atom_bond_ins, atom_type)) {
-    return AtomResult::Err(
+    return BoolResult::Err(
         m_lines.message(std::format("Could not read atom type from {}", line)));
   }
   if (unsupported_atom_type(atom_type)) {
-    return AtomResult::Err(m_lines.message(
+    return BoolResult::Err(m_lines.message(
         std::format("Query atoms are not supported: '{}'", atom_type)));
   }
 
   float x, y, z;
   if (!(m_atom_bond_ins >> x >> y >> z)) {
-    return AtomResult::Err(m_lines.message(
+    return BoolResult::Err(m_lines.message(
         std::format("Could not read atom coordinates from '{}'.", line)));
   }
 
   int aamap;
   if (!(m_atom_bond_ins >> aamap) || (aamap < 0)) {
-    return AtomResult::Err(m_lines.message(
+    return BoolResult::Err(m_lines.message(
         std::format("Invalid atom-atom mapping {} from '{}.", aamap, line)));
   }
 
   V3000AtomPropReader prop_reader;
   const auto prop_result = prop_reader.read(m_atom_bond_ins);
   if (!prop_result.is_ok()) {
-    return AtomResult::Err(m_lines.message(prop_result.error()));
+    return BoolResult::Err(m_lines.message(prop_result.error()));
   }
   auto props = prop_result.value();
   props.index = atom_index;
   props.aamap = aamap;
 
-  return AtomResult::Ok(Atom({.atomic_num = get_atomic_num(atom_type),
-                              .pos = {x, y, z},
-                              .props = std::move(props),
-                              .optional_cols = m_atom_bond_ins.str()}));
+  atom.assign(get_atomic_num(atom_type), {x, y, z}, props,
+              m_atom_bond_ins.view());
+  return BoolResult::Ok(true);
 }
 
-BondsResult V3000CTabReader::read_bonds(unsigned int num_bonds) {
-  BondVector bonds;
-  bonds.reserve(num_bonds);
+BoolResult V3000CTabReader::read_bonds(unsigned int num_bonds,
+                                       BondVector &bonds) {
   if (num_bonds == 0) {
-    return BondsResult::Ok(bonds);
+    bonds.clear();
+    return BoolResult::Ok(true);
   }
 
-  std::string line;
-
   const auto begin_bonds = check_v30_line_eq("BEGIN BOND");
   if (!begin_bonds.is_ok()) {
-    return BondsResult::Err(begin_bonds.error());
+    return BoolResult::Err(begin_bonds.error());
   }
 
   for (unsigned int i = 0; i != num_bonds; ++i) {
-    const auto bond = read_next_bond();
-    if (bond.is_ok()) {
-      bonds.emplace_back(bond.value());
-    } else {
-      return BondsResult::Err(bond.error());
+    if (i == bonds.size()) {
+      bonds.emplace_back();
+    }
+    const auto bond = read_next_bond(bonds[i]);
+    if (!bond.is_ok()) {
+      return bond;
     }
   }
+  bonds.resize(num_bonds);
   const auto end_bond = check_v30_line_eq("END BOND");
   if (!end_bond.is_ok()) {
-    return BondsResult::Err(end_bond.error());
+    return BoolResult::Err(end_bond.error());
   }
-  return BondsResult::Ok(bonds);
+  return BoolResult::Ok(true);
 }
 
-BondResult V3000CTabReader::read_next_bond() {
+BoolResult V3000CTabReader::read_next_bond(Bond &bond) {
   const auto v30_line = next_v30_line();
   if (!v30_line.is_ok()) {
-    return BondResult::Err(v30_line.error());
+    return BoolResult::Err(v30_line.error());
   }
 
-  const auto line = v30_line.value();
+  const std::string &line = v30_line.value();
   m_atom_bond_ins.clear();
   m_atom_bond_ins.str(line);
   // XXX FIX THIS As for atoms, so to does a bond have extra properties
@@ -264,13 +282,11 @@ BondResult V3000CTabReader::read_next_bond() {
     std::string remainder;
     std::getline(m_atom_bond_ins, remainder, '\0');
     constexpr auto stereo = BondStereo::bs_not_stereo;
-    return BondResult::Ok(Bond({.a0 = a0,
-                                .a1 = a1,
-                                .bond_type = static_cast<BondType>(i_bond_type),
-                                .stereo = stereo,
-                                .optional_cols = remainder}));
+    bond.assign(a0, a1, static_cast<BondType>(i_bond_type), stereo,
+                remainder);
+    return BoolResult::Ok(true);
   }
-  return BondResult::Err(
+  return BoolResult::Err(
       m_lines.message(std::format("Failed to read bond from '{}'.", line)));
 }
 
@@ -6,6 +6,8 @@
 #include <optional>
 #include <sstream>
 
+#include "mesaac_mol/mol.hpp"
+
 #include "ctab.hpp"
 #include "line_reader.hpp"
 #include "mol_header_block.hpp"
@@ -20,18 +22,28 @@ struct V3000CTabReader {
   V3000CTabReader(LineReader &lines) : m_lines(lines), m_tags(lines) {}
   [[nodiscard]] Result read(const MolHeaderBlock &header_block);
 
+  // Read into everything but the tags of params, reusing its storage.
+  // Blocks after the CTAB, such as Rgroups, are not kept.
+  [[nodiscard]] mesaac::mol::Result<bool>
+  read(const MolHeaderBlock &header_block, Mol::MolParams &params);
+
 private:
+  using BoolResult = mesaac::mol::Result<bool>;
   using StrResult = mesaac::mol::Result<std::string>;
 
+  [[nodiscard]] BoolResult read(const MolHeaderBlock &header_block,
+                                Mol::MolParams &params,
+                                std::string &post_ctab_block);
+
   [[nodiscard]] StrResult get_counts(const std::string &counts_line,
                                      size_t &num_atoms, size_t &num_bonds);
-  [[nodiscard]] mesaac::mol::Result<AtomVector>
-  read_atoms(unsigned int num_atoms);
-  [[nodiscard]] mesaac::mol::Result<BondVector>
-  read_bonds(unsigned int num_bonds);
+  [[nodiscard]] BoolResult read_atoms(unsigned int num_atoms,
+                                      AtomVector &atoms);
+  [[nodiscard]] BoolResult read_bonds(unsigned int num_bonds,
+                                      BondVector &bonds);
 
-  [[nodiscard]] mesaac::mol::Result<Atom> read_next_atom();
-  [[nodiscard]] mesaac::mol::Result<Bond> read_next_bond();
+  [[nodiscard]] BoolResult read_next_atom(Atom &atom);
+  [[nodiscard]] BoolResult read_next_bond(Bond &bond);
 
   [[nodiscard]] StrResult read_other_blocks(const std::string &terminator);
 
@@ -45,6 +57,7 @@ private:
   LineReader &m_lines;
   SDTagsReader m_tags;
   std::istringstream m_atom_bond_ins;
+  std::string m_post_ctab_block;
 };
 
 } // namespace mesaac::mol::internal
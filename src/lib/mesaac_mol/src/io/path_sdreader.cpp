@@ -58,6 +58,9 @@ PathSDReader &PathSDReader::operator=(PathSDReader &&src) {
 }
 
 Result<Mol> PathSDReader::read() { return m_impl->reader().read(); }
+Result<bool> PathSDReader::read(Mol &mol) {
+  return m_impl->reader().read(mol);
+}
 Result<bool> PathSDReader::skip() { return m_impl->reader().skip(); }
 
 bool PathSDReader::eof() const { return m_impl->reader().eof(); }
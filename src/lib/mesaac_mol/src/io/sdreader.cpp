@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "mesaac_common/stats.hpp"
 #include "mesaac_mol/element_info.hpp"
 
 #include "internal/line_reader.hpp"
@@ -23,32 +24,20 @@ namespace mesaac::mol {
 
 struct SDReaderImpl {
   SDReaderImpl(std::istream &inf, const std::string &description)
-      : m_lines(inf, description), m_v2000(m_lines), m_v3000(m_lines) {}
+      : m_lines(inf, description), m_v2000(m_lines), m_v3000(m_lines),
+        m_tags(m_lines) {}
 
-  using CTabResult = mesaac::mol::Result<internal::CTab>;
-
-  MolResult read() {
+  BoolResult read(Mol &mol) {
     const auto ctab_result = read_molfile();
     if (!ctab_result.is_ok()) {
-      return MolResult::Err(ctab_result.error());
+      return ctab_result;
     }
-
-    const auto ctab = ctab_result.value();
     const auto tags_result = read_tags();
-    if (tags_result.is_ok()) {
-      const auto tags = tags_result.value();
-      return MolResult::Ok(Mol({
-          .atoms = ctab.atoms,
-          .bonds = ctab.bonds,
-          .tags = tags,
-          .name = ctab.name,
-          .metadata = ctab.metadata,
-          .comments = ctab.comments,
-          .counts_line = ctab.counts_line,
-          .properties_block = ctab.raw_properties_block,
-      }));
+    if (!tags_result.is_ok()) {
+      return tags_result;
     }
-    return MolResult::Err(tags_result.error());
+    mol.swap(m_params);
+    return BoolResult::Ok(true);
   }
 
   // Skip the next mol.
@@ -62,22 +51,21 @@ struct SDReaderImpl {
   bool eof() const { return m_lines.eof(); }
 
 private:
-  CTabResult read_molfile() {
-    const auto header_result = internal::MolHeaderBlock::read(m_lines);
+  // Read the header block and CTab into m_params.
+  BoolResult read_molfile() {
+    const auto header_result =
+        internal::MolHeaderBlock::read(m_lines, m_header);
     if (!header_result.is_ok()) {
       if (m_lines.eof()) {
-        return CTabResult::Err("End of file");
+        return BoolResult::Err("End of file");
       }
-      return CTabResult::Err(header_result.error());
+      return header_result;
     }
-    const auto header = header_result.value();
-    return header.is_v3000() ? m_v3000.read(header) : m_v2000.read(header);
+    return m_header.is_v3000() ? m_v3000.read(m_header, m_params)
+                               : m_v2000.read(m_header, m_params);
   }
 
-  internal::SDTagsReader::Result read_tags() {
-    internal::SDTagsReader tags_reader(m_lines);
-    return tags_reader.read();
-  }
+  BoolResult read_tags() { return m_tags.read(m_params.tags); }
 
   // Skip to the end of the current mol.
   BoolResult skip_to_end() {
@@ -97,6 +85,12 @@ private:
   internal::LineReader m_lines;
   internal::V2000CTabReader m_v2000;
   internal::V3000CTabReader m_v3000;
+  internal::SDTagsReader m_tags;
+
+  // Each structure is read into these, then swapped into the caller's Mol.
+  // Afterwards they hold the Mol's old storage, ready to be refilled.
+  internal::MolHeaderBlock m_header;
+  Mol::MolParams m_params;
 };
 
 // SDReader:
@@ -107,7 +101,25 @@ SDReader::~SDReader() {}
 
 BoolResult SDReader::skip() { return m_impl->skip(); }
 
-MolResult SDReader::read() { return m_impl->read(); }
+MolResult SDReader::read() {
+  Mol mol;
+  const auto result = read(mol);
+  if (!result.is_ok()) {
+    return MolResult::Err(result.error());
+  }
+  return MolResult::Ok(std::move(mol));
+}
+
+BoolResult SDReader::read(Mol &mol) {
+  static common::stats::Stage &read_stage(
+      common::stats::stage("SDReader::read"));
+  common::stats::ScopedTimer timer(read_stage);
+  BoolResult result = m_impl->read(mol);
+  if (!result.is_ok()) {
+    timer.set_items(0);
+  }
+  return result;
+}
 
 bool SDReader::eof() const { return m_impl->eof(); }
 
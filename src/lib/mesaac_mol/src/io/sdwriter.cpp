@@ -9,9 +9,11 @@
 #include <format>
 #include <iomanip>
 #include <sstream>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
+#include "mesaac_common/stats.hpp"
 #include "mesaac_mol/element_info.hpp"
 
 using namespace std;
@@ -62,6 +64,10 @@ inline string molfile_timestamp() {
 } // namespace
 
 bool SDWriter::write(const Mol &mol) {
+  static common::stats::Stage &write_stage(
+      common::stats::stage("SDWriter::write"));
+  const common::stats::ScopedTimer timer(write_stage);
+
   bool result = true;
   // According to the spec, the 'metadata' line needs to list the
   // program which wrote the file, and the date/time at which it was
@@ -93,15 +99,15 @@ bool SDWriter::write(const Mol &mol) {
 
   const SDTagMap &tags(mol.tags());
   for (const auto &tag : tags) {
-    string value(tag.second);
+    string_view value(tag.value);
     // Strip all trailing blank lines in value.
     // Also strip trailing whitespace from the last line of value --
     // hope that's legitimate.
     while ((value.size() > 0) &&
            (value.find_last_of("\n\t ") == value.size() - 1)) {
-      value.erase(value.size() - 1);
+      value.remove_suffix(1);
     }
-    m_outf << tag.first << endl << value << endl << endl;
+    m_outf << tag.line << endl << value << endl << endl;
   }
   m_outf << "$$$$" << endl;
 
@@ -12,6 +12,17 @@ using namespace std;
 
 namespace mesaac::mol {
 
+void Mol::swap(MolParams &params) {
+  m_atoms.swap(params.atoms);
+  m_bonds.swap(params.bonds);
+  m_tags.swap(params.tags);
+  m_name.swap(params.name);
+  m_metadata.swap(params.metadata);
+  m_comments.swap(params.comments);
+  m_counts_line.swap(params.counts_line);
+  m_properties_block.swap(params.properties_block);
+}
+
 unsigned int Mol::num_heavy_atoms() const {
   return std::ranges::count_if(
       m_atoms, [](const Atom &atom) { return !atom.is_hydrogen(); });
@@ -1,21 +1,123 @@
 #include "mesaac_mol/sd_tag_map.hpp"
 
+#include <functional>
 #include <iostream>
+#include <stdexcept>
 
 namespace mesaac::mol {
 using namespace std;
 
-void SDTagMap::add_unparsed(const string &tag_line, const string &value) {
-  if (find(tag_line) != end()) {
-    cerr << "Warning: tag already exists: '" << tag_line
-         << "'.  Overwriting with new value." << endl;
+string_view SDTagMap::Tag::name() const {
+  const auto open = line.find('<');
+  if (open == string_view::npos) {
+    return {};
   }
-  insert_or_assign(tag_line, value);
+  const auto close = line.find('>', open + 1);
+  if (close == string_view::npos) {
+    return {};
+  }
+  return line.substr(open + 1, close - open - 1);
+}
+
+void SDTagMap::clear() {
+  m_text.clear();
+  m_entries.clear();
+}
+
+void SDTagMap::swap(SDTagMap &other) {
+  m_text.swap(other.m_text);
+  m_entries.swap(other.m_entries);
+}
+
+SDTagMap::const_iterator SDTagMap::find(string_view key) const {
+  const bool is_line = key.starts_with('>');
+  for (auto i = begin(); i != end(); ++i) {
+    const Tag curr(*i);
+    if (key == (is_line ? curr.line : curr.name())) {
+      return i;
+    }
+  }
+  return end();
+}
+
+string_view SDTagMap::at(string_view key) const {
+  const auto i = find(key);
+  if (i == end()) {
+    throw out_of_range("No such tag: '" + string(key) + "'");
+  }
+  return i->value;
+}
+
+void SDTagMap::add(string_view name, string_view value) {
+  if (views_text(name) || views_text(value)) {
+    const string name_copy(name), value_copy(value);
+    add(string_view(name_copy), string_view(value_copy));
+    return;
+  }
+  // Build the header line in place, rather than in a temporary string.
+  const size_t line_start = m_text.size();
+  m_text += ">  <";
+  m_text += name;
+  m_text += '>';
+  add_value(line_start, value);
+}
+
+void SDTagMap::add_unparsed(string_view tag_line, string_view value) {
+  if (views_text(tag_line) || views_text(value)) {
+    const string line_copy(tag_line), value_copy(value);
+    add_unparsed(line_copy, value_copy);
+    return;
+  }
+  const size_t line_start = m_text.size();
+  m_text += tag_line;
+  add_value(line_start, value);
 }
 
-void SDTagMap::add(const string &name, const string &value) {
-  string tag = ">  <" + name + ">";
-  add_unparsed(tag, value);
+bool SDTagMap::operator==(const SDTagMap &other) const {
+  if (size() != other.size()) {
+    return false;
+  }
+  for (size_t i = 0; i != size(); ++i) {
+    if (tag(i) != other.tag(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SDTagMap::Tag SDTagMap::tag(size_t index) const {
+  const Entry &entry(m_entries[index]);
+  const string_view text(m_text);
+  return {text.substr(entry.line_start, entry.line_size),
+          text.substr(entry.value_start, entry.value_size)};
+}
+
+// Appending to m_text may reallocate it, invalidating any view of it.
+bool SDTagMap::views_text(string_view s) const {
+  const less<const char *> before;
+  return !before(s.data(), m_text.data()) &&
+         before(s.data(), m_text.data() + m_text.size());
+}
+
+// Finish adding a tag whose header line has just been appended to m_text.
+void SDTagMap::add_value(size_t line_start, string_view value) {
+  const size_t line_size = m_text.size() - line_start;
+  const string_view line(string_view(m_text).substr(line_start));
+  for (auto &entry : m_entries) {
+    if (string_view(m_text).substr(entry.line_start, entry.line_size) ==
+        line) {
+      cerr << "Warning: tag already exists: '" << line
+           << "'.  Overwriting with new value." << endl;
+      // The old value is left in m_text until the next clear().
+      m_text.resize(line_start);
+      entry.value_start = m_text.size();
+      entry.value_size = value.size();
+      m_text += value;
+      return;
+    }
+  }
+  m_entries.push_back({line_start, line_size, m_text.size(), value.size()});
+  m_text += value;
 }
 
 } // namespace mesaac::mol
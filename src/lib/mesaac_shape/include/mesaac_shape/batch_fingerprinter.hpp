@@ -0,0 +1,105 @@
+// Computes shape fingerprints for many conformers at once, into a
+// caller-provided buffer.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "mesaac_shape/vol_box.hpp"
+
+namespace mesaac::shape {
+
+/**
+ * @brief A read-only view of one conformer's atoms.  The conformer should
+ * already be aligned to its principal axes, as for Fingerprinter.
+ */
+struct ConformerView {
+  /**
+   * @brief x, y, z coordinates of each atom, 3 values per atom
+   */
+  std::span<const float> coords;
+
+  /**
+   * @brief radius of each atom
+   */
+  std::span<const float> radii;
+};
+
+/**
+ * @brief Computes the orientation fingerprints of a batch of conformers,
+ * without going through SD files or per-fingerprint allocations.
+ *
+ * Results are packed into a contiguous buffer of 64-bit words.  Each
+ * conformer occupies words_per_conformer() words, holding NumOrientations
+ * fingerprints of words_per_fingerprint() words each, in the same order as
+ * Fingerprinter::compute.  Bit i of a fingerprint is bit (i % 64) of its
+ * word (i / 64); unused high bits of the last word are zero.
+ */
+class BatchFingerprinter {
+public:
+  using Word = std::uint64_t;
+
+  /**
+   * @brief Number of fingerprints computed for each conformer
+   */
+  static constexpr unsigned int NumOrientations = 4;
+
+  /**
+   * @brief Create a new instance.
+   * @param volbox the (Hammersley ellipsoid) points to test for inclusion
+   * @param num_threads number of threads to use; 0 means the OpenMP default
+   */
+  BatchFingerprinter(const VolBox &volbox, unsigned int num_threads = 0);
+
+  BatchFingerprinter(const BatchFingerprinter &src) = delete;
+  BatchFingerprinter &operator=(const BatchFingerprinter &src) = delete;
+
+  /**
+   * @return the number of bits in each fingerprint
+   */
+  size_t num_bits() const { return m_num_bits; }
+
+  /**
+   * @return the number of words in each fingerprint
+   */
+  size_t words_per_fingerprint() const { return m_words_per_fp; }
+
+  /**
+   * @return the number of words holding each conformer's fingerprints
+   */
+  size_t words_per_conformer() const {
+    return NumOrientations * m_words_per_fp;
+  }
+
+  /**
+   * @brief Get the buffer size needed for a batch of conformers.
+   * @param num_conformers number of conformers in the batch
+   * @return the number of words needed to hold the batch's fingerprints
+   */
+  size_t buffer_words(size_t num_conformers) const {
+    return num_conformers * words_per_conformer();
+  }
+
+  /**
+   * @brief Compute the fingerprints of a batch of conformers.
+   * @param conformers the conformers to fingerprint
+   * @param result on return, the fingerprints of conformers
+   * @throw std::invalid_argument if a conformer's coordinates and radii
+   * differ in length, or if result holds fewer than
+   * buffer_words(conformers.size()) words
+   */
+  void compute(std::span<const ConformerView> conformers,
+               std::span<Word> result) const;
+
+private:
+  const VolBox &m_volbox;
+  const unsigned int m_num_threads;
+  const size_t m_num_bits;
+  const size_t m_words_per_fp;
+};
+
+} // namespace mesaac::shape
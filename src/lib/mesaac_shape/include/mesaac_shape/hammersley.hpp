@@ -4,10 +4,26 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "mesaac_shape/shared_types.hpp"
 
 namespace mesaac::shape {
 
+/**
+ * @brief Compute the radical inverse of an index, i.e., the van der Corput
+ * sequence value obtained by mirroring the index's digits, in the given
+ * base, about the radix point.
+ *
+ * Digits are accumulated with integer arithmetic, and the result is formed
+ * with a single division, so it is exact to double precision.
+ *
+ * @param base a prime base, 2 or greater
+ * @param index the sequence index
+ * @return the radical inverse of index, in 0...1
+ */
+double radical_inverse(unsigned int base, std::uint32_t index);
+
 /**
  * @brief Generates Hammersley points.
  */
@@ -82,32 +98,58 @@ struct Hammersley {
     const float zmax;
   };
 
-  /**
-   * @brief Create a (3D) Hammersley spheroid point generator.
-   * @param num_points the number of points to generate
-   */
-  Hammersley(const size_t num_points)
-      : m_num_points(num_points), m_point_index(0) {}
-
   /**
    * @brief Get a Hammersley spheroid point set.
+   *
+   * Enough candidate points are generated to yield about
+   * params.num_points within the ellipsoid.
+   *
    * @param params specifies the point set to be generated
    * @param result on return, the generated points
    */
   static void get_ellipsoid(const EllipsoidParams &params, PointList &result);
 
+  /**
+   * @brief Get the points of a Hammersley cube point set which lie within
+   * an ellipsoid.
+   *
+   * The cube spans -params.scale...params.scale on each axis.  Candidates
+   * are generated and filtered in parallel batches; the result preserves
+   * sequence order.
+   *
+   * @param params specifies the ellipsoid, and the maximum number of
+   * points to return
+   * @param num_candidates the number of points in the cube point set
+   * @param result on return, the points within the ellipsoid
+   */
+  static void get_ellipsoid_from_cube(const EllipsoidParams &params,
+                                      size_t num_candidates,
+                                      PointList &result);
+
   /**
    * @brief Get a Hammersley cuboid point set.
    * @param params specifies the point set to be generated
    * @param result on return, the generated points
    */
   static void get_cuboid(const CuboidParams &params, PointList &result);
-
-private:
-  const size_t m_num_points;
-  unsigned int m_point_index;
-
-  Point next_point();
 };
 
+/**
+ * @brief Get the first params.num_points points of the Halton sequence, in
+ * bases 2, 3 and 5, which lie within an ellipsoid.
+ *
+ * Unlike a Hammersley point set, the Halton sequence does not depend on the
+ * number of points.  So each result is a prefix of every larger result for
+ * the same ellipsoid, and its first n points sample the ellipsoid as evenly
+ * as a smaller point set would.  Fingerprints built from such a point set
+ * are nested in the same way: their first n bits form a valid
+ * lower-resolution fingerprint.
+ *
+ * @param params specifies the ellipsoid, and the number of points to return
+ * @param result on return, the points within the ellipsoid, in sequence
+ * order
+ */
+void get_halton_ellipsoid(const Hammersley::EllipsoidParams &params,
+                          PointList &result);
+
 } // namespace mesaac::shape
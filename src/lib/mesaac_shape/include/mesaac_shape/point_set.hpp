@@ -0,0 +1,78 @@
+// Reads point clouds, such as Hammersley spheres, with a binary cache.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "mesaac_shape/shared_types.hpp"
+
+namespace mesaac::shape {
+
+/**
+ * @brief Get the pathname of the binary cache for a point cloud file.
+ *
+ * @param path pathname of a point cloud text file
+ * @return path with ".ptcache" appended
+ */
+std::filesystem::path point_set_cache_path(const std::filesystem::path &path);
+
+/**
+ * @brief Read a point cloud, e.g., a Hammersley sphere or ellipsoid.
+ *
+ * The file holds one point per line, with space-separated x, y, z
+ * coordinates.  Reading stops at the first token which is not a number.
+ *
+ * The points are also saved to a binary cache next to the text file.  The
+ * cache records a hash of the text content; while the hash still matches,
+ * later reads memory-map the cache instead of parsing the text.  If the
+ * cache cannot be written, e.g. because the directory is read-only, the
+ * points are still returned.
+ *
+ * @param path pathname of a point cloud text file
+ * @return the points, each with 3 coordinates
+ * @throw std::runtime_error if the file cannot be read
+ */
+PointList read_point_set(const std::filesystem::path &path);
+
+/**
+ * @brief The prefix which marks a point cloud source as a Hammersley
+ * generator spec.
+ */
+inline const std::string CloudSpecPrefix = "cloud:";
+
+/**
+ * @brief The prefix which marks a point cloud source as a Halton generator
+ * spec.
+ */
+inline const std::string HaltonSpecPrefix = "halton:";
+
+/**
+ * @brief Find out whether a point cloud source is a generator spec, rather
+ * than a pathname.
+ *
+ * @param source a generator spec or a pathname
+ * @return whether source starts with a generator spec prefix
+ */
+bool is_point_cloud_spec(const std::string &source);
+
+/**
+ * @brief Get a point cloud from a file or from a generator spec.
+ *
+ * A source of the form "cloud:N,SCALE,A,B,C" generates about N Hammersley
+ * ellipsoid points in memory (see Hammersley::get_ellipsoid); e.g.,
+ * "cloud:20000,11,1,1,1" is a sphere of radius 11.  A source of the form
+ * "halton:N,SCALE,A,B,C" generates exactly N prefix-nested Halton points
+ * for the same ellipsoid (see get_halton_ellipsoid).  Any other source is
+ * the pathname of a point cloud file (see read_point_set).
+ *
+ * @param source a generator spec or a pathname
+ * @return the points, each with 3 coordinates
+ * @throw std::invalid_argument if a generator spec is malformed
+ * @throw std::runtime_error if a file cannot be read
+ */
+PointList get_point_cloud(const std::string &source);
+
+} // namespace mesaac::shape
@@ -0,0 +1,65 @@
+// USR (Ultrafast Shape Recognition) moment descriptors.
+// Copyright (c) 2011 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#pragma once
+
+#include <span>
+
+#include "mesaac_mol/mol.hpp"
+
+namespace mesaac::shape {
+
+/**
+ * @brief The number of USR descriptors: three moments of atom distance
+ * distributions about each of four reference points.
+ */
+const unsigned int NumUsrDescriptors = 12;
+
+/**
+ * @brief The number of atom classes for which USRCAT descriptors are
+ * computed.
+ */
+const unsigned int NumUsrcatClasses = 5;
+
+/**
+ * @brief The number of USRCAT descriptors: USR descriptors for each atom
+ * class.
+ */
+const unsigned int NumUsrcatDescriptors = NumUsrDescriptors * NumUsrcatClasses;
+
+/**
+ * @brief Compute the USR descriptors of a conformer.
+ *
+ * The reference points are the heavy atom centroid (ctd), the atom closest
+ * to ctd (cst), the atom farthest from ctd (fct), and the atom farthest
+ * from fct (ftf).  For each reference point, in that order, the
+ * descriptors are the mean, the standard deviation and the cube root of
+ * the third central moment of the distances from the reference point to
+ * the heavy atoms.  All values are in Ångstroms.  A conformer with no heavy
+ * atoms has all-zero descriptors.
+ *
+ * @param mol a conformer with 3D coordinates
+ * @param descriptors on return, the NumUsrDescriptors descriptors of mol
+ * @throw std::invalid_argument if descriptors has the wrong size
+ */
+void get_usr_descriptors(const mol::Mol &mol, std::span<float> descriptors);
+
+/**
+ * @brief Compute the USRCAT descriptors of a conformer.
+ *
+ * USRCAT extends USR with the moments of distances from the same four
+ * reference points to the heavy atoms of each of several classes.  The
+ * classes are assigned by element: all heavy atoms; hydrophobic (C, S,
+ * Cl, Br, I); nitrogen; oxygen; and any other heavy atom.  The first
+ * NumUsrDescriptors descriptors are the USR descriptors.  A class with no
+ * atoms has all-zero descriptors.
+ *
+ * @param mol a conformer with 3D coordinates
+ * @param descriptors on return, the NumUsrcatDescriptors descriptors of mol
+ * @throw std::invalid_argument if descriptors has the wrong size
+ */
+void get_usrcat_descriptors(const mol::Mol &mol,
+                            std::span<float> descriptors);
+
+} // namespace mesaac::shape
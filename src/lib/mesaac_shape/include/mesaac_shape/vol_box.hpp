@@ -26,7 +26,7 @@ public:
   VolBox(const PointList &points, const float sphere_scale);
 
   // Get the number of points within this VolBox.
-  unsigned int size();
+  unsigned int size() const;
 
   // OBS:  spheres should be a list of 4-membered Points:
   //       x, y, z, radius
@@ -8,6 +8,8 @@
 #include <format>
 #include <stdexcept>
 
+#include "mesaac_common/stats.hpp"
+
 using namespace std;
 
 namespace mesaac::shape {
@@ -89,6 +91,10 @@ void AxisAligner::align_to_axes(mol::Mol &m) {
 }
 
 void AxisAligner::align_to_axes(mol::AtomVector &atoms) {
+  static common::stats::Stage &align_stage(
+      common::stats::stage("AxisAligner::align_to_axes"));
+  const common::stats::ScopedTimer timer(align_stage);
+
   // Strategy:
   //   Get mean-centered heavy atom coordinates
   //   Get mean-centered cloud points
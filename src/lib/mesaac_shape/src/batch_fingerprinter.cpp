@@ -0,0 +1,106 @@
+// Computes shape fingerprints for many conformers at once, into a
+// caller-provided buffer.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_shape/batch_fingerprinter.hpp"
+
+#include <format>
+#include <stdexcept>
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#include "mesaac_common/stats.hpp"
+
+using namespace std;
+
+namespace mesaac::shape {
+
+namespace {
+// The orientations used by Fingerprinter, in the same order.
+const float c_flips[BatchFingerprinter::NumOrientations][3] = {
+    {1.0, 1.0, 1.0}, // Unflipped
+    {1.0, -1.0, -1.0},
+    {-1.0, 1.0, -1.0},
+    {-1.0, -1.0, 1.0}};
+
+const size_t c_word_bits = 8 * sizeof(BatchFingerprinter::Word);
+
+// Fingerprints are copied block for block into the result buffer.
+static_assert(sizeof(Fingerprint::block_type) ==
+              sizeof(BatchFingerprinter::Word));
+
+// Per-thread working storage, reused from one conformer to the next so that
+// a batch needs no per-fingerprint allocations.
+struct Scratch {
+  PointList spheres;
+  Fingerprint bits;
+};
+
+void get_flipped_spheres(const ConformerView &conformer, const float *flip,
+                         PointList &spheres) {
+  const size_t num_atoms = conformer.radii.size();
+  spheres.resize(num_atoms);
+  for (size_t i = 0; i < num_atoms; ++i) {
+    Point &sphere(spheres[i]);
+    sphere.resize(4);
+    for (unsigned int k = 0; k < 3; ++k) {
+      sphere[k] = flip[k] * conformer.coords[3 * i + k];
+    }
+    sphere[3] = conformer.radii[i];
+  }
+}
+} // namespace
+
+BatchFingerprinter::BatchFingerprinter(const VolBox &volbox,
+                                       unsigned int num_threads)
+    : m_volbox(volbox), m_num_threads(num_threads), m_num_bits(volbox.size()),
+      m_words_per_fp((m_num_bits + c_word_bits - 1) / c_word_bits) {}
+
+void BatchFingerprinter::compute(span<const ConformerView> conformers,
+                                 span<Word> result) const {
+  static common::stats::Stage &compute_stage(
+      common::stats::stage("BatchFingerprinter::compute"));
+  const common::stats::ScopedTimer timer(compute_stage, conformers.size());
+
+  // Validate up front; exceptions must not escape a parallel region.
+  for (size_t i = 0; i < conformers.size(); ++i) {
+    const auto &conformer(conformers[i]);
+    if (conformer.coords.size() != 3 * conformer.radii.size()) {
+      throw invalid_argument(
+          format("Conformer {} has {} coordinates for {} radii; expected {}.",
+                 i, conformer.coords.size(), conformer.radii.size(),
+                 3 * conformer.radii.size()));
+    }
+  }
+  const size_t num_words = buffer_words(conformers.size());
+  if (result.size() < num_words) {
+    throw invalid_argument(
+        format("Fingerprint buffer has {} words.  Need at least {} words.",
+               result.size(), num_words));
+  }
+
+#if HAVE_OPENMP
+  const int num_threads = m_num_threads ? m_num_threads : omp_get_max_threads();
+#pragma omp parallel num_threads(num_threads)
+#endif
+  {
+    Scratch scratch;
+#if HAVE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int i = 0; i < int(conformers.size()); i++) {
+      Word *conformer_words = result.data() + i * words_per_conformer();
+      for (unsigned int i_flip = 0; i_flip < NumOrientations; ++i_flip) {
+        get_flipped_spheres(conformers[i], c_flips[i_flip], scratch.spheres);
+        m_volbox.set_bits_for_spheres(scratch.spheres, scratch.bits, true, 0);
+        boost::to_block_range(scratch.bits,
+                              conformer_words + i_flip * m_words_per_fp);
+      }
+    }
+  }
+}
+
+} // namespace mesaac::shape
@@ -4,94 +4,113 @@
 
 #include "mesaac_shape/hammersley.hpp"
 
-#include <bitset>
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
 #include <numbers>
+#include <vector>
 
 namespace mesaac::shape {
 using namespace std;
 
 namespace {
-// In practice only the first of these primes is used.
-static constexpr array<unsigned int, 29> primes{
-    3,  5,  7,  11, 13, 17, 19, 23, 29, 31, 37,  41,  43,  47,
-    53, 59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109};
-
-using DigitsVector = vector<int>;
-
-DigitsVector radix_digits(int n, int radix) {
-  DigitsVector result;
-  while (n) {
-    result.push_back(n % radix);
-    n = n / radix;
-  }
-  return result;
+// Candidates are generated and filtered this many at a time.
+const size_t BatchSize = 4096;
+
+using RawPoint = array<double, 3>;
+using Coords = array<float, 3>;
+
+std::uint32_t reverse_bits(std::uint32_t n) {
+  n = ((n >> 1) & 0x55555555) | ((n & 0x55555555) << 1);
+  n = ((n >> 2) & 0x33333333) | ((n & 0x33333333) << 2);
+  n = ((n >> 4) & 0x0f0f0f0f) | ((n & 0x0f0f0f0f) << 4);
+  n = ((n >> 8) & 0x00ff00ff) | ((n & 0x00ff00ff) << 8);
+  return (n >> 16) | (n << 16);
+}
+
+// Get the point at (1-based) index of a num_points Hammersley point set in
+// the unit cube.
+RawPoint unit_point(std::uint32_t index, size_t num_points) {
+  return {double(index) / double(num_points), radical_inverse(2, index),
+          radical_inverse(3, index)};
 }
 
-float hamm_dim_0(unsigned int index, unsigned int sample_size) {
-  // the first dimension is just the sequence i/N (sample_size)
-  return float(index) / float(sample_size);
+// Get the point at (1-based) index of the Halton sequence in the unit cube.
+// Unlike a Hammersley point, it does not depend on the size of the set.
+RawPoint halton_point(std::uint32_t index) {
+  return {radical_inverse(2, index), radical_inverse(3, index),
+          radical_inverse(5, index)};
 }
 
-// Subsequent dimensions D in 1...N are mathematically the same (van der
-// Corput dimension computed from a prime).  Here, a separate implementation is
-// used for dimension 1, i.e., for prime 2, to take advantage of C++ base-2
-// facilities.
-
-float hamm_dim_1(const unsigned int index) {
-  size_t j = 0;
-  float result = 0.0;
-  size_t twocount = 1;
-  bitset<32> i_int(index);
-  while (twocount <= index) {
-    if (i_int[j]) {
-      result += 1.0 / (float)(twocount * 2);
+// Generate up to num_candidates unit cube points, keeping up to max_points
+// of those for which filter returns true.  generator receives a 1-based
+// index and returns the corresponding unit cube point; filter receives a
+// unit cube point, and sets the coordinates to store.
+template <typename Generator, typename Filter>
+void get_filtered_points(size_t num_candidates, size_t max_points,
+                         const Generator &generator, const Filter &filter,
+                         PointList &result) {
+  result.clear();
+  result.reserve(max_points);
+
+  vector<Coords> coords(BatchSize);
+  vector<unsigned char> keep(BatchSize);
+  for (size_t first = 1;
+       (first <= num_candidates) && (result.size() < max_points);
+       first += BatchSize) {
+    const int batch_size = min(BatchSize, num_candidates - first + 1);
+#if HAVE_OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < batch_size; ++i) {
+      const RawPoint raw(generator(first + i));
+      keep[i] = filter(raw, coords[i]);
+    }
+
+    for (int i = 0; (i < batch_size) && (result.size() < max_points); ++i) {
+      if (keep[i]) {
+        result.push_back({coords[i][0], coords[i][1], coords[i][2]});
+      }
     }
-    j++;
-    twocount *= 2;
   }
-  return result;
 }
 
-float hamm_dim_n(const unsigned int dimension, const unsigned int index) {
-  const auto prime = primes.at(dimension - 2);
-  size_t j = 0;
-  float result = 0.0;
-  size_t count = 1;
-  const auto digits = radix_digits(index, prime);
-  while (count <= index) {
-    if (digits[j]) {
-      result += digits[j] / (float)(count * prime);
+// Get a filter which keeps the unit cube points that, once scaled and
+// mean-centered, lie within an ellipsoid.
+auto ellipsoid_filter(const Hammersley::EllipsoidParams &params) {
+  const double scale = params.scale;
+  const double scale_sqr = scale * scale;
+  return [=](const RawPoint &raw, Coords &coords) {
+    // Scale & mean-center the point.
+    for (unsigned int k = 0; k < 3; ++k) {
+      coords[k] = scale * (1.0 - 2.0 * raw[k]);
     }
-    j++;
-    count *= prime;
-  }
-  return result;
+    // Filter points that lie outside the spheroid.
+    const float xsqr = coords[0] * coords[0] / params.a;
+    const float ysqr = coords[1] * coords[1] / params.b;
+    const float zsqr = coords[2] * coords[2] / params.c;
+    return (xsqr + ysqr + zsqr) < scale_sqr;
+  };
 }
 } // namespace
 
-Point Hammersley::next_point() {
-  // Get the next hammersley point that lies within the spheroid.
-  for (;;) {
-    m_point_index += 1;
-    if (m_point_index > m_num_points) {
-      return {0, 0, 0};
-    }
-    return {
-        hamm_dim_0(m_point_index, m_num_points),
-        hamm_dim_1(m_point_index),
-        hamm_dim_n(2, m_point_index),
-    };
+double radical_inverse(unsigned int base, std::uint32_t index) {
+  if (base == 2) {
+    return ldexp(double(reverse_bits(index)), -32);
+  }
+  // index has at most 21 base-3 digits, so neither value overflows.
+  std::uint64_t reversed = 0, denom = 1;
+  while (index) {
+    reversed = reversed * base + index % base;
+    denom *= base;
+    index /= base;
   }
+  return double(reversed) / double(denom);
 }
 
 void Hammersley::get_ellipsoid(const Hammersley::EllipsoidParams &params,
-                               std::vector<Point> &result) {
-  const Point zero{0, 0, 0};
-
-  const float scale_2 = params.scale * 2.0;
-  const float scale_sqr = params.scale * params.scale;
-
+                               PointList &result) {
   // Estimate the fraction of unit volume covered by a spheroid.
   // From Wikipedia (https://en.wikipedia.org/wiki/Ellipsoid#Volume)
   // the volume of an ellipsoid with scaling factors a, b, c --
@@ -109,49 +128,29 @@ void Hammersley::get_ellipsoid(const Hammersley::EllipsoidParams &params,
   if (total_points * fraction < params.num_points) {
     total_points += 1;
   }
-  Hammersley gen(total_points);
-  result.clear();
-  result.reserve(params.num_points);
-  for (size_t num_generated = 0;; ++num_generated) {
-    if (result.size() >= params.num_points) {
-      // Enough points
-      std::cerr << "DBG: get_ellipsoid filled #points = " << params.num_points
-                << " after generating #points = " << num_generated << " of "
-                << total_points << " or "
-                << (int)(100 * num_generated / total_points)
-                << "% of all estimated." << std::endl;
-      return;
-    }
+  get_ellipsoid_from_cube(params, total_points, result);
+}
 
-    const Point raw_point = gen.next_point();
-    if (raw_point == zero) {
-      // No more points available
-      std::cerr << "DBG: get_ellipsoid ran out of points after filling "
-                   "#points = "
-                << result.size() << " of required " << params.num_points
-                << ", or " << (int)(100 * result.size() / params.num_points)
-                << "%" << std::endl;
-      return;
-    }
+void Hammersley::get_ellipsoid_from_cube(const EllipsoidParams &params,
+                                         size_t num_candidates,
+                                         PointList &result) {
+  const auto generator = [num_candidates](std::uint32_t index) {
+    return unit_point(index, num_candidates);
+  };
+  get_filtered_points(num_candidates, params.num_points, generator,
+                      ellipsoid_filter(params), result);
+}
 
-    // Scale & mean-center the point.
-    const float x = params.scale - scale_2 * raw_point[0],
-                y = params.scale - scale_2 * raw_point[1],
-                z = params.scale - scale_2 * raw_point[2];
-    // Filter points that lie outside the spheroid.
-    const float xsqr = x * x / params.a;
-    const float ysqr = y * y / params.b;
-    const float zsqr = z * z / params.c;
-    if ((xsqr + ysqr + zsqr) < scale_sqr) {
-      result.emplace_back(Point{x, y, z});
-    }
-  }
+void get_halton_ellipsoid(const Hammersley::EllipsoidParams &params,
+                          PointList &result) {
+  // The sequence is unbounded, so generate candidates until enough points
+  // have been accepted.
+  get_filtered_points(numeric_limits<std::uint32_t>::max(), params.num_points,
+                      halton_point, ellipsoid_filter(params), result);
 }
 
 void Hammersley::get_cuboid(const CuboidParams &params, PointList &result) {
-  const Point zero{0, 0, 0};
   result.clear();
-  result.reserve(params.num_points);
 
   // Real-world bounds
   const float dxw = params.xmax - params.xmin, dyw = params.ymax - params.ymin,
@@ -171,28 +170,18 @@ void Hammersley::get_cuboid(const CuboidParams &params, PointList &result) {
         total_points += 1;
       }
 
-      Hammersley gen(total_points);
-
-      for (;;) {
-        if (result.size() >= params.num_points) {
-          // Enough points
-          return;
-        }
-
-        const Point raw_point = gen.next_point();
-        if (raw_point == zero) {
-          // No more points available
-          return;
-        }
-
-        const float x(raw_point[0]), y(raw_point[1]), z(raw_point[2]);
-        if ((x <= dx) && (y <= dy) && (z <= dz)) {
-          // Shift points to center.
-          result.emplace_back(Point{(x * dw_max) + params.xmin,
-                                    (y * dw_max) + params.ymin,
-                                    (z * dw_max) + params.zmin});
-        }
-      }
+      const auto in_cuboid = [&](const RawPoint &raw, Coords &coords) {
+        const float x(raw[0]), y(raw[1]), z(raw[2]);
+        // Shift points to center.
+        coords = {(x * dw_max) + params.xmin, (y * dw_max) + params.ymin,
+                  (z * dw_max) + params.zmin};
+        return (x <= dx) && (y <= dy) && (z <= dz);
+      };
+      const auto generator = [total_points](std::uint32_t index) {
+        return unit_point(index, total_points);
+      };
+      get_filtered_points(total_points, params.num_points, generator,
+                          in_cuboid, result);
     }
   }
 }
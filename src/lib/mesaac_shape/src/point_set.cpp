@@ -0,0 +1,223 @@
+//
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_shape/point_set.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include "mesaac_common/mapped_file.hpp"
+#include "mesaac_shape/hammersley.hpp"
+
+using namespace std;
+
+namespace mesaac::shape {
+
+namespace {
+const char Magic[8] = {'M', 'E', 'S', 'A', 'P', 'T', 'S', 'C'};
+const std::uint32_t Version = 1;
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t num_points;
+  std::uint64_t source_size;
+  std::uint64_t source_hash;
+};
+static_assert(sizeof(Header) == 32);
+
+// FNV-1a
+std::uint64_t content_hash(span<const std::byte> content) {
+  std::uint64_t result = 0xcbf29ce484222325ULL;
+  for (const std::byte b : content) {
+    result ^= std::to_integer<std::uint64_t>(b);
+    result *= 0x100000001b3ULL;
+  }
+  return result;
+}
+
+bool is_space(char c) {
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+vector<float> parse_coords(span<const std::byte> content) {
+  vector<float> result;
+  const char *curr = reinterpret_cast<const char *>(content.data());
+  const char *const end = curr + content.size();
+  for (;;) {
+    while ((curr != end) && is_space(*curr)) {
+      ++curr;
+    }
+    float value;
+    if (curr == end) {
+      break;
+    }
+    const auto [next, error] = from_chars(curr, end, value);
+    if (error != errc()) {
+      break;
+    }
+    result.push_back(value);
+    curr = next;
+  }
+  // Drop any incomplete trailing point.
+  result.resize(result.size() - result.size() % 3);
+  return result;
+}
+
+optional<vector<float>> read_cache(const filesystem::path &cache_path,
+                                   std::uint64_t source_size,
+                                   std::uint64_t source_hash) {
+  error_code ec;
+  if (!filesystem::exists(cache_path, ec)) {
+    return nullopt;
+  }
+  try {
+    const common::MappedFile cache(cache_path);
+    Header header;
+    if (cache.size() < sizeof(header)) {
+      return nullopt;
+    }
+    memcpy(&header, cache.data(), sizeof(header));
+    const size_t num_coords = size_t(header.num_points) * 3;
+    if ((memcmp(header.magic, Magic, sizeof(Magic)) != 0) ||
+        (header.version != Version) || (header.source_size != source_size) ||
+        (header.source_hash != source_hash) ||
+        (cache.size() != sizeof(header) + num_coords * sizeof(float))) {
+      return nullopt;
+    }
+    vector<float> result(num_coords);
+    memcpy(result.data(), cache.data() + sizeof(header),
+           num_coords * sizeof(float));
+    return result;
+  } catch (const runtime_error &) {
+    return nullopt;
+  }
+}
+
+// Write the cache to a temporary file and rename it into place, so that
+// concurrent processes never see a partial cache.
+void write_cache(const filesystem::path &cache_path,
+                 std::uint64_t source_size, std::uint64_t source_hash,
+                 const vector<float> &coords) {
+  Header header{};
+  memcpy(header.magic, Magic, sizeof(Magic));
+  header.version = Version;
+  header.num_points = coords.size() / 3;
+  header.source_size = source_size;
+  header.source_hash = source_hash;
+
+  filesystem::path tmp_path(cache_path);
+  tmp_path += "." + to_string(getpid()) + ".tmp";
+  {
+    ofstream outf(tmp_path, ios::binary);
+    if (!outf) {
+      return;
+    }
+    outf.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    outf.write(reinterpret_cast<const char *>(coords.data()),
+               coords.size() * sizeof(float));
+    if (!outf) {
+      outf.close();
+      error_code ec;
+      filesystem::remove(tmp_path, ec);
+      return;
+    }
+  }
+  error_code ec;
+  filesystem::rename(tmp_path, cache_path, ec);
+  if (ec) {
+    filesystem::remove(tmp_path, ec);
+  }
+}
+
+Hammersley::EllipsoidParams parse_cloud_spec(const string &source,
+                                             const string &prefix) {
+  const string spec(source.substr(prefix.size()));
+  const char *curr = spec.data();
+  const char *const end = curr + spec.size();
+
+  size_t num_points = 0;
+  array<float, 4> dims{};
+  auto [next, error] = from_chars(curr, end, num_points);
+  bool ok = (error == errc());
+  for (auto &dim : dims) {
+    if (!ok || (next == end) || (*next != ',')) {
+      ok = false;
+      break;
+    }
+    const auto dim_result = from_chars(next + 1, end, dim);
+    ok = (dim_result.ec == errc()) && (dim > 0.0);
+    next = dim_result.ptr;
+  }
+  if (!ok || (next != end) || (num_points == 0)) {
+    throw invalid_argument(
+        format("Invalid point cloud spec '{}': expected {}N,SCALE,A,B,C with "
+               "positive values",
+               source, prefix));
+  }
+  return {.num_points = num_points,
+          .scale = dims[0],
+          .a = dims[1],
+          .b = dims[2],
+          .c = dims[3]};
+}
+} // namespace
+
+filesystem::path point_set_cache_path(const filesystem::path &path) {
+  filesystem::path result(path);
+  result += ".ptcache";
+  return result;
+}
+
+PointList read_point_set(const filesystem::path &path) {
+  const common::MappedFile source(path);
+  const span<const std::byte> content(source.data(), source.size());
+  const std::uint64_t source_hash = content_hash(content);
+
+  const auto cache_path(point_set_cache_path(path));
+  auto coords = read_cache(cache_path, content.size(), source_hash);
+  if (!coords) {
+    coords = parse_coords(content);
+    write_cache(cache_path, content.size(), source_hash, *coords);
+  }
+
+  PointList result;
+  result.reserve(coords->size() / 3);
+  for (size_t i = 0; i < coords->size(); i += 3) {
+    result.push_back({(*coords)[i], (*coords)[i + 1], (*coords)[i + 2]});
+  }
+  return result;
+}
+
+bool is_point_cloud_spec(const string &source) {
+  return source.starts_with(CloudSpecPrefix) ||
+         source.starts_with(HaltonSpecPrefix);
+}
+
+PointList get_point_cloud(const string &source) {
+  PointList result;
+  if (source.starts_with(CloudSpecPrefix)) {
+    Hammersley::get_ellipsoid(parse_cloud_spec(source, CloudSpecPrefix),
+                              result);
+  } else if (source.starts_with(HaltonSpecPrefix)) {
+    get_halton_ellipsoid(parse_cloud_spec(source, HaltonSpecPrefix), result);
+  } else {
+    result = read_point_set(source);
+  }
+  return result;
+}
+
+} // namespace mesaac::shape
@@ -0,0 +1,154 @@
+// USR (Ultrafast Shape Recognition) moment descriptors.
+// Copyright (c) 2011 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include "mesaac_shape/usr_descriptors.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace mesaac::shape {
+
+namespace {
+using Coords = array<double, 3>;
+
+struct HeavyAtom {
+  Coords pos;
+  unsigned int atom_class;
+};
+
+const unsigned int NumRefPoints = 4;
+const unsigned int NumMoments = 3;
+
+unsigned int get_atom_class(unsigned int atomic_num) {
+  switch (atomic_num) {
+  case 6:  // C
+  case 16: // S
+  case 17: // Cl
+  case 35: // Br
+  case 53: // I
+    return 1;
+  case 7: // N
+    return 2;
+  case 8: // O
+    return 3;
+  default:
+    return 4;
+  }
+}
+
+vector<HeavyAtom> get_heavy_atoms(const mol::Mol &mol) {
+  vector<HeavyAtom> result;
+  result.reserve(mol.num_atoms());
+  for (const auto &atom : mol.atoms()) {
+    if (!atom.is_hydrogen()) {
+      const auto pos(atom.pos());
+      result.push_back({.pos = {pos.x(), pos.y(), pos.z()},
+                        .atom_class = get_atom_class(atom.atomic_num())});
+    }
+  }
+  return result;
+}
+
+double distance(const Coords &a, const Coords &b) {
+  const double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+  return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+// Get the positions of atoms nearest to and farthest from ref.
+pair<Coords, Coords> get_extremes(const vector<HeavyAtom> &atoms,
+                                  const Coords &ref) {
+  const auto by_distance = [&ref](const HeavyAtom &a, const HeavyAtom &b) {
+    return distance(a.pos, ref) < distance(b.pos, ref);
+  };
+  const auto [nearest, farthest] =
+      minmax_element(atoms.begin(), atoms.end(), by_distance);
+  return {nearest->pos, farthest->pos};
+}
+
+array<Coords, NumRefPoints> get_ref_points(const vector<HeavyAtom> &atoms) {
+  Coords ctd{0.0, 0.0, 0.0};
+  for (const auto &atom : atoms) {
+    for (unsigned int k = 0; k < 3; ++k) {
+      ctd[k] += atom.pos[k];
+    }
+  }
+  for (auto &c : ctd) {
+    c /= atoms.size();
+  }
+  const auto [cst, fct] = get_extremes(atoms, ctd);
+  const auto ftf = get_extremes(atoms, fct).second;
+  return {ctd, cst, fct, ftf};
+}
+
+// Compute the moments of distances from ref to the atoms of atom_class
+// (0 for all atoms).
+void get_moments(const vector<HeavyAtom> &atoms, unsigned int atom_class,
+                 const Coords &ref, span<float> moments) {
+  unsigned int n = 0;
+  double sum = 0.0;
+  for (const auto &atom : atoms) {
+    if ((atom_class == 0) || (atom.atom_class == atom_class)) {
+      sum += distance(atom.pos, ref);
+      n++;
+    }
+  }
+  if (n == 0) {
+    fill(moments.begin(), moments.end(), 0.0);
+    return;
+  }
+
+  const double mean = sum / n;
+  double sum_sq = 0.0, sum_cube = 0.0;
+  for (const auto &atom : atoms) {
+    if ((atom_class == 0) || (atom.atom_class == atom_class)) {
+      const double dev = distance(atom.pos, ref) - mean;
+      sum_sq += dev * dev;
+      sum_cube += dev * dev * dev;
+    }
+  }
+  moments[0] = mean;
+  moments[1] = sqrt(sum_sq / n);
+  moments[2] = cbrt(sum_cube / n);
+}
+
+void get_descriptors(const mol::Mol &mol, unsigned int num_classes,
+                     span<float> descriptors) {
+  const unsigned int expected_size = NumUsrDescriptors * num_classes;
+  if (descriptors.size() != expected_size) {
+    throw invalid_argument(format("Need room for {} USR descriptors; got {}",
+                                  expected_size, descriptors.size()));
+  }
+  const auto atoms(get_heavy_atoms(mol));
+  if (atoms.empty()) {
+    fill(descriptors.begin(), descriptors.end(), 0.0);
+    return;
+  }
+
+  const auto ref_points(get_ref_points(atoms));
+  unsigned int offset = 0;
+  for (unsigned int atom_class = 0; atom_class < num_classes; ++atom_class) {
+    for (const auto &ref : ref_points) {
+      get_moments(atoms, atom_class, ref,
+                  descriptors.subspan(offset, NumMoments));
+      offset += NumMoments;
+    }
+  }
+}
+} // namespace
+
+void get_usr_descriptors(const mol::Mol &mol, span<float> descriptors) {
+  get_descriptors(mol, 1, descriptors);
+}
+
+void get_usrcat_descriptors(const mol::Mol &mol, span<float> descriptors) {
+  get_descriptors(mol, NumUsrcatClasses, descriptors);
+}
+
+} // namespace mesaac::shape
@@ -8,6 +8,8 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "mesaac_common/stats.hpp"
+
 using namespace std;
 
 namespace mesaac::shape {
@@ -100,7 +102,7 @@ void VolBox::add_points(const PointList &points) {
 }
 
 // Get the number of points within this VolBox.
-unsigned int VolBox::size() { return m_bucket_points.size(); }
+unsigned int VolBox::size() const { return m_bucket_points.size(); }
 
 void VolBox::get_points_within_spheres(const PointList &spheres,
                                        PointList &contained_points,
@@ -121,6 +123,10 @@ void VolBox::set_bits_for_spheres(const PointList &spheres,
                                   shape_defs::BitVector &bits,
                                   bool from_scratch,
                                   unsigned int offset) const {
+  static common::stats::Stage &query_stage(
+      common::stats::stage("VolBox::set_bits_for_spheres"));
+  const common::stats::ScopedTimer timer(query_stage, spheres.size());
+
   if (from_scratch) {
     bits.resize(m_bucket_points.size() + offset);
     bits.reset();
@@ -137,6 +143,10 @@ void VolBox::set_folded_bits_for_spheres(const PointList &spheres,
                                          shape_defs::BitVector &bits,
                                          unsigned int num_folds,
                                          unsigned int offset) const {
+  static common::stats::Stage &query_stage(
+      common::stats::stage("VolBox::set_folded_bits_for_spheres"));
+  const common::stats::ScopedTimer timer(query_stage, spheres.size());
+
   unsigned int fold_factor = 1 << num_folds;
   unsigned int folded_size = m_bucket_points.size() / fold_factor;
   validate_bits(bits, offset + folded_size);
@@ -0,0 +1,169 @@
+#!/usr/bin/env python
+"""Unit test for shape_fp_pack, shape_fp_append, shape_fp_compact and
+measures_sfp_band.
+Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import logging
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+
+import config
+
+SAMPLE_FPS = config.SHARED_DATA_DIR / "measures" / "in" / "sample_shape_fps.txt"
+NUM_SAMPLE_SHAPES = 16
+
+
+def _run(*args):
+    return subprocess.run(
+        [str(arg) for arg in args], capture_output=True, encoding="utf8"
+    )
+
+
+class TestCase(unittest.TestCase):
+    def setUp(self):
+        self._tmpdir = tempfile.TemporaryDirectory()
+        self.tmpdir = Path(self._tmpdir.name)
+        self.db_path = self.tmpdir / "sample.db"
+        completion = _run(config.SHAPE_FP_PACK_EXE, SAMPLE_FPS, self.db_path)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+
+    def tearDown(self):
+        self._tmpdir.cleanup()
+
+    def test_no_args(self):
+        completion = _run(config.MEASURES_SFP_BAND_EXE)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("usage:" in completion.stderr.lower())
+
+    def test_sparse_bands_match_measures_shape_fp(self):
+        out_dir = self.tmpdir / "bands"
+        band_text = self._bands(out_dir, "-b", 5, "-c", 0, "-t", 0.3)
+        self.assertEqual(self._reference("-f", "S", "-t", 0.3), band_text)
+        self.assertEqual(4, len(list(out_dir.glob("band_*.txt"))))
+
+    def test_matrix_bands_match_measures_shape_fp(self):
+        out_dir = self.tmpdir / "bands"
+        band_text = self._bands(out_dir, "-d", "-f", "M", "-b", 7)
+        self.assertEqual(self._reference("-d", "-f", "M"), band_text)
+
+        # With no memory to spare, each band is computed a row at a time.
+        band_text = self._bands(
+            self.tmpdir / "capped", "-d", "-f", "M", "-b", 7, "-c", 0
+        )
+        self.assertEqual(self._reference("-d", "-f", "M"), band_text)
+
+    def test_records(self):
+        out_dir = self.tmpdir / "bands"
+        band_text = self._bands(out_dir, "-r", 3, 9, "-t", 0.3)
+        expected = self._reference("-f", "S", "-t", 0.3).splitlines()[3:9]
+        self.assertEqual(expected, band_text.splitlines())
+
+    def test_resume(self):
+        out_dir = self.tmpdir / "bands"
+        args = ["-b", 4, "-t", 0.3]
+        expected = self._bands(out_dir, *args)
+
+        # Simulate a job killed after completing some bands.
+        band_paths = sorted(out_dir.glob("band_*.txt"))
+        band_paths[-1].unlink()
+        completion = self._run_bands(out_dir, *args)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        self.assertTrue("Wrote 1 bands; 3 bands" in completion.stderr)
+        self.assertEqual(expected, self._band_text(out_dir))
+
+    def test_mismatched_checkpoint(self):
+        out_dir = self.tmpdir / "bands"
+        self._bands(out_dir, "-b", 4)
+        completion = self._run_bands(out_dir, "-b", 5)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("records a different job" in completion.stderr)
+
+    def test_invalid_database(self):
+        completion = _run(
+            config.MEASURES_SFP_BAND_EXE, SAMPLE_FPS, self.tmpdir / "bands"
+        )
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("not a packed shape fingerprint file" in completion.stderr)
+
+    def test_segmented_database(self):
+        # Append the sample as three segments.
+        seg_dir = self.tmpdir / "sample_segments"
+        lines = SAMPLE_FPS.read_text().splitlines(keepends=True)
+        for i, (start, end) in enumerate([(0, 20), (20, 40), (40, 64)]):
+            fps_path = self.tmpdir / f"part_{i}.txt"
+            fps_path.write_text("".join(lines[start:end]))
+            completion = _run(config.SHAPE_FP_APPEND_EXE, fps_path, seg_dir)
+            self.assertEqual(0, completion.returncode, completion.stderr)
+            self.assertTrue(
+                f"global indices {start // 4}..{end // 4 - 1}." in completion.stderr
+            )
+
+        expected = self._reference("-f", "S", "-t", 0.3)
+        band_text = self._bands(
+            self.tmpdir / "bands", "-b", 5, "-t", 0.3, db_path=seg_dir
+        )
+        self.assertEqual(expected, band_text)
+
+        completion = _run(config.SHAPE_FP_COMPACT_EXE, seg_dir)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        self.assertTrue("Merged 3 segments." in completion.stderr)
+        self.assertEqual(1, len(list(seg_dir.glob("segment_*.sfp"))))
+        band_text = self._bands(
+            self.tmpdir / "compacted", "-b", 5, "-t", 0.3, db_path=seg_dir
+        )
+        self.assertEqual(expected, band_text)
+
+    def test_append_compact_over(self):
+        seg_dir = self.tmpdir / "sample_segments"
+        for _ in range(3):
+            completion = _run(config.SHAPE_FP_APPEND_EXE, "-c", 2, SAMPLE_FPS, seg_dir)
+            self.assertEqual(0, completion.returncode, completion.stderr)
+        self.assertTrue("Merged 3 segments." in completion.stderr)
+        self.assertEqual(1, len(list(seg_dir.glob("segment_*.sfp"))))
+
+        completion = self._run_bands(self.tmpdir / "bands", db_path=seg_dir)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        band_text = self._band_text(self.tmpdir / "bands")
+        self.assertEqual(3 * NUM_SAMPLE_SHAPES, len(band_text.splitlines()))
+
+    def test_append_mismatched_bits(self):
+        seg_dir = self.tmpdir / "sample_segments"
+        completion = _run(config.SHAPE_FP_APPEND_EXE, SAMPLE_FPS, seg_dir)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        short_fps = self.tmpdir / "short.txt"
+        short_fps.write_text("0101\n" * 4)
+        completion = _run(config.SHAPE_FP_APPEND_EXE, short_fps, seg_dir)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("cannot append 4-bit fingerprints" in completion.stderr)
+
+    def _run_bands(self, out_dir, *args, db_path=None):
+        return _run(
+            config.MEASURES_SFP_BAND_EXE, *args, db_path or self.db_path, out_dir
+        )
+
+    def _bands(self, out_dir, *args, db_path=None):
+        completion = self._run_bands(out_dir, *args, db_path=db_path)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        return self._band_text(out_dir)
+
+    def _band_text(self, out_dir):
+        return "".join(
+            path.read_text() for path in sorted(out_dir.glob("band_*.txt"))
+        )
+
+    def _reference(self, *args):
+        completion = _run(config.MEASURES_SHAPE_FP_EXE, *args, SAMPLE_FPS)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        return completion.stdout
+
+
+def main():
+    logging.basicConfig(level=logging.DEBUG)
+    unittest.main()
+
+
+if __name__ == "__main__":
+    main()
@@ -3,74 +3,102 @@
 Copyright (c) 2005-2010 Mesa Analytics & Computing, Inc.  All rights reserved
 """
 
-import sys
-import os
-import unittest
 import logging
+import subprocess
+import unittest
 
-from measures_testing import (
-    measure_factory,
-    results_verifier_factory,
-    testfactory,
-)
-
-_thisdir = os.path.abspath(os.path.dirname(__file__))
-
+import config
 
-def _relpath(p):
-    return os.path.abspath(os.path.join(_thisdir, p))
+# Each line of a shape fingerprint file is also a plain fingerprint.
+SAMPLE_FPS = config.SHARED_DATA_DIR / "measures" / "in" / "sample_shape_fps.txt"
+NUM_FPS = 64
+ALL_MEASURES = "BCEHTV"
 
 
-_default_exe = _relpath("../measures_all")
-_formats = "Matrix OrderedPairs SparseMatrix SparseMatrixSearching PVM".split()
+def _run(*args):
+    return subprocess.run(
+        [str(arg) for arg in args], capture_output=True, encoding="utf8"
+    )
 
 
-def _get_arglist(exe, file_gen, expecter):
-    measurer = expecter.fp_measurer()
-    result = [
-        exe,
-        file_gen.pathname(),
-        measurer.measure_opt(),
-        measurer.similarity_opt(),
-        expecter.format_opt(),
-        expecter.searching_opt(),
-        str(expecter.search_number() or "0"),
-    ]
-    alpha = measurer.tversky_alpha()
-    if alpha is not None:
-        result.append(str(alpha))
-    thresh = expecter.threshold()
-    if thresh is not None:
-        result.append(str(thresh))
+def _pairs(output):
+    """Map each (i, j) pair of measures_all output to its list of values."""
+    result = {}
+    for line in output.splitlines():
+        fields = line.split()
+        result[(int(fields[0]), int(fields[1]))] = fields[2:]
     return result
 
 
-def _make_tc(
-    measure_name, is_sim, format_name, search_number, tversky_alpha, threshold
-):
-    return testfactory.get_valid_args_method(
-        measure_name,
-        is_sim,
-        format_name,
-        search_number=search_number,
-        tversky_alpha=tversky_alpha,
-        threshold=threshold,
-        default_exe=_default_exe,
-        get_arglist=_get_arglist,
-    )
-
-
-# Create the placeholder test case:
 class TestCase(unittest.TestCase):
-    pass
-
-
-# Populate it with combinations of good inputs:
-for format in _formats:
-    for measure_name in measure_factory.measure_names():
-        for is_sim in [False, True]:
-            tc = _make_tc(measure_name, is_sim, format, 4, 0.25, 0.7)
-            setattr(TestCase, tc.__name__, tc)
+    def _measures_all(self, *args):
+        completion = _run(config.MEASURES_ALL_EXE, *args, SAMPLE_FPS)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        return _pairs(completion.stdout)
+
+    def test_no_args(self):
+        completion = _run(config.MEASURES_ALL_EXE)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("usage:" in completion.stderr.lower())
+
+    def test_bad_measure(self):
+        completion = _run(config.MEASURES_ALL_EXE, "-m", "TX", SAMPLE_FPS)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("Unsupported measure -X" in completion.stderr)
+
+    def test_matches_measures_nxn(self):
+        for sim_args in [[], ["-d"]]:
+            all_pairs = self._measures_all("-a", 0.3, *sim_args)
+            self.assertEqual(NUM_FPS * NUM_FPS, len(all_pairs))
+            for k, code in enumerate(ALL_MEASURES):
+                with self.subTest(measure=code, args=sim_args):
+                    completion = _run(
+                        config.MEASURES_NXN_EXE,
+                        "-m",
+                        code,
+                        "-a",
+                        0.3,
+                        "-f",
+                        "O",
+                        *sim_args,
+                        SAMPLE_FPS,
+                    )
+                    self.assertEqual(0, completion.returncode)
+                    for line in completion.stdout.splitlines():
+                        i, j, value = line.split()
+                        self.assertEqual(value, all_pairs[(int(i), int(j))][k])
+
+    def test_measure_order(self):
+        all_pairs = self._measures_all()
+        reordered = self._measures_all("-m", "VTB")
+        self.assertEqual(all_pairs.keys(), reordered.keys())
+        for pair, values in reordered.items():
+            expected = all_pairs[pair]
+            self.assertEqual([expected[5], expected[4], expected[0]], values)
+
+    def test_search(self):
+        search_number = 5
+        all_pairs = self._measures_all()
+        searched = self._measures_all("-s", search_number)
+        self.assertEqual(search_number * (NUM_FPS - search_number), len(searched))
+        for (i, j), values in searched.items():
+            self.assertEqual(all_pairs[(i, j + search_number)], values)
+
+    def test_threshold(self):
+        for args, passes in [
+            (["-t", 0.6], lambda v: v >= 0.6),
+            (["-d", "-t", 0.4], lambda v: v <= 0.4),
+        ]:
+            with self.subTest(args=args):
+                unfiltered = self._measures_all("-m", "TC", *args[:-2])
+                filtered = self._measures_all("-m", "TC", *args)
+                expected = {
+                    pair: values
+                    for pair, values in unfiltered.items()
+                    if passes(float(values[0]))
+                }
+                self.assertTrue(0 < len(expected) < len(unfiltered))
+                self.assertEqual(expected, filtered)
 
 
 def main():
@@ -0,0 +1,205 @@
+#!/usr/bin/env python
+"""Unit test for measures_count_nxn.
+Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import logging
+import math
+import random
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+
+import config
+
+
+def _run(*args):
+    return subprocess.run(
+        [str(arg) for arg in args], capture_output=True, encoding="utf8"
+    )
+
+
+def _num_present(counts):
+    return max(1, max(sum(1 for c in v if c > 0) for v in counts))
+
+
+def _tanimoto(counts, i, j):
+    total = sum(
+        min(a, b) / max(a, b) for a, b in zip(counts[i], counts[j]) if a and b
+    )
+    return total / _num_present(counts)
+
+
+def _tversky(alpha):
+    beta = 2.0 - alpha
+
+    def measure(counts, i, j):
+        total = 0.0
+        for a, b in zip(counts[i], counts[j]):
+            if a and b:
+                total += a / (beta * b) if a < b else b / (alpha * a)
+        return total / (_num_present(counts) / min(alpha, beta))
+
+    return measure
+
+
+def _euclidean(counts, i, j):
+    max_count = max(1, max(max(v) for v in counts))
+    norm = max_count * math.sqrt(len(counts[0]))
+    dist = math.sqrt(sum((a - b) ** 2 for a, b in zip(counts[i], counts[j])))
+    return 1.0 - dist / norm
+
+
+def _cosine(counts, i, j):
+    denom = math.sqrt(sum(a * a for a in counts[i])) * math.sqrt(
+        sum(b * b for b in counts[j])
+    )
+    if denom <= 0:
+        return 0.0
+    return sum(a * b for a, b in zip(counts[i], counts[j])) / denom
+
+
+class TestCase(unittest.TestCase):
+    def setUp(self):
+        self._tmpdir = tempfile.TemporaryDirectory()
+        self.tmpdir = Path(self._tmpdir.name)
+
+    def tearDown(self):
+        self._tmpdir.cleanup()
+
+    def test_no_args(self):
+        completion = _run(config.MEASURES_COUNT_NXN_EXE)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("usage:" in completion.stderr.lower())
+
+    def test_8_bit_counts(self):
+        self._verify_measures(self._gen_counts(40, 37, 255))
+
+    def test_16_bit_counts(self):
+        self._verify_measures(self._gen_counts(30, 70, 65535))
+
+    def test_sparse_threshold(self):
+        counts = self._gen_counts(25, 16, 9)
+        path = self._write_counts(counts)
+        for compute_sim, threshold in [(True, 0.3), (False, 0.7)]:
+            with self.subTest(compute_sim=compute_sim):
+                args = ["-f", "S", "-t", threshold]
+                if not compute_sim:
+                    args.append("-d")
+                completion = _run(config.MEASURES_COUNT_NXN_EXE, *args, path)
+                self.assertEqual(0, completion.returncode, completion.stderr)
+                lines = completion.stdout.splitlines()
+                self.assertEqual(len(counts), len(lines))
+                for i, line in enumerate(lines):
+                    fields = line.split()
+                    self.assertEqual("-1", fields[-1])
+                    expected = []
+                    for j in range(len(counts)):
+                        sim = _tanimoto(counts, i, j)
+                        v = sim if compute_sim else 1.0 - sim
+                        # Skip values too close to the threshold to call.
+                        if i != j and abs(v - threshold) > 1.0e-4:
+                            if (v >= threshold) == compute_sim:
+                                expected.append(j)
+                    actual = set(int(j) for j in fields[:-1:2])
+                    self.assertTrue(set(expected) <= actual)
+                    for j in actual:
+                        self.assertNotEqual(i, j)
+
+    def test_shards(self):
+        path = self._write_counts(self._gen_counts(23, 12, 20))
+        args = [config.MEASURES_COUNT_NXN_EXE, "-m", "C", "-f", "M", path]
+        expected = _run(*args).stdout
+
+        paths = []
+        for i in range(1, 4):
+            completion = _run(args[0], "--shard", f"{i}/3", *args[1:])
+            self.assertEqual(0, completion.returncode, completion.stderr)
+            shard_path = self.tmpdir / f"shard_{i}.txt"
+            shard_path.write_text(completion.stdout)
+            paths.append(shard_path)
+        completion = _run(config.MEASURES_MERGE_EXE, *paths)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        self.assertEqual(expected, completion.stdout)
+
+    def test_invalid_input(self):
+        contents = {
+            "negative": "1 2 3\n1 -2 3\n",
+            "non-numeric": "1 2 3\n1 x 3\n",
+            "too large": "1 2 3\n1 65536 3\n",
+            "ragged": "1 2 3\n1 2\n",
+        }
+        for name, content in contents.items():
+            with self.subTest(name=name):
+                path = self.tmpdir / "invalid.txt"
+                path.write_text(content)
+                completion = _run(config.MEASURES_COUNT_NXN_EXE, path)
+                self.assertNotEqual(0, completion.returncode)
+                self.assertTrue("Line 2 of" in completion.stderr)
+
+    def test_invalid_alpha(self):
+        path = self._write_counts(self._gen_counts(3, 4, 5))
+        for alpha in [0.0, 2.0]:
+            completion = _run(
+                config.MEASURES_COUNT_NXN_EXE, "-m", "V", "-a", alpha, path
+            )
+            self.assertNotEqual(0, completion.returncode)
+            self.assertTrue("Tversky alpha" in completion.stderr)
+
+    def _gen_counts(self, num_vectors, num_features, max_count):
+        rng = random.Random(num_vectors * num_features + max_count)
+        result = []
+        for _ in range(num_vectors):
+            # Leave some features absent, as is typical of count data.
+            result.append(
+                [
+                    rng.randint(1, max_count) if rng.random() < 0.6 else 0
+                    for _ in range(num_features)
+                ]
+            )
+        return result
+
+    def _write_counts(self, counts):
+        path = self.tmpdir / "counts.txt"
+        path.write_text(
+            "".join(" ".join(str(c) for c in v) + "\n" for v in counts)
+        )
+        return path
+
+    def _verify_measures(self, counts):
+        path = self._write_counts(counts)
+        measures = [
+            ("T", [], _tanimoto),
+            ("V", ["-a", 0.4], _tversky(0.4)),
+            ("V", ["-a", 1.5], _tversky(1.5)),
+            ("E", [], _euclidean),
+            ("C", [], _cosine),
+        ]
+        for measure, args, ref_measure in measures:
+            for compute_sim in [True, False]:
+                with self.subTest(measure=measure, args=args, sim=compute_sim):
+                    all_args = ["-m", measure, *args, "-f", "O"]
+                    if not compute_sim:
+                        all_args.append("-d")
+                    completion = _run(
+                        config.MEASURES_COUNT_NXN_EXE, *all_args, path
+                    )
+                    self.assertEqual(0, completion.returncode, completion.stderr)
+                    lines = completion.stdout.splitlines()
+                    self.assertEqual(len(counts) ** 2, len(lines))
+                    for line in lines:
+                        i, j, value = line.split()
+                        i, j = int(i), int(j)
+                        sim = 1.0 if i == j else ref_measure(counts, i, j)
+                        expected = sim if compute_sim else 1.0 - sim
+                        self.assertAlmostEqual(expected, float(value), places=4)
+
+
+def main():
+    logging.basicConfig(level=logging.DEBUG)
+    unittest.main()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,153 @@
+#!/usr/bin/env python
+"""Unit test for sharded measures jobs and measures_merge.
+Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import logging
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+
+import config
+
+# Each line of a shape fingerprint file is also a plain fingerprint.
+SAMPLE_FPS = config.SHARED_DATA_DIR / "measures" / "in" / "sample_shape_fps.txt"
+
+
+def _run(*args):
+    return subprocess.run(
+        [str(arg) for arg in args], capture_output=True, encoding="utf8"
+    )
+
+
+class TestCase(unittest.TestCase):
+    def setUp(self):
+        self._tmpdir = tempfile.TemporaryDirectory()
+        self.tmpdir = Path(self._tmpdir.name)
+
+    def tearDown(self):
+        self._tmpdir.cleanup()
+
+    def test_no_args(self):
+        completion = _run(config.MEASURES_MERGE_EXE)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("usage:" in completion.stderr.lower())
+
+    def test_measures_nxn(self):
+        for fmt in ["M", "S", "O"]:
+            with self.subTest(fmt=fmt):
+                self._verify_merge(
+                    [config.MEASURES_NXN_EXE, "-f", fmt, "-t", 0.6, SAMPLE_FPS],
+                    "--shard",
+                    num_shards=5,
+                )
+
+    def test_measures_shape_fp(self):
+        arg_lists = [
+            ["-f", "M"],
+            ["-f", "S", "-t", 0.5],
+            ["-f", "S", "-s", 5, "-d", "-t", 0.8],
+            ["-f", "P", "-s", 6, "-t", 0.3],
+            ["-m", "V", "-a", 0.3, "-f", "M"],
+        ]
+        for args in arg_lists:
+            with self.subTest(args=args):
+                self._verify_merge(
+                    [config.MEASURES_SHAPE_FP_EXE, *args, SAMPLE_FPS],
+                    "-p",
+                    num_shards=3,
+                )
+
+    def test_measures_sim(self):
+        # Tversky output is written in two sections, which must be
+        # interleaved when merged.
+        arg_lists = [
+            ["-T", "-S", "-S", 20, 0.5],
+            ["-V", "-D", "-S", 20, 0.3, 0.6],
+            ["-V", "-S", "-M", 20, 0.3],
+            ["-V", "-S", "-O", 20, 0.3],
+        ]
+        for args in arg_lists:
+            with self.subTest(args=args):
+                self._verify_merge(
+                    [config.MEASURES_SIM_EXE, SAMPLE_FPS, *args],
+                    "--shard",
+                    num_shards=4,
+                )
+
+    def test_more_shards_than_rows(self):
+        self._verify_merge(
+            [config.MEASURES_SIM_EXE, SAMPLE_FPS, "-T", "-S", "-M", 3],
+            "--shard",
+            num_shards=5,
+        )
+
+    def test_invalid_shard(self):
+        for spec in ["0/4", "5/4", "x"]:
+            completion = _run(
+                config.MEASURES_NXN_EXE, "--shard", spec, SAMPLE_FPS
+            )
+            self.assertNotEqual(0, completion.returncode)
+            self.assertTrue("Invalid shard" in completion.stderr)
+
+    def test_missing_shard(self):
+        paths = self._run_shards([config.MEASURES_NXN_EXE, SAMPLE_FPS], 3)
+        completion = _run(config.MEASURES_MERGE_EXE, paths[0], paths[2])
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("Expected 3 shard files" in completion.stderr)
+
+        completion = _run(config.MEASURES_MERGE_EXE, *paths[:2], paths[0])
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("missing or duplicated" in completion.stderr)
+
+    def test_incomplete_shard(self):
+        paths = self._run_shards([config.MEASURES_NXN_EXE, SAMPLE_FPS], 3)
+        # Simulate a shard process that was killed before finishing.
+        lines = paths[1].read_text().splitlines(keepends=True)
+        paths[1].write_text("".join(lines[:-2]))
+
+        completion = _run(config.MEASURES_MERGE_EXE, *paths)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("is incomplete" in completion.stderr)
+
+    def test_mismatched_jobs(self):
+        paths = self._run_shards([config.MEASURES_NXN_EXE, SAMPLE_FPS], 2)
+        other_paths = self._run_shards(
+            [config.MEASURES_SIM_EXE, SAMPLE_FPS, "-T", "-S", "-M", 10], 2
+        )
+        completion = _run(config.MEASURES_MERGE_EXE, paths[0], other_paths[1])
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("different job" in completion.stderr)
+
+    def _run_shards(self, args, num_shards, shard_flag="--shard"):
+        result = []
+        run_dir = Path(tempfile.mkdtemp(dir=self.tmpdir))
+        for i in range(1, num_shards + 1):
+            shard_args = [args[0], shard_flag, f"{i}/{num_shards}", *args[1:]]
+            completion = _run(*shard_args)
+            self.assertEqual(0, completion.returncode, completion.stderr)
+            path = run_dir / f"shard_{i}.txt"
+            path.write_text(completion.stdout)
+            result.append(path)
+        return result
+
+    def _verify_merge(self, args, shard_flag, num_shards):
+        completion = _run(*args)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        expected = completion.stdout
+
+        paths = self._run_shards(args, num_shards, shard_flag)
+        # Shards may be given in any order.
+        completion = _run(config.MEASURES_MERGE_EXE, *reversed(paths))
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        self.assertEqual(expected, completion.stdout)
+
+
+def main():
+    logging.basicConfig(level=logging.DEBUG)
+    unittest.main()
+
+
+if __name__ == "__main__":
+    main()
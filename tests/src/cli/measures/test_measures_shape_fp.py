@@ -34,6 +34,8 @@ class CmdLineArgs:
     output_format: tp.Optional[str]
     sparse_threshold: tp.Optional[float]
     fingerprint_path: Path
+    screen_bits: tp.Optional[int] = None
+    screen_margin: tp.Optional[float] = None
 
     def as_subprocess_args(self):
         """Convert to a subprocess.run argument list."""
@@ -50,6 +52,10 @@ class CmdLineArgs:
             raw_args += ["-f", self.output_format]
         if self.sparse_threshold is not None:
             raw_args += ["-t", self.sparse_threshold]
+        if self.screen_bits is not None:
+            raw_args += ["--screen-bits", self.screen_bits]
+        if self.screen_margin is not None:
+            raw_args += ["--screen-margin", self.screen_margin]
         raw_args.append(self.fingerprint_path)
         return [str(arg) for arg in raw_args]
 
@@ -350,6 +356,178 @@ class TestCase(unittest.TestCase):
 
             self.assertEqual(len(diffs), 0)
 
+    def test_screening_wide_margin(self):
+        """With a wide margin, prefix screening should not change results."""
+        with fp_file_generator.ShapeFPFileGenerator(4) as fp_gen:
+            fp_filename = Path(fp_gen.pathname())
+            thresh = 0.5
+            args = CmdLineArgs(
+                measure="T",
+                tversky_alpha=None,
+                compute_similarity=True,
+                search_index=None,
+                output_format="S",
+                sparse_threshold=thresh,
+                fingerprint_path=fp_filename,
+                screen_bits=2,
+                screen_margin=1.0,
+            )
+            completion = self._run_with_args(args)
+            self.assertEqual(0, completion.returncode)
+
+            meas = shape_measure.Tani()
+            fpm = fp_measurer.FPSimMeasurer(
+                meas, fp_gen.numbits(), fp_gen.fingerprints()
+            )
+            verifier = rv.SparseMatrix(fpm, None, thresh)
+
+            inf = io.StringIO(completion.stdout)
+            diffs = list(verifier.diffs(inf))
+            self.assertEqual(len(diffs), 0)
+
+    def test_screening_keeps_full_values(self):
+        """Screening may drop pairs, but any pair it outputs should have the
+        same value as without screening."""
+        with fp_file_generator.ShapeFPFileGenerator(4) as fp_gen:
+            fp_filename = Path(fp_gen.pathname())
+            for compute_sim, thresh in [(True, 0.5), (False, 0.5)]:
+                kw = dict(
+                    measure="T",
+                    tversky_alpha=None,
+                    compute_similarity=compute_sim,
+                    search_index=2,
+                    output_format="P",
+                    sparse_threshold=thresh,
+                    fingerprint_path=fp_filename,
+                )
+                full = self._run_with_args(CmdLineArgs(**kw))
+                self.assertEqual(0, full.returncode)
+                screened = self._run_with_args(
+                    CmdLineArgs(**kw, screen_bits=2, screen_margin=0.0)
+                )
+                self.assertEqual(0, screened.returncode)
+
+                full_rows = full.stdout.splitlines()
+                screened_rows = screened.stdout.splitlines()
+                self.assertEqual(len(full_rows), len(screened_rows))
+                for full_row, screened_row in zip(full_rows, screened_rows):
+                    full_values = self._pvm_row_values(full_row)
+                    screened_values = self._pvm_row_values(screened_row)
+                    for j, value in screened_values.items():
+                        self.assertEqual(full_values[j], value)
+
+    def test_screening_invalid_args(self):
+        with fp_file_generator.ShapeFPFileGenerator(4) as fp_gen:
+            fp_filename = fp_gen.pathname()
+            for opts in [["--screen-bits", "0"], ["--screen-margin", "-1"]]:
+                completion = subprocess.run(
+                    [str(EXE)] + opts + [fp_filename],
+                    capture_output=True,
+                    encoding="utf8",
+                )
+                self.assertNotEqual(0, completion.returncode)
+                self.assertTrue("--screen-" in completion.stderr)
+
+    def test_matrix_ignores_screening(self):
+        with fp_file_generator.ShapeFPFileGenerator(4) as fp_gen:
+            completion = subprocess.run(
+                [str(EXE), "-f", "M", "--screen-bits", "2", fp_gen.pathname()],
+                capture_output=True,
+                encoding="utf8",
+            )
+            self.assertEqual(0, completion.returncode)
+            self.assertTrue(
+                "--screen-bits is ignored" in completion.stderr.lower()
+            )
+
+    def test_compressed_database(self):
+        """Compressed databases should give the same results as text files."""
+        with (
+            fp_file_generator.ShapeFPFileGenerator(4) as fp_gen,
+            tempfile.TemporaryDirectory() as tmpdir,
+        ):
+            db_path = Path(tmpdir) / "fps.sfpz"
+            completion = subprocess.run(
+                [
+                    str(config.SHAPE_FP_PACK_EXE),
+                    "-c",
+                    fp_gen.pathname(),
+                    str(db_path),
+                ],
+                capture_output=True,
+                encoding="utf8",
+            )
+            self.assertEqual(0, completion.returncode, completion.stderr)
+
+            for opts in [
+                ["-f", "M"],
+                ["-f", "S", "-t", "0.5"],
+                ["-f", "P", "-t", "0.5", "-s", "2", "-d"],
+            ]:
+                expected = subprocess.run(
+                    [str(EXE)] + opts + [fp_gen.pathname()],
+                    capture_output=True,
+                    encoding="utf8",
+                )
+                actual = subprocess.run(
+                    [str(EXE)] + opts + [str(db_path)],
+                    capture_output=True,
+                    encoding="utf8",
+                )
+                self.assertEqual(0, actual.returncode, actual.stderr)
+                self.assertEqual(expected.stdout, actual.stdout)
+
+    def test_segmented_database(self):
+        """Packed and segmented databases should give the same results as text
+        files.  A segmented database's segments are read as one database."""
+        with (
+            fp_file_generator.ShapeFPFileGenerator(4) as fp_gen,
+            tempfile.TemporaryDirectory() as tmpdir,
+        ):
+            lines = Path(fp_gen.pathname()).read_text().splitlines(keepends=True)
+            # Split on a shape boundary, so each segment holds whole shapes.
+            split = 4 * (len(lines) // 8)
+            db_dir = Path(tmpdir) / "fps.db"
+            for i, part in enumerate([lines[:split], lines[split:]]):
+                part_path = Path(tmpdir) / f"part_{i}.txt"
+                part_path.write_text("".join(part))
+                self._run_tool(config.SHAPE_FP_APPEND_EXE, part_path, db_dir)
+            packed_path = Path(tmpdir) / "fps.sfp"
+            self._run_tool(config.SHAPE_FP_PACK_EXE, fp_gen.pathname(), packed_path)
+
+            for opts in [
+                ["-f", "M"],
+                ["-f", "S", "-t", "0.5"],
+                ["-f", "P", "-t", "0.5", "-s", "2", "-d"],
+            ]:
+                expected = subprocess.run(
+                    [str(EXE)] + opts + [fp_gen.pathname()],
+                    capture_output=True,
+                    encoding="utf8",
+                )
+                for db_path in [db_dir, packed_path]:
+                    with self.subTest(opts=opts, db_path=db_path.name):
+                        actual = subprocess.run(
+                            [str(EXE)] + opts + [str(db_path)],
+                            capture_output=True,
+                            encoding="utf8",
+                        )
+                        self.assertEqual(0, actual.returncode, actual.stderr)
+                        self.assertEqual(expected.stdout, actual.stdout)
+
+    def _run_tool(self, exe: Path, *args: tp.Any) -> None:
+        completion = subprocess.run(
+            [str(exe)] + [str(arg) for arg in args],
+            capture_output=True,
+            encoding="utf8",
+        )
+        self.assertEqual(0, completion.returncode, completion.stderr)
+
+    def _pvm_row_values(self, row: str) -> tp.Dict[str, str]:
+        fields = row.split()
+        self.assertEqual("-1", fields[-1])
+        return dict(zip(fields[:-1:2], fields[1:-1:2]))
+
     def _run_with_args(self, args: CmdLineArgs) -> subprocess.CompletedProcess:
         return subprocess.run(
             args.as_subprocess_args(), capture_output=True, encoding="utf8"
@@ -0,0 +1,96 @@
+#!/usr/bin/env python
+"""Unit test for shape_cluster.
+Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import logging
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+
+import config
+
+SAMPLE_FPS = config.SHARED_DATA_DIR / "measures" / "in" / "sample_shape_fps.txt"
+NUM_SAMPLE_SHAPES = 16
+
+
+class TestCase(unittest.TestCase):
+    def test_no_args(self):
+        """Verify usage is shown when no args are provided."""
+        completion = self._run()
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("usage:" in completion.stderr.lower())
+        self.assertTrue("missing argument" in completion.stderr.lower())
+
+    def test_help(self):
+        completion = self._run("--help")
+        self.assertEqual(0, completion.returncode)
+        self.assertTrue("usage:" in completion.stderr.lower())
+
+    def test_assignments_and_centroids(self):
+        with tempfile.TemporaryDirectory() as dirname:
+            centroids_path = Path(dirname) / "centroids.txt"
+            assignments = self._assignments(
+                "-t", 0.6, "-c", centroids_path, SAMPLE_FPS
+            )
+            self.assertEqual(list(range(NUM_SAMPLE_SHAPES)), list(assignments))
+
+            centroids = [
+                [int(field) for field in line.split()]
+                for line in centroids_path.read_text().splitlines()
+            ]
+
+        self.assertEqual(len(centroids), len(set(assignments.values())))
+        for cluster, centroid, size in centroids:
+            # Every centroid belongs to its own cluster.
+            self.assertEqual(cluster, assignments[centroid])
+            members = [i for i, c in assignments.items() if c == cluster]
+            self.assertEqual(size, len(members))
+        # Clusters are created in order of decreasing neighbor count.
+        self.assertGreaterEqual(centroids[0][2], centroids[-1][2])
+
+    def test_spilled_results_match(self):
+        with tempfile.TemporaryDirectory() as dirname:
+            in_memory = self._assignments("-t", 0.6, SAMPLE_FPS)
+            spilled = self._assignments(
+                "-t", 0.6, "-b", 0, "-s", dirname, SAMPLE_FPS
+            )
+            self.assertEqual(in_memory, spilled)
+            # Spill files are removed on exit.
+            self.assertEqual([], list(Path(dirname).iterdir()))
+
+    def test_singletons(self):
+        assignments = self._assignments("-t", 1.01, SAMPLE_FPS)
+        self.assertEqual(NUM_SAMPLE_SHAPES, len(set(assignments.values())))
+
+    def test_non_existent_fp_file(self):
+        completion = self._run(str(SAMPLE_FPS) + ".non_existent")
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue(
+            "cannot open fingerprint file" in completion.stderr.lower()
+        )
+
+    def _assignments(self, *args):
+        completion = self._run(*args)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        result = {}
+        for line in completion.stdout.splitlines():
+            index, cluster = line.split()
+            result[int(index)] = int(cluster)
+        return result
+
+    def _run(self, *args):
+        all_args = [config.SHAPE_CLUSTER_EXE] + list(args)
+        return subprocess.run(
+            [str(arg) for arg in all_args], capture_output=True, encoding="utf8"
+        )
+
+
+def main():
+    logging.basicConfig(level=logging.DEBUG)
+    unittest.main()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,251 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/popcount_index.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+#include "shape_search.hpp"
+
+namespace mesaac::cli::measures {
+namespace {
+using mesaac::measures::shape::FPsPerShape;
+using mesaac::measures::shape::PackedShapeFPWriter;
+using mesaac::measures::shape::PopcountIndex;
+using mesaac::measures::shape::SegmentedShapeFPs;
+using mesaac::shape::ShapeFingerprint;
+using mesaac::shape::ShapeFingerprintVector;
+
+ShapeFingerprintVector random_sfps(unsigned int num_shapes,
+                                   unsigned int num_bits) {
+  std::mt19937 gen(20101118);
+  ShapeFingerprintVector result(num_shapes);
+  for (auto &sfp : result) {
+    for (unsigned int k = 0; k != FPsPerShape; ++k) {
+      shape_defs::BitVector fp(num_bits);
+      for (unsigned int b = 0; b != num_bits; ++b) {
+        fp[b] = gen() & 1;
+      }
+      sfp.push_back(fp);
+    }
+  }
+  return result;
+}
+
+SearchRequest make_request(const ShapeFingerprint &query) {
+  return {.database = "",
+          .measure_code = 'T',
+          .tversky_alpha = 0.0,
+          .compute_similarity = true,
+          .threshold = 0.0,
+          .max_hits = 0,
+          .query = query};
+}
+} // namespace
+
+TEST_CASE("mesaac::cli::measures::search", "[mesaac]") {
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_shape_search.bin";
+  const unsigned int num_bits = 100;
+  const auto sfps = random_sfps(20, num_bits);
+  {
+    PackedShapeFPWriter writer(path, num_bits);
+    for (const auto &sfp : sfps) {
+      writer.write(sfp);
+    }
+  }
+  const SegmentedShapeFPs db(path);
+
+  const auto measurer = mesaac::measures::shape::get_shape_pair_measurer(
+      mesaac::measures::get_measures(mesaac::measures::MeasureType::tanimoto,
+                                     0.0),
+      true);
+  std::vector<float> expected;
+  for (const auto &sfp : sfps) {
+    expected.push_back(measurer->value(sfps[0], sfp));
+  }
+
+  SECTION("Threshold search") {
+    SearchRequest request(make_request(sfps[0]));
+    request.threshold = 0.4;
+    const SearchResponse response(search(db, request));
+    REQUIRE(response.error.empty());
+    unsigned int h = 0;
+    for (unsigned int i = 0; i < sfps.size(); ++i) {
+      if (expected[i] >= request.threshold) {
+        REQUIRE(h < response.hits.size());
+        REQUIRE(response.hits[h].index == i);
+        REQUIRE(response.hits[h].value == expected[i]);
+        h++;
+      }
+    }
+    REQUIRE(h == response.hits.size());
+  }
+
+  SECTION("Best hits") {
+    SearchRequest request(make_request(sfps[0]));
+    request.max_hits = 5;
+    const SearchResponse response(search(db, request));
+    REQUIRE(response.error.empty());
+    REQUIRE(response.hits.size() == 5);
+    REQUIRE(response.hits[0].index == 0);
+    std::vector<float> best(expected);
+    std::sort(best.rbegin(), best.rend());
+    for (unsigned int h = 0; h < 5; ++h) {
+      REQUIRE(response.hits[h].value == best[h]);
+    }
+
+    request.compute_similarity = false;
+    request.threshold = 1.0;
+    const SearchResponse nearest(search(db, request));
+    REQUIRE(nearest.hits.size() == 5);
+    REQUIRE(nearest.hits[0].index == 0);
+    REQUIRE(nearest.hits[0].value == 0.0);
+  }
+
+  SECTION("Popcount index") {
+    const auto index_path =
+        std::filesystem::temp_directory_path() / "test_shape_search.idx";
+    mesaac::measures::shape::write_popcount_index(db, index_path);
+    const PopcountIndex index(index_path);
+    for (const unsigned int max_hits : {0u, 3u}) {
+      SearchRequest request(make_request(sfps[1]));
+      request.threshold = 0.3;
+      request.max_hits = max_hits;
+      const SearchResponse expected_response(search(db, request));
+      const SearchResponse response(search(index, request));
+      REQUIRE(response.error.empty());
+      REQUIRE(response.hits.size() == expected_response.hits.size());
+      for (unsigned int h = 0; h < response.hits.size(); ++h) {
+        REQUIRE(response.hits[h].index == expected_response.hits[h].index);
+        REQUIRE(response.hits[h].value == expected_response.hits[h].value);
+      }
+    }
+
+    SearchRequest request(make_request(random_sfps(1, num_bits + 1)[0]));
+    REQUIRE(!search(index, request).error.empty());
+    std::filesystem::remove(index_path);
+  }
+
+  SECTION("Invalid requests") {
+    SearchRequest request(make_request(random_sfps(1, num_bits + 1)[0]));
+    REQUIRE(!search(db, request).error.empty());
+
+    request = make_request(sfps[0]);
+    request.measure_code = 'X';
+    REQUIRE(!search(db, request).error.empty());
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("mesaac::cli::measures::search protocol", "[mesaac]") {
+  int fds[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  const Socket client(fds[0]), server(fds[1]);
+
+  SearchRequest request(make_request(random_sfps(1, 130)[0]));
+  request.database = "cox2";
+  request.measure_code = 'V';
+  request.tversky_alpha = 0.25;
+  request.compute_similarity = false;
+  request.threshold = 0.75;
+  request.max_hits = 10;
+  send_request(client.fd(), request);
+
+  const auto received = receive_request(server.fd());
+  REQUIRE(received.has_value());
+  REQUIRE(received->database == request.database);
+  REQUIRE(received->measure_code == request.measure_code);
+  REQUIRE(received->tversky_alpha == request.tversky_alpha);
+  REQUIRE(received->compute_similarity == request.compute_similarity);
+  REQUIRE(received->threshold == request.threshold);
+  REQUIRE(received->max_hits == request.max_hits);
+  REQUIRE(received->query == request.query);
+
+  SearchResponse response;
+  response.hits = {{.index = 3, .value = 0.5}, {.index = 7, .value = 0.25}};
+  send_response(server.fd(), response);
+  const SearchResponse received_response(receive_response(client.fd()));
+  REQUIRE(received_response.error.empty());
+  REQUIRE(received_response.hits.size() == 2);
+  REQUIRE(received_response.hits[1].index == 7);
+  REQUIRE(received_response.hits[1].value == 0.25);
+
+  response.error = "No such database.";
+  send_response(server.fd(), response);
+  REQUIRE(receive_response(client.fd()).error == response.error);
+
+  // A closed connection ends the request stream.
+  ::shutdown(client.fd(), SHUT_WR);
+  REQUIRE(!receive_request(server.fd()).has_value());
+}
+
+TEST_CASE("mesaac::cli::measures::RequestReader", "[mesaac]") {
+  int fds[2];
+  REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  const Socket client(fds[0]), server(fds[1]);
+
+  const unsigned int num_bits = 130;
+  SearchRequest request(make_request(random_sfps(1, num_bits)[0]));
+  request.database = std::string(MaxDatabaseNameBytes, 'd');
+
+  // Capture one request's bytes, to send them a piece at a time.
+  send_request(client.fd(), request);
+  std::string bytes(max_request_bytes(num_bits) + 4, '\0');
+  const ssize_t num_bytes = ::read(server.fd(), bytes.data(), bytes.size());
+  REQUIRE(num_bytes > 4);
+  bytes.resize(num_bytes);
+  REQUIRE(bytes.size() == max_request_bytes(num_bits) + 4);
+
+  SECTION("Partial requests") {
+    RequestReader reader(max_request_bytes(num_bits));
+    REQUIRE(reader.read_available(server.fd()));
+    REQUIRE(!reader.take_request().has_value());
+
+    // The length prefix, and then the payload, arrive in pieces.
+    size_t begin = 0;
+    for (const size_t end : {size_t(2), size_t(9), bytes.size()}) {
+      REQUIRE(::write(client.fd(), bytes.data() + begin, end - begin) ==
+              ssize_t(end - begin));
+      REQUIRE(reader.read_available(server.fd()));
+      REQUIRE(reader.take_request().has_value() == (end == bytes.size()));
+      begin = end;
+    }
+
+    // Only one request is read at a time.
+    send_request(client.fd(), request);
+    send_request(client.fd(), request);
+    REQUIRE(reader.read_available(server.fd()));
+    REQUIRE(reader.take_request()->query == request.query);
+    REQUIRE(reader.read_available(server.fd()));
+    REQUIRE(reader.take_request()->database == request.database);
+
+    ::shutdown(client.fd(), SHUT_WR);
+    REQUIRE(!reader.read_available(server.fd()));
+  }
+
+  SECTION("Oversized requests") {
+    RequestReader reader(max_request_bytes(num_bits - 64));
+    REQUIRE(::write(client.fd(), bytes.data(), 4) == 4);
+    REQUIRE_THROWS_AS(reader.read_available(server.fd()), std::runtime_error);
+
+    request.database += 'd';
+    REQUIRE_THROWS_AS(send_request(client.fd(), request),
+                      std::invalid_argument);
+  }
+
+  SECTION("Closed in mid-message") {
+    RequestReader reader(max_request_bytes(num_bits));
+    REQUIRE(::write(client.fd(), bytes.data(), 9) == 9);
+    ::shutdown(client.fd(), SHUT_WR);
+    REQUIRE_THROWS_AS(reader.read_available(server.fd()), std::runtime_error);
+  }
+}
+} // namespace mesaac::cli::measures
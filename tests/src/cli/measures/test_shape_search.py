@@ -0,0 +1,311 @@
+#!/usr/bin/env python
+"""Unit test for shape_search_server and shape_search_client.
+Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import logging
+import socket
+import struct
+import subprocess
+import tempfile
+import time
+import unittest
+from pathlib import Path
+
+import config
+
+SAMPLE_FPS = config.SHARED_DATA_DIR / "measures" / "in" / "sample_shape_fps.txt"
+# Each shape fingerprint is 4 lines, one per orientation.
+NUM_QUERY_LINES = 16
+
+
+def _run(*args):
+    return subprocess.run(
+        [str(arg) for arg in args], capture_output=True, encoding="utf8"
+    )
+
+
+class TestCase(unittest.TestCase):
+    def setUp(self):
+        self._tmpdir = tempfile.TemporaryDirectory()
+        self.tmpdir = Path(self._tmpdir.name)
+
+        lines = SAMPLE_FPS.read_text().splitlines(keepends=True)
+        self.query_path = self.tmpdir / "queries.txt"
+        self.query_path.write_text("".join(lines[:NUM_QUERY_LINES]))
+        targets_path = self.tmpdir / "targets.txt"
+        targets_path.write_text("".join(lines[NUM_QUERY_LINES:]))
+
+        self.socket_path = self.tmpdir / "search.sock"
+        db_paths = [self.tmpdir / "targets.db", self.tmpdir / "sample.db"]
+        for fps_path, db_path in zip([targets_path, SAMPLE_FPS], db_paths):
+            completion = _run(config.SHAPE_FP_PACK_EXE, fps_path, db_path)
+            self.assertEqual(0, completion.returncode, completion.stderr)
+
+        # A segmented database, which starts with the first two targets.
+        self.growing_dir = self.tmpdir / "growing"
+        self.growing_rest = self.tmpdir / "growing_rest.txt"
+        self.growing_rest.write_text("".join(lines[NUM_QUERY_LINES + 8 :]))
+        growing_start = self.tmpdir / "growing_start.txt"
+        growing_start.write_text("".join(lines[NUM_QUERY_LINES : NUM_QUERY_LINES + 8]))
+        completion = _run(config.SHAPE_FP_APPEND_EXE, growing_start, self.growing_dir)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        db_paths.append(self.growing_dir)
+
+        # A popcount index of the targets.
+        self.index_path = self.tmpdir / "indexed.idx"
+        completion = _run(config.SHAPE_FP_INDEX_EXE, db_paths[0], self.index_path)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        db_paths.append(self.index_path)
+
+        self.server = subprocess.Popen(
+            [
+                str(config.SHAPE_SEARCH_SERVER_EXE),
+                "-j",
+                "2",
+                str(self.socket_path),
+            ]
+            + [str(path) for path in db_paths],
+            stderr=subprocess.PIPE,
+            encoding="utf8",
+        )
+        for _ in range(100):
+            if self.socket_path.exists():
+                break
+            time.sleep(0.05)
+        self.assertTrue(self.socket_path.exists())
+
+    def tearDown(self):
+        self.server.terminate()
+        self.server.wait(timeout=10)
+        self.server.stderr.close()
+        self._tmpdir.cleanup()
+
+    def test_no_args(self):
+        for exe in [
+            config.SHAPE_SEARCH_SERVER_EXE,
+            config.SHAPE_SEARCH_CLIENT_EXE,
+        ]:
+            completion = _run(exe)
+            self.assertNotEqual(0, completion.returncode)
+            self.assertTrue("usage:" in completion.stderr.lower())
+
+    def test_threshold_matches_measures_shape_fp(self):
+        num_queries = NUM_QUERY_LINES // 4
+        for fmt in ["S", "P"]:
+            for args in [
+                ["-t", "0.4"],
+                ["-d", "-t", "0.6"],
+                ["-m", "V", "-a", "0.3", "-t", "0.37"],
+            ]:
+                expected = _run(
+                    config.MEASURES_SHAPE_FP_EXE,
+                    "-s",
+                    num_queries,
+                    "-f",
+                    fmt,
+                    *args,
+                    SAMPLE_FPS,
+                )
+                self.assertEqual(0, expected.returncode, expected.stderr)
+                if fmt == "S":
+                    # measures_shape_fp numbers its search columns from the
+                    # start of the file, not from the first target.
+                    expected_rows = [
+                        self._renumber(line, num_queries)
+                        for line in expected.stdout.splitlines()
+                    ]
+                else:
+                    expected_rows = expected.stdout.splitlines()
+                self.assertEqual(expected_rows, self._search("-f", fmt, *args))
+
+    def test_max_hits(self):
+        rows = self._search("-D", "sample", "-k", 3, "-f", "P")
+        self.assertEqual(NUM_QUERY_LINES // 4, len(rows))
+        for i, row in enumerate(rows):
+            fields = row.split()
+            self.assertEqual("-1", fields[-1])
+            indices = [int(index) for index in fields[:-1:2]]
+            values = [float(value) for value in fields[1:-1:2]]
+            self.assertEqual(3, len(indices))
+            # Each query is also in the sample database.
+            self.assertEqual(1.0, values[0])
+            self.assertEqual(sorted(values, reverse=True), values)
+
+    def test_segmented_database_grows(self):
+        for row in self._search("-D", "growing", "-f", "P"):
+            indices = [int(index) for index in row.split()[:-1:2]]
+            self.assertTrue(all(index < 2 for index in indices))
+
+        # The server picks up new segments without a restart.
+        completion = _run(
+            config.SHAPE_FP_APPEND_EXE, self.growing_rest, self.growing_dir
+        )
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        expected = self._search("-D", "targets", "-t", 0.3)
+        self.assertEqual(expected, self._search("-D", "growing", "-t", 0.3))
+
+        completion = _run(config.SHAPE_FP_COMPACT_EXE, self.growing_dir)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        self.assertEqual(expected, self._search("-D", "growing", "-t", 0.3))
+
+    def test_popcount_index(self):
+        for args in [
+            ["-t", "0.4"],
+            ["-d", "-t", "0.6"],
+            ["-m", "V", "-a", "0.3", "-t", "0.37"],
+            ["-m", "E", "-t", "0.5"],
+            ["-m", "B", "-k", 3],
+        ]:
+            expected = self._search("-D", "targets", "-f", "S", *args)
+            self.assertEqual(expected, self._search("-D", "indexed", "-f", "S", *args))
+
+    def test_measures_shape_fp_index(self):
+        for fmt in ["S", "P"]:
+            for args in [["-t", "0.4"], ["-m", "C", "-d", "-t", "0.5"]]:
+                completion = _run(
+                    config.MEASURES_SHAPE_FP_EXE,
+                    "-x",
+                    self.index_path,
+                    "-f",
+                    fmt,
+                    *args,
+                    self.query_path,
+                )
+                self.assertEqual(0, completion.returncode, completion.stderr)
+                self.assertEqual(
+                    self._search("-D", "targets", "-f", fmt, *args),
+                    completion.stdout.splitlines(),
+                )
+
+        completion = _run(
+            config.MEASURES_SHAPE_FP_EXE,
+            "-x",
+            self.index_path,
+            "-f",
+            "M",
+            self.query_path,
+        )
+        self.assertNotEqual(0, completion.returncode)
+
+    def test_minhash_index(self):
+        index_path = self.tmpdir / "minhash.idx"
+        completion = _run(
+            config.SHAPE_FP_INDEX_EXE,
+            "-b",
+            16,
+            "-r",
+            2,
+            self.tmpdir / "targets.db",
+            index_path,
+        )
+        self.assertEqual(0, completion.returncode, completion.stderr)
+
+        completion = _run(
+            config.MEASURES_SHAPE_FP_EXE,
+            "-x",
+            index_path,
+            "-f",
+            "P",
+            "-t",
+            "0.5",
+            self.query_path,
+        )
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        expected_rows = self._search("-D", "targets", "-f", "P", "-t", "0.5")
+        num_hits = 0
+        for row, expected_row in zip(completion.stdout.splitlines(), expected_rows):
+            # Hits are exact, but some may be missed.
+            hits = self._hits(row)
+            num_hits += len(hits)
+            self.assertTrue(hits.items() <= self._hits(expected_row).items())
+        self.assertTrue(num_hits > 0)
+
+    def test_unknown_database(self):
+        completion = _run(
+            config.SHAPE_SEARCH_CLIENT_EXE,
+            "-D",
+            "no_such_db",
+            self.socket_path,
+            self.query_path,
+        )
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("No database is named" in completion.stderr)
+
+    def test_idle_connections(self):
+        # The server has two threads.  Clients that stay connected without
+        # sending requests must not keep it from answering others.
+        idle = []
+        try:
+            for _ in range(3):
+                connection = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+                connection.connect(str(self.socket_path))
+                idle.append(connection)
+            completion = subprocess.run(
+                [
+                    str(config.SHAPE_SEARCH_CLIENT_EXE),
+                    "-t",
+                    "0.4",
+                    str(self.socket_path),
+                    str(self.query_path),
+                ],
+                capture_output=True,
+                encoding="utf8",
+                timeout=10,
+            )
+            self.assertEqual(0, completion.returncode, completion.stderr)
+            self.assertEqual(NUM_QUERY_LINES // 4, len(completion.stdout.splitlines()))
+        finally:
+            for connection in idle:
+                connection.close()
+
+    def test_stalled_requests(self):
+        stalled = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        oversized = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            # A client that stops in mid-request must not hold up others.
+            stalled.connect(str(self.socket_path))
+            stalled.sendall(struct.pack("=I", 100) + b"x")
+            rows = self._search("-t", 0.4)
+            self.assertEqual(NUM_QUERY_LINES // 4, len(rows))
+
+            # Requests far larger than any query are refused before they
+            # are read.
+            oversized.connect(str(self.socket_path))
+            oversized.settimeout(10)
+            oversized.sendall(struct.pack("=I", 1 << 30))
+            self.assertEqual(b"", oversized.recv(1))
+        finally:
+            stalled.close()
+            oversized.close()
+
+    def test_stop(self):
+        self.server.terminate()
+        self.assertEqual(0, self.server.wait(timeout=10))
+        self.assertFalse(self.socket_path.exists())
+
+    def _search(self, *args):
+        completion = _run(
+            config.SHAPE_SEARCH_CLIENT_EXE, *args, self.socket_path, self.query_path
+        )
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        return completion.stdout.splitlines()
+
+    def _hits(self, row):
+        fields = row.split()
+        return dict(zip(fields[:-1:2], fields[1:-1:2]))
+
+    def _renumber(self, line, offset):
+        fields = line.split()
+        for k in range(1, len(fields) - 1, 2):
+            fields[k] = str(int(fields[k]) - offset)
+        return " ".join(fields)
+
+
+def main():
+    logging.basicConfig(level=logging.DEBUG)
+    unittest.main()
+
+
+if __name__ == "__main__":
+    main()
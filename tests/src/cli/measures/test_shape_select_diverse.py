@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+"""Unit test for shape_select_diverse.
+Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import logging
+import subprocess
+import unittest
+
+import config
+
+SAMPLE_FPS = config.SHARED_DATA_DIR / "measures" / "in" / "sample_shape_fps.txt"
+NUM_SAMPLE_SHAPES = 16
+
+
+class TestCase(unittest.TestCase):
+    def test_no_args(self):
+        """Verify usage is shown when no args are provided."""
+        completion = self._run()
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("usage:" in completion.stderr.lower())
+        self.assertTrue("missing argument" in completion.stderr.lower())
+
+    def test_help(self):
+        completion = self._run("--help")
+        self.assertEqual(0, completion.returncode)
+        self.assertTrue("usage:" in completion.stderr.lower())
+
+    def test_max_min_selects_all(self):
+        """With no limit or threshold, MaxMin selects every shape once."""
+        indices = self._selected(SAMPLE_FPS)
+        self.assertEqual(0, indices[0])
+        self.assertEqual(list(range(NUM_SAMPLE_SHAPES)), sorted(indices))
+
+    def test_max_min_limit(self):
+        all_indices = self._selected(SAMPLE_FPS)
+        indices = self._selected("-n", 5, SAMPLE_FPS)
+        self.assertEqual(all_indices[:5], indices)
+
+    def test_first_index(self):
+        indices = self._selected("-i", 7, "-n", 3, SAMPLE_FPS)
+        self.assertEqual(3, len(indices))
+        self.assertEqual(7, indices[0])
+
+    def test_sphere_exclusion(self):
+        indices = self._selected("-p", "S", "-t", 1.0, SAMPLE_FPS)
+        # Every distance is <= 1.0, so the first pick excludes the rest.
+        self.assertEqual([0], indices)
+
+        indices = self._selected("-p", "S", "-t", 0.0, SAMPLE_FPS)
+        self.assertEqual(list(range(NUM_SAMPLE_SHAPES)), sorted(indices))
+
+    def test_invalid_first_index(self):
+        completion = self._run("-i", NUM_SAMPLE_SHAPES, SAMPLE_FPS)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("first index" in completion.stderr.lower())
+
+    def test_non_existent_fp_file(self):
+        completion = self._run(str(SAMPLE_FPS) + ".non_existent")
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue(
+            "cannot open fingerprint file" in completion.stderr.lower()
+        )
+
+    def _selected(self, *args):
+        completion = self._run(*args)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        return [int(line) for line in completion.stdout.split()]
+
+    def _run(self, *args):
+        all_args = [config.SHAPE_SELECT_DIVERSE_EXE] + list(args)
+        return subprocess.run(
+            [str(arg) for arg in all_args], capture_output=True, encoding="utf8"
+        )
+
+
+def main():
+    logging.basicConfig(level=logging.DEBUG)
+    unittest.main()
+
+
+if __name__ == "__main__":
+    main()
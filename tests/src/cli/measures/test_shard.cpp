@@ -0,0 +1,46 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "shard.hpp"
+
+namespace mesaac::cli::measures {
+TEST_CASE("mesaac::cli::measures::parse_shard", "[mesaac]") {
+  SECTION("Test valid shards") {
+    const Shard shard(parse_shard("2/4"));
+    REQUIRE(shard.index == 2);
+    REQUIRE(shard.count == 4);
+    REQUIRE(parse_shard("1/1").index == 1);
+  }
+  SECTION("Test invalid shards") {
+    for (const auto spec : {"", "2", "/4", "2/", "0/4", "5/4", "2/4x",
+                            "-1/4", "a/b", "2/0"}) {
+      REQUIRE_THROWS_AS(parse_shard(spec), std::invalid_argument);
+    }
+  }
+}
+
+TEST_CASE("mesaac::cli::measures::get_shard_rows", "[mesaac]") {
+  SECTION("Test shards partition the rows") {
+    for (unsigned int num_rows : {0, 1, 3, 16, 17, 1001}) {
+      for (unsigned int count : {1, 2, 3, 7}) {
+        unsigned int expected_begin = 0;
+        for (unsigned int index = 1; index <= count; ++index) {
+          const RowRange rows(get_shard_rows(Shard{index, count}, num_rows));
+          REQUIRE(rows.begin == expected_begin);
+          REQUIRE(rows.end >= rows.begin);
+          // Shards are balanced to within one row.
+          REQUIRE(rows.end - rows.begin <= num_rows / count + 1);
+          REQUIRE(rows.end - rows.begin >= num_rows / count);
+          expected_begin = rows.end;
+        }
+        REQUIRE(expected_begin == num_rows);
+      }
+    }
+  }
+  SECTION("Test large row counts") {
+    const unsigned int num_rows = 4000000000u;
+    const RowRange rows(get_shard_rows(Shard{3, 4}, num_rows));
+    REQUIRE(rows.begin == 2000000000u);
+    REQUIRE(rows.end == 3000000000u);
+  }
+}
+} // namespace mesaac::cli::measures
@@ -0,0 +1,201 @@
+#!/usr/bin/env python
+"""Unit test for usr_measures.
+Copyright (c) 2011 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import logging
+import random
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+
+import config
+
+
+def _run(*args):
+    return subprocess.run(
+        [str(arg) for arg in args], capture_output=True, encoding="utf8"
+    )
+
+
+def _usr_sim(a, b):
+    return 1.0 / (1.0 + sum(abs(x - y) for x, y in zip(a, b)) / len(a))
+
+
+def _sparse_rows(stdout):
+    """Parse sparse matrix rows into lists of (column, value)."""
+    result = []
+    for line in stdout.splitlines():
+        fields = line.split()
+        assert fields[-1] == "-1"
+        result.append(
+            [
+                (int(fields[k]), float(fields[k + 1]))
+                for k in range(0, len(fields) - 1, 2)
+            ]
+        )
+    return result
+
+
+class TestCase(unittest.TestCase):
+    def setUp(self):
+        self._tmpdir = tempfile.TemporaryDirectory()
+        self.tmpdir = Path(self._tmpdir.name)
+        self.vectors = self._gen_vectors(60, 12, seed=1)
+        self.usr_path = self._write_vectors("usr.txt", self.vectors)
+
+    def tearDown(self):
+        self._tmpdir.cleanup()
+
+    def test_no_args(self):
+        completion = _run(config.USR_MEASURES_EXE)
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("usage:" in completion.stderr.lower())
+
+    def test_ordered_pairs(self):
+        for compute_sim in [True, False]:
+            with self.subTest(compute_sim=compute_sim):
+                args = ["-f", "O"] + ([] if compute_sim else ["-d"])
+                completion = _run(
+                    config.USR_MEASURES_EXE, *args, self.usr_path
+                )
+                self.assertEqual(0, completion.returncode, completion.stderr)
+                lines = completion.stdout.splitlines()
+                self.assertEqual(len(self.vectors) ** 2, len(lines))
+                for line in lines:
+                    i, j, value = line.split()
+                    sim = _usr_sim(self.vectors[int(i)], self.vectors[int(j)])
+                    expected = sim if compute_sim else 1.0 - sim
+                    self.assertAlmostEqual(expected, float(value), places=5)
+
+    def test_matrix(self):
+        completion = _run(config.USR_MEASURES_EXE, "-f", "M", self.usr_path)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        rows = completion.stdout.splitlines()
+        self.assertEqual(len(self.vectors), len(rows))
+        for i, row in enumerate(rows):
+            values = [float(v) for v in row.split()]
+            self.assertEqual(len(self.vectors), len(values))
+            self.assertEqual(1.0, values[i])
+
+    def test_sparse_threshold(self):
+        threshold = 0.45
+        completion = _run(
+            config.USR_MEASURES_EXE, "-t", threshold, self.usr_path
+        )
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        rows = _sparse_rows(completion.stdout)
+        self.assertEqual(len(self.vectors), len(rows))
+        for i, row in enumerate(rows):
+            cols = [j for j, _ in row]
+            self.assertEqual(sorted(cols), cols)
+            self.assertFalse(i in cols)
+            for j, v in enumerate(self.vectors):
+                sim = _usr_sim(self.vectors[i], v)
+                # Skip values too close to the threshold to call.
+                if i != j and abs(sim - threshold) > 1.0e-5:
+                    self.assertEqual(sim > threshold, j in cols)
+
+    def test_top_k(self):
+        for compute_sim in [True, False]:
+            with self.subTest(compute_sim=compute_sim):
+                args = ["-k", 4] + ([] if compute_sim else ["-d"])
+                completion = _run(
+                    config.USR_MEASURES_EXE, *args, self.usr_path
+                )
+                self.assertEqual(0, completion.returncode, completion.stderr)
+                rows = _sparse_rows(completion.stdout)
+                for i, row in enumerate(rows):
+                    self.assertEqual(4, len(row))
+                    sims = sorted(
+                        (
+                            _usr_sim(self.vectors[i], v)
+                            for j, v in enumerate(self.vectors)
+                            if j != i
+                        ),
+                        reverse=True,
+                    )
+                    for (_, value), sim in zip(row, sims):
+                        expected = sim if compute_sim else 1.0 - sim
+                        self.assertAlmostEqual(expected, value, places=5)
+
+    def test_queries(self):
+        queries = self._gen_vectors(5, 12, seed=2)
+        query_path = self._write_vectors("queries.txt", queries)
+        completion = _run(
+            config.USR_MEASURES_EXE,
+            "-q",
+            query_path,
+            "-k",
+            3,
+            "-t",
+            0.2,
+            self.usr_path,
+        )
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        rows = _sparse_rows(completion.stdout)
+        self.assertEqual(len(queries), len(rows))
+        for query, row in zip(queries, rows):
+            ranked = sorted(
+                range(len(self.vectors)),
+                key=lambda j: (-_usr_sim(query, self.vectors[j]), j),
+            )
+            expected = [
+                j for j in ranked[:3] if _usr_sim(query, self.vectors[j]) >= 0.2
+            ]
+            self.assertEqual(expected, [j for j, _ in row])
+
+    def test_shards(self):
+        args = [config.USR_MEASURES_EXE, "-f", "M", self.usr_path]
+        expected = _run(*args).stdout
+        paths = []
+        for i in range(1, 5):
+            completion = _run(args[0], "--shard", f"{i}/4", *args[1:])
+            self.assertEqual(0, completion.returncode, completion.stderr)
+            path = self.tmpdir / f"shard_{i}.txt"
+            path.write_text(completion.stdout)
+            paths.append(path)
+        completion = _run(config.MEASURES_MERGE_EXE, *paths)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        self.assertEqual(expected, completion.stdout)
+
+    def test_invalid_input(self):
+        contents = {
+            "non-numeric": "1 2 3\n1 x 3\n",
+            "ragged": "1 2 3\n1 2\n",
+        }
+        for name, content in contents.items():
+            with self.subTest(name=name):
+                path = self.tmpdir / "invalid.txt"
+                path.write_text(content)
+                completion = _run(config.USR_MEASURES_EXE, path)
+                self.assertNotEqual(0, completion.returncode)
+                self.assertTrue("Line 2 of" in completion.stderr)
+
+        queries = self._write_vectors("queries.txt", [[1.0, 2.0]])
+        completion = _run(config.USR_MEASURES_EXE, "-q", queries, self.usr_path)
+        self.assertNotEqual(0, completion.returncode)
+
+    def _gen_vectors(self, num_vectors, num_features, seed):
+        rng = random.Random(seed)
+        return [
+            [round(rng.uniform(0.0, 6.0), 4) for _ in range(num_features)]
+            for _ in range(num_vectors)
+        ]
+
+    def _write_vectors(self, name, vectors):
+        path = self.tmpdir / name
+        path.write_text(
+            "".join(" ".join(str(x) for x in v) + "\n" for v in vectors)
+        )
+        return path
+
+
+def main():
+    logging.basicConfig(level=logging.DEBUG)
+    unittest.main()
+
+
+if __name__ == "__main__":
+    main()
@@ -7,10 +7,12 @@ import base64
 import gzip
 import io
 import itertools
+import json
 import logging
 from pathlib import Path
 import struct
 import subprocess
+import tempfile
 import typing as tp
 import unittest
 
@@ -193,6 +195,25 @@ class TestCase(unittest.TestCase):
         self.assertNotEqual(0, completion.returncode)
         self.assertTrue("requires 1" in completion.stderr.lower())
 
+    def test_stats(self):
+        """Verify the per-stage statistics report."""
+        with tempfile.TemporaryDirectory() as tmpdir:
+            stats_path = Path(tmpdir) / "stats.json"
+            completion, sd_pathname, _sph = self._run_cox2(["--stats", stats_path])
+            self.assertEqual(0, completion.returncode, completion.stderr)
+            stats = json.loads(stats_path.read_text())
+
+        self.assertTrue(stats["wall_seconds"] > 0)
+        stages = {stage["name"]: stage for stage in stats["stages"]}
+        num_mols = self._num_sd_structures(sd_pathname)
+        self.assertEqual(num_mols, stages["SDReader::read"]["items"])
+        self.assertEqual(num_mols, stages["AxisAligner::align_to_axes"]["items"])
+        num_fps = len(completion.stdout.splitlines())
+        self.assertEqual(num_fps, stages["SDFShapeFingerprinter::write"]["items"])
+        for stage in stages.values():
+            self.assertTrue(stage["calls"] > 0)
+            self.assertTrue(stage["seconds"] >= 0)
+
     def _get_ids_and_fps(self, fp_output: str) -> tuple[list, list]:
         ids = []
         fps = []
@@ -0,0 +1,148 @@
+#!/usr/bin/env python
+"""Unit test for usr_descriptors.
+Copyright (c) 2011 Mesa Analytics & Computing, Inc.  All rights reserved
+"""
+
+import logging
+import math
+import subprocess
+import tempfile
+import unittest
+from pathlib import Path
+
+import config
+
+SD_PATH = config.SD_DATA_DIR / "cox2_3d_first_5.sd"
+
+
+def _read_heavy_atoms(sd_path):
+    """Get the heavy atom coordinates of each structure of a V2000 SD file."""
+    result = []
+    lines = sd_path.read_text().splitlines()
+    i = 0
+    while i + 3 < len(lines):
+        num_atoms = int(lines[i + 3][:3])
+        atoms = []
+        for line in lines[i + 4 : i + 4 + num_atoms]:
+            fields = line.split()
+            if fields[3] != "H":
+                atoms.append(tuple(float(f) for f in fields[:3]))
+        result.append(atoms)
+        while lines[i] != "$$$$":
+            i += 1
+        i += 1
+    return result
+
+
+def _usr(atoms):
+    """Compute reference USR descriptors."""
+    n = len(atoms)
+    ctd = tuple(sum(a[k] for a in atoms) / n for k in range(3))
+    cst = min(atoms, key=lambda a: math.dist(a, ctd))
+    fct = max(atoms, key=lambda a: math.dist(a, ctd))
+    ftf = max(atoms, key=lambda a: math.dist(a, fct))
+    result = []
+    for ref in [ctd, cst, fct, ftf]:
+        dists = [math.dist(a, ref) for a in atoms]
+        mean = sum(dists) / n
+        var = sum((d - mean) ** 2 for d in dists) / n
+        third = sum((d - mean) ** 3 for d in dists) / n
+        result += [mean, math.sqrt(var), math.copysign(abs(third) ** (1 / 3), third)]
+    return result
+
+
+class TestCase(unittest.TestCase):
+    def setUp(self):
+        self._tmpdir = tempfile.TemporaryDirectory()
+        self.tmpdir = Path(self._tmpdir.name)
+
+    def tearDown(self):
+        self._tmpdir.cleanup()
+
+    def test_usage(self):
+        """Verify that help is shown when no args are given."""
+        completion = self._run()
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("usage" in completion.stderr.lower())
+
+    def test_nonexistent_sdf_pathname(self):
+        completion = self._run(
+            self.tmpdir / "no_such_sdf.nope", self.tmpdir / "out.bin"
+        )
+        self.assertNotEqual(0, completion.returncode)
+        self.assertTrue("Cannot open SD file" in completion.stderr)
+
+    def test_usr_values(self):
+        """Verify ASCII USR descriptors against a reference implementation."""
+        out_path = self.tmpdir / "usr.txt"
+        names_path = self.tmpdir / "names.txt"
+        completion = self._run("-f", "A", "-n", names_path, SD_PATH, out_path)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+
+        structures = _read_heavy_atoms(SD_PATH)
+        rows = out_path.read_text().splitlines()
+        self.assertEqual(len(structures), len(rows))
+        for atoms, row in zip(structures, rows):
+            actual = [float(v) for v in row.split()]
+            self.assertEqual(12, len(actual))
+            for e, a in zip(_usr(atoms), actual):
+                self.assertAlmostEqual(e, a, places=3)
+
+        names = names_path.read_text().splitlines()
+        self.assertEqual(["1-1", "1-3", "1-4", "1-5", "1-6"], names)
+
+    def test_usrcat(self):
+        out_path = self.tmpdir / "usrcat.txt"
+        completion = self._run("-c", "-f", "A", SD_PATH, out_path)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+
+        usr_path = self.tmpdir / "usr.txt"
+        completion = self._run("-f", "A", SD_PATH, usr_path)
+        self.assertEqual(0, completion.returncode, completion.stderr)
+
+        for usrcat_row, usr_row in zip(
+            out_path.read_text().splitlines(), usr_path.read_text().splitlines()
+        ):
+            usrcat_values = usrcat_row.split()
+            self.assertEqual(60, len(usrcat_values))
+            self.assertEqual(usr_row.split(), usrcat_values[:12])
+
+    def test_packed(self):
+        """Verify that usr_measures gives the same results for packed and
+        ASCII descriptors."""
+        for args in [[], ["-c"]]:
+            with self.subTest(args=args):
+                packed_path = self.tmpdir / "usr.bin"
+                text_path = self.tmpdir / "usr.txt"
+                completion = self._run(*args, SD_PATH, packed_path)
+                self.assertEqual(0, completion.returncode, completion.stderr)
+                completion = self._run(*args, "-f", "A", SD_PATH, text_path)
+                self.assertEqual(0, completion.returncode, completion.stderr)
+
+                packed = self._measure(packed_path)
+                text = self._measure(text_path)
+                self.assertEqual(len(packed), len(text))
+                for p, t in zip(packed, text):
+                    self.assertAlmostEqual(p, t, places=4)
+
+    def _measure(self, path):
+        completion = subprocess.run(
+            [str(config.USR_MEASURES_EXE), "-f", "O", str(path)],
+            capture_output=True,
+            encoding="utf8",
+        )
+        self.assertEqual(0, completion.returncode, completion.stderr)
+        return [float(line.split()[2]) for line in completion.stdout.splitlines()]
+
+    def _run(self, *args, **kw):
+        args = [config.EXE_PATH] + [str(arg) for arg in args]
+        return subprocess.run(args, **kw, capture_output=True, encoding="utf8")
+
+
+def main():
+    logging.basicConfig(level=logging.DEBUG)
+    unittest.main()
+
+
+if __name__ == "__main__":
+    main()
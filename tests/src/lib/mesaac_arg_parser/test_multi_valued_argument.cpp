@@ -0,0 +1,70 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "mesaac_arg_parser/arg_parser.hpp"
+
+#include <filesystem>
+#include <sstream>
+
+namespace mesaac::arg_parser {
+namespace {
+TEST_CASE("mesaac::arg_parser::MultiValuedArgument",
+          "[mesaac][mesaac_arg_parser]") {
+
+  SECTION("Test consecutive values.") {
+    MultiValuedArgument<unsigned int> arg("values", "Specify values");
+    REQUIRE(arg.has_value() == false);
+    REQUIRE(arg.values().empty());
+
+    CLIArgs args{"1", "2", "3"};
+    REQUIRE(arg.parse(args) == ParseResult::match());
+    REQUIRE(arg.parse(args) == ParseResult::match());
+    REQUIRE(arg.parse(args) == ParseResult::match());
+    REQUIRE(arg.parse(args) == ParseResult::no_match());
+    REQUIRE(arg.has_value() == true);
+    REQUIRE(arg.values() == std::vector<unsigned int>{1, 2, 3});
+  }
+
+  SECTION("Test wrong value type.") {
+    MultiValuedArgument<unsigned int> arg("values", "Specify values");
+    CLIArgs args{"not a number"};
+    auto parse_result = arg.parse(args);
+    REQUIRE(parse_result.matched());
+    REQUIRE(parse_result.error_msg().has_value());
+    REQUIRE(arg.has_value() == false);
+    REQUIRE(args.size() == 1);
+  }
+
+  SECTION("Get positional usage.") {
+    MultiValuedArgument<std::string> arg("value", "Specify string values");
+    REQUIRE(arg.usage() == "value [value ...]");
+    REQUIRE(arg.help() == "value\n        Specify string values");
+  }
+
+  SECTION("Parse after a single-valued argument.") {
+    auto first = Argument<std::string>::create("first", "The first value");
+    auto rest = MultiValuedArgument<std::filesystem::path>::create(
+        "rest", "The remaining values");
+    std::ostringstream outs;
+    ArgParser parser({}, {first, rest}, "Description", outs);
+
+    const char *argv[] = {"<test_prog>", "a", "b", "c"};
+    const int argc = sizeof(argv) / sizeof(argv[0]);
+    REQUIRE(parser.parse_args(argc, argv) == 0);
+    REQUIRE(first->value() == "a");
+    REQUIRE(rest->values() == std::vector<std::filesystem::path>{"b", "c"});
+  }
+
+  SECTION("Require at least one value.") {
+    auto values =
+        MultiValuedArgument<std::string>::create("values", "Some values");
+    std::ostringstream outs;
+    ArgParser parser({}, {values}, "Description", outs);
+
+    const char *argv[] = {"<test_prog>"};
+    const int argc = sizeof(argv) / sizeof(argv[0]);
+    REQUIRE(parser.parse_args(argc, argv) == 1);
+    REQUIRE(outs.str().starts_with("Missing argument(s): values"));
+  }
+}
+} // namespace
+} // namespace mesaac::arg_parser
@@ -0,0 +1,53 @@
+// Unit test for file_sync
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "mesaac_common/file_sync.hpp"
+
+using namespace std;
+
+namespace mesaac::common {
+
+namespace {
+string read_file(const filesystem::path &path) {
+  ifstream inf(path, ios::binary);
+  ostringstream result;
+  result << inf.rdbuf();
+  return result.str();
+}
+
+TEST_CASE("mesaac::common::file_sync", "[mesaac]") {
+  const auto dir = filesystem::temp_directory_path() / "test_file_sync";
+  filesystem::remove_all(dir);
+  filesystem::create_directories(dir);
+  const auto src = dir / "new.txt.tmp";
+  const auto dest = dir / "new.txt";
+
+  SECTION("Sync files and directories") {
+    ofstream(src) << "content";
+    REQUIRE_NOTHROW(sync_file(src));
+    REQUIRE_NOTHROW(sync_directory(dir));
+    REQUIRE_THROWS_AS(sync_file(dir / "missing.txt"), runtime_error);
+    REQUIRE_THROWS_AS(sync_directory(src), runtime_error);
+  }
+
+  SECTION("Rename durably") {
+    ofstream(dest) << "old content";
+    ofstream(src) << "new content";
+    rename_durably(src, dest);
+    REQUIRE(!filesystem::exists(src));
+    REQUIRE(read_file(dest) == "new content");
+    REQUIRE_THROWS_AS(rename_durably(src, dest), runtime_error);
+  }
+  filesystem::remove_all(dir);
+}
+} // namespace
+} // namespace mesaac::common
@@ -0,0 +1,54 @@
+// Unit test for mapped_file
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "mesaac_common/mapped_file.hpp"
+
+using namespace std;
+
+namespace mesaac::common {
+
+namespace {
+filesystem::path write_temp_file(const string &name, const string &content) {
+  const auto result = filesystem::temp_directory_path() / name;
+  ofstream outf(result, ios::binary);
+  outf << content;
+  return result;
+}
+
+TEST_CASE("mesaac::common::MappedFile", "[mesaac]") {
+  SECTION("Map file content") {
+    const string content("Some mapped content.");
+    const auto path = write_temp_file("test_mapped_file.txt", content);
+    {
+      MappedFile mapped(path);
+      REQUIRE(mapped.size() == content.size());
+      REQUIRE(memcmp(mapped.data(), content.data(), content.size()) == 0);
+    }
+    filesystem::remove(path);
+  }
+
+  SECTION("Map empty file") {
+    const auto path = write_temp_file("test_mapped_file_empty.txt", "");
+    {
+      MappedFile mapped(path);
+      REQUIRE(mapped.size() == 0);
+      REQUIRE(mapped.data() == nullptr);
+    }
+    filesystem::remove(path);
+  }
+
+  SECTION("Nonexistent file") {
+    REQUIRE_THROWS_AS(MappedFile("/no/such/file/to/map"), runtime_error);
+  }
+}
+} // namespace
+} // namespace mesaac::common
@@ -0,0 +1,99 @@
+// Unit test for stats
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mesaac_common/stats.hpp"
+
+using namespace std;
+
+namespace mesaac::common::stats {
+
+namespace {
+TEST_CASE("mesaac::common::stats", "[mesaac]") {
+  Stage &timed = stage("test_stats.timed");
+  REQUIRE(&timed == &stage("test_stats.timed"));
+  REQUIRE(timed.name() == "test_stats.timed");
+  reset();
+
+  SECTION("Disabled timers record nothing") {
+    disable();
+    { const ScopedTimer timer(timed, 10); }
+    REQUIRE(timed.totals().calls == 0);
+  }
+
+  SECTION("Enabled timers record calls and items") {
+    enable();
+    { const ScopedTimer timer(timed); }
+    {
+      ScopedTimer timer(timed);
+      timer.set_items(5);
+    }
+    disable();
+    const Totals totals = timed.totals();
+    REQUIRE(totals.calls == 2);
+    REQUIRE(totals.items == 6);
+
+    timed.reset();
+    REQUIRE(timed.totals().calls == 0);
+  }
+
+  SECTION("Threads accumulate into one stage") {
+    enable();
+    const unsigned int num_threads = 8, num_calls = 1000;
+    vector<thread> threads;
+    for (unsigned int i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&timed]() {
+        for (unsigned int j = 0; j < num_calls; ++j) {
+          const ScopedTimer timer(timed, 2);
+        }
+      });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    disable();
+    const Totals totals = timed.totals();
+    REQUIRE(totals.calls == num_threads * num_calls);
+    REQUIRE(totals.items == 2 * num_threads * num_calls);
+  }
+
+  SECTION("JSON report") {
+    Stage &unused = stage("test_stats.unused");
+    timed.reset();
+    timed.record(2000000000, 100);
+
+    ostringstream outs;
+    write_json(outs, 1.5);
+    const string json = outs.str();
+    REQUIRE(json.find("\"wall_seconds\": 1.500000") != string::npos);
+    REQUIRE(json.find("{\"name\": \"test_stats.timed\", \"calls\": 1, "
+                      "\"items\": 100, \"seconds\": 2.000000, "
+                      "\"items_per_second\": 50.0}") != string::npos);
+    // Stages with no measurements are omitted.
+    REQUIRE(json.find(unused.name()) == string::npos);
+
+    const auto path = filesystem::temp_directory_path() / "test_stats.json";
+    enable();
+    write_report(path);
+    disable();
+    ifstream inf(path);
+    const string content((istreambuf_iterator<char>(inf)),
+                         istreambuf_iterator<char>());
+    REQUIRE(content.find("test_stats.timed") != string::npos);
+    filesystem::remove(path);
+
+    REQUIRE_THROWS_AS(write_report(filesystem::path("/no/such/dir/x.json")),
+                      runtime_error);
+  }
+}
+} // namespace
+} // namespace mesaac::common::stats
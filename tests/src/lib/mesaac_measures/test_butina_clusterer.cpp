@@ -0,0 +1,51 @@
+// Unit test for butina_clusterer
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "mesaac_measures/butina_clusterer.hpp"
+#include "mesaac_measures/tanimoto.hpp"
+
+namespace mesaac::measures::shape {
+namespace {
+using IndexList = std::vector<unsigned int>;
+
+const shape_defs::ArrayBitVectors fps{{8, 0b00001111},
+                                      {8, 0b00001110},
+                                      {8, 0b11110000},
+                                      {8, 0b11100000},
+                                      {8, 0b00001001},
+                                      {8, 0b01000000}};
+} // namespace
+
+TEST_CASE("mesaac::measures::shape::cluster_taylor_butina",
+          "[mesaac][mesaac_measures]") {
+  const auto measurer =
+      get_fp_measurer(std::make_shared<Tanimoto>(), true, fps);
+
+  SECTION("Clusters") {
+    for (const std::size_t budget : {std::size_t(0), std::size_t(1 << 20)}) {
+      NeighborLists lists(*measurer, fps.size(),
+                          {.threshold = 0.5,
+                           .is_similarity = true,
+                           .memory_budget = budget});
+      const auto clusters = cluster_taylor_butina(lists);
+
+      // Fingerprint 0 has the most neighbors (1, 4), so it becomes the
+      // first centroid.  2 and 3 tie; 2 wins by index.  5 is a singleton.
+      REQUIRE(clusters.centroids == IndexList{0, 2, 5});
+      REQUIRE(clusters.sizes == IndexList{3, 2, 1});
+      REQUIRE(clusters.assignments == IndexList{0, 0, 1, 1, 0, 2});
+    }
+  }
+
+  SECTION("Singletons") {
+    NeighborLists lists(*measurer, fps.size(),
+                        {.threshold = 1.0, .is_similarity = true});
+    const auto clusters = cluster_taylor_butina(lists);
+    REQUIRE(clusters.centroids == IndexList{0, 1, 2, 3, 4, 5});
+    REQUIRE(clusters.assignments == IndexList{0, 1, 2, 3, 4, 5});
+  }
+}
+} // namespace mesaac::measures::shape
@@ -0,0 +1,140 @@
+// Unit test for compressed_fp
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_measures/compressed_fp.hpp"
+
+namespace mesaac::measures {
+namespace {
+// Get a bit vector whose blocks have the given densities, so that its
+// compressed form mixes empty, sparse and dense blocks.
+shape_defs::BitVector mixed_bits(std::mt19937 &gen, unsigned int num_bits,
+                                 const std::vector<double> &densities) {
+  shape_defs::BitVector result(num_bits);
+  for (unsigned int i = 0; i < num_bits; i++) {
+    const double density =
+        densities[(i / CompressedFP::BlockBits) % densities.size()];
+    result[i] = std::bernoulli_distribution(density)(gen);
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::CompressedFP", "[mesaac]") {
+  std::mt19937 gen(20101118);
+  // Five blocks, the last of them partial.
+  const unsigned int num_bits = 4 * CompressedFP::BlockBits + 200;
+
+  SECTION("Empty fingerprints") {
+    const CompressedFP empty;
+    REQUIRE(empty.num_bits() == 0);
+    REQUIRE(empty.count() == 0);
+    REQUIRE(intersection_count(empty, empty) == 0);
+
+    const CompressedFP zeros{shape_defs::BitVector(num_bits)};
+    REQUIRE(zeros.num_bits() == num_bits);
+    REQUIRE(zeros.count() == 0);
+    REQUIRE(zeros.num_dense_blocks() == 0);
+    REQUIRE(zeros.num_sparse_blocks() == 0);
+  }
+
+  SECTION("Round trip") {
+    const auto bits = mixed_bits(gen, num_bits, {0.0, 0.01, 0.3, 0.02, 0.5});
+    const CompressedFP fp(bits);
+    REQUIRE(fp.num_bits() == num_bits);
+    REQUIRE(fp.count() == bits.count());
+    REQUIRE(fp.num_dense_blocks() == 2);
+    REQUIRE(fp.num_sparse_blocks() == 2);
+
+    shape_defs::BitVector decoded(3, 0b101);
+    fp.decode(decoded);
+    REQUIRE(decoded == bits);
+  }
+
+  SECTION("Sparse fingerprints take less memory") {
+    const auto sparse = mixed_bits(gen, num_bits, {0.01});
+    const auto dense = mixed_bits(gen, num_bits, {0.3});
+    const std::size_t bitset_bytes = sparse.num_blocks() * 8;
+    REQUIRE(CompressedFP(sparse).memory_bytes() < bitset_bytes / 2);
+    // Dense fingerprints cost little more than their words.
+    REQUIRE(CompressedFP(dense).memory_bytes() < bitset_bytes + 128);
+  }
+
+  SECTION("Packed words") {
+    const auto bits = mixed_bits(gen, num_bits, {0.3, 0.01});
+    std::vector<std::uint64_t> words(bits.num_blocks());
+    boost::to_block_range(bits, words.begin());
+    // Unused bits of the last word are ignored.
+    words.back() |= ~std::uint64_t(0) << (num_bits % 64);
+    REQUIRE(CompressedFP(words, num_bits) == CompressedFP(bits));
+
+    words.pop_back();
+    REQUIRE_THROWS_AS(CompressedFP(words, num_bits), std::invalid_argument);
+  }
+
+  SECTION("Counts across mixed encodings") {
+    // Every pairing of empty, sparse and dense blocks.
+    const std::vector<std::vector<double>> patterns{
+        {0.0, 0.01, 0.3}, {0.01, 0.3, 0.0}, {0.3, 0.0, 0.01},
+        {0.02, 0.02, 0.02}, {0.4, 0.4, 0.4}};
+    std::vector<shape_defs::BitVector> bits;
+    for (const auto &pattern : patterns) {
+      bits.push_back(mixed_bits(gen, num_bits, pattern));
+    }
+    for (const auto &bits1 : bits) {
+      const CompressedFP fp1(bits1);
+      for (const auto &bits2 : bits) {
+        const CompressedFP fp2(bits2);
+        REQUIRE(intersection_count(fp1, fp2) == (bits1 & bits2).count());
+        REQUIRE(union_count(fp1, fp2) == (bits1 | bits2).count());
+
+        const auto expected = get_contingency_counts(bits1, bits2);
+        const auto counts = get_contingency_counts(fp1, fp2);
+        REQUIRE(counts.a == expected.a);
+        REQUIRE(counts.b == expected.b);
+        REQUIRE(counts.c == expected.c);
+        REQUIRE(counts.n == expected.n);
+      }
+    }
+  }
+
+  SECTION("Mismatched sizes") {
+    const CompressedFP fp1{shape_defs::BitVector(100)};
+    const CompressedFP fp2{shape_defs::BitVector(101)};
+    REQUIRE_THROWS_AS(intersection_count(fp1, fp2), std::invalid_argument);
+    REQUIRE_THROWS_AS(get_contingency_counts(fp1, fp2),
+                      std::invalid_argument);
+  }
+
+  SECTION("Binary form") {
+    const CompressedFP fp(
+        mixed_bits(gen, num_bits, {0.0, 0.01, 0.3, 0.02, 0.5}));
+    std::stringstream buffer;
+    fp.write(buffer);
+    const std::string bytes = buffer.str();
+
+    std::istringstream ins(bytes);
+    REQUIRE(CompressedFP::read(ins, num_bits) == fp);
+
+    std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+    REQUIRE_THROWS_AS(CompressedFP::read(truncated, num_bits),
+                      std::runtime_error);
+
+    // Block 1 is sparse; make its first offset out of order.
+    std::string corrupt(bytes);
+    const std::size_t num_blocks = 5;
+    corrupt[4 * num_blocks] = char(0xff);
+    corrupt[4 * num_blocks + 1] = char(0x03);
+    std::istringstream corrupt_ins(corrupt);
+    REQUIRE_THROWS_AS(CompressedFP::read(corrupt_ins, num_bits),
+                      std::runtime_error);
+  }
+}
+} // namespace mesaac::measures
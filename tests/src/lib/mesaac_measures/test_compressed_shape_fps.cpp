@@ -0,0 +1,139 @@
+// Unit test for compressed_shape_fps
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_measures/compressed_shape_fps.hpp"
+#include "mesaac_measures/measures_factory.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+namespace mesaac::measures::shape {
+namespace {
+using mesaac::shape::ShapeFingerprint;
+using mesaac::shape::ShapeFingerprintVector;
+
+// Mostly sparse shape fingerprints, with a dense stretch in some.
+ShapeFingerprintVector random_sfps(unsigned int num_shapes,
+                                   unsigned int num_bits) {
+  std::mt19937 gen(20101119);
+  std::bernoulli_distribution sparse(0.02);
+  std::bernoulli_distribution dense(0.4);
+  ShapeFingerprintVector result(num_shapes);
+  for (unsigned int i = 0; i != num_shapes; ++i) {
+    for (unsigned int k = 0; k != FPsPerShape; ++k) {
+      shape_defs::BitVector fp(num_bits);
+      for (unsigned int b = 0; b != num_bits; ++b) {
+        const bool in_dense_stretch = (i % 3 == 0) && (b < num_bits / 3);
+        fp[b] = in_dense_stretch ? dense(gen) : sparse(gen);
+      }
+      result[i].push_back(fp);
+    }
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::shape::CompressedShapeFPs",
+          "[mesaac][mesaac_measures]") {
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_compressed_shape_fps.bin";
+  const unsigned int num_bits = 3000;
+  const auto expected = random_sfps(12, num_bits);
+
+  SECTION("Round trip") {
+    {
+      CompressedShapeFPWriter writer(path, num_bits);
+      for (const auto &sfp : expected) {
+        writer.write(sfp);
+      }
+      REQUIRE(writer.size() == expected.size());
+    }
+    REQUIRE(CompressedShapeFPs::is_compressed(path));
+
+    const CompressedShapeFPs fps(path);
+    REQUIRE(fps.size() == expected.size());
+    REQUIRE(fps.num_bits() == num_bits);
+
+    ShapeFingerprint actual;
+    for (unsigned int i = 0; i != expected.size(); ++i) {
+      fps.get(i, actual);
+      REQUIRE(actual == expected[i]);
+    }
+    ShapeFingerprintVector range;
+    fps.append_range(3, 7, range);
+    REQUIRE(range.size() == 4);
+    REQUIRE(range[3] == expected[6]);
+    REQUIRE_THROWS_AS(fps.get(expected.size(), actual), std::out_of_range);
+  }
+
+  SECTION("In-memory collections") {
+    CompressedShapeFPs fps(num_bits);
+    for (const auto &sfp : expected) {
+      fps.push_back(sfp);
+    }
+    REQUIRE(fps.size() == expected.size());
+    // Far smaller than the fingerprints' words.
+    const std::size_t packed_bytes =
+        expected.size() * FPsPerShape * expected[0][0].num_blocks() * 8;
+    REQUIRE(fps.memory_bytes() < packed_bytes);
+
+    const ShapeFingerprint too_few{expected[0][0], expected[0][1]};
+    REQUIRE_THROWS_AS(fps.push_back(too_few), std::invalid_argument);
+    const ShapeFingerprint wrong_length(FPsPerShape,
+                                        shape_defs::BitVector(num_bits + 1));
+    REQUIRE_THROWS_AS(fps.push_back(wrong_length), std::invalid_argument);
+  }
+
+  SECTION("Measures match uncompressed measures") {
+    CompressedShapeFPs fps(num_bits);
+    for (const auto &sfp : expected) {
+      fps.push_back(sfp);
+    }
+    const auto num_fps = expected.size();
+    std::vector<float> row(num_fps);
+    for (const auto type :
+         {MeasureType::bub, MeasureType::cosine, MeasureType::euclidean,
+          MeasureType::hamann, MeasureType::tanimoto, MeasureType::tversky}) {
+      const auto measure = get_measures(type, 0.7);
+      for (const bool compute_sim : {true, false}) {
+        const auto reference =
+            get_shape_measurer(measure, compute_sim, expected);
+        const auto measurer = get_shape_measurer(measure, compute_sim, fps);
+        REQUIRE(measurer != nullptr);
+        for (unsigned int i = 0; i != num_fps; ++i) {
+          measurer->value_row(i, 0, num_fps, row.data());
+          for (unsigned int j = 0; j != num_fps; ++j) {
+            REQUIRE(row[j] == reference->value(i, j));
+            REQUIRE(measurer->value(i, j) == row[j]);
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("Invalid files") {
+    {
+      std::ofstream outf(path, std::ios::binary);
+      outf << "This is not a compressed shape fingerprint file.";
+    }
+    REQUIRE(!CompressedShapeFPs::is_compressed(path));
+    REQUIRE_THROWS_AS(CompressedShapeFPs(path), std::runtime_error);
+
+    {
+      CompressedShapeFPWriter writer(path, num_bits);
+      writer.write(expected[0]);
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    REQUIRE_THROWS_AS(CompressedShapeFPs(path), std::runtime_error);
+  }
+
+  std::filesystem::remove(path);
+}
+} // namespace mesaac::measures::shape
@@ -0,0 +1,127 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_measures/contingency_counts.hpp"
+#include "mesaac_measures/measures_factory.hpp"
+
+namespace mesaac::measures {
+namespace {
+shape_defs::BitVector random_bits(std::mt19937 &gen, unsigned int num_bits) {
+  std::bernoulli_distribution coin(0.3);
+  shape_defs::BitVector result(num_bits);
+  for (unsigned int i = 0; i < num_bits; i++) {
+    result[i] = coin(gen);
+  }
+  return result;
+}
+
+// Reference similarities, computed the long way with bit vector
+// temporaries.
+float reference_similarity(MeasureType type, float alpha,
+                           const shape_defs::BitVector &v1,
+                           const shape_defs::BitVector &v2) {
+  const float a = (v1 & v2).count();
+  const float b = (v1 & ~v2).count();
+  const float c = (~v1 & v2).count();
+  const float d = (~v1 & ~v2).count();
+  switch (type) {
+  case MeasureType::bub: {
+    const float s = std::sqrt(a * d);
+    return (s + a + b + c) > 0 ? (s + a) / (s + a + b + c) : 0.0f;
+  }
+  case MeasureType::cosine:
+    return (a + b) * (a + c) > 0 ? a / std::sqrt((a + b) * (a + c)) : 0.0f;
+  case MeasureType::euclidean:
+    return 1.0f - std::sqrt((b + c) / v1.size());
+  case MeasureType::hamann:
+    return ((a + d) - (b + c)) / (a + b + c + d);
+  case MeasureType::tanimoto:
+    return (a + b + c) > 0 ? a / (a + b + c) : 0.0f;
+  case MeasureType::tversky: {
+    const float denom = a + alpha * b + (2.0f - alpha) * c;
+    return denom ? a / denom : 1.0f;
+  }
+  }
+  return 0.0f;
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::ContingencyCounts", "[mesaac]") {
+  using Catch::Matchers::WithinAbs;
+
+  SECTION("Counts of small vectors") {
+    shape_defs::BitVector v1(8, 0b11001100);
+    shape_defs::BitVector v2(8, 0b10101010);
+
+    const auto counts = get_contingency_counts(v1, v2);
+    REQUIRE(counts.a == 2);
+    REQUIRE(counts.b == 2);
+    REQUIRE(counts.c == 2);
+    REQUIRE(counts.n == 8);
+    REQUIRE(counts.d() == 2);
+  }
+
+  SECTION("Counts span several blocks") {
+    std::mt19937 gen(1);
+    const unsigned int num_bits = 200;
+    const auto v1 = random_bits(gen, num_bits);
+    const auto v2 = random_bits(gen, num_bits);
+
+    const auto counts = get_contingency_counts(v1, v2);
+    REQUIRE(counts.a == (v1 & v2).count());
+    REQUIRE(counts.b == (v1 & ~v2).count());
+    REQUIRE(counts.c == (~v1 & v2).count());
+    REQUIRE(counts.d() == (~v1 & ~v2).count());
+    REQUIRE(counts.n == num_bits);
+
+    std::vector<std::uint64_t> words1(v1.num_blocks());
+    std::vector<std::uint64_t> words2(v2.num_blocks());
+    boost::to_block_range(v1, words1.begin());
+    boost::to_block_range(v2, words2.begin());
+    const auto packed = get_contingency_counts(words1, words2, num_bits);
+    REQUIRE(packed.a == counts.a);
+    REQUIRE(packed.b == counts.b);
+    REQUIRE(packed.c == counts.c);
+    REQUIRE(packed.n == counts.n);
+  }
+
+  SECTION("Mismatched sizes") {
+    shape_defs::BitVector v1(8);
+    shape_defs::BitVector v2(9);
+    REQUIRE_THROWS_AS(get_contingency_counts(v1, v2), std::invalid_argument);
+  }
+
+  SECTION("Every measure matches its bit vector definition") {
+    std::mt19937 gen(2);
+    const float alpha = 0.75;
+    for (const auto type :
+         {MeasureType::bub, MeasureType::cosine, MeasureType::euclidean,
+          MeasureType::hamann, MeasureType::tanimoto, MeasureType::tversky}) {
+      const auto measure = get_measures(type, alpha);
+      for (unsigned int trial = 0; trial < 20; trial++) {
+        const auto v1 = random_bits(gen, 150);
+        const auto v2 = random_bits(gen, 150);
+        const auto counts = get_contingency_counts(v1, v2);
+        const float expected = reference_similarity(type, alpha, v1, v2);
+        REQUIRE_THAT(measure->similarity(counts), WithinAbs(expected, 1.0e-6));
+        REQUIRE(measure->similarity(counts) == measure->similarity(v1, v2));
+        REQUIRE(measure->distance(counts) == measure->distance(v1, v2));
+      }
+    }
+  }
+
+  SECTION("Empty vectors") {
+    shape_defs::BitVector empty(16);
+    const auto counts = get_contingency_counts(empty, empty);
+    REQUIRE(get_measures(MeasureType::tanimoto, 0)->similarity(counts) == 0.0f);
+    REQUIRE(get_measures(MeasureType::tversky, 1)->similarity(counts) == 1.0f);
+    REQUIRE(get_measures(MeasureType::cosine, 0)->similarity(counts) == 0.0f);
+    REQUIRE(get_measures(MeasureType::hamann, 0)->similarity(counts) == 1.0f);
+  }
+}
+} // namespace mesaac::measures
@@ -0,0 +1,213 @@
+// Unit test for count_measures
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mesaac_measures/count_measures.hpp"
+
+namespace mesaac::measures {
+namespace {
+using Catch::Matchers::WithinAbs;
+using Counts = std::vector<unsigned int>;
+
+// Long enough to span more than one padded chunk.
+const unsigned int NumFeatures = 37;
+
+std::vector<Counts> make_counts(unsigned int max_count) {
+  std::vector<Counts> result;
+  for (unsigned int i = 0; i != 5; ++i) {
+    Counts counts(NumFeatures, 0);
+    for (unsigned int k = 0; k != NumFeatures; ++k) {
+      // Sparse-ish, with some shared features and some large counts.
+      if ((k + i) % (i + 2) != 0) {
+        counts[k] = ((k * 7 + i * 13) % 11) * max_count / 10;
+      }
+    }
+    result.push_back(counts);
+  }
+  // A vector with no counts.
+  result.push_back(Counts(NumFeatures, 0));
+  return result;
+}
+
+// Reference implementations, computed directly from the definitions.
+float ref_tanimoto(const Counts &a, const Counts &b) {
+  float sum = 0.0;
+  for (unsigned int k = 0; k != a.size(); ++k) {
+    if (a[k] && b[k]) {
+      sum += float(std::min(a[k], b[k])) / std::max(a[k], b[k]);
+    }
+  }
+  return sum;
+}
+
+float ref_tversky(const Counts &a, const Counts &b, float alpha) {
+  const float beta = 2.0 - alpha;
+  float sum = 0.0;
+  for (unsigned int k = 0; k != a.size(); ++k) {
+    if (a[k] && b[k]) {
+      sum += (a[k] < b[k]) ? a[k] / (beta * b[k]) : b[k] / (alpha * a[k]);
+    }
+  }
+  return sum;
+}
+
+float ref_euclidean(const Counts &a, const Counts &b) {
+  double sum = 0.0;
+  for (unsigned int k = 0; k != a.size(); ++k) {
+    const double diff = double(a[k]) - double(b[k]);
+    sum += diff * diff;
+  }
+  return std::sqrt(sum);
+}
+
+float ref_cosine(const Counts &a, const Counts &b) {
+  double dot = 0.0, aa = 0.0, bb = 0.0;
+  for (unsigned int k = 0; k != a.size(); ++k) {
+    dot += double(a[k]) * b[k];
+    aa += double(a[k]) * a[k];
+    bb += double(b[k]) * b[k];
+  }
+  return (aa && bb) ? dot / std::sqrt(aa * bb) : 0.0;
+}
+
+template <typename CountType>
+CountVectors<CountType> to_count_vectors(const std::vector<Counts> &all) {
+  CountVectors<CountType> result(NumFeatures);
+  for (const auto &counts : all) {
+    result.push_back(std::span<const unsigned int>(counts));
+  }
+  return result;
+}
+
+template <typename CountType> void check_measures(unsigned int count_limit) {
+  const auto all(make_counts(count_limit));
+  const auto cvs(to_count_vectors<CountType>(all));
+  REQUIRE(cvs.size() == all.size());
+
+  unsigned int max_present = 0;
+  unsigned int max_count = 0;
+  for (const auto &counts : all) {
+    max_present = std::max<unsigned int>(
+        max_present, std::count_if(counts.begin(), counts.end(),
+                                   [](unsigned int c) { return c > 0; }));
+    max_count = std::max(max_count,
+                         *std::max_element(counts.begin(), counts.end()));
+  }
+  const double max_distance = max_count * std::sqrt(double(NumFeatures));
+
+  const float alpha = 0.6;
+  const auto tanimoto =
+      get_count_measurer(MeasureType::tanimoto, 0.0, true, cvs);
+  const auto tversky =
+      get_count_measurer(MeasureType::tversky, alpha, true, cvs);
+  const auto euclidean =
+      get_count_measurer(MeasureType::euclidean, 0.0, true, cvs);
+  const auto cosine = get_count_measurer(MeasureType::cosine, 0.0, true, cvs);
+  const auto cosine_dist =
+      get_count_measurer(MeasureType::cosine, 0.0, false, cvs);
+
+  for (unsigned int i = 0; i != all.size(); ++i) {
+    REQUIRE(tanimoto->value(i, i) == 1.0);
+    REQUIRE(cosine_dist->value(i, i) == 0.0);
+    for (unsigned int j = 0; j != all.size(); ++j) {
+      if (i == j) {
+        continue;
+      }
+      const auto &a(all[i]);
+      const auto &b(all[j]);
+      REQUIRE_THAT(tanimoto->value(i, j),
+                   WithinAbs(ref_tanimoto(a, b) / max_present, 1.0e-5));
+      REQUIRE_THAT(tversky->value(i, j),
+                   WithinAbs(ref_tversky(a, b, alpha) * alpha / max_present,
+                             1.0e-5));
+      REQUIRE_THAT(euclidean->value(i, j),
+                   WithinAbs(1.0 - ref_euclidean(a, b) / max_distance, 1.0e-5));
+      REQUIRE_THAT(cosine->value(i, j), WithinAbs(ref_cosine(a, b), 1.0e-5));
+      REQUIRE_THAT(cosine_dist->value(i, j),
+                   WithinAbs(1.0 - ref_cosine(a, b), 1.0e-5));
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::CountVectors", "[mesaac][mesaac_measures]") {
+  SECTION("Rows are zero-padded") {
+    CountVectors8 cvs(3);
+    REQUIRE(cvs.size() == 0);
+    REQUIRE(cvs.stride() == CountVectors8::Chunk);
+    const Counts counts{1, 2, 255};
+    cvs.push_back(std::span<const unsigned int>(counts));
+    REQUIRE(cvs.size() == 1);
+    REQUIRE(cvs.num_features() == 3);
+    REQUIRE(cvs[0][2] == 255);
+    REQUIRE(cvs[0][3] == 0);
+    REQUIRE(cvs[0][CountVectors8::Chunk - 1] == 0);
+  }
+
+  SECTION("Invalid counts") {
+    CountVectors8 cvs(3);
+    const Counts too_short{1, 2};
+    REQUIRE_THROWS_AS(cvs.push_back(std::span<const unsigned int>(too_short)),
+                      std::invalid_argument);
+    const Counts too_large{1, 2, 256};
+    REQUIRE_THROWS_AS(cvs.push_back(std::span<const unsigned int>(too_large)),
+                      std::out_of_range);
+    const std::vector<int> negative{1, -2, 3};
+    REQUIRE_THROWS_AS(cvs.push_back(std::span<const int>(negative)),
+                      std::out_of_range);
+
+    CountVectors16 cvs16(3);
+    cvs16.push_back(std::span<const unsigned int>(too_large));
+    REQUIRE(cvs16[0][2] == 256);
+  }
+}
+
+TEST_CASE("mesaac::measures::get_count_measurer",
+          "[mesaac][mesaac_measures]") {
+  SECTION("8-bit counts") { check_measures<std::uint8_t>(255); }
+
+  SECTION("16-bit counts") { check_measures<std::uint16_t>(65535); }
+
+  SECTION("Unsupported measures and parameters") {
+    const CountVectors8 cvs(4);
+    REQUIRE_THROWS_AS(get_count_measurer(MeasureType::hamann, 0.0, true, cvs),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(get_count_measurer(MeasureType::tversky, 0.0, true, cvs),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(get_count_measurer(MeasureType::tversky, 2.0, true, cvs),
+                      std::invalid_argument);
+  }
+
+  SECTION("Euclidean on 0/1 counts matches bit vectors") {
+    CountVectors8 cvs(4);
+    for (const Counts &counts : {Counts{1, 1, 0, 0}, Counts{1, 0, 1, 0}}) {
+      cvs.push_back(std::span<const unsigned int>(counts));
+    }
+    const auto euclidean =
+        get_count_measurer(MeasureType::euclidean, 0.0, true, cvs);
+    REQUIRE_THAT(euclidean->value(0, 1),
+                 WithinAbs(1.0 - std::sqrt(2.0 / 4.0), 1.0e-6));
+  }
+
+  SECTION("Tversky with alpha 1 is Tanimoto") {
+    const auto cvs(to_count_vectors<std::uint8_t>(make_counts(255)));
+    const auto tanimoto =
+        get_count_measurer(MeasureType::tanimoto, 0.0, false, cvs);
+    const auto tversky =
+        get_count_measurer(MeasureType::tversky, 1.0, false, cvs);
+    for (unsigned int i = 0; i != cvs.size(); ++i) {
+      for (unsigned int j = 0; j != cvs.size(); ++j) {
+        REQUIRE_THAT(tversky->value(i, j),
+                     WithinAbs(tanimoto->value(i, j), 1.0e-6));
+      }
+    }
+  }
+}
+} // namespace mesaac::measures
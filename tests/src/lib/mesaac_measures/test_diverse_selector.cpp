@@ -0,0 +1,77 @@
+// Unit test for diverse_selector
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_measures/diverse_selector.hpp"
+#include "mesaac_measures/tanimoto.hpp"
+
+namespace mesaac::measures::shape {
+namespace {
+using IndexList = std::vector<unsigned int>;
+
+// Two tight pairs: {0, 1} and {2, 3}.  Tanimoto distance within
+// a pair is 0.25; between pairs it is 1.0.
+const shape_defs::ArrayBitVectors fps{{8, 0b00001111},
+                                      {8, 0b00001110},
+                                      {8, 0b11110000},
+                                      {8, 0b11100000}};
+
+IIndexedShapeFPMeasure::Ptr get_dist_measurer() {
+  return get_fp_measurer(std::make_shared<Tanimoto>(), false, fps);
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::shape::select_diverse",
+          "[mesaac][mesaac_measures]") {
+  const auto measurer = get_dist_measurer();
+  REQUIRE(measurer != nullptr);
+
+  SECTION("MaxMin picks the most distant candidate first") {
+    DiverseSelectionParams params;
+    const auto selected = select_diverse(*measurer, fps.size(), params);
+    REQUIRE(selected == IndexList{0, 2, 1, 3});
+  }
+
+  SECTION("MaxMin stops below threshold") {
+    DiverseSelectionParams params{.method = DiverseSelectionMethod::max_min,
+                                  .threshold = 0.5};
+    REQUIRE(select_diverse(*measurer, fps.size(), params) == IndexList{0, 2});
+  }
+
+  SECTION("MaxMin honors first index and selection limit") {
+    DiverseSelectionParams params{.method = DiverseSelectionMethod::max_min,
+                                  .max_selected = 2,
+                                  .first_index = 3};
+    REQUIRE(select_diverse(*measurer, fps.size(), params) == IndexList{3, 0});
+  }
+
+  SECTION("Sphere exclusion") {
+    DiverseSelectionParams params{
+        .method = DiverseSelectionMethod::sphere_exclusion, .threshold = 0.5};
+    REQUIRE(select_diverse(*measurer, fps.size(), params) == IndexList{0, 2});
+
+    params.threshold = 0.0;
+    REQUIRE(select_diverse(*measurer, fps.size(), params) ==
+            IndexList{0, 1, 2, 3});
+
+    params.max_selected = 1;
+    REQUIRE(select_diverse(*measurer, fps.size(), params) == IndexList{0});
+  }
+
+  SECTION("Empty collection") {
+    DiverseSelectionParams params;
+    REQUIRE(select_diverse(*measurer, 0, params).empty());
+  }
+
+  SECTION("Invalid first index") {
+    DiverseSelectionParams params{.first_index = 4};
+    REQUIRE_THROWS_AS(select_diverse(*measurer, fps.size(), params),
+                      std::invalid_argument);
+  }
+}
+} // namespace mesaac::measures::shape
@@ -0,0 +1,148 @@
+// Unit test for minhash_index
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_measures/minhash_index.hpp"
+#include "mesaac_measures/popcount_index.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+namespace mesaac::measures::shape {
+namespace {
+using mesaac::shape::ShapeFingerprint;
+using mesaac::shape::ShapeFingerprintVector;
+
+// Shapes are noisy copies of a few prototypes, so that each shape has
+// near neighbors.
+ShapeFingerprintVector clustered_sfps(unsigned int num_shapes,
+                                      unsigned int num_bits) {
+  std::mt19937 gen(20101120);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  ShapeFingerprintVector prototypes(5);
+  for (auto &sfp : prototypes) {
+    for (unsigned int k = 0; k != FPsPerShape; ++k) {
+      shape_defs::BitVector fp(num_bits);
+      for (unsigned int b = 0; b != num_bits; ++b) {
+        fp[b] = uniform(gen) < 0.3;
+      }
+      sfp.push_back(fp);
+    }
+  }
+  ShapeFingerprintVector result;
+  for (unsigned int i = 0; i != num_shapes; ++i) {
+    ShapeFingerprint sfp(prototypes[i % prototypes.size()]);
+    for (auto &fp : sfp) {
+      for (unsigned int b = 0; b != num_bits; ++b) {
+        if (uniform(gen) < 0.02) {
+          fp.flip(b);
+        }
+      }
+    }
+    result.push_back(sfp);
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::shape::MinHashIndex",
+          "[mesaac][mesaac_measures]") {
+  const auto db_path =
+      std::filesystem::temp_directory_path() / "test_minhash_index.db";
+  const auto index_path =
+      std::filesystem::temp_directory_path() / "test_minhash_index.idx";
+
+  const unsigned int num_bits = 300;
+  const auto sfps = clustered_sfps(100, num_bits);
+  {
+    PackedShapeFPWriter writer(db_path, num_bits);
+    for (const auto &sfp : sfps) {
+      writer.write(sfp);
+    }
+  }
+  const MinHashParams params{
+      .num_bands = 16, .rows_per_band = 2, .seed = 20101120};
+  write_minhash_index(SegmentedShapeFPs(db_path), db_path, index_path,
+                      params);
+  REQUIRE(is_minhash_index(index_path));
+  REQUIRE(is_shape_fp_index(index_path));
+  REQUIRE_FALSE(is_minhash_index(db_path));
+  REQUIRE_FALSE(is_shape_fp_index(db_path));
+
+  const MinHashIndex index(index_path);
+  REQUIRE(index.size() == sfps.size());
+  REQUIRE(index.num_bits() == num_bits);
+  REQUIRE(index.params().num_bands == params.num_bands);
+  REQUIRE(index.params().rows_per_band == params.rows_per_band);
+  REQUIRE(index.params().seed == params.seed);
+
+  SECTION("Candidates") {
+    for (const unsigned int q : {0u, 3u, 57u}) {
+      const auto candidates = index.candidates(sfps[q]);
+      REQUIRE(std::is_sorted(candidates.begin(), candidates.end()));
+      REQUIRE(std::adjacent_find(candidates.begin(), candidates.end()) ==
+              candidates.end());
+      // A shape always shares every band with itself.
+      REQUIRE(std::binary_search(candidates.begin(), candidates.end(), q));
+    }
+  }
+
+  SECTION("Hits are exact, and near neighbors are found") {
+    const auto measurer = get_shape_pair_measurer(
+        get_measures(MeasureType::tanimoto, 0.0), true);
+    for (const unsigned int q : {0u, 3u, 57u}) {
+      std::vector<IndexHit> expected;
+      for (unsigned int i = 0; i != sfps.size(); ++i) {
+        const float value = measurer->value(sfps[q], sfps[i]);
+        if (value >= 0.8) {
+          expected.push_back({.index = i, .value = value});
+        }
+      }
+      const auto actual =
+          index.search(sfps[q], MeasureType::tanimoto, 0.0, true, 0.8);
+      REQUIRE(actual.size() == expected.size());
+      for (size_t i = 0; i != expected.size(); ++i) {
+        REQUIRE(actual[i].index == expected[i].index);
+        REQUIRE(actual[i].value == expected[i].value);
+      }
+    }
+  }
+
+  SECTION("Opened by kind") {
+    REQUIRE(dynamic_cast<MinHashIndex *>(
+                open_shape_fp_index(index_path).get()) != nullptr);
+    const auto popcount_path =
+        std::filesystem::temp_directory_path() / "test_minhash_index.pci";
+    write_popcount_index(SegmentedShapeFPs(db_path), popcount_path);
+    REQUIRE(dynamic_cast<PopcountIndex *>(
+                open_shape_fp_index(popcount_path).get()) != nullptr);
+    std::filesystem::remove(popcount_path);
+    REQUIRE_THROWS_AS(open_shape_fp_index(db_path), std::runtime_error);
+  }
+
+  SECTION("Invalid queries and parameters") {
+    const auto wrong_size = clustered_sfps(1, num_bits + 1);
+    REQUIRE_THROWS_AS(index.candidates(wrong_size[0]), std::invalid_argument);
+    REQUIRE_THROWS_AS(write_minhash_index(SegmentedShapeFPs(db_path), db_path,
+                                          index_path,
+                                          {.num_bands = 0,
+                                           .rows_per_band = 2,
+                                           .seed = 0}),
+                      std::invalid_argument);
+  }
+
+  SECTION("Missing database") {
+    std::filesystem::remove(db_path);
+    REQUIRE_THROWS_AS(MinHashIndex(index_path), std::runtime_error);
+  }
+
+  std::filesystem::remove(db_path);
+  std::filesystem::remove(index_path);
+}
+} // namespace mesaac::measures::shape
@@ -0,0 +1,80 @@
+// Unit test for neighbor_lists
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "mesaac_measures/neighbor_lists.hpp"
+#include "mesaac_measures/tanimoto.hpp"
+
+namespace mesaac::measures::shape {
+namespace {
+using IndexList = NeighborLists::IndexList;
+
+// Tanimoto similarities: 0.75 within {0, 1} and {2, 3}, 0.5 between
+// 0 and 4, less than 0.5 otherwise.
+const shape_defs::ArrayBitVectors fps{{8, 0b00001111},
+                                      {8, 0b00001110},
+                                      {8, 0b11110000},
+                                      {8, 0b11100000},
+                                      {8, 0b00001001}};
+
+void check_lists(const NeighborLists &lists) {
+  REQUIRE(lists.size() == fps.size());
+  const std::vector<IndexList> expected{{1, 4}, {0}, {3}, {2}, {0}};
+  IndexList actual;
+  for (unsigned int i = 0; i != fps.size(); ++i) {
+    REQUIRE(lists.count(i) == expected[i].size());
+    lists.neighbors(i, actual);
+    REQUIRE(actual == expected[i]);
+  }
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::shape::NeighborLists",
+          "[mesaac][mesaac_measures]") {
+  const auto measure = std::make_shared<Tanimoto>();
+
+  SECTION("Similarity neighbors, in memory") {
+    const auto measurer = get_fp_measurer(measure, true, fps);
+    NeighborLists lists(*measurer, fps.size(),
+                        {.threshold = 0.5, .is_similarity = true});
+    REQUIRE_FALSE(lists.is_spilled());
+    check_lists(lists);
+  }
+
+  SECTION("Distance neighbors, spilled to disk") {
+    const auto measurer = get_fp_measurer(measure, false, fps);
+    NeighborLists lists(
+        *measurer, fps.size(),
+        {.threshold = 0.5, .is_similarity = false, .memory_budget = 0});
+    REQUIRE(lists.is_spilled());
+    check_lists(lists);
+  }
+
+  SECTION("Small batches") {
+    // Room for two full rows: rows are computed two at a time, and all of
+    // the neighbors still fit in memory.
+    const auto measurer = get_fp_measurer(measure, true, fps);
+    NeighborLists lists(
+        *measurer, fps.size(),
+        {.threshold = 0.5,
+         .is_similarity = true,
+         .memory_budget = 2 * fps.size() * sizeof(NeighborLists::Index)});
+    REQUIRE_FALSE(lists.is_spilled());
+    check_lists(lists);
+  }
+
+  SECTION("No neighbors") {
+    const auto measurer = get_fp_measurer(measure, true, fps);
+    NeighborLists lists(*measurer, fps.size(),
+                        {.threshold = 1.0, .is_similarity = true});
+    IndexList actual{42};
+    for (unsigned int i = 0; i != fps.size(); ++i) {
+      REQUIRE(lists.count(i) == 0);
+      lists.neighbors(i, actual);
+      REQUIRE(actual.empty());
+    }
+  }
+}
+} // namespace mesaac::measures::shape
@@ -0,0 +1,102 @@
+// Unit test for packed_shape_fps
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+#include "mesaac_measures/packed_shape_fps.hpp"
+
+namespace mesaac::measures::shape {
+namespace {
+using mesaac::shape::ShapeFingerprint;
+using mesaac::shape::ShapeFingerprintVector;
+
+ShapeFingerprintVector random_sfps(unsigned int num_shapes,
+                                   unsigned int num_bits) {
+  std::mt19937 gen(20101105);
+  ShapeFingerprintVector result(num_shapes);
+  for (auto &sfp : result) {
+    for (unsigned int k = 0; k != FPsPerShape; ++k) {
+      shape_defs::BitVector fp(num_bits);
+      for (unsigned int b = 0; b != num_bits; ++b) {
+        fp[b] = gen() & 1;
+      }
+      sfp.push_back(fp);
+    }
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::shape::PackedShapeFPs",
+          "[mesaac][mesaac_measures]") {
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_packed_shape_fps.bin";
+
+  SECTION("Round trip") {
+    // 130 bits spans three 64-bit words, exercising the partial last word.
+    for (const unsigned int num_bits : {8u, 64u, 130u}) {
+      const auto expected = random_sfps(9, num_bits);
+      {
+        PackedShapeFPWriter writer(path, num_bits);
+        for (const auto &sfp : expected) {
+          writer.write(sfp);
+        }
+        REQUIRE(writer.size() == expected.size());
+      }
+
+      REQUIRE(PackedShapeFPs::is_packed(path));
+      PackedShapeFPs packed(path);
+      REQUIRE(packed.size() == expected.size());
+      REQUIRE(packed.num_bits() == num_bits);
+
+      ShapeFingerprint actual;
+      for (unsigned int i = 0; i != expected.size(); ++i) {
+        packed.get(i, actual);
+        REQUIRE(actual == expected[i]);
+      }
+
+      ShapeFingerprintVector range;
+      packed.append_range(3, 7, range);
+      REQUIRE(range.size() == 4);
+      REQUIRE(range[0] == expected[3]);
+      REQUIRE(range[3] == expected[6]);
+
+      REQUIRE_THROWS_AS(packed.get(expected.size(), actual),
+                        std::out_of_range);
+    }
+  }
+
+  SECTION("Invalid shape fingerprints") {
+    PackedShapeFPWriter writer(path, 8);
+    const ShapeFingerprint too_few{{8, 0b1}, {8, 0b10}};
+    REQUIRE_THROWS_AS(writer.write(too_few), std::invalid_argument);
+
+    const ShapeFingerprint wrong_length{{8, 0b1}, {8, 0b10}, {8, 0}, {9, 0}};
+    REQUIRE_THROWS_AS(writer.write(wrong_length), std::invalid_argument);
+  }
+
+  SECTION("Invalid files") {
+    {
+      std::ofstream outf(path, std::ios::binary);
+      outf << "This is not a packed shape fingerprint file.";
+    }
+    REQUIRE(!PackedShapeFPs::is_packed(path));
+    REQUIRE_THROWS_AS(PackedShapeFPs(path), std::runtime_error);
+
+    {
+      PackedShapeFPWriter writer(path, 64);
+      writer.write(random_sfps(1, 64)[0]);
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    REQUIRE_THROWS_AS(PackedShapeFPs(path), std::runtime_error);
+  }
+
+  std::filesystem::remove(path);
+}
+} // namespace mesaac::measures::shape
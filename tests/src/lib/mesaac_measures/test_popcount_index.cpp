@@ -0,0 +1,159 @@
+// Unit test for popcount_index
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_measures/popcount_index.hpp"
+#include "mesaac_measures/shape_measures_factory.hpp"
+
+namespace mesaac::measures::shape {
+namespace {
+using mesaac::shape::ShapeFingerprint;
+using mesaac::shape::ShapeFingerprintVector;
+
+// Fingerprint densities vary from shape to shape, so that popcounts spread
+// over many buckets.
+ShapeFingerprintVector random_sfps(unsigned int num_shapes,
+                                   unsigned int num_bits) {
+  std::mt19937 gen(20101119);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  ShapeFingerprintVector result(num_shapes);
+  for (auto &sfp : result) {
+    const double density = 0.1 + 0.6 * uniform(gen);
+    for (unsigned int k = 0; k != FPsPerShape; ++k) {
+      shape_defs::BitVector fp(num_bits);
+      for (unsigned int b = 0; b != num_bits; ++b) {
+        fp[b] = uniform(gen) < density;
+      }
+      sfp.push_back(fp);
+    }
+  }
+  return result;
+}
+
+std::vector<IndexHit> scan(const ShapeFingerprintVector &sfps,
+                           const ShapeFingerprint &query, MeasureType type,
+                           float alpha, bool compute_sim, float threshold) {
+  const auto measurer =
+      get_shape_pair_measurer(get_measures(type, alpha), compute_sim);
+  std::vector<IndexHit> result;
+  for (unsigned int i = 0; i != sfps.size(); ++i) {
+    const float value = measurer->value(query, sfps[i]);
+    if (compute_sim ? (value >= threshold) : (value <= threshold)) {
+      result.push_back({.index = i, .value = value});
+    }
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::shape::get_popcount_window",
+          "[mesaac][mesaac_measures]") {
+  SECTION("Tanimoto") {
+    const auto window =
+        get_popcount_window(MeasureType::tanimoto, 0.0, 0.5, 100, 1000);
+    REQUIRE(window.min_count == 50);
+    REQUIRE(window.max_count == 200);
+  }
+
+  SECTION("Clamped to the fingerprint size") {
+    const auto window =
+        get_popcount_window(MeasureType::tanimoto, 0.0, 0.5, 600, 1000);
+    REQUIRE(window.min_count == 300);
+    REQUIRE(window.max_count == 1000);
+  }
+
+  SECTION("Unbounded measures") {
+    for (const float min_similarity : {0.0f, 0.9f}) {
+      const auto window =
+          get_popcount_window(MeasureType::bub, 0.0, min_similarity, 10, 64);
+      REQUIRE(window.min_count == 0);
+      REQUIRE(window.max_count == 64);
+    }
+    const auto window =
+        get_popcount_window(MeasureType::tanimoto, 0.0, 0.0, 10, 64);
+    REQUIRE(window.min_count == 0);
+    REQUIRE(window.max_count == 64);
+  }
+
+  SECTION("Unreachable thresholds") {
+    const auto window =
+        get_popcount_window(MeasureType::euclidean, 0.0, 1.5, 10, 64);
+    REQUIRE(window.min_count > window.max_count);
+  }
+}
+
+TEST_CASE("mesaac::measures::shape::PopcountIndex",
+          "[mesaac][mesaac_measures]") {
+  const auto db_path =
+      std::filesystem::temp_directory_path() / "test_popcount_index.db";
+  const auto index_path =
+      std::filesystem::temp_directory_path() / "test_popcount_index.idx";
+
+  const unsigned int num_bits = 200;
+  const auto sfps = random_sfps(60, num_bits);
+  {
+    PackedShapeFPWriter writer(db_path, num_bits);
+    for (const auto &sfp : sfps) {
+      writer.write(sfp);
+    }
+  }
+  write_popcount_index(SegmentedShapeFPs(db_path), index_path);
+  REQUIRE(is_popcount_index(index_path));
+  REQUIRE_FALSE(is_popcount_index(db_path));
+
+  const PopcountIndex index(index_path);
+  REQUIRE(index.size() == sfps.size());
+  REQUIRE(index.num_bits() == num_bits);
+
+  SECTION("Searches match full scans") {
+    const MeasureType types[] = {
+        MeasureType::bub,      MeasureType::cosine,   MeasureType::euclidean,
+        MeasureType::hamann,   MeasureType::tanimoto, MeasureType::tversky,
+    };
+    for (const auto type : types) {
+      for (const float alpha : {0.0f, 0.7f, 2.0f}) {
+        for (const float threshold : {0.0f, 0.3f, 0.5f, 0.8f}) {
+          for (const bool compute_sim : {true, false}) {
+            for (const unsigned int q : {0u, 17u, 42u}) {
+              const auto expected =
+                  scan(sfps, sfps[q], type, alpha, compute_sim, threshold);
+              const auto actual =
+                  index.search(sfps[q], type, alpha, compute_sim, threshold);
+              REQUIRE(actual.size() == expected.size());
+              for (size_t i = 0; i != expected.size(); ++i) {
+                REQUIRE(actual[i].index == expected[i].index);
+                REQUIRE(actual[i].value == expected[i].value);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("Invalid queries") {
+    const auto wrong_size = random_sfps(1, num_bits + 1);
+    REQUIRE_THROWS_AS(
+        index.search(wrong_size[0], MeasureType::tanimoto, 0.0, true, 0.5),
+        std::invalid_argument);
+  }
+
+  SECTION("Invalid files") {
+    REQUIRE_THROWS_AS(PopcountIndex(db_path), std::runtime_error);
+    std::filesystem::resize_file(index_path,
+                                 std::filesystem::file_size(index_path) - 8);
+    REQUIRE_THROWS_AS(PopcountIndex(index_path), std::runtime_error);
+  }
+
+  std::filesystem::remove(db_path);
+  std::filesystem::remove(index_path);
+}
+} // namespace mesaac::measures::shape
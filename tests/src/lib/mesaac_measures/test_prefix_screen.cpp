@@ -0,0 +1,120 @@
+// Unit test for prefix_screen
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include <memory>
+#include <random>
+
+#include "mesaac_measures/prefix_screen.hpp"
+#include "mesaac_measures/tanimoto.hpp"
+
+namespace mesaac::measures::shape {
+namespace {
+using mesaac::shape::ShapeFingerprintVector;
+
+const unsigned int NumBits = 512;
+const unsigned int NumShapes = 12;
+
+// Get shape fingerprints which are progressively noisier copies of a
+// single random fingerprint, so that their similarities span a wide range.
+ShapeFingerprintVector get_sfps() {
+  std::mt19937 gen(20101118);
+  shape_defs::BitVector base(NumBits);
+  for (unsigned int b = 0; b != NumBits; ++b) {
+    base[b] = gen() & 1;
+  }
+
+  ShapeFingerprintVector result(NumShapes);
+  for (unsigned int i = 0; i != NumShapes; ++i) {
+    std::bernoulli_distribution flip(0.5 * i / NumShapes);
+    for (unsigned int k = 0; k != 4; ++k) {
+      shape_defs::BitVector fp(base);
+      for (unsigned int b = 0; b != NumBits; ++b) {
+        if (flip(gen)) {
+          fp.flip(b);
+        }
+      }
+      result[i].push_back(fp);
+    }
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::shape::get_prefix_screened_measurer",
+          "[mesaac][mesaac_measures]") {
+  const auto sfps = get_sfps();
+  const auto measure = std::make_shared<Tanimoto>();
+
+  // Catch2 runs the test case once for each generated value, so that
+  // every section covers both similarity and distance screening.
+  const bool compute_sim = GENERATE(true, false);
+  const auto full = get_shape_measurer(measure, compute_sim, sfps);
+
+  // Measures the prefixes that the screened measurer uses.
+  ShapeFingerprintVector prefixes(sfps);
+  for (auto &sfp : prefixes) {
+    for (auto &fp : sfp) {
+      fp.resize(128);
+    }
+  }
+  const auto prefix = get_shape_measurer(measure, compute_sim, prefixes);
+
+  SECTION("No screening when the prefix is the whole fingerprint") {
+    const auto screened = get_prefix_screened_measurer(
+        measure, compute_sim, sfps,
+        {.num_bits = NumBits, .threshold = 0.5, .margin = 0.0});
+    for (unsigned int i = 0; i != NumShapes; ++i) {
+      for (unsigned int j = 0; j != NumShapes; ++j) {
+        REQUIRE(screened->value(i, j) == full->value(i, j));
+      }
+    }
+  }
+
+  SECTION("A wide margin never drops a pair") {
+    const auto screened = get_prefix_screened_measurer(
+        measure, compute_sim, sfps,
+        {.num_bits = 128, .threshold = 0.5, .margin = 1.0});
+    for (unsigned int i = 0; i != NumShapes; ++i) {
+      for (unsigned int j = 0; j != NumShapes; ++j) {
+        REQUIRE(screened->value(i, j) == full->value(i, j));
+      }
+    }
+  }
+
+  SECTION("Hopeless pairs get their prefix measures") {
+    const float threshold = compute_sim ? 0.6 : 0.4;
+    const auto screened = get_prefix_screened_measurer(
+        measure, compute_sim, sfps,
+        {.num_bits = 128, .threshold = threshold, .margin = 0.0});
+    unsigned int num_screened = 0, num_measured = 0;
+    for (unsigned int i = 0; i != NumShapes; ++i) {
+      for (unsigned int j = 0; j != NumShapes; ++j) {
+        const float prefix_value = prefix->value(i, j);
+        const bool hopeless = compute_sim ? (prefix_value < threshold)
+                                          : (prefix_value > threshold);
+        if (hopeless) {
+          REQUIRE(screened->value(i, j) == prefix_value);
+          num_screened++;
+        } else {
+          REQUIRE(screened->value(i, j) == full->value(i, j));
+          num_measured++;
+        }
+      }
+    }
+    REQUIRE(num_screened > 0);
+    REQUIRE(num_measured > 0);
+  }
+
+  SECTION("No measure") {
+    REQUIRE(get_prefix_screened_measurer(
+                nullptr, true, sfps,
+                {.num_bits = 128, .threshold = 0.5, .margin = 0.0}) ==
+            nullptr);
+  }
+}
+
+} // namespace mesaac::measures::shape
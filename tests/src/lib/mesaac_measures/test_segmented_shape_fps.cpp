@@ -0,0 +1,171 @@
+// Unit test for segmented_shape_fps
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+
+#include "mesaac_measures/segmented_shape_fps.hpp"
+
+namespace mesaac::measures::shape {
+namespace {
+using mesaac::shape::ShapeFingerprint;
+using mesaac::shape::ShapeFingerprintVector;
+
+ShapeFingerprintVector random_sfps(unsigned int num_shapes,
+                                   unsigned int num_bits) {
+  std::mt19937 gen(20101112);
+  ShapeFingerprintVector result(num_shapes);
+  for (auto &sfp : result) {
+    for (unsigned int k = 0; k != FPsPerShape; ++k) {
+      shape_defs::BitVector fp(num_bits);
+      for (unsigned int b = 0; b != num_bits; ++b) {
+        fp[b] = gen() & 1;
+      }
+      sfp.push_back(fp);
+    }
+  }
+  return result;
+}
+
+void append(const std::filesystem::path &dir,
+            const ShapeFingerprintVector &sfps, unsigned int begin,
+            unsigned int end) {
+  SegmentedShapeFPWriter writer(dir, sfps[0][0].size());
+  REQUIRE(writer.first_index() == begin);
+  for (unsigned int i = begin; i != end; ++i) {
+    writer.write(sfps[i]);
+  }
+  writer.close();
+}
+
+void require_contents(const SegmentedShapeFPs &db,
+                      const ShapeFingerprintVector &expected) {
+  REQUIRE(db.size() == expected.size());
+  ShapeFingerprint actual;
+  for (unsigned int i = 0; i != expected.size(); ++i) {
+    db.get(i, actual);
+    REQUIRE(actual == expected[i]);
+    const auto popcounts = db.popcounts(i);
+    for (unsigned int k = 0; k != FPsPerShape; ++k) {
+      REQUIRE(popcounts[k] == expected[i][k].count());
+    }
+  }
+  REQUIRE_THROWS_AS(db.get(expected.size(), actual), std::out_of_range);
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::shape::SegmentedShapeFPs",
+          "[mesaac][mesaac_measures]") {
+  const auto dir =
+      std::filesystem::temp_directory_path() / "test_segmented_shape_fps.db";
+  std::filesystem::remove_all(dir);
+
+  const unsigned int num_bits = 130;
+  const auto expected = random_sfps(12, num_bits);
+
+  SECTION("Append segments") {
+    append(dir, expected, 0, 5);
+    append(dir, expected, 5, 6);
+    append(dir, expected, 6, 12);
+
+    REQUIRE(SegmentedShapeFPs::is_database(dir));
+    const SegmentedShapeFPs db(dir);
+    REQUIRE(db.num_segments() == 3);
+    REQUIRE(db.num_bits() == num_bits);
+    require_contents(db, expected);
+
+    ShapeFingerprintVector range;
+    db.append_range(3, 8, range);
+    REQUIRE(range.size() == 5);
+    REQUIRE(range[0] == expected[3]);
+    REQUIRE(range[4] == expected[7]);
+  }
+
+  SECTION("Compaction preserves global indices") {
+    append(dir, expected, 0, 4);
+    append(dir, expected, 4, 12);
+    const SegmentedShapeFPs before(dir);
+    REQUIRE(compact_segments(dir) == 2);
+    REQUIRE(before.is_stale());
+    // Readers opened before compaction keep working.
+    require_contents(before, expected);
+
+    const SegmentedShapeFPs after(dir);
+    REQUIRE(after.num_segments() == 1);
+    REQUIRE_FALSE(after.is_stale());
+    require_contents(after, expected);
+    REQUIRE(compact_segments(dir) == 0);
+
+    // Later appends follow the compacted segment.
+    const auto more = random_sfps(2, num_bits);
+    {
+      SegmentedShapeFPWriter writer(dir, num_bits);
+      REQUIRE(writer.first_index() == expected.size());
+      writer.write(more[0]);
+      writer.write(more[1]);
+      writer.close();
+    }
+    REQUIRE(after.is_stale());
+    const SegmentedShapeFPs appended(dir);
+    REQUIRE(appended.num_segments() == 2);
+    ShapeFingerprint actual;
+    appended.get(expected.size() + 1, actual);
+    REQUIRE(actual == more[1]);
+  }
+
+  SECTION("Unpublished segments are invisible") {
+    append(dir, expected, 0, 3);
+    {
+      SegmentedShapeFPWriter writer(dir, num_bits);
+      writer.write(expected[3]);
+      // Destroyed without close()
+    }
+    {
+      SegmentedShapeFPWriter writer(dir, num_bits);
+      writer.close();
+    }
+    const SegmentedShapeFPs db(dir);
+    REQUIRE(db.num_segments() == 1);
+    REQUIRE(db.size() == 3);
+  }
+
+  SECTION("Mismatched fingerprint sizes") {
+    append(dir, expected, 0, 3);
+    REQUIRE_THROWS_AS(SegmentedShapeFPWriter(dir, num_bits + 1),
+                      std::runtime_error);
+
+    SegmentedShapeFPWriter writer(dir, num_bits);
+    const auto wrong_size = random_sfps(1, num_bits + 1);
+    REQUIRE_THROWS_AS(writer.write(wrong_size[0]), std::invalid_argument);
+  }
+
+  SECTION("Packed database files") {
+    const auto path = dir.string() + ".bin";
+    {
+      PackedShapeFPWriter writer(path, num_bits);
+      for (const auto &sfp : expected) {
+        writer.write(sfp);
+      }
+    }
+    REQUIRE(SegmentedShapeFPs::is_database(path));
+    const SegmentedShapeFPs db(path);
+    REQUIRE(db.num_segments() == 1);
+    REQUIRE_FALSE(db.is_stale());
+    require_contents(db, expected);
+    std::filesystem::remove(path);
+  }
+
+  SECTION("Invalid databases") {
+    std::filesystem::create_directories(dir);
+    REQUIRE_FALSE(SegmentedShapeFPs::is_database(dir));
+    REQUIRE_THROWS_AS(SegmentedShapeFPs(dir), std::runtime_error);
+    REQUIRE_THROWS_AS(compact_segments(dir), std::runtime_error);
+  }
+
+  std::filesystem::remove_all(dir);
+}
+} // namespace mesaac::measures::shape
@@ -9,8 +9,10 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "mesaac_measures/bub.hpp"
 #include "mesaac_measures/cosine.hpp"
@@ -318,6 +320,86 @@ void test_shape_pair_measurer(FPGroupGen &&fp_gen) {
   // TBD
 }
 
+// A measure the batch measurers don't know, to exercise their fallback
+// to virtual dispatch.
+class HalfTanimoto : public MeasuresBase {
+public:
+  using MeasuresBase::similarity;
+  std::string name() const override { return "HalfTanimoto"; }
+  float similarity(const ContingencyCounts &counts) const override {
+    return 0.5f * Tanimoto().similarity(counts);
+  }
+};
+
+shape_defs::BitVector random_bv(std::mt19937 &gen, unsigned int num_bits) {
+  shape_defs::BitVector result(num_bits);
+  for (unsigned int b = 0; b != num_bits; ++b) {
+    result[b] = (gen() % 3) == 0;
+  }
+  return result;
+}
+
+void require_batches_match(const shape::IIndexedShapeFPMeasure &measurer,
+                           unsigned int num_fps) {
+  // Rows and blocks must agree exactly with pairwise values, including
+  // for column ranges wider than one tile and for self-comparisons.
+  std::vector<float> row(num_fps);
+  for (unsigned int i = 0; i != num_fps; ++i) {
+    measurer.value_row(i, 0, num_fps, row.data());
+    for (unsigned int j = 0; j != num_fps; ++j) {
+      REQUIRE(row[j] == measurer.value(i, j));
+    }
+  }
+
+  const unsigned int i_begin = 3, i_end = 9, j_begin = 5, j_end = num_fps;
+  const unsigned int num_cols = j_end - j_begin;
+  std::vector<float> block((i_end - i_begin) * num_cols);
+  measurer.value_block(i_begin, i_end, j_begin, j_end, block.data());
+  for (unsigned int i = i_begin; i != i_end; ++i) {
+    for (unsigned int j = j_begin; j != j_end; ++j) {
+      REQUIRE(block[(i - i_begin) * num_cols + (j - j_begin)] ==
+              measurer.value(i, j));
+    }
+  }
+
+  // Empty ranges write nothing.
+  measurer.value_row(0, 4, 4, nullptr);
+  measurer.value_block(2, 2, 0, num_fps, nullptr);
+}
+
+void test_batches(const MeasuresBase::Ptr measure, bool compute_sim) {
+  std::mt19937 gen(20101112);
+  // Not a multiple of the 64-bit word size.
+  const unsigned int num_bits = 150;
+  const unsigned int num_fps = 80;
+
+  shape_defs::ArrayBitVectors fps;
+  shape_defs::ShapeFPBlocks shape_fps;
+  for (unsigned int i = 0; i != num_fps; ++i) {
+    fps.push_back(random_bv(gen, num_bits));
+    shape_defs::ArrayBitVectors sfp{fps.back()};
+    while (sfp.size() != 4) {
+      sfp.push_back(random_bv(gen, num_bits));
+    }
+    shape_fps.push_back(sfp);
+  }
+
+  INFO(measure->name() << (compute_sim ? " similarity" : " distance"));
+  const auto fp_measurer = shape::get_fp_measurer(measure, compute_sim, fps);
+  require_batches_match(*fp_measurer, num_fps);
+  // Self-comparisons are exact by definition; the rest use the measure.
+  for (unsigned int j = 2; j != num_fps; ++j) {
+    const float expected = compute_sim ? measure->similarity(fps[1], fps[j])
+                                       : measure->distance(fps[1], fps[j]);
+    REQUIRE_THAT(fp_measurer->value(1, j),
+                 Catch::Matchers::WithinAbs(expected, 1.0e-6));
+  }
+
+  const auto shape_measurer =
+      shape::get_shape_measurer(measure, compute_sim, shape_fps);
+  require_batches_match(*shape_measurer, num_fps);
+}
+
 TEST_CASE("mesaac::measures::shape_measures_factory",
           "[mesaac][mesaac_measures]") {
   constexpr int num_bits = 4;
@@ -385,6 +467,15 @@ TEST_CASE("mesaac::measures::shape_measures_factory",
         // TBD
       }
     }
+
+    SECTION("Row and block batches") {
+      auto all_measures = measures;
+      all_measures.push_back(std::make_shared<HalfTanimoto>());
+      for (const auto &measure : all_measures) {
+        test_batches(measure, true);
+        test_batches(measure, false);
+      }
+    }
   }
 
   SECTION("Getting fingerprint measures") {
@@ -0,0 +1,174 @@
+// Unit test for usr_measures
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_measures/usr_measures.hpp"
+
+namespace mesaac::measures {
+namespace {
+using Catch::Matchers::WithinAbs;
+
+std::vector<std::vector<float>> random_values(unsigned int num_vectors,
+                                              unsigned int num_features) {
+  std::mt19937 gen(20110412);
+  std::uniform_real_distribution<float> dist(0.0, 8.0);
+  std::vector<std::vector<float>> result(num_vectors);
+  for (auto &values : result) {
+    for (unsigned int k = 0; k != num_features; ++k) {
+      values.push_back(dist(gen));
+    }
+  }
+  return result;
+}
+
+UsrVectors as_usr_vectors(const std::vector<std::vector<float>> &values) {
+  UsrVectors result(values.at(0).size());
+  for (const auto &v : values) {
+    result.push_back(v);
+  }
+  return result;
+}
+
+// The original, unvectorized USR S measure.
+float reference_similarity(const std::vector<float> &a,
+                           const std::vector<float> &b) {
+  float sum = 0.0;
+  for (unsigned int k = 0; k != a.size(); ++k) {
+    sum += std::fabs(a[k] - b[k]);
+  }
+  return 1.0 / (1.0 + sum / a.size());
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::usr_similarities", "[mesaac][mesaac_measures]") {
+  // Enough vectors to span several row and column tiles.
+  const auto values = random_values(300, 12);
+  const auto vectors = as_usr_vectors(values);
+
+  SECTION("Full matrix") {
+    std::vector<float> sims(vectors.size() * vectors.size());
+    usr_similarities(vectors, 0, vectors.size(), vectors, sims);
+    for (unsigned int i = 0; i != values.size(); ++i) {
+      for (unsigned int j = 0; j != values.size(); ++j) {
+        const float expected = reference_similarity(values[i], values[j]);
+        REQUIRE_THAT(sims[i * values.size() + j],
+                     WithinAbs(expected, 1.0e-6));
+      }
+    }
+  }
+
+  SECTION("Row range of other vectors") {
+    const auto col_values = random_values(17, 12);
+    const auto cols = as_usr_vectors(col_values);
+    std::vector<float> sims(5 * cols.size());
+    usr_similarities(vectors, 40, 45, cols, sims);
+    for (unsigned int i = 0; i != 5; ++i) {
+      for (unsigned int j = 0; j != cols.size(); ++j) {
+        const float expected =
+            reference_similarity(values[40 + i], col_values[j]);
+        REQUIRE_THAT(sims[i * cols.size() + j],
+                     WithinAbs(expected, 1.0e-6));
+      }
+    }
+  }
+
+  SECTION("Invalid arguments") {
+    const auto other = as_usr_vectors(random_values(3, 60));
+    std::vector<float> sims(vectors.size() * vectors.size());
+    REQUIRE_THROWS_AS(usr_similarities(vectors, 0, 1, other, sims),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(
+        usr_similarities(vectors, 0, vectors.size() + 1, vectors, sims),
+        std::invalid_argument);
+    std::vector<float> too_small(vectors.size() - 1);
+    REQUIRE_THROWS_AS(usr_similarities(vectors, 0, 1, vectors, too_small),
+                      std::invalid_argument);
+  }
+}
+
+TEST_CASE("mesaac::measures::usr_top_k", "[mesaac][mesaac_measures]") {
+  const auto values = random_values(50, 12);
+  const auto vectors = as_usr_vectors(values);
+  const auto &query = values[7];
+
+  SECTION("Top k") {
+    const auto hits = usr_top_k(vectors, query, 5);
+    REQUIRE(hits.size() == 5);
+    REQUIRE(hits[0].index == 7);
+    REQUIRE_THAT(hits[0].similarity, WithinAbs(1.0, 1.0e-6));
+    for (unsigned int h = 1; h != hits.size(); ++h) {
+      REQUIRE(hits[h - 1].similarity >= hits[h].similarity);
+    }
+    // No other vector may be more similar than the last hit.
+    unsigned int num_better = 0;
+    for (const auto &v : values) {
+      if (reference_similarity(query, v) > hits.back().similarity + 1.0e-6) {
+        num_better++;
+      }
+    }
+    REQUIRE(num_better < hits.size());
+  }
+
+  SECTION("More than available") {
+    REQUIRE(usr_top_k(vectors, query, 100).size() == values.size());
+    REQUIRE(usr_top_k(vectors, query, 0).empty());
+  }
+
+  SECTION("Wrong query length") {
+    const std::vector<float> too_long(13, 0.0);
+    REQUIRE_THROWS_AS(usr_top_k(vectors, too_long, 1), std::invalid_argument);
+  }
+}
+
+TEST_CASE("mesaac::measures::usr_within", "[mesaac][mesaac_measures]") {
+  const auto values = random_values(50, 12);
+  const auto vectors = as_usr_vectors(values);
+  const auto &query = values[11];
+  const float min_similarity = 0.4;
+
+  const auto hits = usr_within(vectors, query, min_similarity);
+  unsigned int h = 0;
+  for (unsigned int i = 0; i != values.size(); ++i) {
+    const float expected = reference_similarity(query, values[i]);
+    // Skip values too close to the threshold to call.
+    if (std::fabs(expected - min_similarity) < 1.0e-5) {
+      if ((h < hits.size()) && (hits[h].index == i)) {
+        h++;
+      }
+    } else if (expected > min_similarity) {
+      REQUIRE(h < hits.size());
+      REQUIRE(hits[h].index == i);
+      REQUIRE_THAT(hits[h].similarity, WithinAbs(expected, 1.0e-6));
+      h++;
+    }
+  }
+  REQUIRE(h == hits.size());
+}
+
+TEST_CASE("mesaac::measures::get_usr_measurer", "[mesaac][mesaac_measures]") {
+  const auto values = random_values(10, 12);
+  const auto vectors = as_usr_vectors(values);
+
+  const auto sim = get_usr_measurer(true, vectors);
+  const auto dist = get_usr_measurer(false, vectors);
+  for (unsigned int i = 0; i != values.size(); ++i) {
+    REQUIRE(sim->value(i, i) == 1.0);
+    REQUIRE(dist->value(i, i) == 0.0);
+    for (unsigned int j = 0; j != values.size(); ++j) {
+      if (i != j) {
+        const float expected = reference_similarity(values[i], values[j]);
+        REQUIRE_THAT(sim->value(i, j), WithinAbs(expected, 1.0e-6));
+        REQUIRE_THAT(dist->value(i, j), WithinAbs(1.0 - expected, 1.0e-6));
+      }
+    }
+  }
+}
+} // namespace mesaac::measures
@@ -0,0 +1,116 @@
+// Unit test for usr_vectors
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_measures/usr_vectors.hpp"
+
+namespace mesaac::measures {
+namespace {
+std::vector<std::vector<float>> sample_values(unsigned int num_vectors,
+                                              unsigned int num_features) {
+  std::vector<std::vector<float>> result;
+  for (unsigned int i = 0; i != num_vectors; ++i) {
+    std::vector<float> values;
+    for (unsigned int k = 0; k != num_features; ++k) {
+      values.push_back(0.25 * i + 0.5 * k);
+    }
+    result.push_back(values);
+  }
+  return result;
+}
+
+void require_values(const UsrVectors &vectors,
+                    const std::vector<std::vector<float>> &expected) {
+  REQUIRE(vectors.size() == expected.size());
+  for (unsigned int i = 0; i != expected.size(); ++i) {
+    const float *actual = vectors[i];
+    for (unsigned int k = 0; k != vectors.stride(); ++k) {
+      const float expected_value =
+          (k < expected[i].size()) ? expected[i][k] : 0.0;
+      REQUIRE(actual[k] == expected_value);
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("mesaac::measures::UsrVectors", "[mesaac][mesaac_measures]") {
+  const auto path =
+      std::filesystem::temp_directory_path() / "test_usr_vectors.bin";
+
+  SECTION("Padding") {
+    // USR has 12 descriptors; USRCAT has 60.
+    for (const unsigned int num_features : {12u, 16u, 60u}) {
+      const auto expected = sample_values(5, num_features);
+      UsrVectors vectors(num_features);
+      for (const auto &values : expected) {
+        vectors.push_back(values);
+      }
+      REQUIRE(vectors.num_features() == num_features);
+      REQUIRE(vectors.stride() % UsrVectors::Chunk == 0);
+      REQUIRE(vectors.stride() >= num_features);
+      REQUIRE(vectors.stride() < num_features + UsrVectors::Chunk);
+      require_values(vectors, expected);
+    }
+  }
+
+  SECTION("Round trip") {
+    const auto expected = sample_values(7, 12);
+    {
+      UsrVectorWriter writer(path, 12);
+      for (const auto &values : expected) {
+        writer.write(values);
+      }
+      REQUIRE(writer.size() == expected.size());
+    }
+
+    REQUIRE(UsrVectors::is_packed(path));
+    const UsrVectors packed(path);
+    REQUIRE(packed.num_features() == 12);
+    require_values(packed, expected);
+  }
+
+  SECTION("Invalid vectors") {
+    UsrVectors vectors(12);
+    const std::vector<float> too_short(11, 0.0);
+    REQUIRE_THROWS_AS(vectors.push_back(too_short), std::invalid_argument);
+
+    UsrVectorWriter writer(path, 12);
+    REQUIRE_THROWS_AS(writer.write(too_short), std::invalid_argument);
+  }
+
+  SECTION("Mapped vectors are read-only") {
+    {
+      UsrVectorWriter writer(path, 12);
+    }
+    UsrVectors packed(path);
+    REQUIRE(packed.size() == 0);
+    const std::vector<float> values(12, 0.0);
+    REQUIRE_THROWS_AS(packed.push_back(values), std::logic_error);
+  }
+
+  SECTION("Invalid files") {
+    {
+      std::ofstream outf(path, std::ios::binary);
+      outf << "0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9 1.0 1.1 1.2\n";
+    }
+    REQUIRE_FALSE(UsrVectors::is_packed(path));
+    REQUIRE_THROWS_AS(UsrVectors(path), std::runtime_error);
+
+    {
+      UsrVectorWriter writer(path, 12);
+      writer.write(sample_values(1, 12)[0]);
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    REQUIRE_THROWS_AS(UsrVectors(path), std::runtime_error);
+  }
+
+  std::filesystem::remove(path);
+}
+} // namespace mesaac::measures
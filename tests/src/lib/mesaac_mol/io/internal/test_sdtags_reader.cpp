@@ -27,14 +27,15 @@ $$$$)LINES");
 
   REQUIRE(reader_result.is_ok());
 
-  const std::map<std::string, std::string> expected{
-      {">  <Name>", "A Chemical Structure\n"},
-      {">  <Family>", "A.1\n"},
-      {">  <IC50_uM>", "0.06\n"},
-      {">  <set>", "1\n"},
-  };
+  // Tags keep their file order.
+  SDTagMap expected;
+  expected.add("Name", "A Chemical Structure\n");
+  expected.add("Family", "A.1\n");
+  expected.add("IC50_uM", "0.06\n");
+  expected.add("set", "1\n");
   const auto &actual = reader_result.value();
   REQUIRE(actual == expected);
+  REQUIRE(actual.get<float>("IC50_uM") == 0.06f);
 }
 
 TEST_CASE("mesaac::mol::internal::SDTagsReader - Missing terminator",
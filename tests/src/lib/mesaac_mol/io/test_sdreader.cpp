@@ -43,7 +43,7 @@ const std::filesystem::path test_sdf_path(const std::string &rel_path) {
 
 string tagstr(const Mol &m) {
   ostringstream resultf;
-  // Maps are supposed to keep their keys in sorted order.
+  // Tags are kept in file order.
   for (const auto &[key, value] : m.tags()) {
     resultf << "'" << key << "' = '" << value << "'" << endl;
   }
@@ -147,6 +147,50 @@ TEST_CASE("mesaac::mol::SDReader - Multiple structures", "[mesaac]") {
   REQUIRE(num_found == 467u);
 }
 
+TEST_CASE("mesaac::mol::SDReader - Refill a Mol", "[mesaac]") {
+  // Reading into an existing Mol must give the same molecules as reading
+  // new ones, although the molecules vary in size.
+  std::filesystem::path pathname(test_sdf_path("cox2_3d.sd"));
+  ifstream inf(pathname);
+  SDReader reader(inf, pathname);
+  ifstream refill_inf(pathname);
+  SDReader refill_reader(refill_inf, pathname);
+
+  Mol refilled;
+  unsigned int num_found = 0;
+  for (;;) {
+    auto result = reader.read();
+    const auto refill_result = refill_reader.read(refilled);
+    REQUIRE(result.is_ok() == refill_result.is_ok());
+    if (!result.is_ok()) {
+      break;
+    }
+    const Mol m(std::move(result).value());
+    REQUIRE(refilled.name() == m.name());
+    REQUIRE(refilled.num_atoms() == m.num_atoms());
+    REQUIRE(refilled.num_bonds() == m.num_bonds());
+    for (unsigned int i = 0; i != m.num_atoms(); i++) {
+      const Atom &expected(m.atoms().at(i));
+      const Atom &actual(refilled.atoms().at(i));
+      REQUIRE(actual.atomic_num() == expected.atomic_num());
+      REQUIRE(actual.pos().x() == expected.pos().x());
+      REQUIRE(actual.pos().y() == expected.pos().y());
+      REQUIRE(actual.pos().z() == expected.pos().z());
+      REQUIRE(actual.optional_cols() == expected.optional_cols());
+    }
+    for (unsigned int i = 0; i != m.num_bonds(); i++) {
+      const Bond &expected(m.bonds().at(i));
+      const Bond &actual(refilled.bonds().at(i));
+      REQUIRE(actual.a0() == expected.a0());
+      REQUIRE(actual.a1() == expected.a1());
+      REQUIRE(actual.optional_cols() == expected.optional_cols());
+    }
+    REQUIRE(tagstr(refilled) == tagstr(m));
+    num_found++;
+  }
+  REQUIRE(num_found == 467u);
+}
+
 TEST_CASE("mesaac::mol::SDReader - Properties block", "[mesaac]") {
   // Show we can read properties blocks.
   // The block contents are not used by mesaac::mol.  They are preserved
@@ -212,13 +256,12 @@ TEST_CASE("mesaac::mol::SDReader - Tags", "[mesaac]") {
   }
 
   const string exp_last(
-      "'>   (MD-0894)	<BOILING.POINT>	FROM ARCHIVES' = 'Yet another example, "
-      "with extensive whitespace after the '> '.\n'\n'> (MD-0894)	"
-      "<BOILING.POINT>	FROM ARCHIVES' = 'Yet another example.\n'\n'> "
-      "<Attribute>' = '1\n'\n'> <ID>' = '644742\n'\n'> DT12	55' = 'Another "
-      "sample\nwith multiline values.\n'\n'>55 (MD-08974)	"
+      "'> <ID>' = '644742\n'\n'> <Attribute>' = '1\n'\n'>55 (MD-08974)	"
       "<BOILING.POINT>	DT12' = 'This is a sample tag from the ctfile "
-      "spec.\n'\n");
+      "spec.\n'\n'> DT12	55' = 'Another sample\nwith multiline values.\n'\n"
+      "'> (MD-0894)	<BOILING.POINT>	FROM ARCHIVES' = 'Yet another "
+      "example.\n'\n'>   (MD-0894)	<BOILING.POINT>	FROM ARCHIVES' = 'Yet "
+      "another example, with extensive whitespace after the '> '.\n'\n");
   if (exp_last != prev) {
     cerr << "tag strings don't match:" << endl
          << "Diff    : " << strdiff_summary(exp_last, prev) << endl;
@@ -79,10 +79,8 @@ TEST_CASE("mesaac::mol::SDWriter - Dimensionality", "[mesaac]") {
 }
 
 TEST_CASE("mesaac::mol::SDWriter - Basic writing", "[mesaac]") {
-  // OBS:  mol::SDWriter will write out its tags by lexical order
-  // of tag header.  This may not be the same as the input.
-  // For simplified testing, use an input file whose tags are
-  // already sorted lexically by tag header.
+  // mol::SDWriter writes tags in the order in which they were read.
+  // (It used to sort them by tag header, hence this input file.)
   const filesystem::path in_path(test_sdf_path("sorted_tags.sdf"));
   ifstream inf(in_path);
   SDReader reader(inf, in_path);
@@ -0,0 +1,90 @@
+// Unit test for mol::SDTagMap
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_mol/sd_tag_map.hpp"
+
+using namespace std;
+
+namespace mesaac::mol {
+namespace {
+TEST_CASE("mesaac::mol::SDTagMap", "[mesaac]") {
+  SECTION("Names and header lines") {
+    SDTagMap tags;
+    REQUIRE(tags.empty());
+    tags.add("t1", 1.0);
+    tags.add_unparsed(">  <t2>  (MFCD0001)", "two\n");
+    tags.add_unparsed("> DT12  55", "no name\n");
+    REQUIRE(tags.size() == 3);
+
+    // Tags can be found by name or by header line.
+    REQUIRE(tags.at("t1") == "1");
+    REQUIRE(tags.at(">  <t1>") == "1");
+    REQUIRE(tags.at("t2") == "two\n");
+    REQUIRE(tags.at(">  <t2>  (MFCD0001)") == "two\n");
+    REQUIRE(tags.at("> DT12  55") == "no name\n");
+    REQUIRE(!tags.contains(">  <t2>"));
+    REQUIRE(!tags.contains("t3"));
+    REQUIRE_THROWS_AS(tags.at("t3"), out_of_range);
+
+    // Tags keep the order in which they were added.
+    vector<string> names;
+    for (const auto &tag : tags) {
+      names.push_back(string(tag.name()));
+    }
+    REQUIRE(names == vector<string>{"t1", "t2", ""});
+  }
+
+  SECTION("Last one wins") {
+    SDTagMap tags;
+    tags.add("t1", "first");
+    tags.add("t2", "second");
+    tags.add("t1", 42.0);
+    REQUIRE(tags.size() == 2);
+    REQUIRE(tags.begin()->line == ">  <t1>");
+    REQUIRE(tags.get<double>("t1") == 42.0);
+    REQUIRE(tags.at("t2") == "second");
+  }
+
+  SECTION("Numeric values") {
+    SDTagMap tags;
+    tags.add("float", 0.1234567f);
+    tags.add("int", -17);
+    tags.add("padded", "  +3.5e2 kcal/mol\n");
+    tags.add("text", "not a number\n");
+    // Numbers are formatted as by an ostream.
+    REQUIRE(tags.at("float") == "0.123457");
+    REQUIRE(tags.get<float>("float") == 0.123457f);
+    REQUIRE(tags.get<int>("int") == -17);
+    REQUIRE(tags.get<double>("padded") == 350.0);
+    REQUIRE(tags.get<int>("padded") == 3);
+    REQUIRE(!tags.get<double>("text").has_value());
+    REQUIRE(!tags.get<double>("missing").has_value());
+  }
+
+  SECTION("Copies and reuse") {
+    SDTagMap tags;
+    tags.add("t1", "one");
+    SDTagMap copy(tags);
+    tags.clear();
+    REQUIRE(tags.empty());
+    REQUIRE(copy.at("t1") == "one");
+
+    // Values may come from the map itself.
+    tags.add("t1", "one");
+    tags.add("t2", tags.at("t1"));
+    REQUIRE(tags.at("t2") == "one");
+    REQUIRE(tags != copy);
+
+    tags.swap(copy);
+    REQUIRE(tags.size() == 1);
+    REQUIRE(copy.size() == 2);
+  }
+}
+} // namespace
+} // namespace mesaac::mol
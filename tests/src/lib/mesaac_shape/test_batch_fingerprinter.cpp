@@ -0,0 +1,107 @@
+// Unit test for batch_fingerprinter.
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_shape/batch_fingerprinter.hpp"
+#include "mesaac_shape/fingerprinter.hpp"
+#include "mesaac_shape/hammersley.hpp"
+
+using namespace std;
+
+namespace mesaac::shape {
+namespace {
+struct Conformer {
+  mol::AtomVector atoms;
+  vector<float> coords;
+  vector<float> radii;
+
+  explicit Conformer(float wobble) {
+    float y = wobble;
+    for (float x = -4.0; x <= 4.0; x += 2.0) {
+      atoms.push_back(mol::Atom({.atomic_num = 12, .pos = {x, y, 0}}));
+      y = -y;
+    }
+    for (const auto &atom : atoms) {
+      const auto &pos(atom.pos());
+      coords.insert(coords.end(), {pos.x(), pos.y(), pos.z()});
+      radii.push_back(atom.radius());
+    }
+  }
+
+  ConformerView view() const { return {.coords = coords, .radii = radii}; }
+};
+
+TEST_CASE("mesaac::shape::BatchFingerprinter", "[mesaac]") {
+  PointList hamms;
+  Hammersley::get_ellipsoid(
+      {.num_points = 1000, .scale = 6.0, .a = 1.0, .b = 0.5, .c = 0.25},
+      hamms);
+  const VolBox volbox(hamms, 1.0);
+
+  const vector<Conformer> conformers{Conformer(0.0), Conformer(0.5),
+                                     Conformer(1.0)};
+  vector<ConformerView> views;
+  for (const auto &conformer : conformers) {
+    views.push_back(conformer.view());
+  }
+
+  const BatchFingerprinter batch(volbox);
+  REQUIRE(batch.num_bits() == hamms.size());
+  REQUIRE(batch.words_per_fingerprint() == (hamms.size() + 63) / 64);
+  REQUIRE(batch.words_per_conformer() == 4 * batch.words_per_fingerprint());
+
+  SECTION("Matches Fingerprinter") {
+    vector<BatchFingerprinter::Word> words(batch.buffer_words(views.size()));
+    batch.compute(views, words);
+
+    Fingerprinter fingerprinter(volbox);
+    for (size_t i = 0; i < conformers.size(); ++i) {
+      ShapeFingerprint expected;
+      fingerprinter.compute(conformers[i].atoms, expected);
+      REQUIRE(expected.size() == BatchFingerprinter::NumOrientations);
+      for (size_t j = 0; j < expected.size(); ++j) {
+        const auto *first = words.data() + i * batch.words_per_conformer() +
+                            j * batch.words_per_fingerprint();
+        const Fingerprint actual(first, first + batch.words_per_fingerprint());
+        Fingerprint trimmed(actual);
+        trimmed.resize(expected[j].size());
+        REQUIRE(expected[j].any());
+        REQUIRE(trimmed == expected[j]);
+        // Padding bits are clear.
+        REQUIRE(actual.count() == expected[j].count());
+      }
+    }
+
+    // Results do not depend on the number of threads.
+    for (const unsigned int num_threads : {1, 3}) {
+      const BatchFingerprinter threaded(volbox, num_threads);
+      vector<BatchFingerprinter::Word> threaded_words(words.size());
+      threaded.compute(views, threaded_words);
+      REQUIRE(threaded_words == words);
+    }
+  }
+
+  SECTION("Empty batch") {
+    vector<BatchFingerprinter::Word> words;
+    REQUIRE_NOTHROW(batch.compute({}, words));
+  }
+
+  SECTION("Invalid arguments") {
+    vector<BatchFingerprinter::Word> words(batch.buffer_words(views.size()) -
+                                           1);
+    REQUIRE_THROWS_AS(batch.compute(views, words), invalid_argument);
+
+    words.resize(batch.buffer_words(1));
+    const vector<float> coords{0.0, 0.0, 0.0, 1.0};
+    const vector<float> radii{1.5};
+    const ConformerView bad{.coords = coords, .radii = radii};
+    REQUIRE_THROWS_AS(batch.compute({&bad, 1}, words), invalid_argument);
+  }
+}
+} // namespace
+} // namespace mesaac::shape
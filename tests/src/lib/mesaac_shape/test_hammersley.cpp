@@ -5,6 +5,9 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 #include "mesaac_shape/hammersley.hpp"
 
 using namespace std;
@@ -40,6 +43,23 @@ void check_max_extents(const PointList &points, float xmin, float xmax,
   }
 }
 
+TEST_CASE("mesaac::shape::radical_inverse", "[mesaac]") {
+  REQUIRE(radical_inverse(2, 0) == 0.0);
+  REQUIRE(radical_inverse(2, 1) == 0.5);
+  // 110 -> .011
+  REQUIRE(radical_inverse(2, 6) == 0.375);
+  REQUIRE(radical_inverse(2, 0x80000000) == 0x1p-32);
+  REQUIRE(radical_inverse(3, 1) == 1.0 / 3.0);
+  // 12 -> .21
+  REQUIRE(radical_inverse(3, 5) == 7.0 / 9.0);
+  // 102 -> .201
+  REQUIRE(radical_inverse(5, 27) == 51.0 / 125.0);
+  // 3^20 - 1 has twenty base-3 digits, all 2s.
+  const double all_twos = radical_inverse(3, 3486784400U);
+  REQUIRE_THAT(all_twos, Catch::Matchers::WithinAbs(1.0, 1.0e-9));
+  REQUIRE(all_twos < 1.0);
+}
+
 TEST_CASE("mesaac::shape::Hammersley - get_ellipsoid", "[mesaac]") {
   const unsigned int num_points = 10240;
   const float scale = 1.0;
@@ -64,6 +84,81 @@ TEST_CASE("mesaac::shape::Hammersley - get_ellipsoid", "[mesaac]") {
   }
 }
 
+TEST_CASE("mesaac::shape::Hammersley - get_ellipsoid_from_cube", "[mesaac]") {
+  // Spans several generation batches.
+  const unsigned int num_candidates = 10000;
+  const float scale = 2.0;
+  const float a = 1.0, b = 0.5, c = 0.25;
+
+  PointList points;
+  Hammersley::get_ellipsoid_from_cube(
+      {.num_points = num_candidates, .scale = scale, .a = a, .b = b, .c = c},
+      num_candidates, points);
+
+  // Compare to a one-point-at-a-time filter.
+  PointList expected;
+  for (unsigned int i = 1; i <= num_candidates; ++i) {
+    const float x = scale * (1.0 - 2.0 * i / num_candidates);
+    const float y = scale * (1.0 - 2.0 * radical_inverse(2, i));
+    const float z = scale * (1.0 - 2.0 * radical_inverse(3, i));
+    if ((x * x / a + y * y / b + z * z / c) < scale * scale) {
+      expected.push_back({x, y, z});
+    }
+  }
+  REQUIRE(!expected.empty());
+  REQUIRE(points.size() == expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    for (unsigned int k = 0; k < 3; ++k) {
+      REQUIRE_THAT(points[i][k],
+                   Catch::Matchers::WithinAbs(expected[i][k], 1.0e-6));
+    }
+  }
+
+  SECTION("Maximum number of points") {
+    PointList truncated;
+    Hammersley::get_ellipsoid_from_cube(
+        {.num_points = 100, .scale = scale, .a = a, .b = b, .c = c},
+        num_candidates, truncated);
+    REQUIRE(truncated.size() == 100);
+    REQUIRE(truncated[99] == points[99]);
+  }
+}
+
+TEST_CASE("mesaac::shape::get_halton_ellipsoid", "[mesaac]") {
+  const float scale = 2.0;
+  const float a = 1.0, b = 0.5, c = 0.25;
+
+  PointList points;
+  get_halton_ellipsoid(
+      {.num_points = 5000, .scale = scale, .a = a, .b = b, .c = c}, points);
+  REQUIRE(points.size() == 5000);
+  for (const auto &point : points) {
+    const auto mag = (point[0] * point[0] / a) + (point[1] * point[1] / b) +
+                     (point[2] * point[2] / c);
+    REQUIRE(mag < scale * scale);
+  }
+
+  // Smaller point sets are prefixes of larger ones.
+  PointList prefix;
+  get_halton_ellipsoid(
+      {.num_points = 1000, .scale = scale, .a = a, .b = b, .c = c}, prefix);
+  REQUIRE(prefix.size() == 1000);
+  REQUIRE(std::equal(prefix.begin(), prefix.end(), points.begin()));
+
+  // The prefix still spans the ellipsoid.
+  const float x_extent = scale * ::sqrt(a), y_extent = scale * ::sqrt(b),
+              z_extent = scale * ::sqrt(c);
+  float x_max = 0.0, y_max = 0.0, z_max = 0.0;
+  for (const auto &point : prefix) {
+    x_max = max(x_max, fabs(point[0]));
+    y_max = max(y_max, fabs(point[1]));
+    z_max = max(z_max, fabs(point[2]));
+  }
+  REQUIRE(x_max > 0.9 * x_extent);
+  REQUIRE(y_max > 0.9 * y_extent);
+  REQUIRE(z_max > 0.9 * z_extent);
+}
+
 TEST_CASE("mesaac::shape::Hammersley - get_cuboid", "[mesaac]") {
   // Lacking better ideas, how about a semi-random test for a
   // flattish volume?
@@ -0,0 +1,133 @@
+// Unit test for point_set
+// Copyright (c) 2010 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "mesaac_shape/hammersley.hpp"
+#include "mesaac_shape/point_set.hpp"
+
+using namespace std;
+
+namespace mesaac::shape {
+
+namespace {
+filesystem::path write_points(const string &content) {
+  const auto result =
+      filesystem::temp_directory_path() / "test_point_set_points.txt";
+  filesystem::remove(point_set_cache_path(result));
+  ofstream outf(result);
+  outf << content;
+  return result;
+}
+
+PointList read_text_points(const filesystem::path &path) {
+  PointList result;
+  ifstream inf(path);
+  float x, y, z;
+  while (inf >> x >> y >> z) {
+    result.push_back({x, y, z});
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("mesaac::shape::read_point_set", "[mesaac][mesaac_shape]") {
+  SECTION("Parse and cache") {
+    const auto path = write_points("1.0 2.0 3.0\n-4.5 5e-1 6\n  7 8 9.25\n");
+    const PointList expected{{1.0, 2.0, 3.0}, {-4.5, 0.5, 6.0}, {7, 8, 9.25}};
+
+    REQUIRE(read_point_set(path) == expected);
+    REQUIRE(filesystem::exists(point_set_cache_path(path)));
+    // The second read comes from the cache.
+    REQUIRE(read_point_set(path) == expected);
+  }
+
+  SECTION("Stale cache") {
+    const auto path = write_points("1 2 3\n");
+    REQUIRE(read_point_set(path) == PointList{{1, 2, 3}});
+
+    // Same size, different content.
+    write_points("3 2 1\n");
+    REQUIRE(read_point_set(path) == PointList{{3, 2, 1}});
+  }
+
+  SECTION("Corrupt cache") {
+    const auto path = write_points("1 2 3\n");
+    {
+      ofstream outf(point_set_cache_path(path), ios::binary);
+      outf << "garbage";
+    }
+    REQUIRE(read_point_set(path) == PointList{{1, 2, 3}});
+  }
+
+  SECTION("Incomplete and invalid input") {
+    const auto path = write_points("1 2 3\n4 5 6\n7 8\n");
+    REQUIRE(read_point_set(path).size() == 2);
+
+    write_points("1 2 3\nx 5 6\n");
+    REQUIRE(read_point_set(path).size() == 1);
+
+    write_points("");
+    REQUIRE(read_point_set(path).empty());
+  }
+
+  SECTION("Hammersley sphere") {
+    // Work on a copy, to keep the cache out of the test data directory.
+    const filesystem::path data_path(
+        string(TEST_DATA_DIR) + "/hammersley/hamm_spheroid_10k_11rad.txt");
+    const auto path = write_points("");
+    filesystem::copy_file(data_path, path,
+                          filesystem::copy_options::overwrite_existing);
+    const auto expected = read_text_points(path);
+    REQUIRE(expected.size() == 10240);
+    REQUIRE(read_point_set(path) == expected);
+    REQUIRE(read_point_set(path) == expected);
+  }
+
+  SECTION("Nonexistent file") {
+    REQUIRE_THROWS_AS(
+        read_point_set(filesystem::temp_directory_path() / "no_such.txt"),
+        std::runtime_error);
+  }
+}
+
+TEST_CASE("mesaac::shape::get_point_cloud", "[mesaac][mesaac_shape]") {
+  SECTION("Generated cloud") {
+    PointList expected;
+    Hammersley::get_ellipsoid(
+        {.num_points = 2000, .scale = 11.0, .a = 1.0, .b = 0.5, .c = 0.5},
+        expected);
+    REQUIRE(!expected.empty());
+    REQUIRE(get_point_cloud("cloud:2000,11,1,0.5,0.5") == expected);
+  }
+
+  SECTION("Generated Halton cloud") {
+    const auto points = get_point_cloud("halton:2000,11,1,0.5,0.5");
+    REQUIRE(points.size() == 2000);
+    REQUIRE(is_point_cloud_spec("halton:2000,11,1,0.5,0.5"));
+    REQUIRE_THROWS_AS(get_point_cloud("halton:2000,11,1,0.5"),
+                      std::invalid_argument);
+  }
+
+  SECTION("Invalid cloud specs") {
+    for (const string spec :
+         {"cloud:", "cloud:2000", "cloud:2000,11,1,1", "cloud:2000,11,1,1,1,",
+          "cloud:2000,11,1,1,x", "cloud:0,11,1,1,1", "cloud:2000,11,0,1,1",
+          "cloud:2000,-11,1,1,1"}) {
+      REQUIRE_THROWS_AS(get_point_cloud(spec), std::invalid_argument);
+    }
+  }
+
+  SECTION("Point cloud file") {
+    const auto path = write_points("1 2 3\n");
+    REQUIRE(!is_point_cloud_spec(path.string()));
+    REQUIRE(get_point_cloud(path.string()) == PointList{{1, 2, 3}});
+  }
+}
+
+} // namespace mesaac::shape
@@ -0,0 +1,186 @@
+// Unit test for usr_descriptors.
+// Copyright (c) 2011 Mesa Analytics & Computing, Inc.  All rights reserved
+//
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "mesaac_shape/usr_descriptors.hpp"
+
+using namespace std;
+
+namespace mesaac::shape {
+namespace {
+using Catch::Matchers::WithinAbs;
+
+mol::Atom make_atom(unsigned int atomic_num, float x, float y, float z) {
+  return mol::Atom({atomic_num, {x, y, z}});
+}
+
+mol::Mol make_mol(const mol::AtomVector &atoms) {
+  return mol::Mol({.atoms = atoms});
+}
+
+// A small, asymmetric molecule with every USRCAT atom class.
+mol::AtomVector sample_atoms() {
+  return {
+      make_atom(6, 0.0, 0.0, 0.0),   make_atom(6, 1.5, 0.1, 0.0),
+      make_atom(7, 2.2, 1.3, 0.2),   make_atom(8, 3.6, 1.2, -0.4),
+      make_atom(6, 2.1, -1.2, 0.3),  make_atom(9, 2.9, -2.0, 1.1),
+      make_atom(17, -1.2, 0.9, 1.4), make_atom(1, -0.5, -0.9, -0.3),
+  };
+}
+
+array<float, NumUsrDescriptors> usr(const mol::Mol &mol) {
+  array<float, NumUsrDescriptors> result;
+  get_usr_descriptors(mol, result);
+  return result;
+}
+
+array<float, NumUsrcatDescriptors> usrcat(const mol::Mol &mol) {
+  array<float, NumUsrcatDescriptors> result;
+  get_usrcat_descriptors(mol, result);
+  return result;
+}
+
+template <typename Descriptors>
+void require_equal(const Descriptors &actual, const Descriptors &expected) {
+  for (unsigned int k = 0; k != expected.size(); ++k) {
+    REQUIRE_THAT(actual[k], WithinAbs(expected[k], 1.0e-4));
+  }
+}
+} // namespace
+
+TEST_CASE("mesaac::shape::get_usr_descriptors", "[mesaac][mesaac_shape]") {
+  SECTION("Known values") {
+    // Four carbons along the x axis.  The centroid is at x = 1.5.  The
+    // closest atom is at x = 1, and the farthest at x = 3; the atom
+    // farthest from that is at x = 0.
+    const auto mol = make_mol({
+        make_atom(6, 0.0, 0.0, 0.0),
+        make_atom(6, 1.0, 0.0, 0.0),
+        make_atom(6, 2.0, 0.0, 0.0),
+        make_atom(6, 3.0, 0.0, 0.0),
+    });
+    const array<float, NumUsrDescriptors> expected{
+        1.0, 0.5,          0.0, // ctd
+        1.0, sqrt(0.5f),   0.0, // cst
+        1.5, sqrt(1.25f),  0.0, // fct
+        1.5, sqrt(1.25f),  0.0, // ftf
+    };
+    require_equal(usr(mol), expected);
+  }
+
+  SECTION("Skewed distances") {
+    // Distances from the centroid (1, 0, 0) are 1, 1, 2, 2, which are
+    // symmetric about their mean.
+    const auto mol = make_mol({
+        make_atom(6, 0.0, 0.0, 0.0),
+        make_atom(6, 2.0, 0.0, 0.0),
+        make_atom(6, 1.0, 2.0, 0.0),
+        make_atom(6, 1.0, -2.0, 0.0),
+    });
+    const auto actual = usr(mol);
+    REQUIRE_THAT(actual[0], WithinAbs(1.5, 1.0e-5));
+    REQUIRE_THAT(actual[2], WithinAbs(0.0, 1.0e-5));
+
+    const auto skewed = make_mol({
+        make_atom(6, 0.0, 0.0, 0.0),
+        make_atom(6, 2.0, 0.0, 0.0),
+        make_atom(6, 1.0, 2.0, 0.0),
+    });
+    // The centroid is (1, 2/3, 0), so the distances are not symmetric.
+    const float d0 = sqrt(1.0 + 4.0 / 9.0), d2 = 4.0 / 3.0;
+    const float mean = (2 * d0 + d2) / 3;
+    const float third = (2 * pow(d0 - mean, 3.0f) + pow(d2 - mean, 3.0f)) / 3;
+    const auto skewed_actual = usr(skewed);
+    REQUIRE_THAT(skewed_actual[0], WithinAbs(mean, 1.0e-5));
+    REQUIRE_THAT(skewed_actual[2], WithinAbs(cbrt(third), 1.0e-4));
+  }
+
+  SECTION("Hydrogens are ignored") {
+    auto atoms = sample_atoms();
+    const auto expected = usr(make_mol(atoms));
+    atoms.push_back(make_atom(1, 9.0, 9.0, 9.0));
+    require_equal(usr(make_mol(atoms)), expected);
+  }
+
+  SECTION("Invariant under rotation and translation") {
+    const auto atoms = sample_atoms();
+    const auto expected = usr(make_mol(atoms));
+
+    // Rotate 30 degrees about z, then translate.
+    const float c = cos(M_PI / 6), s = sin(M_PI / 6);
+    mol::AtomVector moved;
+    for (const auto &atom : atoms) {
+      const auto p = atom.pos();
+      moved.push_back(make_atom(atom.atomic_num(),
+                                c * p.x() - s * p.y() + 4.0,
+                                s * p.x() + c * p.y() - 2.0, p.z() + 7.0));
+    }
+    require_equal(usr(make_mol(moved)), expected);
+  }
+
+  SECTION("No heavy atoms") {
+    const array<float, NumUsrDescriptors> zeros{};
+    require_equal(usr(make_mol({})), zeros);
+    require_equal(usr(make_mol({make_atom(1, 1.0, 2.0, 3.0)})), zeros);
+  }
+
+  SECTION("Wrong size") {
+    const auto mol = make_mol(sample_atoms());
+    vector<float> too_small(NumUsrDescriptors - 1);
+    REQUIRE_THROWS_AS(get_usr_descriptors(mol, too_small),
+                      std::invalid_argument);
+    vector<float> too_large(NumUsrcatDescriptors + 1);
+    REQUIRE_THROWS_AS(get_usrcat_descriptors(mol, too_large),
+                      std::invalid_argument);
+  }
+}
+
+TEST_CASE("mesaac::shape::get_usrcat_descriptors", "[mesaac][mesaac_shape]") {
+  const auto mol = make_mol(sample_atoms());
+  const auto usr_values = usr(mol);
+  const auto usrcat_values = usrcat(mol);
+
+  SECTION("Leading USR descriptors") {
+    for (unsigned int k = 0; k != NumUsrDescriptors; ++k) {
+      REQUIRE(usrcat_values[k] == usr_values[k]);
+    }
+  }
+
+  SECTION("Single-atom classes") {
+    // The molecule has one nitrogen: its distances to the reference points
+    // have no spread.
+    const unsigned int nitrogen = 2 * NumUsrDescriptors;
+    for (unsigned int ref = 0; ref != 4; ++ref) {
+      REQUIRE(usrcat_values[nitrogen + 3 * ref] > 0.0);
+      REQUIRE_THAT(usrcat_values[nitrogen + 3 * ref + 1],
+                   WithinAbs(0.0, 1.0e-6));
+      REQUIRE_THAT(usrcat_values[nitrogen + 3 * ref + 2],
+                   WithinAbs(0.0, 1.0e-6));
+    }
+  }
+
+  SECTION("Empty classes") {
+    const auto carbons = make_mol({
+        make_atom(6, 0.0, 0.0, 0.0),
+        make_atom(6, 1.0, 0.0, 0.0),
+        make_atom(6, 1.0, 1.0, 0.0),
+    });
+    const auto values = usrcat(carbons);
+    for (unsigned int k = 2 * NumUsrDescriptors; k != values.size(); ++k) {
+      REQUIRE(values[k] == 0.0);
+    }
+    // Hydrophobic descriptors are the same as for all heavy atoms.
+    for (unsigned int k = 0; k != NumUsrDescriptors; ++k) {
+      REQUIRE(values[NumUsrDescriptors + k] == values[k]);
+    }
+  }
+}
+} // namespace mesaac::shape